@@ -28,6 +28,7 @@
 #include <type_traits>
 #include <utility>
 #include <POLDER/details/config.h>
+#include <POLDER/execution.h>
 #include <POLDER/math/details/cmath_base.h>
 
 namespace polder
@@ -81,6 +82,42 @@ namespace polder
     auto for_each(InputIt1 first1, InputIt1 last1, InputIt2 first2, BinaryOperation binary_op)
         -> BinaryOperation;
 
+    /**
+     * @brief Applies an unary function to a range.
+     *
+     * Same as the overload without an execution policy,
+     * except that the elements may be processed by several
+     * threads, depending on the policy.
+     *
+     * @param policy Execution policy
+     * @param first First element of the range
+     * @param last Last element of the range
+     * @param unary_op Operation to apply to the range
+     */
+    template<typename ExecutionPolicy, typename RandomAccessIt, typename UnaryOperation>
+    auto for_each(ExecutionPolicy&& policy, RandomAccessIt first, RandomAccessIt last,
+                  UnaryOperation unary_op)
+        -> std::enable_if_t<execution::is_execution_policy<std::decay_t<ExecutionPolicy>>::value>;
+
+    /**
+     * @brief Applies a binary function to a range.
+     *
+     * Same as the overload without an execution policy,
+     * except that the elements may be processed by several
+     * threads, depending on the policy.
+     *
+     * @param policy Execution policy
+     * @param first1 First element of the first range
+     * @param last1 Last element of the first range
+     * @param first2 First element of the second range
+     * @param binary_op Operation to apply to the range
+     */
+    template<typename ExecutionPolicy, typename RandomAccessIt1,
+             typename RandomAccessIt2, typename BinaryOperation>
+    auto for_each(ExecutionPolicy&& policy, RandomAccessIt1 first1, RandomAccessIt1 last1,
+                  RandomAccessIt2 first2, BinaryOperation binary_op)
+        -> std::enable_if_t<execution::is_execution_policy<std::decay_t<ExecutionPolicy>>::value>;
+
     /**
      * @brief Fused std::min_element and std::is_sorted.
      *
@@ -51,6 +51,33 @@ auto for_each(InputIt1 first1, InputIt1 last1, InputIt2 first2, BinaryOperation
     return binary_op;
 }
 
+template<typename ExecutionPolicy, typename RandomAccessIt, typename UnaryOperation>
+auto for_each(ExecutionPolicy&& policy, RandomAccessIt first, RandomAccessIt last,
+              UnaryOperation unary_op)
+    -> std::enable_if_t<execution::is_execution_policy<std::decay_t<ExecutionPolicy>>::value>
+{
+    execution::parallel_for(policy, last - first,
+        [&](std::size_t begin, std::size_t end)
+        {
+            std::for_each(first + begin, first + end, unary_op);
+        }
+    );
+}
+
+template<typename ExecutionPolicy, typename RandomAccessIt1,
+         typename RandomAccessIt2, typename BinaryOperation>
+auto for_each(ExecutionPolicy&& policy, RandomAccessIt1 first1, RandomAccessIt1 last1,
+              RandomAccessIt2 first2, BinaryOperation binary_op)
+    -> std::enable_if_t<execution::is_execution_policy<std::decay_t<ExecutionPolicy>>::value>
+{
+    execution::parallel_for(policy, last1 - first1,
+        [&](std::size_t begin, std::size_t end)
+        {
+            polder::for_each(first1 + begin, first1 + end, first2 + begin, binary_op);
+        }
+    );
+}
+
 template<class ForwardIt, class Compare>
 auto min_element_and_is_sorted(ForwardIt first, ForwardIt last, Compare comp)
     -> decltype(auto)
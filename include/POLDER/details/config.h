@@ -226,6 +226,40 @@
 
 #endif
 
+////////////////////////////////////////////////////////////
+// Instruction set dispatch tools
+////////////////////////////////////////////////////////////
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+
+    // Functions can be compiled for a specific instruction
+    // set and selected at runtime depending on the CPU
+    #define POLDER_X86_DISPATCH 1
+
+    #define POLDER_TARGET(isa) __attribute__((target(isa)))
+
+#else
+
+    #define POLDER_X86_DISPATCH 0
+
+    #define POLDER_TARGET(isa)
+
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+
+    // Inlines every call made in the function; combined with
+    // POLDER_TARGET, generic code called from the function is
+    // compiled for the target instruction set
+    #define POLDER_FLATTEN __attribute__((flatten))
+
+#else
+
+    #define POLDER_FLATTEN
+
+#endif
+
 ////////////////////////////////////////////////////////////
 // Some global documentation
 ////////////////////////////////////////////////////////////
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+////////////////////////////////////////////////////////////
+// parallel_policy
+////////////////////////////////////////////////////////////
+
+inline auto parallel_policy::on(thread_pool& pool) const
+    -> parallel_policy
+{
+    parallel_policy res = *this;
+    res._pool = &pool;
+    return res;
+}
+
+inline auto parallel_policy::with_threshold(std::size_t threshold) const
+    -> parallel_policy
+{
+    parallel_policy res = *this;
+    res._threshold = threshold;
+    return res;
+}
+
+inline auto parallel_policy::pool() const
+    -> thread_pool&
+{
+    return _pool ? *_pool : thread_pool::default_pool();
+}
+
+inline auto parallel_policy::threshold() const
+    -> std::size_t
+{
+    return _threshold;
+}
+
+////////////////////////////////////////////////////////////
+// Parallel building blocks
+////////////////////////////////////////////////////////////
+
+inline auto for_work(sequenced_policy policy, std::size_t)
+    -> sequenced_policy
+{
+    return policy;
+}
+
+inline auto for_work(const parallel_policy& policy, std::size_t work)
+    -> parallel_policy
+{
+    return policy.with_threshold(
+        work < policy.threshold() ? std::numeric_limits<std::size_t>::max() : 0
+    );
+}
+
+namespace details
+{
+    // Number of chunks a parallel algorithm splits its work
+    // into: more chunks than threads helps to balance work
+    // between the threads through work stealing
+    inline auto nb_chunks(const parallel_policy& policy, std::size_t size)
+        -> std::size_t
+    {
+        if (size < 2 || size < policy.threshold())
+        {
+            return 1;
+        }
+        const std::size_t nb_threads = policy.pool().size() + 1;
+        return std::min(size, nb_threads == 1 ? 1 : 4 * nb_threads);
+    }
+
+    inline auto chunk_begin(std::size_t size, std::size_t chunk, std::size_t nb_chunks)
+        -> std::size_t
+    {
+        return size / nb_chunks * chunk + std::min(chunk, size % nb_chunks);
+    }
+
+    // Runs func(chunk) for every chunk in [0, nb_chunks),
+    // the calling thread running the first one and helping
+    // with the other ones until they are all done
+    template<typename Function>
+    auto run_chunks(thread_pool& pool, std::size_t nb_chunks, Function& func)
+        -> void
+    {
+        std::atomic<std::size_t> remaining(nb_chunks - 1);
+        std::exception_ptr exception;
+        std::mutex exception_mutex;
+
+        auto guarded_call = [&](std::size_t chunk) {
+            try
+            {
+                func(chunk);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(exception_mutex);
+                if (not exception)
+                {
+                    exception = std::current_exception();
+                }
+            }
+        };
+
+        for (std::size_t chunk = 1 ; chunk < nb_chunks ; ++chunk)
+        {
+            pool.submit([&, chunk] {
+                guarded_call(chunk);
+                --remaining;
+            });
+        }
+        guarded_call(0);
+
+        // The tasks reference the current stack frame, so
+        // we have to wait for them even if something threw
+        while (remaining.load() != 0)
+        {
+            if (not pool.try_run_pending_task())
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////
+// Parallel building blocks
+////////////////////////////////////////////////////////////
+
+template<typename Function>
+auto parallel_for(sequenced_policy, std::size_t size, Function&& func)
+    -> void
+{
+    func(std::size_t(0), size);
+}
+
+template<typename Function>
+auto parallel_for(const parallel_policy& policy, std::size_t size, Function&& func)
+    -> void
+{
+    const std::size_t nb_chunks = details::nb_chunks(policy, size);
+    if (nb_chunks == 1)
+    {
+        func(std::size_t(0), size);
+        return;
+    }
+
+    auto chunk_func = [&](std::size_t chunk) {
+        func(details::chunk_begin(size, chunk, nb_chunks),
+             details::chunk_begin(size, chunk + 1, nb_chunks));
+    };
+    details::run_chunks(policy.pool(), nb_chunks, chunk_func);
+}
+
+template<typename Result, typename Map, typename Reduce>
+auto parallel_reduce(sequenced_policy, std::size_t size,
+                     Map&& map, Reduce&&)
+    -> Result
+{
+    POLDER_ASSERT(size > 0);
+    return map(std::size_t(0), size);
+}
+
+template<typename Result, typename Map, typename Reduce>
+auto parallel_reduce(const parallel_policy& policy, std::size_t size,
+                     Map&& map, Reduce&& reduce)
+    -> Result
+{
+    POLDER_ASSERT(size > 0);
+
+    const std::size_t nb_chunks = details::nb_chunks(policy, size);
+    if (nb_chunks == 1)
+    {
+        return map(std::size_t(0), size);
+    }
+
+    // Chunks are never empty since nb_chunks <= size; the
+    // results are not stored in a std::vector because of
+    // std::vector<bool> which can not be written concurrently
+    std::unique_ptr<Result[]> results(new Result[nb_chunks]);
+    auto chunk_func = [&](std::size_t chunk) {
+        results[chunk] = map(details::chunk_begin(size, chunk, nb_chunks),
+                             details::chunk_begin(size, chunk + 1, nb_chunks));
+    };
+    details::run_chunks(policy.pool(), nb_chunks, chunk_func);
+
+    Result res = results[0];
+    for (std::size_t i = 1 ; i < nb_chunks ; ++i)
+    {
+        res = reduce(res, results[i]);
+    }
+    return res;
+}
@@ -16,137 +16,145 @@
  * see <http://www.gnu.org/licenses/>.
  */
 
+template<typename T, typename Allocator>
+constexpr std::size_t Matrix<T, Allocator>::alignment;
+
 ////////////////////////////////////////////////////////////
 // Defaulted functions
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-Matrix<T>::Matrix() = default;
+template<typename T, typename Allocator>
+Matrix<T, Allocator>::Matrix() = default;
+
+template<typename T, typename Allocator>
+Matrix<T, Allocator>::Matrix(const Allocator& alloc):
+    _data(alloc)
+{}
+
+template<typename T, typename Allocator>
+Matrix<T, Allocator>::~Matrix() = default;
+
+// The rows are computed on the fly, so copying a
+// Matrix only copies its dimensions and its data
+template<typename T, typename Allocator>
+Matrix<T, Allocator>::Matrix(const Matrix& other) = default;
 
-template<typename T>
-Matrix<T>::~Matrix() = default;
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::operator=(const Matrix<T, Allocator>& other) &
+    -> Matrix& = default;
 
 ////////////////////////////////////////////////////////////
 // Constructors
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-Matrix<T>::Matrix(const Matrix& other):
+template<typename T, typename Allocator>
+Matrix<T, Allocator>::Matrix(Matrix<T, Allocator>&& other) noexcept:
     _height(other._height),
     _width(other._width),
-    _data(other._data),
-    _rows()
+    _data(std::move(other._data))
 {
-    for (size_type i = 0 ; i < height() ; ++i)
-    {
-        T* target = _data.data() + i * _width;
-        _rows.emplace_back(_width, target);
-    }
+    other._height = 0;
+    other._width = 0;
 }
 
-template<typename T>
-Matrix<T>::Matrix(Matrix<T>&& other) noexcept:
-    _height(other._height),
-    _width(other._width),
-    _data(std::move(other._data)),
-    _rows(std::move(other._rows))
-{}
-
-template<typename T>
-Matrix<T>::Matrix(std::initializer_list<T> values):
+template<typename T, typename Allocator>
+Matrix<T, Allocator>::Matrix(std::initializer_list<T> values, const Allocator& alloc):
     _height(1),
     _width(values.size()),
-    _data(std::begin(values), std::end(values)),
-    _rows()
-{
-    _rows.emplace_back(_width, data());
-}
+    _data(std::begin(values), std::end(values), alloc)
+{}
 
-template<typename T>
-Matrix<T>::Matrix(std::initializer_list<std::initializer_list<T>> values):
+template<typename T, typename Allocator>
+Matrix<T, Allocator>::Matrix(std::initializer_list<std::initializer_list<T>> values,
+                             const Allocator& alloc):
     _height(values.size()),
     _width(std::begin(values)->size()),
-    _data(_height*_width), // reserve memory
-    _rows()
+    _data(alloc)
 {
-    size_type _count = 0;
+    _data.reserve(_height * _width);
     for (const auto& row: values)
     {
         if (row.size() != _width)
         {
             throw std::logic_error("All the rows in a Matrix should have the same size.");
         }
-        T* target = _data.data() + _count * _width;
-        _rows.emplace_back(_width, target);
-        std::copy(std::begin(row), std::end(row), target);
-        ++_count;
+        _data.insert(std::end(_data), std::begin(row), std::end(row));
     }
 }
 
-template<typename T>
-Matrix<T>::Matrix(size_type h, size_type w):
+template<typename T, typename Allocator>
+Matrix<T, Allocator>::Matrix(size_type h, size_type w, const Allocator& alloc):
     _height(h),
     _width(w),
-    _data(_height*_width), // reserve memory
-    _rows()
-{
-    for (size_type i = 0 ; i < height() ; ++i)
-    {
-        T* target = _data.data() + i * _width;
-        _rows.emplace_back(_width, target);
-    }
-}
+    _data(_height*_width, alloc) // reserve memory
+{}
 
-template<typename T>
-Matrix<T>::Matrix(size_type w):
-    Matrix<T>(1, w)
+template<typename T, typename Allocator>
+Matrix<T, Allocator>::Matrix(size_type w, const Allocator& alloc):
+    Matrix<T, Allocator>(1, w, alloc)
 {}
 
+template<typename T, typename Allocator>
+template<typename Derived>
+Matrix<T, Allocator>::Matrix(const ImmutableMatrix<Derived>& expr):
+    Matrix<T, Allocator>(expr, Allocator())
+{}
+
+template<typename T, typename Allocator>
+template<typename Derived>
+Matrix<T, Allocator>::Matrix(const ImmutableMatrix<Derived>& expr, const Allocator& alloc):
+    Matrix<T, Allocator>(expr.height(), expr.width(), alloc)
+{
+    details::apply_expression(data(), expr.derived(), assign());
+}
+
 ////////////////////////////////////////////////////////////
 // Construction functions
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-auto Matrix<T>::zeros(size_type height, size_type width)
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::zeros(size_type height, size_type width,
+                                 const Allocator& alloc)
     -> Matrix
 {
-    auto res = Matrix<T>(height, width);
+    auto res = Matrix<T, Allocator>(height, width, alloc);
     res.fill(T{});
     return res;
 }
 
-template<typename T>
-auto Matrix<T>::zeros(size_type width)
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::zeros(size_type width, const Allocator& alloc)
     -> Matrix
 {
-    auto res = Matrix<T>(width);
+    auto res = Matrix<T, Allocator>(width, alloc);
     res.fill(T{});
     return res;
 }
 
-template<typename T>
-auto Matrix<T>::ones(size_type height, size_type width)
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::ones(size_type height, size_type width,
+                                const Allocator& alloc)
     -> Matrix
 {
-    auto res = Matrix<T>(height, width);
+    auto res = Matrix<T, Allocator>(height, width, alloc);
     res.fill(T{1});
     return res;
 }
 
-template<typename T>
-auto Matrix<T>::ones(size_type width)
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::ones(size_type width, const Allocator& alloc)
     -> Matrix
 {
-    auto res = Matrix<T>(width);
+    auto res = Matrix<T, Allocator>(width, alloc);
     res.fill(T{1});
     return res;
 }
 
-template<typename T>
-auto Matrix<T>::identity(size_type size)
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::identity(size_type size, const Allocator& alloc)
     -> Matrix
 {
-    auto res = zeros(size, size);
+    auto res = zeros(size, size, alloc);
     for (size_type i = 0 ; i < size ; ++i)
     {
         res(i, i) = T{1};
@@ -154,13 +162,13 @@ auto Matrix<T>::identity(size_type size)
     return res;
 }
 
-template<typename T>
-auto Matrix<T>::eye(size_type x, size_type y, int k)
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::eye(size_type x, size_type y, int k, const Allocator& alloc)
     -> Matrix
 {
     POLDER_ASSERT(x > 0);
 
-    Matrix<T> res = (y == 0) ? Matrix<T>(x, x) : Matrix<T>(x, y);
+    Matrix<T, Allocator> res(x, (y == 0) ? x : y, alloc);
     for (size_type i = 0 ; i < res.height() ; ++i)
     {
         for (size_type j = 0 ; j < res.width() ; ++j)
@@ -182,36 +190,40 @@ auto Matrix<T>::eye(size_type x, size_type y, int k)
 // Assignment operator
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-auto Matrix<T>::operator=(const Matrix<T>& other) &
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::operator=(Matrix<T, Allocator>&& other) & noexcept
     -> Matrix&
 {
     if (this != &other)
     {
         _height = other._height;
         _width = other._width;
-        _data = other._data;
-        _rows = std::vector<row>();
-        for (size_type i = 0 ; i < height() ; ++i)
-        {
-            T* target = _data.data() + i * _width;
-            _rows.emplace_back(_width, target);
-        }
+        _data = std::move(other._data);
+        other._height = 0;
+        other._width = 0;
     }
     return *this;
 }
 
-template<typename T>
-auto Matrix<T>::operator=(Matrix<T>&& other) & noexcept
+template<typename T, typename Allocator>
+template<typename Derived>
+auto Matrix<T, Allocator>::operator=(const ImmutableMatrix<Derived>& expr) &
     -> Matrix&
 {
-    if (this != &other)
+    if (not details::has_flat_access<Derived>::value)
     {
-        _height = other._height;
-        _width = other._width;
-        _data = std::move(other._data);
-        _rows = std::move(other._rows);
+        // The expression may read elements of this
+        // Matrix after they have been overwritten
+        return *this = Matrix<T, Allocator>(expr, get_allocator());
     }
+
+    if (height() != expr.height() || width() != expr.width())
+    {
+        *this = Matrix<T, Allocator>(expr.height(), expr.width(), get_allocator());
+    }
+    // Element-wise expressions only read the element
+    // being written, so they can be evaluated in place
+    details::apply_expression(data(), expr.derived(), assign());
     return *this;
 }
 
@@ -219,29 +231,29 @@ auto Matrix<T>::operator=(Matrix<T>&& other) & noexcept
 // Operators (accessors)
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-auto Matrix<T>::operator[](size_type index)
-    -> row&
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::operator[](size_type index)
+    -> row
 {
-    return _rows[index];
+    return { _width, _data.data() + index * _width };
 }
 
-template<typename T>
-auto Matrix<T>::operator[](size_type index) const
-    -> const row&
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::operator[](size_type index) const
+    -> const_row
 {
-    return _rows[index];
+    return { _width, _data.data() + index * _width };
 }
 
-template<typename T>
-auto Matrix<T>::operator()(size_type y, size_type x)
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::operator()(size_type y, size_type x)
     -> reference
 {
     return _data[y*width()+x];
 }
 
-template<typename T>
-auto Matrix<T>::operator()(size_type y, size_type x) const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::operator()(size_type y, size_type x) const
     -> value_type
 {
     return _data[y*width()+x];
@@ -251,8 +263,8 @@ auto Matrix<T>::operator()(size_type y, size_type x) const
 // Matrix-Matrix arithmetic operations
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-auto Matrix<T>::operator+=(const Matrix<T>& other)
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::operator+=(const Matrix<T, Allocator>& other)
     -> Matrix&
 {
     POLDER_ASSERT(width() == other.width());
@@ -261,8 +273,8 @@ auto Matrix<T>::operator+=(const Matrix<T>& other)
     return *this;
 }
 
-template<typename T>
-auto Matrix<T>::operator-=(const Matrix<T>& other)
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::operator-=(const Matrix<T, Allocator>& other)
     -> Matrix&
 {
     POLDER_ASSERT(width() == other.width());
@@ -271,45 +283,81 @@ auto Matrix<T>::operator-=(const Matrix<T>& other)
     return *this;
 }
 
-template<typename T>
-auto Matrix<T>::operator*=(const Matrix<T>& other)
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::operator*=(const Matrix<T, Allocator>& other)
     -> Matrix&
 {
     *this = (*this * other);
     return *this;
 }
 
-template<typename T>
-auto Matrix<T>::operator/=(const Matrix<T>& other)
-    -> Matrix<T>&
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::operator/=(const Matrix<T, Allocator>& other)
+    -> Matrix<T, Allocator>&
 {
-    POLDER_ASSERT(is_square());
-    POLDER_ASSERT(other.is_invertible());
-    return (*this) *= inverse(other);
+    POLDER_ASSERT(other.is_square());
+    details::divide_assign(*this, other, std::is_integral<T>{});
+    return *this;
+}
+
+////////////////////////////////////////////////////////////
+// Matrix-expression arithmetic operations
+////////////////////////////////////////////////////////////
+
+template<typename T, typename Allocator>
+template<typename Derived>
+auto Matrix<T, Allocator>::operator+=(const ImmutableMatrix<Derived>& expr)
+    -> Matrix&
+{
+    POLDER_ASSERT(width() == expr.width());
+    POLDER_ASSERT(height() == expr.height());
+    if (not details::has_flat_access<Derived>::value)
+    {
+        return *this += Matrix<T, Allocator>(expr, get_allocator());
+    }
+    details::apply_expression(data(), expr.derived(), plus_assign());
+    return *this;
+}
+
+template<typename T, typename Allocator>
+template<typename Derived>
+auto Matrix<T, Allocator>::operator-=(const ImmutableMatrix<Derived>& expr)
+    -> Matrix&
+{
+    POLDER_ASSERT(width() == expr.width());
+    POLDER_ASSERT(height() == expr.height());
+    if (not details::has_flat_access<Derived>::value)
+    {
+        return *this -= Matrix<T, Allocator>(expr, get_allocator());
+    }
+    details::apply_expression(data(), expr.derived(), minus_assign());
+    return *this;
 }
 
 ////////////////////////////////////////////////////////////
 // Matrix-value_type arithmetic operations
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-auto Matrix<T>::operator*=(value_type other)
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::operator*=(value_type other)
     -> Matrix&
 {
-    for (auto& val: _data)
+    T* ptr = assume_aligned<alignment>(data());
+    for (size_type i = 0 ; i < size() ; ++i)
     {
-        val *= other;
+        ptr[i] *= other;
     }
     return *this;
 }
 
-template<typename T>
-auto Matrix<T>::operator/=(value_type other)
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::operator/=(value_type other)
     -> Matrix&
 {
-    for (auto& val: _data)
+    T* ptr = assume_aligned<alignment>(data());
+    for (size_type i = 0 ; i < size() ; ++i)
     {
-        val /= other;
+        ptr[i] /= other;
     }
     return *this;
 }
@@ -319,132 +367,152 @@ auto Matrix<T>::operator/=(value_type other)
 ////////////////////////////////////////////////////////////
 
 // Accessors
-template<typename T>
-auto Matrix<T>::front()
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::front()
     -> reference
 {
     return _data.front();
 }
-template<typename T>
-auto Matrix<T>::front() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::front() const
     -> const_reference
 {
     return _data.front();
 }
 
-template<typename T>
-auto Matrix<T>::back()
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::back()
     -> reference
 {
     return _data.back();
 }
-template<typename T>
-auto Matrix<T>::back() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::back() const
     -> const_reference
 {
     return _data.back();
 }
 
-template<typename T>
-auto Matrix<T>::data()
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::data()
     -> T*
 {
     return _data.data();
 }
-template<typename T>
-auto Matrix<T>::data() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::data() const
     -> const T*
 {
     return _data.data();
 }
 
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::get_allocator() const
+    -> allocator_type
+{
+    return _data.get_allocator();
+}
+
 // Iterators
-template<typename T>
-auto Matrix<T>::begin()
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::begin()
     -> iterator
 {
-    return std::begin(_rows);
+    return { _data.data(), _width, 0 };
 }
-template<typename T>
-auto Matrix<T>::begin() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::begin() const
     -> const_iterator
 {
-    return std::begin(_rows);
+    return { _data.data(), _width, 0 };
 }
-template<typename T>
-auto Matrix<T>::cbegin() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::cbegin() const
     -> const_iterator
 {
-    return std::begin(_rows);
+    return { _data.data(), _width, 0 };
 }
 
-template<typename T>
-auto Matrix<T>::end()
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::end()
     -> iterator
 {
-    return std::end(_rows);
+    return { _data.data(), _width, difference_type(_height) };
 }
-template<typename T>
-auto Matrix<T>::end() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::end() const
     -> const_iterator
 {
-    return std::end(_rows);
+    return { _data.data(), _width, difference_type(_height) };
 }
-template<typename T>
-auto Matrix<T>::cend() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::cend() const
     -> const_iterator
 {
-    return std::end(_rows);
+    return { _data.data(), _width, difference_type(_height) };
 }
 
-template<typename T>
-auto Matrix<T>::rbegin()
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::rbegin()
     -> reverse_iterator
 {
-    return _rows.rbegin();
+    return reverse_iterator(end());
 }
-template<typename T>
-auto Matrix<T>::rbegin() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::rbegin() const
     -> const_reverse_iterator
 {
-    return _rows.rbegin();
+    return const_reverse_iterator(end());
 }
-template<typename T>
-auto Matrix<T>::crbegin() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::crbegin() const
     -> const_reverse_iterator
 {
-    return _rows.crbegin();
+    return const_reverse_iterator(cend());
 }
 
-template<typename T>
-auto Matrix<T>::rend()
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::rend()
     -> reverse_iterator
 {
-    return _rows.rend();
+    return reverse_iterator(begin());
 }
-template<typename T>
-auto Matrix<T>::rend() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::rend() const
     -> const_reverse_iterator
 {
-    return _rows.rend();
+    return const_reverse_iterator(begin());
 }
-template<typename T>
-auto Matrix<T>::crend() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::crend() const
     -> const_reverse_iterator
 {
-    return _rows.crend();
+    return const_reverse_iterator(cbegin());
 }
 
 // Modifiers
-template<typename T>
-auto Matrix<T>::fill(value_type value)
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::fill(value_type value)
     -> void
 {
     std::fill(std::begin(_data), std::end(_data), value);
 }
 
-template<typename T>
-auto Matrix<T>::swap(Matrix<T>&& other)
+template<typename T, typename Allocator>
+template<typename ExecutionPolicy>
+auto Matrix<T, Allocator>::fill(ExecutionPolicy&& policy, value_type value)
+    -> void
+{
+    execution::parallel_for(policy, _data.size(),
+        [&](std::size_t begin, std::size_t end)
+        {
+            std::fill(fbegin() + begin, fbegin() + end, value);
+        }
+    );
+}
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::swap(Matrix<T, Allocator>&& other)
     -> void
 {
     std::swap(*this, other);
@@ -454,8 +522,8 @@ auto Matrix<T>::swap(Matrix<T>&& other)
 // NumPy-like functions
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-auto Matrix<T>::all() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::all() const
     -> bool
 {
     for (const auto& val: _data)
@@ -468,8 +536,27 @@ auto Matrix<T>::all() const
     return true;
 }
 
-template<typename T>
-auto Matrix<T>::any() const
+template<typename T, typename Allocator>
+template<typename ExecutionPolicy>
+auto Matrix<T, Allocator>::all(ExecutionPolicy&& policy) const
+    -> bool
+{
+    if (_data.empty())
+    {
+        return true;
+    }
+    return execution::parallel_reduce<bool>(policy, _data.size(),
+        [&](std::size_t begin, std::size_t end)
+        {
+            return std::all_of(fbegin() + begin, fbegin() + end,
+                               [](const T& val) { return bool(val); });
+        },
+        std::logical_and<>{}
+    );
+}
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::any() const
     -> bool
 {
     for (const auto& val: _data)
@@ -482,51 +569,168 @@ auto Matrix<T>::any() const
     return false;
 }
 
-template<typename T>
-auto Matrix<T>::min() const
+template<typename T, typename Allocator>
+template<typename ExecutionPolicy>
+auto Matrix<T, Allocator>::any(ExecutionPolicy&& policy) const
+    -> bool
+{
+    if (_data.empty())
+    {
+        return false;
+    }
+    return execution::parallel_reduce<bool>(policy, _data.size(),
+        [&](std::size_t begin, std::size_t end)
+        {
+            return std::any_of(fbegin() + begin, fbegin() + end,
+                               [](const T& val) { return bool(val); });
+        },
+        std::logical_or<>{}
+    );
+}
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::min() const
     -> value_type
 {
     return *std::min_element(fbegin(), fend());
 }
 
-template<typename T>
-auto Matrix<T>::max() const
+template<typename T, typename Allocator>
+template<typename ExecutionPolicy>
+auto Matrix<T, Allocator>::min(ExecutionPolicy&& policy) const
+    -> value_type
+{
+    return execution::parallel_reduce<value_type>(policy, _data.size(),
+        [&](std::size_t begin, std::size_t end)
+        {
+            return *std::min_element(fbegin() + begin, fbegin() + end);
+        },
+        [](const T& lhs, const T& rhs) { return std::min(lhs, rhs); }
+    );
+}
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::max() const
     -> value_type
 {
     return *std::max_element(fbegin(), fend());
 }
 
-template<typename T>
-auto Matrix<T>::sum() const
+template<typename T, typename Allocator>
+template<typename ExecutionPolicy>
+auto Matrix<T, Allocator>::max(ExecutionPolicy&& policy) const
+    -> value_type
+{
+    return execution::parallel_reduce<value_type>(policy, _data.size(),
+        [&](std::size_t begin, std::size_t end)
+        {
+            return *std::max_element(fbegin() + begin, fbegin() + end);
+        },
+        [](const T& lhs, const T& rhs) { return std::max(lhs, rhs); }
+    );
+}
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::sum() const
     -> value_type
 {
     return std::accumulate(fbegin(), fend(), T{0});
 }
 
-template<typename T>
-auto Matrix<T>::reshape(size_type height, size_type width)
+template<typename T, typename Allocator>
+template<typename ExecutionPolicy>
+auto Matrix<T, Allocator>::sum(ExecutionPolicy&& policy) const
+    -> value_type
+{
+    if (_data.empty())
+    {
+        return T{0};
+    }
+    return execution::parallel_reduce<value_type>(policy, _data.size(),
+        [&](std::size_t begin, std::size_t end)
+        {
+            return std::accumulate(fbegin() + begin, fbegin() + end, T{0});
+        },
+        std::plus<>{}
+    );
+}
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::reshape(size_type height, size_type width)
     -> void
 {
     POLDER_ASSERT(height*width == size());
 
     _height = height;
     _width = width;
-    _rows = std::vector<row>();
-    for (size_type i = 0 ; i < _height ; ++i)
-    {
-        T* target = _data.data() + i * _width;
-        _rows.emplace_back(_width, target);
-    }
 }
 
-template<typename T>
-auto Matrix<T>::flatten()
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::flatten()
     -> void
 {
     _height = 1;
     _width = _data.size();
-    _rows = std::vector<row>();
-    _rows.emplace_back(_width, data());
+}
+
+////////////////////////////////////////////////////////////
+// Views
+////////////////////////////////////////////////////////////
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::view()
+    -> view_type
+{
+    return { _data.data(), _height, _width };
+}
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::view() const
+    -> const_view_type
+{
+    return { _data.data(), _height, _width };
+}
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::block(size_type y, size_type x, size_type height, size_type width)
+    -> view_type
+{
+    return view().block(y, x, height, width);
+}
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::block(size_type y, size_type x, size_type height, size_type width) const
+    -> const_view_type
+{
+    return view().block(y, x, height, width);
+}
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::col(size_type x)
+    -> column
+{
+    return view().col(x);
+}
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::col(size_type x) const
+    -> const_column
+{
+    return view().col(x);
+}
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::transposed()
+    -> transposed_type
+{
+    return view().transposed();
+}
+
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::transposed() const
+    -> const_transposed_type
+{
+    return view().transposed();
 }
 
 ////////////////////////////////////////////////////////////
@@ -534,30 +738,30 @@ auto Matrix<T>::flatten()
 ////////////////////////////////////////////////////////////
 
 // Capacity
-template<typename T>
-auto Matrix<T>::height() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::height() const
     -> size_type
 {
     return _height;
 }
 
-template<typename T>
-auto Matrix<T>::width() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::width() const
     -> size_type
 {
     return _width;
 }
 
 // Properties
-template<typename T>
-auto Matrix<T>::is_symmetric() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::is_symmetric() const
     -> bool
 {
     for (size_type i = 1 ; i < _height ; ++i)
     {
         for (size_type j = 0 ; j < i ; ++j)
         {
-            if (_rows[i][j] != _rows[j][i])
+            if (operator()(i, j) != operator()(j, i))
             {
                 return false;
             }
@@ -566,16 +770,16 @@ auto Matrix<T>::is_symmetric() const
     return true;
 }
 
-template<typename T>
-auto Matrix<T>::is_invertible() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::is_invertible() const
     -> bool
 {
     return is_square() && (determinant() != 0);
 }
 
 // other functions
-template<typename T>
-auto Matrix<T>::determinant() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::determinant() const
     -> value_type
 {
     POLDER_ASSERT(is_square());
@@ -586,41 +790,17 @@ auto Matrix<T>::determinant() const
         return _data[0] * _data[3] -
                _data[1] * _data[2];
     }
-    else
-    {
-        value_type res{};
-        // For all numbers in the first line
-        for (size_type i = 0 ; i < width() ; ++i)
-        {
-            // Create a matrix 1 degree lesser than the first one
-            Matrix<T> sub(height()-1, width()-1);
-
-            size_type count = 0;
-            // Fill the new matrix
-            for (size_type j = 1 ; j < height() ; ++j)
-            {
-                for (size_type k = 0 ; k < width() ; ++k)
-                {
-                    if (k != i)
-                    {
-                        sub._data[count++] = _rows[j][k];
-                    }
-                }
-            }
-            res += _data[i] * sub.determinant() * int(std::pow(-1, i));
-        }
-        return res;
-    }
+    return details::compute_determinant(*this, std::is_integral<T>{});
 }
 
-template<typename T>
-auto Matrix<T>::minor(size_type y, size_type x) const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::minor(size_type y, size_type x) const
     -> value_type
 {
     POLDER_ASSERT(y < height() && x < width());
 
     // Create a matrix 1 degree lesser than the first one
-    Matrix<T> sub(height()-1, width()-1);
+    Matrix<T, Allocator> sub(height()-1, width()-1, get_allocator());
 
     size_type count = 0;
     // Fill the new matrix
@@ -630,7 +810,7 @@ auto Matrix<T>::minor(size_type y, size_type x) const
         {
             if (i != y && j != x)
             {
-                sub._data[count++] = _rows[i][j];
+                sub._data[count++] = operator()(i, j);
             }
         }
     }
@@ -641,205 +821,88 @@ auto Matrix<T>::minor(size_type y, size_type x) const
 // Flat iterator functions
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-auto Matrix<T>::fbegin()
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::fbegin()
     -> flat_iterator
 {
     return std::begin(_data);
 }
-template<typename T>
-auto Matrix<T>::fbegin() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::fbegin() const
     -> const_flat_iterator
 {
     return std::begin(_data);
 }
-template<typename T>
-auto Matrix<T>::cfbegin() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::cfbegin() const
     -> const_flat_iterator
 {
     return std::begin(_data);
 }
 
-template<typename T>
-auto Matrix<T>::fend()
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::fend()
     -> flat_iterator
 {
     return std::end(_data);
 }
-template<typename T>
-auto Matrix<T>::fend() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::fend() const
     -> const_flat_iterator
 {
     return std::end(_data);
 }
-template<typename T>
-auto Matrix<T>::cfend() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::cfend() const
     -> const_flat_iterator
 {
     return std::end(_data);
 }
 
-template<typename T>
-auto Matrix<T>::rfbegin()
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::rfbegin()
     -> reverse_flat_iterator
 {
     return _data.rbegin();
 }
-template<typename T>
-auto Matrix<T>::rfbegin() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::rfbegin() const
     -> const_reverse_flat_iterator
 {
     return _data.rbegin();
 }
-template<typename T>
-auto Matrix<T>::crfbegin() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::crfbegin() const
     -> const_reverse_flat_iterator
 {
     return _data.crbegin();
 }
 
-template<typename T>
-auto Matrix<T>::rfend()
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::rfend()
     -> reverse_flat_iterator
 {
     return _data.rend();
 }
-template<typename T>
-auto Matrix<T>::rfend() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::rfend() const
     -> const_reverse_flat_iterator
 {
     return _data.rend();
 }
-template<typename T>
-auto Matrix<T>::crfend() const
+template<typename T, typename Allocator>
+auto Matrix<T, Allocator>::crfend() const
     -> const_reverse_flat_iterator
 {
     return _data.crend();
 }
 
-////////////////////////////////////////////////////////////
-// Matrix::row constructors
-////////////////////////////////////////////////////////////
-
-template<typename T>
-Matrix<T>::row::row(size_type size, T* data_addr):
-    _size(size),
-    _data(data_addr)
-{}
-
-////////////////////////////////////////////////////////////
-// Matrix::row operators
-////////////////////////////////////////////////////////////
-
-template<typename T>
-auto Matrix<T>::row::operator[](size_type index)
-    -> reference
-{
-    return _data[index];
-}
-
-template<typename T>
-auto Matrix<T>::row::operator[](size_type index) const
-    -> const_reference
-{
-    return _data[index];
-}
-
-////////////////////////////////////////////////////////////
-// Matrix::row functions
-////////////////////////////////////////////////////////////
-
-// Iterators
-template<typename T>
-auto Matrix<T>::row::begin()
-    -> iterator
-{
-    return _data;
-}
-template<typename T>
-auto Matrix<T>::row::begin() const
-    -> const_iterator
-{
-    return _data;
-}
-template<typename T>
-auto Matrix<T>::row::cbegin() const
-    -> const_iterator
-{
-    return _data;
-}
-
-template<typename T>
-auto Matrix<T>::row::end()
-    -> iterator
-{
-    return _data + _size;
-}
-template<typename T>
-auto Matrix<T>::row::end() const
-    -> const_iterator
-{
-    return _data + _size;
-}
-template<typename T>
-auto Matrix<T>::row::cend() const
-    -> const_iterator
-{
-    return _data + _size;
-}
-
-template<typename T>
-auto Matrix<T>::row::rbegin()
-    -> reverse_iterator
-{
-    return reverse_iterator(end());
-}
-template<typename T>
-auto Matrix<T>::row::rbegin() const
-    -> const_reverse_iterator
-{
-    return const_reverse_iterator(end());
-}
-template<typename T>
-auto Matrix<T>::row::crbegin() const
-    -> const_reverse_iterator
-{
-    return const_reverse_iterator(cend());
-}
-
-template<typename T>
-auto Matrix<T>::row::rend()
-    -> reverse_iterator
-{
-    return reverse_iterator(begin());
-}
-template<typename T>
-auto Matrix<T>::row::rend() const
-    -> const_reverse_iterator
-{
-    return const_reverse_iterator(begin());
-}
-template<typename T>
-auto Matrix<T>::row::crend() const
-    -> const_reverse_iterator
-{
-    return const_reverse_iterator(cbegin());
-}
-
-// Capacity
-template<typename T>
-auto Matrix<T>::row::size() const
-    -> size_type
-{
-    return _size;
-}
-
 ////////////////////////////////////////////////////////////
 // Matrix-Matrix comparison (outside class)
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-auto operator==(const Matrix<T>& lhs, const Matrix<T>& rhs)
+template<typename T, typename Allocator>
+auto operator==(const Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs)
     -> bool
 {
     if (lhs.height() != rhs.height()
@@ -851,8 +914,8 @@ auto operator==(const Matrix<T>& lhs, const Matrix<T>& rhs)
                       rhs.fbegin(), rhs.fend());
 }
 
-template<typename T>
-auto operator!=(const Matrix<T>& lhs, const Matrix<T>& rhs)
+template<typename T, typename Allocator>
+auto operator!=(const Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs)
     -> bool
 {
     return !(lhs == rhs);
@@ -862,81 +925,133 @@ auto operator!=(const Matrix<T>& lhs, const Matrix<T>& rhs)
 // Matrix-Matrix arithmetic operations (outside class)
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-auto operator+(Matrix<T> lhs, const Matrix<T>& rhs)
-    -> Matrix<T>
+template<typename T, typename Allocator>
+auto operator*(const Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs)
+    -> Matrix<T, Allocator>
 {
-    return lhs += rhs;
+    POLDER_ASSERT(lhs.width() == rhs.height());
+
+    Matrix<T, Allocator> res(lhs.height(), rhs.width(), lhs.get_allocator());
+    gemm(lhs.height(), rhs.width(), lhs.width(),
+         lhs.data(), lhs.width(),
+         rhs.data(), rhs.width(),
+         res.data(), res.width());
+    return res;
 }
 
-template<typename T>
-auto operator-(Matrix<T> lhs, const Matrix<T>& rhs)
-    -> Matrix<T>
+template<typename T, typename Allocator>
+auto operator/(Matrix<T, Allocator> lhs, const Matrix<T, Allocator>& rhs)
+    -> Matrix<T, Allocator>
 {
-    return lhs -= rhs;
+    return lhs /= rhs;
 }
 
-template<typename T>
-auto operator*(Matrix<T> lhs, const Matrix<T>& rhs)
-    -> Matrix<T>
+namespace details
 {
-    POLDER_ASSERT(lhs.width() == rhs.height());
-    using size_type = typename Matrix<T>::size_type;
+    template<typename T, typename Allocator>
+    auto strided_view(const Matrix<T, Allocator>& mat)
+        -> StridedMatrixView<const T>
+    {
+        return mat.view();
+    }
 
-    Matrix<T> res = Matrix<T>(lhs.height(), rhs.width());
-    for (size_type i = 0 ; i < lhs.height() ; ++i)
+    template<typename T>
+    auto strided_view(const MatrixView<T>& view)
+        -> StridedMatrixView<const std::remove_const_t<T>>
     {
-        for (size_type j = 0 ; j < rhs.width() ; ++j)
-        {
-            T val{};
-            for (size_type k = 0 ; k < lhs.width() ; ++k)
-            {
-                val += lhs(i, k) * rhs(k, j);
-            }
-            res(i, j) = val;
-        }
+        return view;
+    }
+
+    template<typename T>
+    auto strided_view(const StridedMatrixView<T>& view)
+        -> StridedMatrixView<const std::remove_const_t<T>>
+    {
+        return view;
+    }
+
+    template<typename ExecutionPolicy, typename Lhs, typename Rhs>
+    auto multiply_strided(ExecutionPolicy&& policy, const Lhs& lhs, const Rhs& rhs)
+        -> Matrix<typename types_t<Lhs>::value_type>
+    {
+        using value_type = typename types_t<Lhs>::value_type;
+        static_assert(std::is_same<value_type, typename types_t<Rhs>::value_type>::value,
+                      "the operands of a product shall have the same value_type");
+        POLDER_ASSERT(lhs.width() == rhs.height());
+
+        auto a = strided_view(lhs);
+        auto b = strided_view(rhs);
+        Matrix<value_type> res(lhs.height(), rhs.width());
+        gemm(std::forward<ExecutionPolicy>(policy),
+             lhs.height(), rhs.width(), lhs.width(),
+             a.data(), a.row_stride(), a.col_stride(),
+             b.data(), b.row_stride(), b.col_stride(),
+             res.data(), res.width());
+        return res;
     }
-    return res;
 }
 
-template<typename T>
-auto operator/(Matrix<T> lhs, const Matrix<T>& rhs)
-    -> Matrix<T>
+template<typename Lhs, typename Rhs, typename>
+auto operator*(const Lhs& lhs, const Rhs& rhs)
+    -> Matrix<typename types_t<Lhs>::value_type>
 {
-    return lhs /= rhs;
+    return details::multiply_strided(execution::seq, lhs, rhs);
 }
 
 ////////////////////////////////////////////////////////////
-// Matrix-value_type arithmetic operations (outside class)
+// Matrix-Matrix arithmetic operations with an execution policy
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-auto operator*(Matrix<T> lhs, T rhs)
-    -> Matrix<T>
+template<typename ExecutionPolicy, typename T, typename Allocator>
+auto add(ExecutionPolicy&& policy, const Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs)
+    -> Matrix<T, Allocator>
+{
+    POLDER_ASSERT(lhs.width() == rhs.width());
+    POLDER_ASSERT(lhs.height() == rhs.height());
+
+    Matrix<T, Allocator> res = lhs;
+    for_each(policy, res.fbegin(), res.fend(), rhs.fbegin(), plus_assign());
+    return res;
+}
+
+template<typename ExecutionPolicy, typename T, typename Allocator>
+auto subtract(ExecutionPolicy&& policy, const Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs)
+    -> Matrix<T, Allocator>
 {
-    return lhs *= rhs;
+    POLDER_ASSERT(lhs.width() == rhs.width());
+    POLDER_ASSERT(lhs.height() == rhs.height());
+
+    Matrix<T, Allocator> res = lhs;
+    for_each(policy, res.fbegin(), res.fend(), rhs.fbegin(), minus_assign());
+    return res;
 }
 
-template<typename T>
-auto operator*(T lhs, Matrix<T> rhs)
-    -> Matrix<T>
+template<typename ExecutionPolicy, typename T, typename Allocator>
+auto multiply(ExecutionPolicy&& policy, const Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs)
+    -> Matrix<T, Allocator>
 {
-    return rhs *= lhs;
+    POLDER_ASSERT(lhs.width() == rhs.height());
+
+    Matrix<T, Allocator> res(lhs.height(), rhs.width(), lhs.get_allocator());
+    gemm(policy, lhs.height(), rhs.width(), lhs.width(),
+         lhs.data(), lhs.width(),
+         rhs.data(), rhs.width(),
+         res.data(), res.width());
+    return res;
 }
 
-template<typename T>
-auto operator/(Matrix<T> lhs, T rhs)
-    -> Matrix<T>
+template<typename ExecutionPolicy, typename Lhs, typename Rhs, typename>
+auto multiply(ExecutionPolicy&& policy, const Lhs& lhs, const Rhs& rhs)
+    -> Matrix<typename types_t<Lhs>::value_type>
 {
-    return lhs /= rhs;
+    return details::multiply_strided(std::forward<ExecutionPolicy>(policy), lhs, rhs);
 }
 
 ////////////////////////////////////////////////////////////
 // Stream handling
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-auto operator<<(std::ostream& stream, const Matrix<T>& mat)
+template<typename T, typename Allocator>
+auto operator<<(std::ostream& stream, const Matrix<T, Allocator>& mat)
     -> std::ostream&
 {
     for (const auto& row: mat)
@@ -954,14 +1069,14 @@ auto operator<<(std::ostream& stream, const Matrix<T>& mat)
 // Miscellaneous functions
 ////////////////////////////////////////////////////////////
 
-template<typename T>
-auto adjugate(const Matrix<T>& mat)
-    -> Matrix<T>
+template<typename T, typename Allocator>
+auto adjugate(const Matrix<T, Allocator>& mat)
+    -> Matrix<T, Allocator>
 {
     POLDER_ASSERT(mat.is_square());
-    using size_type = typename Matrix<T>::size_type;
+    using size_type = typename Matrix<T, Allocator>::size_type;
 
-    Matrix<T> res(mat.height(), mat.width());
+    Matrix<T, Allocator> res(mat.height(), mat.width(), mat.get_allocator());
 
     if (mat.height() == 2)
     {
@@ -985,9 +1100,9 @@ auto adjugate(const Matrix<T>& mat)
     return res;
 }
 
-template<typename T>
-auto cofactor(const Matrix<T> mat, std::pair<std::size_t, std::size_t> index)
-    -> typename Matrix<T>::value_type
+template<typename T, typename Allocator>
+auto cofactor(const Matrix<T, Allocator>& mat, std::pair<std::size_t, std::size_t> index)
+    -> typename Matrix<T, Allocator>::value_type
 {
     auto y = index.first;
     auto x = index.second;
@@ -995,49 +1110,30 @@ auto cofactor(const Matrix<T> mat, std::pair<std::size_t, std::size_t> index)
     return minor(mat, {y, x}) * int(std::pow(-1, y+x));
 }
 
-template<typename T>
-inline auto determinant(const Matrix<T>& mat)
-    -> typename Matrix<T>::value_type
+template<typename T, typename Allocator>
+inline auto determinant(const Matrix<T, Allocator>& mat)
+    -> typename Matrix<T, Allocator>::value_type
 {
     return mat.determinant();
 }
 
-template<typename T>
-auto inverse(const Matrix<T>& mat)
-    -> Matrix<T>
+template<typename T, typename Allocator>
+auto inverse(const Matrix<T, Allocator>& mat)
+    -> Matrix<T, Allocator>
 {
-    // Faster than mat.is_invertible
-    POLDER_ASSERT(mat.is_square());
-    const T det = determinant(mat);
-    POLDER_ASSERT(det != 0);
-
-    if (mat.height() == 2)
-    {
-        // Optimized formula for 2x2 Matrix
-        Matrix<T> res(2, 2);
-        res(0, 0) = mat(1, 1);
-        res(0, 1) = -mat(0, 1);
-        res(1, 0) = -mat(1, 0);
-        res(1, 1) = mat(0, 0);
-        return (res /= det);
-    }
-    else
-    {
-        // Generic formula
-        return transpose(adjugate(mat)) /= det;
-    }
+    return details::compute_inverse(mat, std::is_integral<T>{});
 }
 
-template<typename T>
-inline auto minor(const Matrix<T>& mat, std::pair<std::size_t, std::size_t> index)
-    -> typename Matrix<T>::value_type
+template<typename T, typename Allocator>
+inline auto minor(const Matrix<T, Allocator>& mat, std::pair<std::size_t, std::size_t> index)
+    -> typename Matrix<T, Allocator>::value_type
 {
     return mat.minor(index.first, index.second);
 }
 
-template<typename T>
-auto trace(const Matrix<T>& mat)
-    -> typename Matrix<T>::value_type
+template<typename T, typename Allocator>
+auto trace(const Matrix<T, Allocator>& mat)
+    -> typename Matrix<T, Allocator>::value_type
 {
     POLDER_ASSERT(mat.is_square());
 
@@ -1049,18 +1145,27 @@ auto trace(const Matrix<T>& mat)
     return res;
 }
 
-template<typename T>
-auto transpose(const Matrix<T>& mat)
-    -> Matrix<T>
+template<typename T, typename Allocator>
+auto transpose(const Matrix<T, Allocator>& mat)
+    -> Matrix<T, Allocator>
+{
+    Matrix<T, Allocator> res(mat.width(), mat.height(), mat.get_allocator());
+    transpose(mat.height(), mat.width(),
+              mat.data(), mat.width(),
+              res.data(), res.width());
+    return res;
+}
+
+template<typename T, typename Allocator>
+auto transpose_in_place(Matrix<T, Allocator>& mat)
+    -> void
 {
-    using size_type = typename Matrix<T>::size_type;
-    Matrix<T> res = Matrix<T>(mat.width(), mat.height());
-    for (size_type i = 0 ; i < mat.height() ; ++i)
+    if (mat.is_square())
     {
-        for (size_type j = 0 ; j < mat.width() ; ++j)
-        {
-            res[j][i] = mat[i][j];
-        }
+        transpose_in_place(mat.height(), mat.data(), mat.width());
+    }
+    else
+    {
+        mat = transpose(mat);
     }
-    return res;
 }
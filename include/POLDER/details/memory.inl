@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+namespace details
+{
+    // Number of elements of type T that can be
+    // allocated without overflowing a std::size_t
+    template<typename T>
+    auto checked_size(std::size_t n)
+        -> std::size_t
+    {
+        if (n > std::size_t(-1) / sizeof(T))
+        {
+            throw std::bad_alloc();
+        }
+        return n * sizeof(T);
+    }
+}
+
+////////////////////////////////////////////////////////////
+// aligned_allocator
+////////////////////////////////////////////////////////////
+
+template<typename T, std::size_t Alignment>
+constexpr std::size_t aligned_allocator<T, Alignment>::alignment;
+
+template<typename T, std::size_t Alignment>
+template<typename U>
+aligned_allocator<T, Alignment>::aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept
+{}
+
+template<typename T, std::size_t Alignment>
+auto aligned_allocator<T, Alignment>::allocate(std::size_t n)
+    -> T*
+{
+    return static_cast<T*>(details::aligned_allocate(details::checked_size<T>(n), Alignment));
+}
+
+template<typename T, std::size_t Alignment>
+auto aligned_allocator<T, Alignment>::deallocate(T* ptr, std::size_t) noexcept
+    -> void
+{
+    details::aligned_deallocate(ptr);
+}
+
+template<typename T, typename U, std::size_t Alignment>
+auto operator==(const aligned_allocator<T, Alignment>&,
+                const aligned_allocator<U, Alignment>&) noexcept
+    -> bool
+{
+    return true;
+}
+
+template<typename T, typename U, std::size_t Alignment>
+auto operator!=(const aligned_allocator<T, Alignment>&,
+                const aligned_allocator<U, Alignment>&) noexcept
+    -> bool
+{
+    return false;
+}
+
+////////////////////////////////////////////////////////////
+// arena_allocator
+////////////////////////////////////////////////////////////
+
+template<typename T, std::size_t Alignment>
+constexpr std::size_t arena_allocator<T, Alignment>::alignment;
+
+template<typename T, std::size_t Alignment>
+arena_allocator<T, Alignment>::arena_allocator(monotonic_arena& arena) noexcept:
+    _arena(&arena)
+{}
+
+template<typename T, std::size_t Alignment>
+template<typename U>
+arena_allocator<T, Alignment>::arena_allocator(const arena_allocator<U, Alignment>& other) noexcept:
+    _arena(&other.arena())
+{}
+
+template<typename T, std::size_t Alignment>
+auto arena_allocator<T, Alignment>::allocate(std::size_t n)
+    -> T*
+{
+    return static_cast<T*>(_arena->allocate(details::checked_size<T>(n), Alignment));
+}
+
+template<typename T, std::size_t Alignment>
+auto arena_allocator<T, Alignment>::deallocate(T*, std::size_t) noexcept
+    -> void
+{
+    // The memory is reclaimed by the arena
+}
+
+template<typename T, std::size_t Alignment>
+auto arena_allocator<T, Alignment>::arena() const noexcept
+    -> monotonic_arena&
+{
+    return *_arena;
+}
+
+template<typename T, typename U, std::size_t Alignment>
+auto operator==(const arena_allocator<T, Alignment>& lhs,
+                const arena_allocator<U, Alignment>& rhs) noexcept
+    -> bool
+{
+    return &lhs.arena() == &rhs.arena();
+}
+
+template<typename T, typename U, std::size_t Alignment>
+auto operator!=(const arena_allocator<T, Alignment>& lhs,
+                const arena_allocator<U, Alignment>& rhs) noexcept
+    -> bool
+{
+    return not (lhs == rhs);
+}
+
+////////////////////////////////////////////////////////////
+// Alignment utilities
+////////////////////////////////////////////////////////////
+
+template<std::size_t Alignment, typename T>
+inline auto assume_aligned(T* ptr) noexcept
+    -> T*
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<T*>(__builtin_assume_aligned(ptr, Alignment));
+#else
+    return ptr;
+#endif
+}
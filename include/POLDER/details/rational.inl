@@ -279,6 +279,13 @@ auto rational<T>::normalize()
     using math::meta::abs;
     using math::meta::sign;
 
+    // Zero has a single representation
+    if (_numer == 0)
+    {
+        _denom = 1;
+        return;
+    }
+
     // Sign simplification
     _numer *= sign(_denom);
     _denom = abs(_denom);
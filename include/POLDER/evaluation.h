@@ -27,12 +27,19 @@
 ////////////////////////////////////////////////////////////
 // Headers
 ////////////////////////////////////////////////////////////
+#include <POLDER/evaluation/cache.h>
 #include <POLDER/evaluation/callback.h>
+#include <POLDER/evaluation/closure.h>
+#include <POLDER/evaluation/differentiation.h>
 #include <POLDER/evaluation/error.h>
 #include <POLDER/evaluation/evaluator.h>
+#include <POLDER/evaluation/expression.h>
 #include <POLDER/evaluation/functions.h>
+#include <POLDER/evaluation/interval.h>
+#include <POLDER/evaluation/lanes.h>
 #include <POLDER/evaluation/operation.h>
 #include <POLDER/evaluation/operator.h>
+#include <POLDER/evaluation/shared_evaluator.h>
 #include <POLDER/evaluation/token.h>
 
 ////////////////////////////////////////////////////////////
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_EVALUATION_CACHE_H_
+#define POLDER_EVALUATION_CACHE_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <POLDER/details/config.h>
+#include <POLDER/evaluation/expression.h>
+
+namespace polder
+{
+namespace evaluation
+{
+    /**
+     * @brief Bounded cache of compiled expressions.
+     *
+     * Maps expression strings to their compiled expressions
+     * and evicts the least recently used one when it is full.
+     * Every operation locks a mutex, but the expressions are
+     * shared so that they are evaluated outside of the lock.
+     *
+     * A cache with a capacity of 0 is disabled. Copying a
+     * cache copies its capacity but not its content.
+     */
+    template<typename Number>
+    class expression_cache
+    {
+        public:
+
+            using pointer = std::shared_ptr<const expression<Number>>;
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            expression_cache();
+            expression_cache(const expression_cache& other);
+            auto operator=(const expression_cache& other)
+                -> expression_cache&;
+
+            ////////////////////////////////////////////////////////////
+            // Lookup
+
+            /**
+             * @brief Compiled expression for the given string.
+             *
+             * Returns a null pointer when the string is not in the
+             * cache. Counts a hit or a miss.
+             */
+            auto find(const std::string& key)
+                -> pointer;
+
+            /**
+             * @brief Adds a compiled expression to the cache.
+             *
+             * If another thread inserted the same string in the
+             * meantime, its expression is kept and returned.
+             */
+            auto insert(const std::string& key, expression<Number>&& expr)
+                -> pointer;
+
+            ////////////////////////////////////////////////////////////
+            // Invalidation
+
+            /**
+             * @brief Removes the expressions calling a function.
+             */
+            auto invalidate(const std::string& name)
+                -> void;
+
+            auto clear()
+                -> void;
+
+            ////////////////////////////////////////////////////////////
+            // Capacity and statistics
+
+            auto enabled() const
+                -> bool;
+
+            auto capacity() const
+                -> std::size_t;
+
+            // Evicts the least recently used expressions if needed
+            auto set_capacity(std::size_t capacity)
+                -> void;
+
+            auto size() const
+                -> std::size_t;
+
+            auto hits() const
+                -> std::size_t;
+
+            auto misses() const
+                -> std::size_t;
+
+        private:
+
+            using entry = std::pair<std::string, pointer>;
+
+            auto evict()
+                -> void;
+
+            mutable std::mutex _mutex;
+            std::atomic<std::size_t> _capacity;
+
+            // Most recently used first
+            std::list<entry> _entries;
+            std::unordered_map<std::string, typename std::list<entry>::iterator> _index;
+
+            std::size_t _hits;
+            std::size_t _misses;
+    };
+
+    #include "details/cache.inl"
+}}
+
+#endif // POLDER_EVALUATION_CACHE_H_
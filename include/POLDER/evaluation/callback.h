@@ -24,6 +24,7 @@
 #include <cstddef>
 #include <functional>
 #include <utility>
+#include <vector>
 #include <POLDER/details/config.h>
 #include <POLDER/type_traits.h>
 
@@ -50,10 +51,13 @@ namespace evaluation
         public:
 
             /**
-             * Convert the given function to a callback.
+             * Convert the given function to a callback. A pure
+             * function always returns the same result for the same
+             * parameters and has no side effect: its calls with
+             * constant parameters are evaluated at compile time.
              */
             template<typename Func>
-            callback(Func&& function);
+            callback(Func&& function, bool pure=false);
 
             /**
              * Call the original function with an array of Number
@@ -63,14 +67,37 @@ namespace evaluation
             auto operator()(Number* args) const
                 -> Number;
 
+            /**
+             * Register the partial derivatives of the function:
+             * there is one per parameter, the i-th one is the
+             * derivative with respect to the i-th parameter and
+             * takes the same parameters as the function.
+             */
+            template<typename... Partials>
+            auto set_partials(Partials&&... partials)
+                -> void;
+
+            // Whether the partial derivatives are known
+            auto has_partials() const
+                -> bool;
+
+            /**
+             * Write the partial derivatives of the function at
+             * args to res, which holds arity elements.
+             */
+            auto partials(Number* args, Number* res) const
+                -> void;
+
             const std::size_t arity; /**< Number of parameters that the function takes */
+            const bool pure;         /**< Whether the function is pure */
 
         private:
 
             template<typename Func, std::size_t... Ind>
-            callback(Func&& function, std::index_sequence<Ind...>);
+            callback(Func&& function, bool pure, std::index_sequence<Ind...>);
 
             std::function<Number(Number*)> _func;
+            std::function<void(Number*, Number*)> _partials;
     };
 
     #include "details/callback.inl"
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_EVALUATION_CLOSURE_H_
+#define POLDER_EVALUATION_CLOSURE_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <POLDER/details/config.h>
+#include <POLDER/evaluation/callback.h>
+#include <POLDER/evaluation/error.h>
+#include <POLDER/evaluation/expression.h>
+#include <POLDER/evaluation/operation.h>
+#include <POLDER/evaluation/operator.h>
+
+namespace polder
+{
+namespace evaluation
+{
+    namespace details
+    {
+        /**
+         * Node of a closure: evaluates a subexpression for
+         * the given values of the variables.
+         */
+        template<typename Number>
+        struct closure_node
+        {
+            virtual ~closure_node() = default;
+
+            virtual auto operator()(const Number* variables) const
+                -> Number = 0;
+        };
+
+        template<typename Number>
+        using node_ptr = std::unique_ptr<const closure_node<Number>>;
+    }
+
+    /**
+     * @brief Closure-compiled mathematical expression.
+     *
+     * A closure is another representation of a compiled
+     * expression: the program is lowered to a tree of function
+     * objects, every one of them specialized for its operator
+     * and for the kind of its operands. An operator node reads
+     * its constant and variable operands directly and calls
+     * the nodes of its other operands, so that evaluating the
+     * closure does not dispatch on instructions and does not
+     * use a stack of operands.
+     *
+     * The functions are bound to nodes specialized for their
+     * arity, which evaluate the parameters in a local array
+     * and call the function with it. The parameters of the
+     * functions with more than 8 parameters are evaluated in
+     * a buffer kept by the calling thread and reused by the
+     * next evaluations.
+     *
+     * A closure is built from an expression, after its
+     * simplification, and keeps its own copy of the callbacks.
+     * It can be moved but not copied, and can be evaluated
+     * concurrently from several threads, provided that the
+     * connected functions can.
+     */
+    template<typename Number>
+    class closure
+    {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            explicit closure(const expression<Number>& expr);
+
+            ////////////////////////////////////////////////////////////
+            // Evaluation
+
+            /**
+             * @brief Evaluate the closure.
+             *
+             * The variables have the same meaning as for
+             * expression::evaluate.
+             */
+            auto evaluate() const
+                -> Number;
+            auto evaluate(const Number* variables, std::size_t size) const
+                -> Number;
+            auto evaluate(std::initializer_list<Number> variables) const
+                -> Number;
+
+            /**
+             * @brief Calls evaluate.
+             */
+            auto operator()() const
+                -> Number;
+            auto operator()(const Number* variables, std::size_t size) const
+                -> Number;
+            auto operator()(std::initializer_list<Number> variables) const
+                -> Number;
+
+            // Number of variables of the expression
+            auto nb_variables() const
+                -> std::size_t;
+
+        private:
+
+            details::node_ptr<Number> _root;
+            std::size_t _nb_variables;
+    };
+
+    #include "details/closure.inl"
+}}
+
+#endif // POLDER_EVALUATION_CLOSURE_H_
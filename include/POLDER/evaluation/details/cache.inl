@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+////////////////////////////////////////////////////////////
+// Construction
+
+template<typename Number>
+expression_cache<Number>::expression_cache():
+    _capacity(0),
+    _hits(0),
+    _misses(0)
+{}
+
+template<typename Number>
+expression_cache<Number>::expression_cache(const expression_cache& other):
+    _capacity(other.capacity()),
+    _hits(0),
+    _misses(0)
+{}
+
+template<typename Number>
+auto expression_cache<Number>::operator=(const expression_cache& other)
+    -> expression_cache&
+{
+    if (this != &other)
+    {
+        set_capacity(other.capacity());
+        clear();
+    }
+    return *this;
+}
+
+////////////////////////////////////////////////////////////
+// Lookup
+
+template<typename Number>
+auto expression_cache<Number>::find(const std::string& key)
+    -> pointer
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _index.find(key);
+    if (it == _index.end())
+    {
+        ++_misses;
+        return nullptr;
+    }
+
+    // Move the entry to the front of the list
+    _entries.splice(_entries.begin(), _entries, it->second);
+    ++_hits;
+    return it->second->second;
+}
+
+template<typename Number>
+auto expression_cache<Number>::insert(const std::string& key, expression<Number>&& expr)
+    -> pointer
+{
+    auto compiled = std::make_shared<const expression<Number>>(std::move(expr));
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _index.find(key);
+    if (it != _index.end())
+    {
+        return it->second->second;
+    }
+
+    _entries.emplace_front(key, compiled);
+    _index.emplace(key, _entries.begin());
+    evict();
+    return compiled;
+}
+
+////////////////////////////////////////////////////////////
+// Invalidation
+
+template<typename Number>
+auto expression_cache<Number>::invalidate(const std::string& name)
+    -> void
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (auto it = _entries.begin() ; it != _entries.end() ;)
+    {
+        const auto& names = it->second->function_names();
+        if (std::find(names.begin(), names.end(), name) != names.end())
+        {
+            _index.erase(it->first);
+            it = _entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+template<typename Number>
+auto expression_cache<Number>::clear()
+    -> void
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _index.clear();
+}
+
+////////////////////////////////////////////////////////////
+// Capacity and statistics
+
+template<typename Number>
+auto expression_cache<Number>::enabled() const
+    -> bool
+{
+    return _capacity.load(std::memory_order_relaxed) != 0;
+}
+
+template<typename Number>
+auto expression_cache<Number>::capacity() const
+    -> std::size_t
+{
+    return _capacity.load(std::memory_order_relaxed);
+}
+
+template<typename Number>
+auto expression_cache<Number>::set_capacity(std::size_t capacity)
+    -> void
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _capacity = capacity;
+    evict();
+}
+
+template<typename Number>
+auto expression_cache<Number>::size() const
+    -> std::size_t
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+template<typename Number>
+auto expression_cache<Number>::hits() const
+    -> std::size_t
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hits;
+}
+
+template<typename Number>
+auto expression_cache<Number>::misses() const
+    -> std::size_t
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _misses;
+}
+
+template<typename Number>
+auto expression_cache<Number>::evict()
+    -> void
+{
+    // The mutex is already locked
+    while (_entries.size() > _capacity)
+    {
+        _index.erase(_entries.back().first);
+        _entries.pop_back();
+    }
+}
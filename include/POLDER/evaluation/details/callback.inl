@@ -18,9 +18,10 @@
 
 template<typename Number>
 template<typename Func>
-callback<Number>::callback(Func&& function):
+callback<Number>::callback(Func&& function, bool pure):
     callback(
         std::forward<Func>(function),
+        pure,
         std::make_index_sequence<
             polder::arity<Func>
         >{}
@@ -34,10 +35,53 @@ auto callback<Number>::operator()(Number* args) const
     return _func(args);
 }
 
+template<typename Number>
+template<typename... Partials>
+auto callback<Number>::set_partials(Partials&&... partials)
+    -> void
+{
+    POLDER_ASSERT(sizeof...(Partials) == arity);
+
+    std::vector<callback<Number>> funcs = {
+        callback<Number>(std::forward<Partials>(partials))...
+    };
+    for (const callback<Number>& func: funcs)
+    {
+        POLDER_ASSERT(func.arity == arity);
+        (void) func;
+    }
+
+    _partials = [funcs](Number* args, Number* res)
+    {
+        for (std::size_t i = 0 ; i < funcs.size() ; ++i)
+        {
+            res[i] = funcs[i](args);
+        }
+    };
+}
+
+template<typename Number>
+auto callback<Number>::has_partials() const
+    -> bool
+{
+    return arity == 0 || bool(_partials);
+}
+
+template<typename Number>
+auto callback<Number>::partials(Number* args, Number* res) const
+    -> void
+{
+    if (arity != 0)
+    {
+        _partials(args, res);
+    }
+}
+
 template<typename Number>
 template<typename Func, std::size_t... Ind>
-callback<Number>::callback(Func&& function, std::index_sequence<Ind...>):
+callback<Number>::callback(Func&& function, bool pure, std::index_sequence<Ind...>):
     arity(sizeof...(Ind)),
+    pure(pure),
     _func([function](Number* args)
     {
         return function(args[Ind]...);
@@ -0,0 +1,654 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+namespace details
+{
+    ////////////////////////////////////////////////////////////
+    // Operands of the nodes
+
+    // The constant and variable operands are stored in the
+    // node which uses them instead of being nodes themselves
+
+    template<typename Number>
+    struct constant_operand
+    {
+        auto operator()(const Number*) const
+            -> Number
+        {
+            return value;
+        }
+
+        Number value;
+    };
+
+    template<typename Number>
+    struct variable_operand
+    {
+        auto operator()(const Number* variables) const
+            -> Number
+        {
+            return variables[index];
+        }
+
+        std::size_t index;
+    };
+
+    template<typename Number>
+    struct node_operand
+    {
+        auto operator()(const Number* variables) const
+            -> Number
+        {
+            return (*node)(variables);
+        }
+
+        node_ptr<Number> node;
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Nodes
+
+    // Root of a closure which is a single operand
+    template<typename Number, typename Operand>
+    struct leaf_node final:
+        closure_node<Number>
+    {
+        explicit leaf_node(Operand arg):
+            arg(std::move(arg))
+        {}
+
+        auto operator()(const Number* variables) const
+            -> Number override
+        {
+            return arg(variables);
+        }
+
+        Operand arg;
+    };
+
+    template<typename Number, infix_t Oper, typename Lhs, typename Rhs>
+    struct infix_node final:
+        closure_node<Number>
+    {
+        infix_node(Lhs lhs, Rhs rhs):
+            lhs(std::move(lhs)),
+            rhs(std::move(rhs))
+        {}
+
+        auto operator()(const Number* variables) const
+            -> Number override
+        {
+            return operation(Oper, lhs(variables), rhs(variables));
+        }
+
+        Lhs lhs;
+        Rhs rhs;
+    };
+
+    // x op x, with x computed once
+    template<typename Number, infix_t Oper, typename Arg>
+    struct same_operands_node final:
+        closure_node<Number>
+    {
+        explicit same_operands_node(Arg arg):
+            arg(std::move(arg))
+        {}
+
+        auto operator()(const Number* variables) const
+            -> Number override
+        {
+            const Number value = arg(variables);
+            return operation(Oper, value, value);
+        }
+
+        Arg arg;
+    };
+
+    template<typename Number, prefix_t Oper, typename Arg>
+    struct prefix_node final:
+        closure_node<Number>
+    {
+        explicit prefix_node(Arg arg):
+            arg(std::move(arg))
+        {}
+
+        auto operator()(const Number* variables) const
+            -> Number override
+        {
+            return operation(Oper, arg(variables));
+        }
+
+        Arg arg;
+    };
+
+    template<typename Number, postfix_t Oper, typename Arg>
+    struct postfix_node final:
+        closure_node<Number>
+    {
+        explicit postfix_node(Arg arg):
+            arg(std::move(arg))
+        {}
+
+        auto operator()(const Number* variables) const
+            -> Number override
+        {
+            return operation(Oper, arg(variables));
+        }
+
+        Arg arg;
+    };
+
+    // Call to a function of a known arity: the parameters are
+    // evaluated in a local array of the right size
+    template<typename Number, std::size_t Arity>
+    struct call_node final:
+        closure_node<Number>
+    {
+        call_node(const callback<Number>& func,
+                  std::array<node_ptr<Number>, Arity> args):
+            func(func),
+            args(std::move(args))
+        {}
+
+        auto operator()(const Number* variables) const
+            -> Number override
+        {
+            return call(variables, std::make_index_sequence<Arity>{});
+        }
+
+        template<std::size_t... Ind>
+        auto call(const Number* variables, std::index_sequence<Ind...>) const
+            -> Number
+        {
+            // The parameters are evaluated from left to right
+            Number params[] = { (*args[Ind])(variables)... };
+            return func(params);
+        }
+
+        auto call(const Number*, std::index_sequence<>) const
+            -> Number
+        {
+            return func(nullptr);
+        }
+
+        callback<Number> func;
+        std::array<node_ptr<Number>, Arity> args;
+    };
+
+    // Functions with more parameters than that are rare
+    // enough for their parameters to be kept out of the node
+    constexpr std::size_t max_bound_arity = 8;
+
+    // Parameter buffers of the variadic calls evaluated by the
+    // current thread, one per nesting level: a buffer is only
+    // ever grown, so a thread stops allocating once it has
+    // evaluated its biggest calls
+    template<typename Number>
+    struct variadic_buffers
+    {
+        std::vector<std::vector<Number>> buffers;
+        std::size_t depth = 0;
+    };
+
+    template<typename Number>
+    struct variadic_call_node final:
+        closure_node<Number>
+    {
+        variadic_call_node(const callback<Number>& func,
+                           std::vector<node_ptr<Number>> args):
+            func(func),
+            args(std::move(args))
+        {}
+
+        auto operator()(const Number* variables) const
+            -> Number override
+        {
+            auto& local = thread_buffers();
+            if (local.depth == local.buffers.size())
+            {
+                local.buffers.emplace_back();
+            }
+            auto& buffer = local.buffers[local.depth];
+            if (buffer.size() < args.size())
+            {
+                buffer.resize(args.size());
+            }
+
+            // The nested calls may add buffers, which moves the
+            // vectors but not the elements they own
+            Number* params = buffer.data();
+            depth_guard guard{ local.depth };
+            for (std::size_t i = 0 ; i < args.size() ; ++i)
+            {
+                params[i] = (*args[i])(variables);
+            }
+            return func(params);
+        }
+
+        static auto thread_buffers()
+            -> variadic_buffers<Number>&
+        {
+            static thread_local variadic_buffers<Number> buffers;
+            return buffers;
+        }
+
+        // Gives the buffer back even if an exception is thrown
+        struct depth_guard
+        {
+            explicit depth_guard(std::size_t& depth):
+                depth(depth)
+            {
+                ++depth;
+            }
+
+            ~depth_guard()
+            {
+                --depth;
+            }
+
+            std::size_t& depth;
+        };
+
+        callback<Number> func;
+        std::vector<node_ptr<Number>> args;
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Lowering of the instructions
+
+    enum struct operand_kind
+    {
+        constant,
+        variable,
+        node,
+        duplicate   // Copy of the previous operand
+    };
+
+    // Operand of the program being lowered
+    template<typename Number>
+    struct lowered_operand
+    {
+        operand_kind kind;
+        Number value;
+        std::size_t index;
+        node_ptr<Number> node;
+    };
+
+    template<typename Number>
+    auto make_operand(node_ptr<Number>&& node)
+        -> lowered_operand<Number>
+    {
+        return { operand_kind::node, Number{}, 0, std::move(node) };
+    }
+
+    // Calls func with the operand as a constant_operand,
+    // variable_operand or node_operand depending on its kind
+    template<typename Number, typename Func>
+    auto with_operand(lowered_operand<Number>&& arg, Func&& func)
+        -> node_ptr<Number>
+    {
+        switch (arg.kind)
+        {
+            case operand_kind::constant:
+                return func(constant_operand<Number>{ arg.value });
+            case operand_kind::variable:
+                return func(variable_operand<Number>{ arg.index });
+            case operand_kind::node:
+                return func(node_operand<Number>{ std::move(arg.node) });
+            case operand_kind::duplicate:
+                break;
+        }
+        // The simplifications only duplicate the left operand
+        // of a multiplication
+        throw error(error_type::unexpected_token,
+                    "unexpected duplicated operand in a closure");
+    }
+
+    template<typename Number>
+    auto make_node(lowered_operand<Number>&& arg)
+        -> node_ptr<Number>
+    {
+        if (arg.kind == operand_kind::node)
+        {
+            return std::move(arg.node);
+        }
+        return with_operand(std::move(arg), [](auto arg)
+            -> node_ptr<Number>
+        {
+            return std::make_unique<leaf_node<Number, decltype(arg)>>(std::move(arg));
+        });
+    }
+
+    // Calls func with an integral_constant holding the
+    // operator, so that func can use it as a template
+    // parameter
+    template<typename Func>
+    auto with_operator(infix_t oper, Func&& func)
+        -> decltype(func(std::integral_constant<infix_t, infix_t::ADD>{}))
+    {
+        switch (oper)
+        {
+            case infix_t::EQ:
+                return func(std::integral_constant<infix_t, infix_t::EQ>{});
+            case infix_t::NE:
+                return func(std::integral_constant<infix_t, infix_t::NE>{});
+            case infix_t::GE:
+                return func(std::integral_constant<infix_t, infix_t::GE>{});
+            case infix_t::LE:
+                return func(std::integral_constant<infix_t, infix_t::LE>{});
+            case infix_t::AND:
+                return func(std::integral_constant<infix_t, infix_t::AND>{});
+            case infix_t::OR:
+                return func(std::integral_constant<infix_t, infix_t::OR>{});
+            case infix_t::XOR:
+                return func(std::integral_constant<infix_t, infix_t::XOR>{});
+            case infix_t::POW:
+                return func(std::integral_constant<infix_t, infix_t::POW>{});
+            case infix_t::SPACE:
+                return func(std::integral_constant<infix_t, infix_t::SPACE>{});
+            case infix_t::LSHIFT:
+                return func(std::integral_constant<infix_t, infix_t::LSHIFT>{});
+            case infix_t::RSHIFT:
+                return func(std::integral_constant<infix_t, infix_t::RSHIFT>{});
+            case infix_t::ADD:
+                return func(std::integral_constant<infix_t, infix_t::ADD>{});
+            case infix_t::SUB:
+                return func(std::integral_constant<infix_t, infix_t::SUB>{});
+            case infix_t::MUL:
+                return func(std::integral_constant<infix_t, infix_t::MUL>{});
+            case infix_t::DIV:
+                return func(std::integral_constant<infix_t, infix_t::DIV>{});
+            case infix_t::MOD:
+                return func(std::integral_constant<infix_t, infix_t::MOD>{});
+            case infix_t::BAND:
+                return func(std::integral_constant<infix_t, infix_t::BAND>{});
+            case infix_t::BOR:
+                return func(std::integral_constant<infix_t, infix_t::BOR>{});
+            case infix_t::GT:
+                return func(std::integral_constant<infix_t, infix_t::GT>{});
+            case infix_t::LT:
+                return func(std::integral_constant<infix_t, infix_t::LT>{});
+            case infix_t::BXOR:
+                return func(std::integral_constant<infix_t, infix_t::BXOR>{});
+            case infix_t::IDIV:
+                return func(std::integral_constant<infix_t, infix_t::IDIV>{});
+        }
+        unknown_operator(oper);
+    }
+
+    template<typename Func>
+    auto with_operator(prefix_t oper, Func&& func)
+        -> decltype(func(std::integral_constant<prefix_t, prefix_t::USUB>{}))
+    {
+        switch (oper)
+        {
+            case prefix_t::USUB:
+                return func(std::integral_constant<prefix_t, prefix_t::USUB>{});
+            case prefix_t::NOT:
+                return func(std::integral_constant<prefix_t, prefix_t::NOT>{});
+            case prefix_t::BNOT:
+                return func(std::integral_constant<prefix_t, prefix_t::BNOT>{});
+        }
+        unknown_operator(oper);
+    }
+
+    template<typename Func>
+    auto with_operator(postfix_t oper, Func&& func)
+        -> decltype(func(std::integral_constant<postfix_t, postfix_t::FAC>{}))
+    {
+        switch (oper)
+        {
+            case postfix_t::FAC:
+                return func(std::integral_constant<postfix_t, postfix_t::FAC>{});
+        }
+        unknown_operator(oper);
+    }
+
+    template<typename Number>
+    auto make_infix_node(infix_t oper, lowered_operand<Number>&& lhs,
+                         lowered_operand<Number>&& rhs)
+        -> node_ptr<Number>
+    {
+        if (rhs.kind == operand_kind::duplicate)
+        {
+            return with_operator(oper, [&](auto op) {
+                return with_operand(std::move(lhs), [&](auto arg)
+                    -> node_ptr<Number>
+                {
+                    using node_type = same_operands_node<Number, decltype(op)::value, decltype(arg)>;
+                    return std::make_unique<node_type>(std::move(arg));
+                });
+            });
+        }
+
+        return with_operator(oper, [&](auto op) {
+            return with_operand(std::move(lhs), [&](auto lhs_arg) {
+                return with_operand(std::move(rhs), [&](auto rhs_arg)
+                    -> node_ptr<Number>
+                {
+                    using node_type = infix_node<Number, decltype(op)::value,
+                                                 decltype(lhs_arg), decltype(rhs_arg)>;
+                    return std::make_unique<node_type>(std::move(lhs_arg), std::move(rhs_arg));
+                });
+            });
+        });
+    }
+
+    template<typename Number>
+    auto make_prefix_node(prefix_t oper, lowered_operand<Number>&& arg)
+        -> node_ptr<Number>
+    {
+        return with_operator(oper, [&](auto op) {
+            return with_operand(std::move(arg), [&](auto arg)
+                -> node_ptr<Number>
+            {
+                using node_type = prefix_node<Number, decltype(op)::value, decltype(arg)>;
+                return std::make_unique<node_type>(std::move(arg));
+            });
+        });
+    }
+
+    template<typename Number>
+    auto make_postfix_node(postfix_t oper, lowered_operand<Number>&& arg)
+        -> node_ptr<Number>
+    {
+        return with_operator(oper, [&](auto op) {
+            return with_operand(std::move(arg), [&](auto arg)
+                -> node_ptr<Number>
+            {
+                using node_type = postfix_node<Number, decltype(op)::value, decltype(arg)>;
+                return std::make_unique<node_type>(std::move(arg));
+            });
+        });
+    }
+
+    template<typename Number, std::size_t... Ind>
+    auto make_call_node(const callback<Number>& func, lowered_operand<Number>* args,
+                        std::index_sequence<Ind...>)
+        -> node_ptr<Number>
+    {
+        (void) args;
+        return std::make_unique<call_node<Number, sizeof...(Ind)>>(
+            func,
+            std::array<node_ptr<Number>, sizeof...(Ind)>{{
+                make_node(std::move(args[Ind]))...
+            }}
+        );
+    }
+
+    template<typename Number>
+    auto make_call_node(const callback<Number>& func, lowered_operand<Number>* args,
+                        std::integral_constant<std::size_t, max_bound_arity + 1>)
+        -> node_ptr<Number>
+    {
+        std::vector<node_ptr<Number>> nodes;
+        nodes.reserve(func.arity);
+        for (std::size_t i = 0 ; i < func.arity ; ++i)
+        {
+            nodes.push_back(make_node(std::move(args[i])));
+        }
+        return std::make_unique<variadic_call_node<Number>>(func, std::move(nodes));
+    }
+
+    // Finds the arity of the function among 0...max_bound_arity
+    // so that it becomes a template parameter of the node
+    template<typename Number, std::size_t Arity>
+    auto make_call_node(const callback<Number>& func, lowered_operand<Number>* args,
+                        std::integral_constant<std::size_t, Arity>)
+        -> node_ptr<Number>
+    {
+        if (func.arity == Arity)
+        {
+            return make_call_node(func, args, std::make_index_sequence<Arity>{});
+        }
+        return make_call_node(func, args, std::integral_constant<std::size_t, Arity + 1>{});
+    }
+}
+
+////////////////////////////////////////////////////////////
+// Construction
+
+template<typename Number>
+closure<Number>::closure(const expression<Number>& expr):
+    _nb_variables(expr.variable_names().size())
+{
+    using details::operand_kind;
+
+    // The program has already been checked by the expression:
+    // there are always enough operands
+    std::vector<details::lowered_operand<Number>> operands;
+    operands.reserve(expr.max_depth());
+
+    for (const instruction& instr: expr.instructions())
+    {
+        switch (instr.code)
+        {
+            case opcode::constant:
+            {
+                operands.push_back({
+                    operand_kind::constant, expr.constants()[instr.index], 0, nullptr
+                });
+                break;
+            }
+
+            case opcode::variable:
+            {
+                operands.push_back({ operand_kind::variable, Number{}, instr.index, nullptr });
+                break;
+            }
+
+            case opcode::duplicate:
+            {
+                operands.push_back({ operand_kind::duplicate, Number{}, 0, nullptr });
+                break;
+            }
+
+            case opcode::infix:
+            {
+                auto rhs = std::move(operands.back());
+                operands.pop_back();
+                auto node = details::make_infix_node(instr.infix, std::move(operands.back()),
+                                                     std::move(rhs));
+                operands.back() = details::make_operand(std::move(node));
+                break;
+            }
+
+            case opcode::prefix:
+            {
+                auto node = details::make_prefix_node(instr.prefix, std::move(operands.back()));
+                operands.back() = details::make_operand(std::move(node));
+                break;
+            }
+
+            case opcode::postfix:
+            {
+                auto node = details::make_postfix_node(instr.postfix, std::move(operands.back()));
+                operands.back() = details::make_operand(std::move(node));
+                break;
+            }
+
+            case opcode::call:
+            {
+                const callback<Number>& func = expr.functions()[instr.index];
+                const std::size_t first = operands.size() - func.arity;
+                auto node = details::make_call_node(func, operands.data() + first,
+                                                    std::integral_constant<std::size_t, 0>{});
+                operands.erase(operands.begin() + first, operands.end());
+                operands.push_back(details::make_operand(std::move(node)));
+                break;
+            }
+        }
+    }
+
+    _root = details::make_node(std::move(operands.back()));
+}
+
+////////////////////////////////////////////////////////////
+// Evaluation
+
+template<typename Number>
+auto closure<Number>::evaluate() const
+    -> Number
+{
+    return evaluate(nullptr, 0);
+}
+
+template<typename Number>
+auto closure<Number>::evaluate(const Number* variables, std::size_t size) const
+    -> Number
+{
+    POLDER_ASSERT(size >= _nb_variables);
+    (void) size;
+
+    return (*_root)(variables);
+}
+
+template<typename Number>
+auto closure<Number>::evaluate(std::initializer_list<Number> variables) const
+    -> Number
+{
+    return evaluate(variables.begin(), variables.size());
+}
+
+template<typename Number>
+auto closure<Number>::operator()() const
+    -> Number
+{
+    return evaluate();
+}
+
+template<typename Number>
+auto closure<Number>::operator()(const Number* variables, std::size_t size) const
+    -> Number
+{
+    return evaluate(variables, size);
+}
+
+template<typename Number>
+auto closure<Number>::operator()(std::initializer_list<Number> variables) const
+    -> Number
+{
+    return evaluate(variables);
+}
+
+template<typename Number>
+auto closure<Number>::nb_variables() const
+    -> std::size_t
+{
+    return _nb_variables;
+}
@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+namespace details
+{
+    // Derivative propagated through a partial derivative; an
+    // operand which does not depend on the variables does not
+    // propagate anything, even if the partial derivative is
+    // infinite or NaN
+    template<typename Number>
+    auto chain(Number partial, Number derivative)
+        -> Number
+    {
+        return (derivative == Number(0)) ? Number(0) : partial * derivative;
+    }
+
+    template<typename Number>
+    auto max_arity(const expression<Number>& expr)
+        -> std::size_t
+    {
+        std::size_t res = 0;
+        for (const callback<Number>& func: expr.functions())
+        {
+            res = std::max(res, func.arity);
+        }
+        return res;
+    }
+
+    template<typename Number>
+    auto check_partials(const expression<Number>& expr, std::size_t index)
+        -> const callback<Number>&
+    {
+        const callback<Number>& func = expr.functions()[index];
+        if (not func.has_partials())
+        {
+            throw error(error_type::unknown_derivative,
+                        "unknown derivative for function " + expr.function_names()[index]);
+        }
+        return func;
+    }
+}
+
+////////////////////////////////////////////////////////////
+// Dual numbers
+
+template<typename Number>
+auto operation(infix_t oper, dual<Number> lhs, dual<Number> rhs)
+    -> dual<Number>
+{
+    const auto partials = derivative(oper, lhs.value, rhs.value);
+    return {
+        operation(oper, lhs.value, rhs.value),
+        details::chain(partials.first, lhs.derivative)
+            + details::chain(partials.second, rhs.derivative)
+    };
+}
+
+template<typename Number>
+auto operation(prefix_t oper, dual<Number> arg)
+    -> dual<Number>
+{
+    return {
+        operation(oper, arg.value),
+        details::chain(derivative(oper, arg.value), arg.derivative)
+    };
+}
+
+template<typename Number>
+auto operation(postfix_t oper, dual<Number> arg)
+    -> dual<Number>
+{
+    return {
+        operation(oper, arg.value),
+        details::chain(derivative(oper, arg.value), arg.derivative)
+    };
+}
+
+////////////////////////////////////////////////////////////
+// Forward mode
+
+template<typename Number>
+auto differentiate(const expression<Number>& expr,
+                   const Number* variables, std::size_t size,
+                   const Number* direction)
+    -> dual<Number>
+{
+    POLDER_ASSERT(size >= expr.variable_names().size());
+    (void) size;
+
+    std::vector<dual<Number>> stack(expr.max_depth());
+    dual<Number>* top = stack.data();
+
+    // Values of the parameters of a function followed
+    // by its partial derivatives
+    const std::size_t max_arity = details::max_arity(expr);
+    std::vector<Number> params(2 * max_arity);
+
+    for (const instruction& instr: expr.instructions())
+    {
+        switch (instr.code)
+        {
+            case opcode::constant:
+            {
+                *top++ = { expr.constants()[instr.index], Number(0) };
+                break;
+            }
+
+            case opcode::variable:
+            {
+                *top++ = { variables[instr.index], direction[instr.index] };
+                break;
+            }
+
+            case opcode::duplicate:
+            {
+                *top = top[-1];
+                ++top;
+                break;
+            }
+
+            case opcode::infix:
+            {
+                --top;
+                top[-1] = operation(instr.infix, top[-1], *top);
+                break;
+            }
+
+            case opcode::prefix:
+            {
+                top[-1] = operation(instr.prefix, top[-1]);
+                break;
+            }
+
+            case opcode::postfix:
+            {
+                top[-1] = operation(instr.postfix, top[-1]);
+                break;
+            }
+
+            case opcode::call:
+            {
+                const callback<Number>& func = details::check_partials(expr, instr.index);
+                top -= func.arity;
+
+                Number* partials = params.data() + max_arity;
+                for (std::size_t i = 0 ; i < func.arity ; ++i)
+                {
+                    params[i] = top[i].value;
+                }
+                func.partials(params.data(), partials);
+
+                Number res = Number(0);
+                for (std::size_t i = 0 ; i < func.arity ; ++i)
+                {
+                    res += details::chain(partials[i], top[i].derivative);
+                }
+                *top++ = { func(params.data()), res };
+                break;
+            }
+        }
+    }
+    return top[-1];
+}
+
+////////////////////////////////////////////////////////////
+// Reverse mode
+
+template<typename Number>
+auto gradient(const expression<Number>& expr,
+              const Number* variables, std::size_t size,
+              Number* res)
+    -> Number
+{
+    POLDER_ASSERT(size >= expr.variable_names().size());
+    (void) size;
+
+    const std::vector<instruction>& code = expr.instructions();
+
+    // Every operand is consumed by exactly one instruction, so
+    // there are about as many edges as instructions: the edges
+    // of the instruction i, from the instructions which computed
+    // its operands, are [first_edge[i], first_edge[i+1])
+    std::vector<std::pair<std::size_t, Number>> edges;
+    edges.reserve(code.size());
+    std::vector<std::size_t> first_edge(code.size() + 1, 0);
+
+    // Operands and the instructions which computed them
+    std::vector<Number> stack(expr.max_depth());
+    std::vector<std::size_t> origins(expr.max_depth());
+    Number* top = stack.data();
+    std::size_t* origin = origins.data();
+
+    std::vector<Number> partials(details::max_arity(expr));
+
+    for (std::size_t i = 0 ; i < code.size() ; ++i)
+    {
+        const instruction& instr = code[i];
+        switch (instr.code)
+        {
+            case opcode::constant:
+            {
+                *top++ = expr.constants()[instr.index];
+                break;
+            }
+
+            case opcode::variable:
+            {
+                *top++ = variables[instr.index];
+                break;
+            }
+
+            case opcode::duplicate:
+            {
+                edges.emplace_back(origin[-1], Number(1));
+                *top = top[-1];
+                ++top;
+                break;
+            }
+
+            case opcode::infix:
+            {
+                --top;
+                origin -= 2;
+                const auto derivatives = derivative(instr.infix, top[-1], *top);
+                edges.emplace_back(origin[0], derivatives.first);
+                edges.emplace_back(origin[1], derivatives.second);
+                top[-1] = operation(instr.infix, top[-1], *top);
+                break;
+            }
+
+            case opcode::prefix:
+            {
+                --origin;
+                edges.emplace_back(*origin, derivative(instr.prefix, top[-1]));
+                top[-1] = operation(instr.prefix, top[-1]);
+                break;
+            }
+
+            case opcode::postfix:
+            {
+                --origin;
+                edges.emplace_back(*origin, derivative(instr.postfix, top[-1]));
+                top[-1] = operation(instr.postfix, top[-1]);
+                break;
+            }
+
+            case opcode::call:
+            {
+                const callback<Number>& func = details::check_partials(expr, instr.index);
+                top -= func.arity;
+                origin -= func.arity;
+
+                func.partials(top, partials.data());
+                for (std::size_t arg = 0 ; arg < func.arity ; ++arg)
+                {
+                    edges.emplace_back(origin[arg], partials[arg]);
+                }
+                *top = func(top);
+                ++top;
+                break;
+            }
+        }
+
+        // Every instruction pushes exactly one operand
+        *origin++ = i;
+        first_edge[i + 1] = edges.size();
+    }
+
+    // Derivative of the expression with respect to the
+    // result of every instruction
+    std::vector<Number> adjoints(code.size(), Number(0));
+    adjoints.back() = Number(1);
+
+    const std::size_t nb_variables = expr.variable_names().size();
+    std::fill_n(res, nb_variables, Number(0));
+
+    // As in forward mode, a null adjoint does not propagate
+    // anything, even through an infinite or NaN partial
+    for (std::size_t i = code.size() ; i-- > 0 ;)
+    {
+        const Number adjoint = adjoints[i];
+        if (code[i].code == opcode::variable)
+        {
+            res[code[i].index] += adjoint;
+        }
+        for (std::size_t edge = first_edge[i] ; edge < first_edge[i + 1] ; ++edge)
+        {
+            adjoints[edges[edge].first] += details::chain(edges[edge].second, adjoint);
+        }
+    }
+    return top[-1];
+}
+
+template<typename Number>
+auto gradient(const expression<Number>& expr,
+              std::initializer_list<Number> variables,
+              Number* res)
+    -> Number
+{
+    return gradient(expr, variables.begin(), variables.size(), res);
+}
@@ -20,8 +20,17 @@ template<typename Number>
 auto evaluator<Number>::evaluate(const std::string& expression) const
     -> Number
 {
-    auto tokens = tokenize<Number>(expression);
-    return eval_postfix(to_postfix(tokens));
+    if (not cache.enabled())
+    {
+        return eval_tokens(tokenize<Number>(expression));
+    }
+
+    auto compiled = cache.find(expression);
+    if (not compiled)
+    {
+        compiled = cache.insert(expression, compile(expression));
+    }
+    return compiled->evaluate();
 }
 
 template<typename Number>
@@ -31,16 +40,47 @@ auto evaluator<Number>::operator()(const std::string& expression) const
     return evaluate(expression);
 }
 
+template<typename Number>
+auto evaluator<Number>::compile(const std::string& expression) const
+    -> evaluation::expression<Number>
+{
+    return compile(expression, {});
+}
+
+template<typename Number>
+auto evaluator<Number>::compile(const std::string& expression,
+                                const std::vector<std::string>& variables) const
+    -> evaluation::expression<Number>
+{
+    return { tokenize<Number>(expression), callbacks, variables };
+}
+
 template<typename Number>
 template<typename Func>
-auto evaluator<Number>::connect(const std::string& name, Func&& function)
+auto evaluator<Number>::connect(const std::string& name, Func&& function, bool pure)
     -> void
 {
     callbacks.emplace(
         std::piecewise_construct,
         std::forward_as_tuple(name),
-        std::forward_as_tuple(function)
+        std::forward_as_tuple(function, pure)
     );
+    cache.invalidate(name);
+}
+
+template<typename Number>
+template<typename... Partials>
+auto evaluator<Number>::connect_derivatives(const std::string& name, Partials&&... partials)
+    -> void
+{
+    auto it = callbacks.find(name);
+    if (it == callbacks.end())
+    {
+        throw error(error_type::unknown_name,
+                    "unknown function: " + name);
+    }
+    it->second.set_partials(std::forward<Partials>(partials)...);
+    cache.invalidate(name);
 }
 
 template<typename Number>
@@ -48,30 +88,80 @@ auto evaluator<Number>::disconnect(const std::string& name)
     -> void
 {
     callbacks.erase(name);
+    cache.invalidate(name);
+}
+
+template<typename Number>
+auto evaluator<Number>::set_cache_capacity(std::size_t capacity)
+    -> void
+{
+    cache.set_capacity(capacity);
+}
+
+template<typename Number>
+auto evaluator<Number>::cache_capacity() const
+    -> std::size_t
+{
+    return cache.capacity();
+}
+
+template<typename Number>
+auto evaluator<Number>::cache_size() const
+    -> std::size_t
+{
+    return cache.size();
+}
+
+template<typename Number>
+auto evaluator<Number>::cache_hits() const
+    -> std::size_t
+{
+    return cache.hits();
+}
+
+template<typename Number>
+auto evaluator<Number>::cache_misses() const
+    -> std::size_t
+{
+    return cache.misses();
+}
+
+template<typename Number>
+auto evaluator<Number>::clear_cache()
+    -> void
+{
+    cache.clear();
 }
 
 template<typename Number>
-auto evaluator<Number>::eval_postfix(std::stack<token<Number>>&& tokens) const
+auto evaluator<Number>::eval_tokens(const std::vector<token<Number>>& tokens) const
     -> Number
 {
-    std::stack<Number> operands;
+    // The operands are contiguous so that the parameters of
+    // a function can be read in place, whatever its arity
+    std::vector<Number> operands;
+    operands.reserve(tokens.size());
 
-    while (not tokens.empty())
+    // The tokens are evaluated as they are parsed
+    parse(tokens, [&](const token<Number>& tok)
     {
-        token<Number> tok = std::move(tokens.top());
-        tokens.pop();
-
         switch (tok.type)
         {
             case token_t::operand:
             {
-                operands.push(tok.data);
+                operands.push_back(tok.data);
                 break;
             }
 
             case token_t::name:
             {
-                auto&& func = callbacks.at(tok.name);
+                auto it = callbacks.find(tok.name);
+                if (it == callbacks.end())
+                {
+                    throw error(error_type::unknown_name,
+                                "unknown name in the expression: " + tok.name);
+                }
+                auto&& func = it->second;
 
                 if (operands.size() < func.arity)
                 {
@@ -86,19 +176,20 @@ auto evaluator<Number>::eval_postfix(std::stack<token<Number>>&& tokens) const
                     throw error(error_type::not_enough_operands, sstr.str());
                 }
 
-                // Only 16 parameters for now
-                // This function would benefit from variable size arrays
-                Number params[16];
-
-                for (std::size_t i = func.arity ; i > 0u ; --i)
-                {
-                    params[i-1u] = std::move(operands.top());
-                    operands.pop();
-                }
-                operands.push(func(params));
+                const std::size_t first = operands.size() - func.arity;
+                Number res = func(operands.data() + first);
+                operands.resize(first);
+                operands.push_back(res);
                 break;
             }
 
+            case token_t::variable:
+            {
+                // Variables only make sense in compiled expressions
+                throw error(error_type::unknown_name,
+                            "unknown name in the expression: " + tok.name);
+            }
+
             case token_t::infix:
             {
                 if (operands.size() < 2)
@@ -111,11 +202,9 @@ auto evaluator<Number>::eval_postfix(std::stack<token<Number>>&& tokens) const
 
                     throw error(error_type::not_enough_operands, sstr.str());
                 }
-                Number rhs = std::move(operands.top());
-                operands.pop();
-                Number lhs = std::move(operands.top());
-                operands.pop();
-                operands.push(operation(tok.infix, lhs, rhs));
+                Number rhs = std::move(operands.back());
+                operands.pop_back();
+                operands.back() = operation(tok.infix, operands.back(), rhs);
                 break;
             }
 
@@ -131,9 +220,7 @@ auto evaluator<Number>::eval_postfix(std::stack<token<Number>>&& tokens) const
 
                     throw error(error_type::not_enough_operands, sstr.str());
                 }
-                Number arg = std::move(operands.top());
-                operands.pop();
-                operands.push(operation(tok.prefix, arg));
+                operands.back() = operation(tok.prefix, operands.back());
                 break;
             }
 
@@ -149,21 +236,24 @@ auto evaluator<Number>::eval_postfix(std::stack<token<Number>>&& tokens) const
 
                     throw error(error_type::not_enough_operands, sstr.str());
                 }
-                Number arg = std::move(operands.top());
-                operands.pop();
-                operands.push(operation(tok.postfix, arg));
+                operands.back() = operation(tok.postfix, operands.back());
                 break;
             }
 
             default:
             {
                 std::stringstream sstr;
-                sstr << "unexpected token in postfix evaluation: "
+                sstr << "unexpected token in the expression: "
                      << to_string(tok);
 
                 throw error(error_type::unexpected_token, sstr.str());
             }
         }
+    });
+    if (operands.empty())
+    {
+        throw error(error_type::not_enough_operands,
+                    "not enough operands for the expression: expected 1, got 0");
     }
-    return operands.top();
+    return operands.back();
 }
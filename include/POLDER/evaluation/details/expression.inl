@@ -0,0 +1,817 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+////////////////////////////////////////////////////////////
+// Instructions
+
+inline instruction::instruction(opcode code, std::size_t index):
+    code(code),
+    index(static_cast<std::uint32_t>(index))
+{}
+
+inline instruction::instruction(infix_t oper):
+    code(opcode::infix),
+    infix(oper),
+    index(0)
+{}
+
+inline instruction::instruction(prefix_t oper):
+    code(opcode::prefix),
+    prefix(oper),
+    index(0)
+{}
+
+inline instruction::instruction(postfix_t oper):
+    code(opcode::postfix),
+    postfix(oper),
+    index(0)
+{}
+
+////////////////////////////////////////////////////////////
+// Column kernels
+
+namespace details
+{
+    // Number of rows evaluated at once by evaluate_columns: the
+    // operands of a block stay in the L1 cache whatever the
+    // depth of the expression
+    constexpr std::size_t column_block_size = 256;
+
+    // The operator is a template parameter so that operation
+    // is reduced to a single operation, and the loops always
+    // run over a whole block so that the compiler vectorizes
+    // them without remainder loop
+
+    template<infix_t Oper, typename Number>
+    auto infix_block(Number* lhs, const Number* rhs)
+        -> void
+    {
+        // The operands are always in different blocks
+        #pragma GCC ivdep
+        for (std::size_t i = 0 ; i < column_block_size ; ++i)
+        {
+            lhs[i] = operation(Oper, lhs[i], rhs[i]);
+        }
+    }
+
+    template<prefix_t Oper, typename Number>
+    auto prefix_block(Number* arg)
+        -> void
+    {
+        for (std::size_t i = 0 ; i < column_block_size ; ++i)
+        {
+            arg[i] = operation(Oper, arg[i]);
+        }
+    }
+
+    template<postfix_t Oper, typename Number>
+    auto postfix_block(Number* arg)
+        -> void
+    {
+        for (std::size_t i = 0 ; i < column_block_size ; ++i)
+        {
+            arg[i] = operation(Oper, arg[i]);
+        }
+    }
+
+    template<typename Number>
+    auto infix_block(infix_t oper, Number* lhs, const Number* rhs)
+        -> void
+    {
+        switch (oper)
+        {
+            case infix_t::EQ:
+                infix_block<infix_t::EQ>(lhs, rhs);
+                return;
+            case infix_t::NE:
+                infix_block<infix_t::NE>(lhs, rhs);
+                return;
+            case infix_t::GE:
+                infix_block<infix_t::GE>(lhs, rhs);
+                return;
+            case infix_t::LE:
+                infix_block<infix_t::LE>(lhs, rhs);
+                return;
+            case infix_t::AND:
+                infix_block<infix_t::AND>(lhs, rhs);
+                return;
+            case infix_t::OR:
+                infix_block<infix_t::OR>(lhs, rhs);
+                return;
+            case infix_t::XOR:
+                infix_block<infix_t::XOR>(lhs, rhs);
+                return;
+            case infix_t::POW:
+                infix_block<infix_t::POW>(lhs, rhs);
+                return;
+            case infix_t::SPACE:
+                infix_block<infix_t::SPACE>(lhs, rhs);
+                return;
+            case infix_t::LSHIFT:
+                infix_block<infix_t::LSHIFT>(lhs, rhs);
+                return;
+            case infix_t::RSHIFT:
+                infix_block<infix_t::RSHIFT>(lhs, rhs);
+                return;
+            case infix_t::ADD:
+                infix_block<infix_t::ADD>(lhs, rhs);
+                return;
+            case infix_t::SUB:
+                infix_block<infix_t::SUB>(lhs, rhs);
+                return;
+            case infix_t::MUL:
+                infix_block<infix_t::MUL>(lhs, rhs);
+                return;
+            case infix_t::DIV:
+                infix_block<infix_t::DIV>(lhs, rhs);
+                return;
+            case infix_t::MOD:
+                infix_block<infix_t::MOD>(lhs, rhs);
+                return;
+            case infix_t::BAND:
+                infix_block<infix_t::BAND>(lhs, rhs);
+                return;
+            case infix_t::BOR:
+                infix_block<infix_t::BOR>(lhs, rhs);
+                return;
+            case infix_t::GT:
+                infix_block<infix_t::GT>(lhs, rhs);
+                return;
+            case infix_t::LT:
+                infix_block<infix_t::LT>(lhs, rhs);
+                return;
+            case infix_t::BXOR:
+                infix_block<infix_t::BXOR>(lhs, rhs);
+                return;
+            case infix_t::IDIV:
+                infix_block<infix_t::IDIV>(lhs, rhs);
+                return;
+        }
+    }
+
+    template<typename Number>
+    auto prefix_block(prefix_t oper, Number* arg)
+        -> void
+    {
+        switch (oper)
+        {
+            case prefix_t::USUB:
+                prefix_block<prefix_t::USUB>(arg);
+                return;
+            case prefix_t::NOT:
+                prefix_block<prefix_t::NOT>(arg);
+                return;
+            case prefix_t::BNOT:
+                prefix_block<prefix_t::BNOT>(arg);
+                return;
+        }
+    }
+
+    template<typename Number>
+    auto postfix_block(postfix_t oper, Number* arg)
+        -> void
+    {
+        switch (oper)
+        {
+            case postfix_t::FAC:
+                postfix_block<postfix_t::FAC>(arg);
+                return;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////
+// Compilation
+
+template<typename Number>
+constexpr std::size_t expression<Number>::small_stack_size;
+
+template<typename Number>
+expression<Number>::expression(const std::vector<token<Number>>& tokens,
+                               const std::map<std::string, callback<Number>, std::less<>>& callbacks,
+                               std::vector<std::string> variables):
+    _variable_names(std::move(variables)),
+    _max_depth(0)
+{
+    // Number of operands on the stack at this point of the
+    // program; it is tracked here so that the evaluation
+    // does not have to check anything
+    std::size_t depth = 0;
+
+    auto require = [&depth](std::size_t nb_operands, const std::string& what)
+    {
+        if (depth < nb_operands)
+        {
+            std::stringstream sstr;
+            sstr << "not enough operands for "
+                 << what
+                 << ": expected "
+                 << nb_operands
+                 << ", got "
+                 << depth;
+
+            throw error(error_type::not_enough_operands, sstr.str());
+        }
+    };
+
+    // There are never more instructions than tokens
+    _code.reserve(tokens.size());
+
+    parse(tokens, [&](const token<Number>& tok)
+    {
+        switch (tok.type)
+        {
+            case token_t::operand:
+            {
+                _code.emplace_back(opcode::constant, _constants.size());
+                _constants.push_back(tok.data);
+                ++depth;
+                break;
+            }
+
+            case token_t::name:
+            {
+                auto it = callbacks.find(tok.name);
+                if (it == callbacks.end())
+                {
+                    throw error(error_type::unknown_name,
+                                "unknown name in the expression: " + tok.name);
+                }
+                require(it->second.arity, "function " + tok.name);
+
+                // Each function is stored once, however many
+                // times it is called
+                auto pos = std::find(_function_names.begin(), _function_names.end(), tok.name);
+                std::size_t index = pos - _function_names.begin();
+                if (pos == _function_names.end())
+                {
+                    _functions.push_back(it->second);
+                    _function_names.push_back(tok.name.str());
+                }
+                _code.emplace_back(opcode::call, index);
+                depth = depth - it->second.arity + 1;
+                break;
+            }
+
+            case token_t::variable:
+            {
+                auto pos = std::find(_variable_names.begin(), _variable_names.end(), tok.name);
+                if (pos == _variable_names.end())
+                {
+                    throw error(error_type::unknown_name,
+                                "unknown name in the expression: " + tok.name);
+                }
+                _code.emplace_back(opcode::variable, pos - _variable_names.begin());
+                ++depth;
+                break;
+            }
+
+            case token_t::infix:
+            {
+                require(2, "infix operator " + to_string(tok.infix));
+                _code.emplace_back(tok.infix);
+                --depth;
+                break;
+            }
+
+            case token_t::prefix:
+            {
+                require(1, "prefix operator " + to_string(tok.prefix));
+                _code.emplace_back(tok.prefix);
+                break;
+            }
+
+            case token_t::postfix:
+            {
+                require(1, "postfix operator " + to_string(tok.postfix));
+                _code.emplace_back(tok.postfix);
+                break;
+            }
+
+            default:
+            {
+                std::stringstream sstr;
+                sstr << "unexpected token in the expression: "
+                     << to_string(tok);
+
+                throw error(error_type::unexpected_token, sstr.str());
+            }
+        }
+    });
+
+    require(1, "the expression");
+    optimize();
+}
+
+template<typename Number>
+auto expression<Number>::optimize()
+    -> void
+{
+    // Operand of the program being simplified: the code that
+    // computes it starts at the index start of the new code,
+    // and is a single constant instruction if is_constant
+    struct operand
+    {
+        std::size_t start;
+        bool is_constant;
+        Number value;
+    };
+
+    std::vector<instruction> code;
+    std::vector<Number> constants;
+    std::vector<operand> operands;
+    std::vector<Number> params;
+
+    // Replaces the code of the operands from first by a constant
+    auto fold = [&](std::size_t first, Number value)
+    {
+        std::size_t start = (first < operands.size()) ? operands[first].start : code.size();
+        code.erase(code.begin() + start, code.end());
+        operands.resize(first);
+        code.emplace_back(opcode::constant, constants.size());
+        constants.push_back(value);
+        operands.push_back({ start, true, value });
+    };
+
+    auto is_constant = [&](std::size_t index, Number value)
+    {
+        return operands[index].is_constant && operands[index].value == value;
+    };
+
+    for (const instruction& instr: _code)
+    {
+        switch (instr.code)
+        {
+            case opcode::constant:
+            {
+                operands.push_back({ code.size(), true, _constants[instr.index] });
+                code.emplace_back(opcode::constant, constants.size());
+                constants.push_back(_constants[instr.index]);
+                break;
+            }
+
+            case opcode::variable:
+            case opcode::duplicate:
+            {
+                operands.push_back({ code.size(), false, Number{} });
+                code.push_back(instr);
+                break;
+            }
+
+            case opcode::prefix:
+            case opcode::postfix:
+            {
+                const std::size_t arg = operands.size() - 1;
+                if (operands[arg].is_constant)
+                {
+                    Number value = (instr.code == opcode::prefix)
+                        ? operation(instr.prefix, operands[arg].value)
+                        : operation(instr.postfix, operands[arg].value);
+                    fold(arg, value);
+                    break;
+                }
+                code.push_back(instr);
+                break;
+            }
+
+            case opcode::infix:
+            {
+                const std::size_t lhs = operands.size() - 2;
+                const std::size_t rhs = operands.size() - 1;
+                const infix_t oper = instr.infix;
+
+                if (operands[lhs].is_constant && operands[rhs].is_constant)
+                {
+                    fold(lhs, operation(oper, operands[lhs].value, operands[rhs].value));
+                    break;
+                }
+
+                // x op c == x: the constant is dropped
+                if ((oper == infix_t::MUL && is_constant(rhs, Number(1)))
+                    || (oper == infix_t::DIV && is_constant(rhs, Number(1)))
+                    || (oper == infix_t::POW && is_constant(rhs, Number(1)))
+                    || (oper == infix_t::ADD && is_constant(rhs, Number(0)))
+                    || (oper == infix_t::SUB && is_constant(rhs, Number(0))))
+                {
+                    code.erase(code.begin() + operands[rhs].start, code.end());
+                    operands.pop_back();
+                    break;
+                }
+
+                // c op x == x: the constant is removed from the front
+                if ((oper == infix_t::MUL && is_constant(lhs, Number(1)))
+                    || (oper == infix_t::ADD && is_constant(lhs, Number(0))))
+                {
+                    code.erase(code.begin() + operands[lhs].start);
+                    operands.pop_back();
+                    operands.back().is_constant = false;
+                    break;
+                }
+
+                // x**2 == x*x, with x computed once
+                if (is_square_product<Number>::value
+                    && oper == infix_t::POW && is_constant(rhs, Number(2)))
+                {
+                    code.back() = instruction(opcode::duplicate, 0);
+                    code.emplace_back(infix_t::MUL);
+                    operands.pop_back();
+                    break;
+                }
+
+                code.push_back(instr);
+                operands.pop_back();
+                operands.back().is_constant = false;
+                break;
+            }
+
+            case opcode::call:
+            {
+                const callback<Number>& func = _functions[instr.index];
+                const std::size_t first = operands.size() - func.arity;
+
+                bool foldable = func.pure;
+                for (std::size_t i = first ; foldable && i < operands.size() ; ++i)
+                {
+                    foldable = operands[i].is_constant;
+                }
+
+                if (foldable)
+                {
+                    params.clear();
+                    for (std::size_t i = first ; i < operands.size() ; ++i)
+                    {
+                        params.push_back(operands[i].value);
+                    }
+                    fold(first, func(params.data()));
+                    break;
+                }
+
+                const std::size_t start = func.arity ? operands[first].start : code.size();
+                operands.resize(first);
+                operands.push_back({ start, false, Number{} });
+                code.push_back(instr);
+                break;
+            }
+        }
+    }
+
+    // The constants of the folded operations are not needed
+    // anymore: only the ones still used are kept
+    _constants.clear();
+    for (instruction& instr: code)
+    {
+        if (instr.code == opcode::constant)
+        {
+            std::size_t index = instr.index;
+            instr.index = static_cast<std::uint32_t>(_constants.size());
+            _constants.push_back(constants[index]);
+        }
+    }
+    _code = std::move(code);
+
+    // The simplifications change the depth of the program
+    std::size_t depth = 0;
+    _max_depth = 0;
+    for (const instruction& instr: _code)
+    {
+        switch (instr.code)
+        {
+            case opcode::constant:
+            case opcode::variable:
+            case opcode::duplicate:
+                ++depth;
+                break;
+            case opcode::infix:
+                --depth;
+                break;
+            case opcode::call:
+                depth = depth - _functions[instr.index].arity + 1;
+                break;
+            default:
+                break;
+        }
+        _max_depth = std::max(_max_depth, depth);
+    }
+}
+
+////////////////////////////////////////////////////////////
+// Evaluation
+
+template<typename Number>
+auto expression<Number>::evaluate() const
+    -> Number
+{
+    return evaluate(nullptr, 0);
+}
+
+template<typename Number>
+auto expression<Number>::evaluate(const Number* variables, std::size_t size) const
+    -> Number
+{
+    POLDER_ASSERT(size >= _variable_names.size());
+    (void) size;
+
+    if (_max_depth <= small_stack_size)
+    {
+        Number stack[small_stack_size];
+        return run(stack, variables);
+    }
+    std::vector<Number> stack(_max_depth);
+    return run(stack.data(), variables);
+}
+
+template<typename Number>
+auto expression<Number>::evaluate(const Number* variables, std::size_t size,
+                                  std::vector<Number>& stack) const
+    -> Number
+{
+    POLDER_ASSERT(size >= _variable_names.size());
+    (void) size;
+
+    if (stack.size() < _max_depth)
+    {
+        stack.resize(_max_depth);
+    }
+    return run(stack.data(), variables);
+}
+
+template<typename Number>
+auto expression<Number>::evaluate(std::initializer_list<Number> variables) const
+    -> Number
+{
+    return evaluate(variables.begin(), variables.size());
+}
+
+template<typename Number>
+auto expression<Number>::operator()() const
+    -> Number
+{
+    return evaluate();
+}
+
+template<typename Number>
+auto expression<Number>::operator()(const Number* variables, std::size_t size) const
+    -> Number
+{
+    return evaluate(variables, size);
+}
+
+template<typename Number>
+auto expression<Number>::operator()(std::initializer_list<Number> variables) const
+    -> Number
+{
+    return evaluate(variables);
+}
+
+template<typename Number>
+auto expression<Number>::run(Number* stack, const Number* variables) const
+    -> Number
+{
+    // One past the top of the stack; the operands have
+    // already been checked during the compilation
+    Number* top = stack;
+
+    for (const instruction& instr: _code)
+    {
+        switch (instr.code)
+        {
+            case opcode::constant:
+            {
+                *top++ = _constants[instr.index];
+                break;
+            }
+
+            case opcode::infix:
+            {
+                --top;
+                top[-1] = operation(instr.infix, top[-1], *top);
+                break;
+            }
+
+            case opcode::prefix:
+            {
+                top[-1] = operation(instr.prefix, top[-1]);
+                break;
+            }
+
+            case opcode::postfix:
+            {
+                top[-1] = operation(instr.postfix, top[-1]);
+                break;
+            }
+
+            case opcode::variable:
+            {
+                *top++ = variables[instr.index];
+                break;
+            }
+
+            case opcode::duplicate:
+            {
+                *top = top[-1];
+                ++top;
+                break;
+            }
+
+            case opcode::call:
+            {
+                // The parameters are the topmost operands, in
+                // order: the function reads them in place
+                const callback<Number>& func = _functions[instr.index];
+                top -= func.arity;
+                *top = func(top);
+                ++top;
+                break;
+            }
+        }
+    }
+    return top[-1];
+}
+
+template<typename Number>
+auto expression<Number>::evaluate_columns(const Number* const* columns, std::size_t size,
+                                          Number* res) const
+    -> void
+{
+    evaluate_columns(execution::seq, columns, size, res);
+}
+
+template<typename Number>
+template<typename ExecutionPolicy>
+auto expression<Number>::evaluate_columns(ExecutionPolicy&& policy,
+                                          const Number* const* columns, std::size_t size,
+                                          Number* res) const
+    -> void
+{
+    constexpr std::size_t block_size = details::column_block_size;
+    const std::size_t nb_blocks = (size + block_size - 1) / block_size;
+
+    // Whether the row blocks are evaluated in parallel is
+    // decided once from the number of instructions to run
+    const auto block_policy = execution::for_work(policy, size * _code.size());
+    execution::parallel_for(block_policy, nb_blocks,
+        [&](std::size_t first, std::size_t last)
+        {
+            // One block of operands per stack level, and room
+            // for the parameters of the widest function
+            std::size_t max_arity = 0;
+            for (const callback<Number>& func: _functions)
+            {
+                max_arity = std::max(max_arity, func.arity);
+            }
+            std::vector<Number> stack(_max_depth * block_size + max_arity);
+            Number* params = stack.data() + _max_depth * block_size;
+
+            for (std::size_t block = first ; block < last ; ++block)
+            {
+                const std::size_t begin = block * block_size;
+                const std::size_t count = std::min(block_size, size - begin);
+                const Number* values = run_block(stack.data(), params, columns, begin, count);
+                std::copy_n(values, count, res + begin);
+            }
+        }
+    );
+}
+
+template<typename Number>
+auto expression<Number>::run_block(Number* stack, Number* params,
+                                   const Number* const* columns,
+                                   std::size_t begin, std::size_t count) const
+    -> const Number*
+{
+    constexpr std::size_t block_size = details::column_block_size;
+
+    // Start of the block past the top of the stack
+    Number* top = stack;
+
+    // The rows past count in the last block are copies of
+    // the last row: the operators can run over whole blocks
+    // without producing errors that the actual rows do not
+
+    for (const instruction& instr: _code)
+    {
+        switch (instr.code)
+        {
+            case opcode::constant:
+            {
+                std::fill_n(top, block_size, _constants[instr.index]);
+                top += block_size;
+                break;
+            }
+
+            case opcode::variable:
+            {
+                std::copy_n(columns[instr.index] + begin, count, top);
+                std::fill(top + count, top + block_size, top[count - 1]);
+                top += block_size;
+                break;
+            }
+
+            case opcode::duplicate:
+            {
+                std::copy_n(top - block_size, block_size, top);
+                top += block_size;
+                break;
+            }
+
+            case opcode::infix:
+            {
+                top -= block_size;
+                details::infix_block(instr.infix, top - block_size, top);
+                break;
+            }
+
+            case opcode::prefix:
+            {
+                details::prefix_block(instr.prefix, top - block_size);
+                break;
+            }
+
+            case opcode::postfix:
+            {
+                details::postfix_block(instr.postfix, top - block_size);
+                break;
+            }
+
+            case opcode::call:
+            {
+                // The parameters of a row are spread over several
+                // blocks: they are gathered before each call
+                const callback<Number>& func = _functions[instr.index];
+                top -= func.arity * block_size;
+                for (std::size_t i = 0 ; i < count ; ++i)
+                {
+                    for (std::size_t arg = 0 ; arg < func.arity ; ++arg)
+                    {
+                        params[arg] = top[arg * block_size + i];
+                    }
+                    top[i] = func(params);
+                }
+                std::fill(top + count, top + block_size, top[count - 1]);
+                top += block_size;
+                break;
+            }
+        }
+    }
+    return top - block_size;
+}
+
+////////////////////////////////////////////////////////////
+// Program inspection
+
+template<typename Number>
+auto expression<Number>::instructions() const
+    -> const std::vector<instruction>&
+{
+    return _code;
+}
+
+template<typename Number>
+auto expression<Number>::constants() const
+    -> const std::vector<Number>&
+{
+    return _constants;
+}
+
+template<typename Number>
+auto expression<Number>::functions() const
+    -> const std::vector<callback<Number>>&
+{
+    return _functions;
+}
+
+template<typename Number>
+auto expression<Number>::function_names() const
+    -> const std::vector<std::string>&
+{
+    return _function_names;
+}
+
+template<typename Number>
+auto expression<Number>::variable_names() const
+    -> const std::vector<std::string>&
+{
+    return _variable_names;
+}
+
+template<typename Number>
+auto expression<Number>::max_depth() const
+    -> std::size_t
+{
+    return _max_depth;
+}
@@ -16,11 +16,63 @@
  * see <http://www.gnu.org/licenses/>.
  */
 
+namespace details
+{
+    template<typename Number>
+    auto parse_number(const char* first, const char* last, bool, std::false_type)
+        -> Number
+    {
+        // strtod needs a null-terminated string: the number is
+        // copied to a local buffer unless it is unusually long
+        char buffer[64];
+        const std::size_t size = last - first;
+        if (size < sizeof buffer)
+        {
+            std::memcpy(buffer, first, size);
+            buffer[size] = '\0';
+            return static_cast<Number>(std::strtod(buffer, nullptr));
+        }
+        return static_cast<Number>(std::stod(std::string(first, last)));
+    }
+
+    // Integers without a dot are parsed exactly, without
+    // going through a double
+    template<typename Number>
+    auto parse_number(const char* first, const char* last, bool has_dot, std::true_type)
+        -> Number
+    {
+        if (has_dot)
+        {
+            return parse_number<Number>(first, last, has_dot, std::false_type{});
+        }
+
+        Number res = 0;
+        for (; first != last ; ++first)
+        {
+            res = res * 10 + (*first - '0');
+        }
+        return res;
+    }
+
+    /**
+     * Parses the digits and dots in [first, last) without
+     * allocating, in the spirit of std::from_chars.
+     */
+    template<typename Number>
+    auto parse_number(const char* first, const char* last, bool has_dot)
+        -> Number
+    {
+        return parse_number<Number>(first, last, has_dot, std::is_integral<Number>{});
+    }
+}
+
 template<typename Number>
 auto tokenize(const std::string& expr)
     -> std::vector<token<Number>>
 {
+    // There are never more tokens than characters
     std::vector<token<Number>> res;
+    res.reserve(expr.size());
 
     // Number of parenthesis
     int nmb_parenthesis = 0;
@@ -59,21 +111,31 @@ auto tokenize(const std::string& expr)
                 }
                 ++it;
             }
-            auto tmp_str = std::string(tmp, it);
-            res.emplace_back(std::stod(tmp_str));
+            res.emplace_back(details::parse_number<Number>(&*tmp, &*tmp + (it - tmp), has_dot));
             --it; // Iteration is pushed one step too far
             continue;
         }
 
         if (std::isalpha(*it) || *it == '_')
         {
-            // Found a function name
+            // Found a name
             auto tmp = it;
             while (std::isalnum(*it) || *it == '_')
             {
                 ++it;
             }
-            res.emplace_back(std::string(tmp, it));
+
+            // A name is a function name if it is followed by
+            // an opening parenthesis, and a variable otherwise
+            auto next = it;
+            while (next != expr.cend() && std::isspace(*next))
+            {
+                ++next;
+            }
+            auto type = (next != expr.cend() && *next == '(') ? token_t::name
+                                                                : token_t::variable;
+
+            res.emplace_back(name_view{ &*tmp, std::size_t(it - tmp) }, type);
             --it; // Iteration is pushed one step too far
             continue;
         }
@@ -184,6 +246,7 @@ auto tokenize(const std::string& expr)
                 {
                     const token<Number>& tok = res.back();
                     if (tok.is_operand()
+                        || tok.is_variable()
                         || tok.is_postfix()
                         || tok.is_right_brace())
                     {
@@ -245,16 +308,16 @@ auto tokenize(const std::string& expr)
                 {
                     res.emplace_back(infix_t::NE);
                 }
+                else if (not res.empty()
+                         && (res.back().is_operand()
+                             || res.back().is_variable()
+                             || res.back().is_postfix()
+                             || res.back().is_right_brace()))
+                {
+                    res.emplace_back(postfix_t::FAC);
+                }
                 else
                 {
-                    const token<Number>& tok = res.back();
-                    if (tok.is_operand()
-                        || tok.is_postfix()
-                        || tok.is_right_brace())
-                    {
-                        res.emplace_back(postfix_t::FAC);
-                        break;
-                    }
                     res.emplace_back(prefix_t::NOT);
                 }
                 break;
@@ -278,93 +341,171 @@ auto tokenize(const std::string& expr)
     return res;
 }
 
-template<typename Number>
-auto to_postfix(const std::vector<token<Number>>& tokens)
-    -> std::stack<token<Number>>
+namespace details
 {
-    // This function implements a Shunting-Yard algorithm
-    // to handle the priority of infix operators
+    /**
+     * Pratt parser: every operator is parsed with the right
+     * operand binding as long as the following operators have
+     * a higher priority, so that the recursion of the parser
+     * replaces the stacks of a Shunting-Yard algorithm.
+     */
+    template<typename Number, typename Handler>
+    class pratt_parser
+    {
+        public:
 
-    std::stack<token<Number>> output;
-    std::stack<token<Number>> operations;
+            using iterator = typename std::vector<token<Number>>::const_iterator;
 
-    for (const token<Number>& tok: tokens)
-    {
-        switch (tok.type)
-        {
-            case token_t::operand:
+            pratt_parser(iterator first, iterator last, Handler& handler):
+                _it(first),
+                _last(last),
+                _handler(handler)
+            {}
+
+            auto parse()
+                -> void
             {
-                output.push(tok);
-                while (not operations.empty() && operations.top().is_prefix())
+                parse_expression(0);
+                if (_it != _last)
                 {
-                    output.push(std::move(operations.top()));
-                    operations.pop();
+                    unexpected();
                 }
-                break;
             }
 
-            case token_t::postfix:
-            {
-                output.push(tok);
-                break;
-            }
+        private:
 
-            case token_t::infix:
+            // Parses the operators whose priority is greater
+            // than min_priority after the next operand
+            auto parse_expression(unsigned int min_priority)
+                -> void
             {
-                while (not operations.empty()
-                       && operations.top().is_infix()
-                       && (priority(tok.infix) <= priority(operations.top().infix)))
+                parse_operand();
+                while (_it != _last)
                 {
-                    output.push(std::move(operations.top()));
-                    operations.pop();
+                    const token<Number>& tok = *_it;
+                    if (tok.is_postfix() && priority(tok.postfix) > min_priority)
+                    {
+                        ++_it;
+                        _handler(tok);
+                    }
+                    else if (tok.is_infix() && priority(tok.infix) > min_priority)
+                    {
+                        ++_it;
+                        unsigned int prio = priority(tok.infix);
+                        if (associativity(tok.infix) == associativity_t::right)
+                        {
+                            --prio;
+                        }
+                        parse_expression(prio);
+                        _handler(tok);
+                    }
+                    else
+                    {
+                        return;
+                    }
                 }
-                operations.push(tok);
-                break;
             }
 
-            case token_t::prefix:
-            case token_t::name:
-            case token_t::left_brace:
+            auto parse_operand()
+                -> void
             {
-                operations.push(tok);
-                break;
+                if (_it == _last)
+                {
+                    throw error(error_type::not_enough_operands,
+                                "unexpected end of the expression");
+                }
+
+                const token<Number>& tok = *_it++;
+                switch (tok.type)
+                {
+                    case token_t::operand:
+                    case token_t::variable:
+                    {
+                        _handler(tok);
+                        break;
+                    }
+
+                    case token_t::prefix:
+                    {
+                        parse_expression(priority(tok.prefix));
+                        _handler(tok);
+                        break;
+                    }
+
+                    case token_t::left_brace:
+                    {
+                        parse_expression(0);
+                        expect_right_brace();
+                        break;
+                    }
+
+                    case token_t::name:
+                    {
+                        // The tokenizer only produces names which
+                        // are followed by a parenthesis
+                        ++_it;
+                        if (_it != _last && _it->is_right_brace())
+                        {
+                            ++_it;
+                        }
+                        else
+                        {
+                            parse_expression(0);
+                            while (_it != _last && _it->is_comma())
+                            {
+                                ++_it;
+                                parse_expression(0);
+                            }
+                            expect_right_brace();
+                        }
+                        _handler(tok);
+                        break;
+                    }
+
+                    default:
+                    {
+                        --_it;
+                        unexpected();
+                    }
+                }
             }
 
-            case token_t::right_brace:
+            auto expect_right_brace()
+                -> void
             {
-                while (not operations.empty() &&
-                       not operations.top().is_left_brace())
+                if (_it == _last)
                 {
-                    output.push(std::move(operations.top()));
-                    operations.pop();
+                    throw error(error_type::mismatched_parenthesis);
                 }
-                operations.pop();
-                while (not operations.empty()
-                       && (operations.top().is_prefix() || operations.top().is_name()))
+                if (not _it->is_right_brace())
                 {
-                    output.push(std::move(operations.top()));
-                    operations.pop();
+                    unexpected();
                 }
-                break;
+                ++_it;
             }
 
-            case token_t::comma:
+            [[noreturn]] auto unexpected() const
+                -> void
             {
-                while (not operations.empty() &&
-                       not operations.top().is_left_brace())
-                {
-                    output.push(std::move(operations.top()));
-                    operations.pop();
-                }
-                break;
+                std::stringstream sstr;
+                sstr << "unexpected token in the expression: "
+                     << to_string(*_it);
+
+                throw error(error_type::unexpected_token, sstr.str());
             }
-        }
-    }
 
-    while (not output.empty())
-    {
-        operations.push(std::move(output.top()));
-        output.pop();
-    }
-    return operations;
+            iterator _it;
+            iterator _last;
+            Handler& _handler;
+    };
+}
+
+template<typename Number, typename Handler>
+auto parse(const std::vector<token<Number>>& tokens, Handler&& handler)
+    -> void
+{
+    details::pratt_parser<Number, std::remove_reference_t<Handler>> parser(
+        tokens.cbegin(), tokens.cend(), handler
+    );
+    parser.parse();
 }
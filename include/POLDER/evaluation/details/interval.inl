@@ -0,0 +1,399 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+////////////////////////////////////////////////////////////
+// Construction
+
+template<typename T>
+interval<T>::interval(T value):
+    lower(value),
+    upper(value)
+{}
+
+template<typename T>
+interval<T>::interval(T lower, T upper):
+    lower(lower),
+    upper(upper)
+{
+    POLDER_ASSERT(not (upper < lower));
+}
+
+template<typename T>
+auto interval<T>::whole()
+    -> interval
+{
+    const T bound = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                        : std::numeric_limits<T>::max();
+    return { -bound, bound };
+}
+
+////////////////////////////////////////////////////////////
+// Observers
+
+template<typename T>
+auto interval<T>::contains(T value) const
+    -> bool
+{
+    return lower <= value && value <= upper;
+}
+
+template<typename T>
+auto interval<T>::is_single() const
+    -> bool
+{
+    return lower == upper;
+}
+
+namespace details
+{
+    // Product of two bounds where 0 * inf is 0: the infinite
+    // bound is never reached while 0 is
+    template<typename T>
+    auto mul_bounds(T lhs, T rhs)
+        -> T
+    {
+        return (lhs == T(0) || rhs == T(0)) ? T(0) : lhs * rhs;
+    }
+
+    // Smallest interval containing four values
+    template<typename T>
+    auto hull(T a, T b, T c, T d)
+        -> interval<T>
+    {
+        return {
+            std::min(std::min(a, b), std::min(c, d)),
+            std::max(std::max(a, b), std::max(c, d))
+        };
+    }
+
+    // Result of a condition which is certainly true, certainly
+    // false, or which depends on the values in the intervals
+    template<typename T>
+    auto truth(bool certainly_true, bool certainly_false)
+        -> interval<T>
+    {
+        if (certainly_true)
+        {
+            return T(1);
+        }
+        if (certainly_false)
+        {
+            return T(0);
+        }
+        return { T(0), T(1) };
+    }
+
+    template<typename T>
+    auto is_true(const interval<T>& arg)
+        -> bool
+    {
+        return not arg.contains(T(0));
+    }
+
+    template<typename T>
+    auto is_false(const interval<T>& arg)
+        -> bool
+    {
+        return arg.is_single() && arg.lower == T(0);
+    }
+
+    // The integer operators cast their operands to integers,
+    // which truncates them: truncation is monotonic
+    template<typename T>
+    auto truncate(const interval<T>& arg)
+        -> interval<T>
+    {
+        return { std::trunc(arg.lower), std::trunc(arg.upper) };
+    }
+}
+
+////////////////////////////////////////////////////////////
+// Arithmetic operators
+
+template<typename T>
+auto operator+(const interval<T>& lhs, const interval<T>& rhs)
+    -> interval<T>
+{
+    return { lhs.lower + rhs.lower, lhs.upper + rhs.upper };
+}
+
+template<typename T>
+auto operator-(const interval<T>& lhs, const interval<T>& rhs)
+    -> interval<T>
+{
+    return { lhs.lower - rhs.upper, lhs.upper - rhs.lower };
+}
+
+template<typename T>
+auto operator*(const interval<T>& lhs, const interval<T>& rhs)
+    -> interval<T>
+{
+    return details::hull(
+        details::mul_bounds(lhs.lower, rhs.lower),
+        details::mul_bounds(lhs.lower, rhs.upper),
+        details::mul_bounds(lhs.upper, rhs.lower),
+        details::mul_bounds(lhs.upper, rhs.upper)
+    );
+}
+
+template<typename T>
+auto operator/(const interval<T>& lhs, const interval<T>& rhs)
+    -> interval<T>
+{
+    if (rhs.contains(T(0)))
+    {
+        return interval<T>::whole();
+    }
+    return lhs * interval<T>(T(1) / rhs.upper, T(1) / rhs.lower);
+}
+
+template<typename T>
+auto operator-(const interval<T>& arg)
+    -> interval<T>
+{
+    return { -arg.upper, -arg.lower };
+}
+
+template<typename T>
+auto pow(const interval<T>& lhs, const interval<T>& rhs)
+    -> interval<T>
+{
+    using std::pow;
+
+    // Integer exponents are defined for negative numbers
+    if (rhs.is_single() && std::trunc(rhs.lower) == rhs.lower)
+    {
+        const T exponent = rhs.lower;
+        if (exponent == T(0))
+        {
+            return T(1);
+        }
+        if (exponent < T(0))
+        {
+            return interval<T>(T(1)) / pow(lhs, interval<T>(-exponent));
+        }
+
+        const T lower = pow(lhs.lower, exponent);
+        const T upper = pow(lhs.upper, exponent);
+        if (std::fmod(exponent, T(2)) != T(0))
+        {
+            // Odd powers are increasing
+            return { lower, upper };
+        }
+        if (lhs.contains(T(0)))
+        {
+            return { T(0), std::max(lower, upper) };
+        }
+        return { std::min(lower, upper), std::max(lower, upper) };
+    }
+
+    // x**y is monotonic in x and in y for x >= 0
+    if (lhs.lower >= T(0))
+    {
+        return details::hull(
+            pow(lhs.lower, rhs.lower),
+            pow(lhs.lower, rhs.upper),
+            pow(lhs.upper, rhs.lower),
+            pow(lhs.upper, rhs.upper)
+        );
+    }
+    return interval<T>::whole();
+}
+
+////////////////////////////////////////////////////////////
+// Comparison operators
+
+template<typename T>
+auto operator==(const interval<T>& lhs, const interval<T>& rhs)
+    -> bool
+{
+    return lhs.lower == rhs.lower && lhs.upper == rhs.upper;
+}
+
+template<typename T>
+auto operator!=(const interval<T>& lhs, const interval<T>& rhs)
+    -> bool
+{
+    return not (lhs == rhs);
+}
+
+////////////////////////////////////////////////////////////
+// Operations of the evaluator
+
+template<typename T>
+auto operation(infix_t oper, const interval<T>& lhs, const interval<T>& rhs)
+    -> interval<T>
+{
+    using details::truth;
+    using details::is_true;
+    using details::is_false;
+
+    switch (oper)
+    {
+        case infix_t::ADD:  return lhs + rhs;
+        case infix_t::SUB:  return lhs - rhs;
+        case infix_t::MUL:  return lhs * rhs;
+        case infix_t::DIV:  return lhs / rhs;
+        case infix_t::POW:  return pow(lhs, rhs);
+
+        case infix_t::LT:
+            return truth<T>(lhs.upper < rhs.lower, lhs.lower >= rhs.upper);
+        case infix_t::GT:
+            return truth<T>(lhs.lower > rhs.upper, lhs.upper <= rhs.lower);
+        case infix_t::LE:
+            return truth<T>(lhs.upper <= rhs.lower, lhs.lower > rhs.upper);
+        case infix_t::GE:
+            return truth<T>(lhs.lower >= rhs.upper, lhs.upper < rhs.lower);
+        case infix_t::EQ:
+            return truth<T>(lhs.is_single() && lhs == rhs,
+                            lhs.upper < rhs.lower || rhs.upper < lhs.lower);
+        case infix_t::NE:
+            return truth<T>(lhs.upper < rhs.lower || rhs.upper < lhs.lower,
+                            lhs.is_single() && lhs == rhs);
+        case infix_t::SPACE:
+        {
+            if (lhs.upper < rhs.lower)
+            {
+                return T(-1);
+            }
+            if (lhs.lower > rhs.upper)
+            {
+                return T(1);
+            }
+            return {
+                (lhs.lower >= rhs.upper) ? T(0) : T(-1),
+                (lhs.upper <= rhs.lower) ? T(0) : T(1)
+            };
+        }
+
+        case infix_t::AND:
+            return truth<T>(is_true(lhs) && is_true(rhs),
+                            is_false(lhs) || is_false(rhs));
+        case infix_t::OR:
+            return truth<T>(is_true(lhs) || is_true(rhs),
+                            is_false(lhs) && is_false(rhs));
+        case infix_t::XOR:
+            return truth<T>((is_true(lhs) && is_false(rhs)) || (is_false(lhs) && is_true(rhs)),
+                            (is_true(lhs) && is_true(rhs)) || (is_false(lhs) && is_false(rhs)));
+
+        case infix_t::IDIV:
+        {
+            const interval<T> dividend = details::truncate(lhs);
+            const interval<T> divisor = details::truncate(rhs);
+            if (divisor.contains(T(0)))
+            {
+                return interval<T>::whole();
+            }
+            return details::truncate(dividend / divisor);
+        }
+
+        case infix_t::MOD:
+        {
+            if (lhs.is_single() && rhs.is_single())
+            {
+                return operation(oper, lhs.lower, rhs.lower);
+            }
+            const interval<T> dividend = details::truncate(lhs);
+            const interval<T> divisor = details::truncate(rhs);
+            if (divisor.contains(T(0)))
+            {
+                return interval<T>::whole();
+            }
+            // The remainder is smaller than the divisor and
+            // has the sign of the dividend
+            const T bound = std::max(-divisor.lower, divisor.upper) - T(1);
+            return {
+                (dividend.lower < T(0)) ? std::max(-bound, dividend.lower) : T(0),
+                (dividend.upper > T(0)) ? std::min(bound, dividend.upper) : T(0)
+            };
+        }
+
+        case infix_t::BAND:
+        case infix_t::BXOR:
+        case infix_t::BOR:
+        case infix_t::LSHIFT:
+        case infix_t::RSHIFT:
+        {
+            if (lhs.is_single() && rhs.is_single())
+            {
+                return operation(oper, lhs.lower, rhs.lower);
+            }
+            return interval<T>::whole();
+        }
+    }
+
+    details::unknown_operator(oper);
+}
+
+template<typename T>
+auto operation(prefix_t oper, const interval<T>& arg)
+    -> interval<T>
+{
+    switch (oper)
+    {
+        case prefix_t::USUB:
+            return -arg;
+        case prefix_t::NOT:
+            return details::truth<T>(details::is_false(arg), details::is_true(arg));
+        case prefix_t::BNOT:
+        {
+            // ~x is -x - 1 for integers
+            const interval<T> value = details::truncate(arg);
+            return { -value.upper - T(1), -value.lower - T(1) };
+        }
+    }
+
+    details::unknown_operator(oper);
+}
+
+template<typename T>
+auto operation(postfix_t oper, const interval<T>& arg)
+    -> interval<T>
+{
+    switch (oper)
+    {
+        case postfix_t::FAC:
+        {
+            // The factorial is increasing for natural numbers
+            if (arg.lower >= T(0))
+            {
+                return { operation(oper, arg.lower), operation(oper, arg.upper) };
+            }
+            return interval<T>::whole();
+        }
+    }
+
+    details::unknown_operator(oper);
+}
+
+////////////////////////////////////////////////////////////
+// Display functions
+
+template<typename T>
+auto to_string(const interval<T>& arg)
+    -> std::string
+{
+    return "[" + std::to_string(arg.lower) + ", " + std::to_string(arg.upper) + "]";
+}
+
+template<typename T>
+auto operator<<(std::ostream& stream, const interval<T>& arg)
+    -> std::ostream&
+{
+    return stream << '[' << arg.lower << ", " << arg.upper << ']';
+}
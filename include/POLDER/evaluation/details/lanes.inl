@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+////////////////////////////////////////////////////////////
+// Construction
+
+template<typename T, std::size_t N>
+lanes<T, N>::lanes(T value)
+{
+    for (std::size_t i = 0 ; i < N ; ++i)
+    {
+        values[i] = value;
+    }
+}
+
+////////////////////////////////////////////////////////////
+// Element access
+
+template<typename T, std::size_t N>
+auto lanes<T, N>::operator[](std::size_t index)
+    -> T&
+{
+    return values[index];
+}
+
+template<typename T, std::size_t N>
+auto lanes<T, N>::operator[](std::size_t index) const
+    -> const T&
+{
+    return values[index];
+}
+
+////////////////////////////////////////////////////////////
+// Arithmetic operators
+
+namespace details
+{
+    // Applies func to every lane of the operands; the loop
+    // has a constant trip count and no dependency between
+    // iterations, so that it is vectorized
+    template<typename T, std::size_t N, typename Func>
+    auto map_lanes(const lanes<T, N>& lhs, const lanes<T, N>& rhs, Func func)
+        -> lanes<T, N>
+    {
+        lanes<T, N> res;
+        for (std::size_t i = 0 ; i < N ; ++i)
+        {
+            res.values[i] = func(lhs.values[i], rhs.values[i]);
+        }
+        return res;
+    }
+
+    template<typename T, std::size_t N, typename Func>
+    auto map_lanes(const lanes<T, N>& arg, Func func)
+        -> lanes<T, N>
+    {
+        lanes<T, N> res;
+        for (std::size_t i = 0 ; i < N ; ++i)
+        {
+            res.values[i] = func(arg.values[i]);
+        }
+        return res;
+    }
+}
+
+template<typename T, std::size_t N>
+auto operator+(const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+    -> lanes<T, N>
+{
+    return details::map_lanes(lhs, rhs, [](T x, T y) { return x + y; });
+}
+
+template<typename T, std::size_t N>
+auto operator-(const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+    -> lanes<T, N>
+{
+    return details::map_lanes(lhs, rhs, [](T x, T y) { return x - y; });
+}
+
+template<typename T, std::size_t N>
+auto operator*(const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+    -> lanes<T, N>
+{
+    return details::map_lanes(lhs, rhs, [](T x, T y) { return x * y; });
+}
+
+template<typename T, std::size_t N>
+auto operator/(const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+    -> lanes<T, N>
+{
+    return details::map_lanes(lhs, rhs, [](T x, T y) { return x / y; });
+}
+
+template<typename T, std::size_t N>
+auto operator-(const lanes<T, N>& arg)
+    -> lanes<T, N>
+{
+    return details::map_lanes(arg, [](T x) { return -x; });
+}
+
+////////////////////////////////////////////////////////////
+// Comparison operators
+
+template<typename T, std::size_t N>
+auto operator==(const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+    -> bool
+{
+    for (std::size_t i = 0 ; i < N ; ++i)
+    {
+        if (lhs.values[i] != rhs.values[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T, std::size_t N>
+auto operator!=(const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+    -> bool
+{
+    return not (lhs == rhs);
+}
+
+////////////////////////////////////////////////////////////
+// Operations of the evaluator
+
+template<typename T, std::size_t N>
+auto operation(infix_t oper, const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+    -> lanes<T, N>
+{
+    // The operator is dispatched once for all the lanes
+    switch (oper)
+    {
+        case infix_t::ADD:  return lhs + rhs;
+        case infix_t::SUB:  return lhs - rhs;
+        case infix_t::MUL:  return lhs * rhs;
+        case infix_t::DIV:  return lhs / rhs;
+        case infix_t::LT:
+            return details::map_lanes(lhs, rhs, [](T x, T y) { return T(x < y); });
+        case infix_t::GT:
+            return details::map_lanes(lhs, rhs, [](T x, T y) { return T(x > y); });
+        case infix_t::LE:
+            return details::map_lanes(lhs, rhs, [](T x, T y) { return T(x <= y); });
+        case infix_t::GE:
+            return details::map_lanes(lhs, rhs, [](T x, T y) { return T(x >= y); });
+        case infix_t::EQ:
+            return details::map_lanes(lhs, rhs, [](T x, T y) { return T(x == y); });
+        case infix_t::NE:
+            return details::map_lanes(lhs, rhs, [](T x, T y) { return T(x != y); });
+        default:
+            return details::map_lanes(lhs, rhs, [oper](T x, T y) {
+                return operation(oper, x, y);
+            });
+    }
+}
+
+template<typename T, std::size_t N>
+auto operation(prefix_t oper, const lanes<T, N>& arg)
+    -> lanes<T, N>
+{
+    if (oper == prefix_t::USUB)
+    {
+        return -arg;
+    }
+    return details::map_lanes(arg, [oper](T x) {
+        return operation(oper, x);
+    });
+}
+
+template<typename T, std::size_t N>
+auto operation(postfix_t oper, const lanes<T, N>& arg)
+    -> lanes<T, N>
+{
+    return details::map_lanes(arg, [oper](T x) {
+        return operation(oper, x);
+    });
+}
+
+namespace details
+{
+    template<std::size_t, typename T>
+    using repeat_type = T;
+
+    template<typename Func, typename T, std::size_t N, typename Indices>
+    struct lanewise_function;
+
+    template<typename Func, typename T, std::size_t N, std::size_t... Ind>
+    struct lanewise_function<Func, T, N, std::index_sequence<Ind...>>
+    {
+        // One parameter per parameter of func, so that the
+        // arity of the function is known to the callbacks
+        auto operator()(repeat_type<Ind, lanes<T, N>>... args) const
+            -> lanes<T, N>
+        {
+            lanes<T, N> res;
+            for (std::size_t i = 0 ; i < N ; ++i)
+            {
+                res.values[i] = func(args.values[i]...);
+            }
+            return res;
+        }
+
+        Func func;
+    };
+}
+
+template<std::size_t N, typename Func>
+auto lanewise(Func&& func)
+{
+    using function_type = std::decay_t<Func>;
+    using value_type = std::decay_t<polder::result_type<function_type>>;
+    return details::lanewise_function<
+        function_type, value_type, N,
+        std::make_index_sequence<polder::arity<function_type>>
+    >{ std::forward<Func>(func) };
+}
+
+////////////////////////////////////////////////////////////
+// Display functions
+
+template<typename T, std::size_t N>
+auto to_string(const lanes<T, N>& arg)
+    -> std::string
+{
+    std::string res = "{";
+    for (std::size_t i = 0 ; i < N ; ++i)
+    {
+        if (i)
+        {
+            res += ", ";
+        }
+        res += std::to_string(arg.values[i]);
+    }
+    return res += "}";
+}
+
+template<typename T, std::size_t N>
+auto operator<<(std::ostream& stream, const lanes<T, N>& arg)
+    -> std::ostream&
+{
+    stream << '{';
+    for (std::size_t i = 0 ; i < N ; ++i)
+    {
+        if (i)
+        {
+            stream << ", ";
+        }
+        stream << arg.values[i];
+    }
+    return stream << '}';
+}
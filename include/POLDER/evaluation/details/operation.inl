@@ -16,37 +16,14 @@
  * see <http://www.gnu.org/licenses/>.
  */
 
-template<typename Number>
-auto operation(infix_t oper, Number lhs, Number rhs)
-    -> Number
+namespace details
 {
-    static const std::unordered_map<infix_t, Number(*)(Number, Number), enum_hash<infix_t>> operations = {
-        { infix_t::ADD,    [](Number a, Number b) -> Number { return a + b; } },
-        { infix_t::SUB,    [](Number a, Number b) -> Number { return a - b; } },
-        { infix_t::MUL,    [](Number a, Number b) -> Number { return a * b; } },
-        { infix_t::LT,     [](Number a, Number b) -> Number { return a < b; } },
-        { infix_t::GT,     [](Number a, Number b) -> Number { return a > b; } },
-        { infix_t::DIV,    [](Number a, Number b) -> Number { return a / b; } },
-        { infix_t::IDIV,   [](Number a, Number b) -> Number { return (std::intmax_t) a / (std::intmax_t) b; } },
-        { infix_t::MOD,    [](Number a, Number b) -> Number { return (std::intmax_t) a % (std::intmax_t) b; } },
-        { infix_t::BAND,   [](Number a, Number b) -> Number { return (std::intmax_t) a & (std::intmax_t) b; } },
-        { infix_t::BXOR,   [](Number a, Number b) -> Number { return (std::intmax_t) a ^ (std::intmax_t) b; } },
-        { infix_t::BOR,    [](Number a, Number b) -> Number { return (std::intmax_t) a | (std::intmax_t) b; } },
-        { infix_t::EQ,     [](Number a, Number b) -> Number { return a == b; } },
-        { infix_t::NE,     [](Number a, Number b) -> Number { return a != b; } },
-        { infix_t::GE,     [](Number a, Number b) -> Number { return a >= b; } },
-        { infix_t::LE,     [](Number a, Number b) -> Number { return a <= b; } },
-        { infix_t::AND,    [](Number a, Number b) -> Number { return a && b; } },
-        { infix_t::XOR,    [](Number a, Number b) -> Number { return (a && !b) || (b && !a); } },
-        { infix_t::OR,     [](Number a, Number b) -> Number { return a || b; } },
-        { infix_t::POW,    [](Number a, Number b) -> Number { return std::pow(a, b); } },
-        { infix_t::SPACE,  [](Number a, Number b) -> Number { return (a < b) ? -1 : (a != b); } },
-        { infix_t::LSHIFT, [](Number a, Number b) -> Number { return (std::intmax_t) a << (std::intmax_t) b; } },
-        { infix_t::RSHIFT, [](Number a, Number b) -> Number { return (std::intmax_t) a >> (std::intmax_t) b; } }
-    };
-
-    auto it = operations.find(oper);
-    if (it == operations.end())
+    // Kept out of operation so that it stays small enough
+    // to be inlined where the operator is known
+    template<typename Operator>
+    [[noreturn]]
+    auto unknown_operator(Operator oper)
+        -> void
     {
         std::stringstream sstr;
         sstr << "unknown operator in the expression: "
@@ -54,47 +31,136 @@ auto operation(infix_t oper, Number lhs, Number rhs)
 
         throw error(error_type::unknown_operator, sstr.str());
     }
-    return it->second(lhs, rhs);
 }
 
 template<typename Number>
-auto operation(prefix_t oper, Number arg)
+auto operation(infix_t oper, Number lhs, Number rhs)
     -> Number
 {
-    static const std::unordered_map<prefix_t, Number(*)(Number), enum_hash<prefix_t>> operations = {
-        { prefix_t::USUB,  [](Number a) -> Number { return -a; } },
-        { prefix_t::NOT,   [](Number a) -> Number { return !a; } },
-        { prefix_t::BNOT,  [](Number a) -> Number { return ~ (std::intmax_t) a; } }
-    };
-
-    auto it = operations.find(oper);
-    if (it == operations.end())
+    // A switch rather than a lookup table so that the compiler
+    // can inline the operation when oper is known
+    switch (oper)
     {
-        std::stringstream sstr;
-        sstr << "unknown operator in the expression: "
-             << to_string(oper);
+        case infix_t::ADD:      return lhs + rhs;
+        case infix_t::SUB:      return lhs - rhs;
+        case infix_t::MUL:      return lhs * rhs;
+        case infix_t::LT:       return lhs < rhs;
+        case infix_t::GT:       return lhs > rhs;
+        case infix_t::DIV:      return lhs / rhs;
+        case infix_t::IDIV:     return (std::intmax_t) lhs / (std::intmax_t) rhs;
+        case infix_t::MOD:      return (std::intmax_t) lhs % (std::intmax_t) rhs;
+        case infix_t::BAND:     return (std::intmax_t) lhs & (std::intmax_t) rhs;
+        case infix_t::BXOR:     return (std::intmax_t) lhs ^ (std::intmax_t) rhs;
+        case infix_t::BOR:      return (std::intmax_t) lhs | (std::intmax_t) rhs;
+        case infix_t::EQ:       return lhs == rhs;
+        case infix_t::NE:       return lhs != rhs;
+        case infix_t::GE:       return lhs >= rhs;
+        case infix_t::LE:       return lhs <= rhs;
+        case infix_t::AND:      return lhs && rhs;
+        case infix_t::XOR:      return (lhs && !rhs) || (rhs && !lhs);
+        case infix_t::OR:       return lhs || rhs;
+        case infix_t::POW:      return std::pow(lhs, rhs);
+        case infix_t::SPACE:    return (lhs < rhs) ? -1 : (lhs != rhs);
+        case infix_t::LSHIFT:   return (std::intmax_t) lhs << (std::intmax_t) rhs;
+        case infix_t::RSHIFT:   return (std::intmax_t) lhs >> (std::intmax_t) rhs;
+    }
 
-        throw error(error_type::unknown_operator, sstr.str());
+    details::unknown_operator(oper);
+}
+
+template<typename Number>
+auto operation(prefix_t oper, Number arg)
+    -> Number
+{
+    switch (oper)
+    {
+        case prefix_t::USUB:    return -arg;
+        case prefix_t::NOT:     return !arg;
+        case prefix_t::BNOT:    return ~ (std::intmax_t) arg;
     }
-    return it->second(arg);
+
+    details::unknown_operator(oper);
 }
 
 template<typename Number>
 auto operation(postfix_t oper, Number arg)
     -> Number
 {
-    static const std::unordered_map<postfix_t, Number(*)(Number), enum_hash<postfix_t>> operations = {
-        { postfix_t::FAC,    [](Number a) -> Number { return math::factorial((std::uintmax_t) a); } }
-    };
+    switch (oper)
+    {
+        case postfix_t::FAC:    return math::factorial((std::uintmax_t) arg);
+    }
+
+    details::unknown_operator(oper);
+}
 
-    auto it = operations.find(oper);
-    if (it == operations.end())
+////////////////////////////////////////////////////////////
+// Derivatives of the operations
+
+template<typename Number>
+auto derivative(infix_t oper, Number lhs, Number rhs)
+    -> std::pair<Number, Number>
+{
+    switch (oper)
     {
-        std::stringstream sstr;
-        sstr << "unknown operator in the expression: "
-             << to_string(oper);
+        case infix_t::ADD:      return { Number(1), Number(1) };
+        case infix_t::SUB:      return { Number(1), Number(-1) };
+        case infix_t::MUL:      return { rhs, lhs };
+        case infix_t::DIV:      return { Number(1) / rhs, -lhs / (rhs * rhs) };
+        case infix_t::POW:
+        {
+            // The logarithm of lhs is only defined for lhs > 0,
+            // and x**c does not depend on the exponent otherwise
+            const Number dlhs = (rhs == Number(0)) ? Number(0)
+                                                   : rhs * std::pow(lhs, rhs - Number(1));
+            const Number drhs = (lhs > Number(0)) ? std::pow(lhs, rhs) * std::log(lhs)
+                                                  : Number(0);
+            return { dlhs, drhs };
+        }
+        case infix_t::LT:
+        case infix_t::GT:
+        case infix_t::IDIV:
+        case infix_t::MOD:
+        case infix_t::BAND:
+        case infix_t::BXOR:
+        case infix_t::BOR:
+        case infix_t::EQ:
+        case infix_t::NE:
+        case infix_t::GE:
+        case infix_t::LE:
+        case infix_t::AND:
+        case infix_t::XOR:
+        case infix_t::OR:
+        case infix_t::SPACE:
+        case infix_t::LSHIFT:
+        case infix_t::RSHIFT:   return { Number(0), Number(0) };
+    }
 
-        throw error(error_type::unknown_operator, sstr.str());
+    details::unknown_operator(oper);
+}
+
+template<typename Number>
+auto derivative(prefix_t oper, Number)
+    -> Number
+{
+    switch (oper)
+    {
+        case prefix_t::USUB:    return Number(-1);
+        case prefix_t::NOT:
+        case prefix_t::BNOT:    return Number(0);
     }
-    return it->second(arg);
+
+    details::unknown_operator(oper);
+}
+
+template<typename Number>
+auto derivative(postfix_t oper, Number)
+    -> Number
+{
+    switch (oper)
+    {
+        case postfix_t::FAC:    return Number(0);
+    }
+
+    details::unknown_operator(oper);
 }
@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+////////////////////////////////////////////////////////////
+// Construction
+
+template<typename Number>
+shared_evaluator<Number>::shared_evaluator():
+    shared_evaluator(evaluator<Number>{})
+{}
+
+template<typename Number>
+shared_evaluator<Number>::shared_evaluator(const evaluator<Number>& eval):
+    _current(std::make_shared<const evaluator<Number>>(eval)),
+    _published(_current.get()),
+    _epoch(0),
+    _epoch_changed(false),
+    _has_retired(false)
+{}
+
+////////////////////////////////////////////////////////////
+// Readers
+
+template<typename Number>
+auto shared_evaluator<Number>::snapshot() const
+    -> snapshot_type
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _current;
+}
+
+template<typename Number>
+auto shared_evaluator<Number>::evaluate(const std::string& expression) const
+    -> Number
+{
+    return with_snapshot([&](const evaluator<Number>& eval) {
+        return eval.evaluate(expression);
+    });
+}
+
+template<typename Number>
+auto shared_evaluator<Number>::operator()(const std::string& expression) const
+    -> Number
+{
+    return evaluate(expression);
+}
+
+template<typename Number>
+auto shared_evaluator<Number>::compile(const std::string& expression) const
+    -> evaluation::expression<Number>
+{
+    return with_snapshot([&](const evaluator<Number>& eval) {
+        return eval.compile(expression);
+    });
+}
+
+template<typename Number>
+auto shared_evaluator<Number>::compile(const std::string& expression,
+                                       const std::vector<std::string>& variables) const
+    -> evaluation::expression<Number>
+{
+    return with_snapshot([&](const evaluator<Number>& eval) {
+        return eval.compile(expression, variables);
+    });
+}
+
+////////////////////////////////////////////////////////////
+// Writers
+
+template<typename Number>
+template<typename Func>
+auto shared_evaluator<Number>::connect(const std::string& name, Func&& function, bool pure)
+    -> void
+{
+    // The previous function is replaced in the same snapshot
+    // so that the readers never see the name disconnected
+    update([&](evaluator<Number>& eval) {
+        eval.disconnect(name);
+        eval.connect(name, std::forward<Func>(function), pure);
+    });
+}
+
+template<typename Number>
+template<typename... Partials>
+auto shared_evaluator<Number>::connect_derivatives(const std::string& name, Partials&&... partials)
+    -> void
+{
+    update([&](evaluator<Number>& eval) {
+        eval.connect_derivatives(name, std::forward<Partials>(partials)...);
+    });
+}
+
+template<typename Number>
+auto shared_evaluator<Number>::disconnect(const std::string& name)
+    -> void
+{
+    update([&](evaluator<Number>& eval) {
+        eval.disconnect(name);
+    });
+}
+
+template<typename Number>
+auto shared_evaluator<Number>::set_cache_capacity(std::size_t capacity)
+    -> void
+{
+    update([&](evaluator<Number>& eval) {
+        eval.set_cache_capacity(capacity);
+    });
+}
+
+////////////////////////////////////////////////////////////
+// Snapshots
+
+template<typename Number>
+template<typename Function>
+auto shared_evaluator<Number>::with_snapshot(Function func) const
+    -> decltype(func(std::declval<const evaluator<Number>&>()))
+{
+    // Registering before reading the snapshot guarantees that
+    // a writer retiring it afterwards sees this reader
+    const std::size_t epoch = _epoch.load();
+    std::atomic<std::size_t>& count = _readers[epoch & 1][reader_stripe()].count;
+    count.fetch_add(1);
+
+    struct reader_guard
+    {
+        const shared_evaluator& owner;
+        std::atomic<std::size_t>& count;
+
+        ~reader_guard()
+        {
+            count.fetch_sub(1);
+            if (owner._has_retired.load())
+            {
+                owner.reclaim();
+            }
+        }
+    };
+    reader_guard guard{ *this, count };
+    return func(*_published.load());
+}
+
+template<typename Number>
+template<typename Modifier>
+auto shared_evaluator<Number>::update(Modifier modify)
+    -> void
+{
+    // Declared first so that the snapshots are destroyed
+    // once the mutex is unlocked
+    std::list<snapshot_type> garbage;
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Copying an evaluator copies the capacity of its
+    // cache but not the cached expressions
+    auto next = std::make_shared<evaluator<Number>>(*_current);
+    modify(*next);
+    _retired.push_back(_current);
+    _published.store(next.get());
+    _current = std::move(next);
+    _has_retired.store(true);
+
+    collect_retired(garbage);
+}
+
+template<typename Number>
+auto shared_evaluator<Number>::reclaim() const
+    -> void
+{
+    // Called by the readers when they are done: nothing
+    // is allocated, only moved between lists
+    std::list<snapshot_type> garbage;
+    std::lock_guard<std::mutex> lock(_mutex);
+    collect_retired(garbage);
+}
+
+template<typename Number>
+auto shared_evaluator<Number>::collect_retired(std::list<snapshot_type>& garbage) const
+    -> void
+{
+    for (;;)
+    {
+        if (not _epoch_changed)
+        {
+            if (_retired.empty())
+            {
+                break;
+            }
+
+            // The readers still registered in the previous
+            // epoch must be gone before the next one reuses
+            // its counters
+            const std::size_t epoch = _epoch.load();
+            if (has_readers(epoch + 1))
+            {
+                break;
+            }
+            _epoch.store(epoch + 1);
+            _retiring.swap(_retired);
+            _epoch_changed = true;
+        }
+
+        // The new readers register in the new epoch, so the
+        // ones of the previous epoch are eventually gone
+        if (has_readers(_epoch.load() - 1))
+        {
+            break;
+        }
+        garbage.splice(garbage.end(), _retiring);
+        _epoch_changed = false;
+    }
+    _has_retired.store(not _retired.empty() || not _retiring.empty());
+}
+
+template<typename Number>
+auto shared_evaluator<Number>::has_readers(std::size_t epoch) const
+    -> bool
+{
+    // Every counter only counts its own readers, so a reader
+    // registered before the loop is seen unless it is gone
+    for (const auto& reader: _readers[epoch & 1])
+    {
+        if (reader.count.load() != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename Number>
+auto shared_evaluator<Number>::reader_stripe()
+    -> std::size_t
+{
+    static std::atomic<std::size_t> next_stripe(0);
+    thread_local std::size_t stripe = next_stripe++ % nb_stripes;
+    return stripe;
+}
@@ -16,6 +16,52 @@
  * see <http://www.gnu.org/licenses/>.
  */
 
+////////////////////////////////////////////////////////////
+// Names
+
+inline auto name_view::str() const
+    -> std::string
+{
+    return std::string(data, size);
+}
+
+inline auto operator==(name_view lhs, const std::string& rhs)
+    -> bool
+{
+    return lhs.size == rhs.size()
+        && std::memcmp(lhs.data, rhs.data(), lhs.size) == 0;
+}
+
+inline auto operator==(const std::string& lhs, name_view rhs)
+    -> bool
+{
+    return rhs == lhs;
+}
+
+inline auto operator<(name_view lhs, const std::string& rhs)
+    -> bool
+{
+    return rhs.compare(0, rhs.size(), lhs.data, lhs.size) > 0;
+}
+
+inline auto operator<(const std::string& lhs, name_view rhs)
+    -> bool
+{
+    return lhs.compare(0, lhs.size(), rhs.data, rhs.size) < 0;
+}
+
+inline auto operator+(const std::string& lhs, name_view rhs)
+    -> std::string
+{
+    return std::string(lhs).append(rhs.data, rhs.size);
+}
+
+inline auto operator<<(std::ostream& stream, name_view name)
+    -> std::ostream&
+{
+    return stream.write(name.data, name.size);
+}
+
 ////////////////////////////////////////////////////////////
 // Construction and destruction
 
@@ -29,7 +75,7 @@ token<Number>::token(const token& other):
             data = other.data;
             break;
         case token_t::name:
-            new (&name) std::string;
+        case token_t::variable:
             name = other.name;
             break;
         case token_t::infix:
@@ -51,12 +97,7 @@ token<Number>::token(const token& other):
 template<typename Number>
 token<Number>::token(token_t type):
     type(type)
-{
-    if (type == token_t::name)
-    {
-        new (&name) std::string;
-    }
-}
+{}
 
 template<typename Number>
 token<Number>::token(Number num):
@@ -65,12 +106,10 @@ token<Number>::token(Number num):
 {}
 
 template<typename Number>
-token<Number>::token(std::string name):
-    type(token_t::name)
-{
-    new (&this->name) std::string;
-    this->name = std::move(name);
-}
+token<Number>::token(name_view name, token_t type):
+    type(type),
+    name(name)
+{}
 
 template<typename Number>
 token<Number>::token(infix_t oper):
@@ -92,12 +131,7 @@ token<Number>::token(postfix_t oper):
 
 template<typename Number>
 token<Number>::~token()
-{
-    if (type == token_t::name)
-    {
-        name.~basic_string();
-    }
-}
+{}
 
 ////////////////////////////////////////////////////////////
 // Helper functions
@@ -116,6 +150,13 @@ auto token<Number>::is_name() const
     return type == token_t::name;
 }
 
+template<typename Number>
+auto token<Number>::is_variable() const
+    -> bool
+{
+    return type == token_t::variable;
+}
+
 template<typename Number>
 auto token<Number>::is_infix() const
     -> bool
@@ -165,12 +206,17 @@ template<typename Number>
 auto to_string(const token<Number>& tok)
     -> std::string
 {
+    // The number types of the evaluation provide
+    // their own to_string, found by ADL
+    using std::to_string;
+
     switch (tok.type)
     {
         case token_t::operand:
-            return std::to_string(tok.data);
+            return to_string(tok.data);
         case token_t::name:
-            return tok.name;
+        case token_t::variable:
+            return tok.name.str();
         case token_t::infix:
             return to_string(tok.infix);
         case token_t::prefix:
@@ -199,6 +245,7 @@ auto operator<<(std::ostream& stream, const token<Number>& tok)
             stream << tok.data;
             break;
         case token_t::name:
+        case token_t::variable:
             stream << tok.name;
             break;
         case token_t::infix:
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_EVALUATION_DIFFERENTIATION_H_
+#define POLDER_EVALUATION_DIFFERENTIATION_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+#include <POLDER/details/config.h>
+#include <POLDER/evaluation/callback.h>
+#include <POLDER/evaluation/error.h>
+#include <POLDER/evaluation/expression.h>
+#include <POLDER/evaluation/operation.h>
+#include <POLDER/evaluation/operator.h>
+
+namespace polder
+{
+namespace evaluation
+{
+    /**
+     * Dual number: a value and its derivative in a given
+     * direction. The operations on dual numbers propagate
+     * the derivatives with the chain rule.
+     */
+    template<typename Number>
+    struct dual
+    {
+        Number value;
+        Number derivative;
+    };
+
+    template<typename Number>
+    auto operation(infix_t oper, dual<Number> lhs, dual<Number> rhs)
+        -> dual<Number>;
+
+    template<typename Number>
+    auto operation(prefix_t oper, dual<Number> arg)
+        -> dual<Number>;
+
+    template<typename Number>
+    auto operation(postfix_t oper, dual<Number> arg)
+        -> dual<Number>;
+
+    ////////////////////////////////////////////////////////////
+    // Differentiation of compiled expressions
+
+    // The functions called by the differentiated expressions
+    // need partial derivatives, see evaluator::connect_derivatives
+
+    /**
+     * @brief Forward-mode differentiation.
+     *
+     * Evaluates the expression with dual numbers and returns
+     * its value for the given variables along with its
+     * derivative in the given direction, which holds one
+     * element per variable: the i-th unit vector gives the
+     * partial derivative with respect to the i-th variable.
+     */
+    template<typename Number>
+    auto differentiate(const expression<Number>& expr,
+                       const Number* variables, std::size_t size,
+                       const Number* direction)
+        -> dual<Number>;
+
+    /**
+     * @brief Reverse-mode differentiation.
+     *
+     * Returns the value of the expression for the given
+     * variables and writes its gradient to res, which holds
+     * one element per variable. The program is run once
+     * while recording the partial derivatives of every
+     * instruction, then swept once in reverse order: the
+     * cost does not depend on the number of variables.
+     */
+    template<typename Number>
+    auto gradient(const expression<Number>& expr,
+                  const Number* variables, std::size_t size,
+                  Number* res)
+        -> Number;
+    template<typename Number>
+    auto gradient(const expression<Number>& expr,
+                  std::initializer_list<Number> variables,
+                  Number* res)
+        -> Number;
+
+    #include "details/differentiation.inl"
+}}
+
+#endif // POLDER_EVALUATION_DIFFERENTIATION_H_
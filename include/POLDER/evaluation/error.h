@@ -45,7 +45,9 @@ namespace evaluation
         several_dots,
         stray_comma,
         closed_parenthesis,
-        mismatched_parenthesis
+        mismatched_parenthesis,
+        unknown_name,
+        unknown_derivative
     };
 
     /**
@@ -22,14 +22,17 @@
 // Headers
 ////////////////////////////////////////////////////////////
 #include <cstddef>
+#include <functional>
+#include <map>
 #include <sstream>
-#include <stack>
 #include <string>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 #include <POLDER/details/config.h>
+#include <POLDER/evaluation/cache.h>
 #include <POLDER/evaluation/callback.h>
 #include <POLDER/evaluation/error.h>
+#include <POLDER/evaluation/expression.h>
 #include <POLDER/evaluation/functions.h>
 #include <POLDER/evaluation/token.h>
 
@@ -52,6 +55,10 @@ namespace evaluation
 
             /**
              * @brief Evaluate a mathematical expression.
+             *
+             * When the cache is enabled, the expression is compiled
+             * the first time it is evaluated and the compiled
+             * expression is reused for the same string afterwards.
              */
             auto evaluate(const std::string& expression) const
                 -> Number;
@@ -62,14 +69,52 @@ namespace evaluation
             auto operator()(const std::string& expression) const
                 -> Number;
 
+            /**
+             * @brief Compile a mathematical expression.
+             *
+             * Parse the expression once and resolve the functions
+             * it calls so that the result can be evaluated many
+             * times without parsing it again. The errors that
+             * evaluate would report are reported by compile.
+             */
+            auto compile(const std::string& expression) const
+                -> evaluation::expression<Number>;
+
+            /**
+             * @brief Compile an expression with variables.
+             *
+             * Every name of the expression which is not followed
+             * by a parenthesis is a variable, and is resolved to
+             * its position in variables: it is the index of its
+             * value in the array given to expression::evaluate.
+             */
+            auto compile(const std::string& expression,
+                         const std::vector<std::string>& variables) const
+                -> evaluation::expression<Number>;
+
             /**
              * @brief Register a function.
              *
              * Register a function that will be called when the given
-             * name is used in the mathematical expression.
+             * name is used in the mathematical expression. The calls
+             * to a pure function with constant parameters are folded
+             * by compile.
              */
             template<typename Func>
-            auto connect(const std::string& name, Func&& function)
+            auto connect(const std::string& name, Func&& function, bool pure=false)
+                -> void;
+
+            /**
+             * @brief Register the derivatives of a function.
+             *
+             * Register the partial derivatives of a connected
+             * function so that the expressions calling it can
+             * be differentiated: there is one per parameter of
+             * the function, and every one of them takes the same
+             * parameters as the function.
+             */
+            template<typename... Partials>
+            auto connect_derivatives(const std::string& name, Partials&&... partials)
                 -> void;
 
             /**
@@ -78,12 +123,48 @@ namespace evaluation
             auto disconnect(const std::string& name)
                 -> void;
 
+            ////////////////////////////////////////////////////////////
+            // Cache of compiled expressions
+
+            /**
+             * @brief Set the number of expressions to cache.
+             *
+             * The cache keeps the last expressions evaluated by
+             * evaluate and is disabled when capacity is 0, which
+             * is the default. It is safe to evaluate expressions
+             * from several threads while the cache is enabled.
+             * Connecting or disconnecting a function removes the
+             * cached expressions which call it.
+             */
+            auto set_cache_capacity(std::size_t capacity)
+                -> void;
+
+            auto cache_capacity() const
+                -> std::size_t;
+
+            // Number of cached expressions
+            auto cache_size() const
+                -> std::size_t;
+
+            auto cache_hits() const
+                -> std::size_t;
+
+            auto cache_misses() const
+                -> std::size_t;
+
+            auto clear_cache()
+                -> void;
+
         private:
 
-            auto eval_postfix(std::stack<token<Number>>&& tokens) const
+            auto eval_tokens(const std::vector<token<Number>>& tokens) const
                 -> Number;
 
-            std::unordered_map<std::string, callback<Number>> callbacks;
+            // Transparent comparison: the names of the tokens
+            // are looked up without being copied to strings
+            std::map<std::string, callback<Number>, std::less<>> callbacks;
+
+            mutable expression_cache<Number> cache;
     };
 
     #include "details/evaluator.inl"
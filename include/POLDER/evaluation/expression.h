@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_EVALUATION_EXPRESSION_H_
+#define POLDER_EVALUATION_EXPRESSION_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+#include <POLDER/execution.h>
+#include <POLDER/details/config.h>
+#include <POLDER/evaluation/callback.h>
+#include <POLDER/evaluation/error.h>
+#include <POLDER/evaluation/functions.h>
+#include <POLDER/evaluation/operation.h>
+#include <POLDER/evaluation/operator.h>
+#include <POLDER/evaluation/token.h>
+
+namespace polder
+{
+namespace evaluation
+{
+    template<typename Number>
+    class evaluator;
+
+    /**
+     * Operation codes of a compiled expression.
+     */
+    enum struct opcode:
+        std::uint_fast8_t
+    {
+        constant,   // Push a constant
+        infix,      // Apply an infix operator
+        prefix,     // Apply a prefix operator
+        postfix,    // Apply a postfix operator
+        call,       // Call a function
+        variable,   // Push the value of a variable
+        duplicate   // Push a copy of the top operand
+    };
+
+    /**
+     * Instruction of a compiled expression. The operator
+     * is only meaningful for the operator opcodes, and the
+     * index is the one of the constant, of the function or
+     * of the variable for the other ones.
+     */
+    struct instruction
+    {
+        ////////////////////////////////////////////////////////////
+        // Construction
+
+        instruction(opcode code, std::size_t index);
+
+        explicit instruction(infix_t oper);
+        explicit instruction(prefix_t oper);
+        explicit instruction(postfix_t oper);
+
+        ////////////////////////////////////////////////////////////
+        // Member data
+
+        opcode code;
+
+        union
+        {
+            infix_t infix;
+            prefix_t prefix;
+            postfix_t postfix;
+        };
+
+        std::uint32_t index;
+    };
+
+    /**
+     * @brief Compiled mathematical expression.
+     *
+     * An expression is the result of evaluator::compile: the
+     * expression string is parsed once and for all into a flat
+     * array of instructions in postfix order, where the numbers
+     * are stored apart and the functions are resolved to indices
+     * in a table of callbacks. Evaluating it again and again
+     * does not parse or allocate anything.
+     *
+     * The program is simplified during the compilation: the
+     * operations whose operands are all constants, including
+     * the calls to pure functions, are replaced by their result,
+     * the operations x*1, 1*x, x+0, 0+x, x-0, x/1 and x**1 are
+     * replaced by x, and x**2 is computed as x*x unless
+     * is_square_product<Number> is false.
+     *
+     * The variables of the expression are resolved to slots
+     * during the compilation: their values are read from an
+     * array given at evaluation time, so that the expression
+     * can be evaluated for many different values.
+     *
+     * An expression keeps its own copy of the callbacks it uses:
+     * it remains valid after the evaluator which compiled it is
+     * modified or destroyed. Since it is immutable, it can be
+     * evaluated concurrently from several threads, provided that
+     * the connected functions can.
+     */
+    template<typename Number>
+    class expression
+    {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Evaluation
+
+            /**
+             * @brief Evaluate the compiled expression.
+             *
+             * The operands are kept on the stack of the calling
+             * thread, unless the expression is deeper than
+             * small_stack_size, in which case a stack is allocated
+             * for the evaluation.
+             */
+            auto evaluate() const
+                -> Number;
+
+            /**
+             * @brief Evaluate the expression with variables.
+             *
+             * variables[i] is the value of the i-th variable
+             * given to evaluator::compile, and size shall not be
+             * less than the number of variables.
+             */
+            auto evaluate(const Number* variables, std::size_t size) const
+                -> Number;
+            auto evaluate(std::initializer_list<Number> variables) const
+                -> Number;
+
+            /**
+             * @brief Evaluate the expression with a given stack.
+             *
+             * The operands are kept in stack, which is grown to
+             * max_depth() elements if needed. Evaluating deep
+             * expressions again and again with the same stack
+             * thus only allocates the first time.
+             */
+            auto evaluate(const Number* variables, std::size_t size,
+                          std::vector<Number>& stack) const
+                -> Number;
+
+            /**
+             * @brief Calls evaluate.
+             */
+            auto operator()() const
+                -> Number;
+            auto operator()(const Number* variables, std::size_t size) const
+                -> Number;
+            auto operator()(std::initializer_list<Number> variables) const
+                -> Number;
+
+            /**
+             * @brief Evaluate the expression over columns of values.
+             *
+             * columns[i] points to the values of the i-th variable,
+             * and res[j] receives the value of the expression for
+             * the values columns[i][j], for every j < size.
+             *
+             * The rows are split in blocks, and every instruction
+             * is run over a whole block of rows before the next
+             * one: the operators are thus dispatched once per block
+             * instead of once per row, and applied by loops that
+             * the compiler can vectorize. The blocks are evaluated
+             * in parallel with a parallel policy.
+             */
+            auto evaluate_columns(const Number* const* columns, std::size_t size,
+                                  Number* res) const
+                -> void;
+            template<typename ExecutionPolicy>
+            auto evaluate_columns(ExecutionPolicy&& policy,
+                                  const Number* const* columns, std::size_t size,
+                                  Number* res) const
+                -> void;
+
+            ////////////////////////////////////////////////////////////
+            // Program inspection
+
+            auto instructions() const
+                -> const std::vector<instruction>&;
+
+            auto constants() const
+                -> const std::vector<Number>&;
+
+            auto functions() const
+                -> const std::vector<callback<Number>>&;
+
+            // Names of the functions, in the same order
+            auto function_names() const
+                -> const std::vector<std::string>&;
+
+            // Names of the variables, in slot order
+            auto variable_names() const
+                -> const std::vector<std::string>&;
+
+            /**
+             * @brief Maximal number of operands alive at once.
+             */
+            auto max_depth() const
+                -> std::size_t;
+
+            // Depth up to which evaluate does not allocate
+            static constexpr std::size_t small_stack_size = 32;
+
+        private:
+
+            friend class evaluator<Number>;
+
+            expression(const std::vector<token<Number>>& tokens,
+                       const std::map<std::string, callback<Number>, std::less<>>& callbacks,
+                       std::vector<std::string> variables);
+
+            auto optimize()
+                -> void;
+
+            auto run(Number* stack, const Number* variables) const
+                -> Number;
+
+            auto run_block(Number* stack, Number* params,
+                           const Number* const* columns,
+                           std::size_t begin, std::size_t count) const
+                -> const Number*;
+
+            std::vector<instruction> _code;
+            std::vector<Number> _constants;
+            std::vector<callback<Number>> _functions;
+            std::vector<std::string> _function_names;
+            std::vector<std::string> _variable_names;
+            std::size_t _max_depth;
+    };
+
+    #include "details/expression.inl"
+}}
+
+#endif // POLDER_EVALUATION_EXPRESSION_H_
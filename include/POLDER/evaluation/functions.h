@@ -22,26 +22,42 @@
 // Headers
 ////////////////////////////////////////////////////////////
 #include <cctype>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
-#include <stack>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include <POLDER/details/config.h>
 #include <POLDER/evaluation/error.h>
+#include <POLDER/evaluation/operator.h>
 #include <POLDER/evaluation/token.h>
 
 namespace polder
 {
 namespace evaluation
 {
+    /**
+     * Splits an expression into tokens. The numbers are parsed
+     * in place and the names refer to the expression string,
+     * which thus has to outlive the tokens: no token allocates.
+     */
     template<typename Number>
     auto tokenize(const std::string& expr)
         -> std::vector<token<Number>>;
 
-    template<typename Number>
-    auto to_postfix(const std::vector<token<Number>>& tokens)
-        -> std::stack<token<Number>>;
+    /**
+     * Parses the tokens in a single pass and passes every one
+     * of them but the parenthesis and commas to handler in
+     * postfix order: the operators and the function calls
+     * come after their operands. The tokens are passed by
+     * reference and the parser does not allocate.
+     */
+    template<typename Number, typename Handler>
+    auto parse(const std::vector<token<Number>>& tokens, Handler&& handler)
+        -> void;
 
     #include "details/functions.inl"
 }}
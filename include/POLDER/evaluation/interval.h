@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_EVALUATION_INTERVAL_H_
+#define POLDER_EVALUATION_INTERVAL_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <POLDER/details/config.h>
+#include <POLDER/evaluation/operation.h>
+#include <POLDER/evaluation/operator.h>
+
+namespace polder
+{
+namespace evaluation
+{
+    /**
+     * @brief Closed interval of numbers.
+     *
+     * An interval usable as the Number type of an evaluator
+     * for range analysis: evaluating an expression with
+     * intervals of values for its variables gives an interval
+     * which contains every value the expression can take.
+     *
+     * The result may be wider than the actual range since
+     * the occurrences of a variable are independent: x - x
+     * is not [0, 0]. The bounds are computed with the current
+     * rounding mode, without outward rounding. A comparison or
+     * a logical operator gives [0, 1] when its result depends
+     * on the values in the intervals, and the bitwise operators
+     * give the whole real line unless their operands are single
+     * numbers.
+     */
+    template<typename T>
+    struct interval
+    {
+        ////////////////////////////////////////////////////////////
+        // Construction
+
+        interval() = default;
+
+        // Interval holding a single number
+        interval(T value);
+
+        interval(T lower, T upper);
+
+        // Interval holding every number
+        static auto whole()
+            -> interval;
+
+        ////////////////////////////////////////////////////////////
+        // Observers
+
+        auto contains(T value) const
+            -> bool;
+
+        auto is_single() const
+            -> bool;
+
+        ////////////////////////////////////////////////////////////
+        // Member data
+
+        T lower;
+        T upper;
+    };
+
+    // x * x is wider than x**2 when x contains 0
+    template<typename T>
+    struct is_square_product<interval<T>>:
+        std::false_type
+    {};
+
+    ////////////////////////////////////////////////////////////
+    // Arithmetic operators
+
+    template<typename T>
+    auto operator+(const interval<T>& lhs, const interval<T>& rhs)
+        -> interval<T>;
+
+    template<typename T>
+    auto operator-(const interval<T>& lhs, const interval<T>& rhs)
+        -> interval<T>;
+
+    template<typename T>
+    auto operator*(const interval<T>& lhs, const interval<T>& rhs)
+        -> interval<T>;
+
+    template<typename T>
+    auto operator/(const interval<T>& lhs, const interval<T>& rhs)
+        -> interval<T>;
+
+    template<typename T>
+    auto operator-(const interval<T>& arg)
+        -> interval<T>;
+
+    template<typename T>
+    auto pow(const interval<T>& lhs, const interval<T>& rhs)
+        -> interval<T>;
+
+    ////////////////////////////////////////////////////////////
+    // Comparison operators
+
+    // Two intervals are equal when they have the same bounds
+    template<typename T>
+    auto operator==(const interval<T>& lhs, const interval<T>& rhs)
+        -> bool;
+
+    template<typename T>
+    auto operator!=(const interval<T>& lhs, const interval<T>& rhs)
+        -> bool;
+
+    ////////////////////////////////////////////////////////////
+    // Operations of the evaluator
+
+    template<typename T>
+    auto operation(infix_t oper, const interval<T>& lhs, const interval<T>& rhs)
+        -> interval<T>;
+
+    template<typename T>
+    auto operation(prefix_t oper, const interval<T>& arg)
+        -> interval<T>;
+
+    template<typename T>
+    auto operation(postfix_t oper, const interval<T>& arg)
+        -> interval<T>;
+
+    ////////////////////////////////////////////////////////////
+    // Display functions
+
+    template<typename T>
+    auto to_string(const interval<T>& arg)
+        -> std::string;
+
+    template<typename T>
+    auto operator<<(std::ostream& stream, const interval<T>& arg)
+        -> std::ostream&;
+
+    #include "details/interval.inl"
+}}
+
+#endif // POLDER_EVALUATION_INTERVAL_H_
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_EVALUATION_LANES_H_
+#define POLDER_EVALUATION_LANES_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <POLDER/details/config.h>
+#include <POLDER/evaluation/operation.h>
+#include <POLDER/evaluation/operator.h>
+#include <POLDER/type_traits.h>
+
+namespace polder
+{
+namespace evaluation
+{
+    /**
+     * @brief Fixed-width pack of numbers.
+     *
+     * A pack of N numbers usable as the Number type of an
+     * evaluator: evaluating an expression of lanes evaluates
+     * it for N inputs at once, and every instruction of the
+     * program is dispatched once for the N lanes. The
+     * arithmetic operations are loops over the lanes that
+     * the compiler turns into SIMD instructions; the other
+     * operators are applied lane by lane.
+     *
+     * A number converts to a pack where every lane holds it,
+     * so that the constants of the expressions are broadcast.
+     * Two packs compare equal when all of their lanes do.
+     */
+    template<typename T, std::size_t N>
+    struct lanes
+    {
+        ////////////////////////////////////////////////////////////
+        // Construction
+
+        lanes() = default;
+
+        // Broadcast the value to every lane
+        lanes(T value);
+
+        ////////////////////////////////////////////////////////////
+        // Element access
+
+        auto operator[](std::size_t index)
+            -> T&;
+        auto operator[](std::size_t index) const
+            -> const T&;
+
+        static constexpr auto size()
+            -> std::size_t
+        {
+            return N;
+        }
+
+        ////////////////////////////////////////////////////////////
+        // Member data
+
+        T values[N];
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Arithmetic operators
+
+    template<typename T, std::size_t N>
+    auto operator+(const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+        -> lanes<T, N>;
+
+    template<typename T, std::size_t N>
+    auto operator-(const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+        -> lanes<T, N>;
+
+    template<typename T, std::size_t N>
+    auto operator*(const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+        -> lanes<T, N>;
+
+    template<typename T, std::size_t N>
+    auto operator/(const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+        -> lanes<T, N>;
+
+    template<typename T, std::size_t N>
+    auto operator-(const lanes<T, N>& arg)
+        -> lanes<T, N>;
+
+    ////////////////////////////////////////////////////////////
+    // Comparison operators
+
+    template<typename T, std::size_t N>
+    auto operator==(const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+        -> bool;
+
+    template<typename T, std::size_t N>
+    auto operator!=(const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+        -> bool;
+
+    ////////////////////////////////////////////////////////////
+    // Operations of the evaluator
+
+    template<typename T, std::size_t N>
+    auto operation(infix_t oper, const lanes<T, N>& lhs, const lanes<T, N>& rhs)
+        -> lanes<T, N>;
+
+    template<typename T, std::size_t N>
+    auto operation(prefix_t oper, const lanes<T, N>& arg)
+        -> lanes<T, N>;
+
+    template<typename T, std::size_t N>
+    auto operation(postfix_t oper, const lanes<T, N>& arg)
+        -> lanes<T, N>;
+
+    /**
+     * @brief Apply a function lane by lane.
+     *
+     * Turns a function of numbers of type T into a function
+     * of lanes<T, N> which calls it once per lane, so that
+     * the scalar functions can be connected to an evaluator
+     * of lanes.
+     */
+    template<std::size_t N, typename Func>
+    auto lanewise(Func&& func);
+
+    ////////////////////////////////////////////////////////////
+    // Display functions
+
+    template<typename T, std::size_t N>
+    auto to_string(const lanes<T, N>& arg)
+        -> std::string;
+
+    template<typename T, std::size_t N>
+    auto operator<<(std::ostream& stream, const lanes<T, N>& arg)
+        -> std::ostream&;
+
+    #include "details/lanes.inl"
+}}
+
+#endif // POLDER_EVALUATION_LANES_H_
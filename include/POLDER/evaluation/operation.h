@@ -24,7 +24,8 @@
 #include <cmath>
 #include <cstdint>
 #include <sstream>
-#include <unordered_map>
+#include <type_traits>
+#include <utility>
 #include <POLDER/details/config.h>
 #include <POLDER/evaluation/error.h>
 #include <POLDER/evaluation/operator.h>
@@ -47,6 +48,41 @@ namespace evaluation
     auto operation(postfix_t oper, Number arg)
         -> Number;
 
+    /**
+     * @brief Whether x**2 can be computed as x*x.
+     *
+     * The compiled expressions replace x**2 by x*x, which
+     * gives the same result for numbers but not for types
+     * whose multiplication considers both operands as
+     * independent values, such as intervals: specialize
+     * this trait as std::false_type for them.
+     */
+    template<typename Number>
+    struct is_square_product:
+        std::true_type
+    {};
+
+    ////////////////////////////////////////////////////////////
+    // Derivatives of the operations
+
+    /**
+     * Partial derivatives of operation(oper, lhs, rhs) with
+     * respect to lhs and to rhs. The operators which cast
+     * their operands to integers or return booleans are
+     * piecewise constant: their derivatives are 0.
+     */
+    template<typename Number>
+    auto derivative(infix_t oper, Number lhs, Number rhs)
+        -> std::pair<Number, Number>;
+
+    template<typename Number>
+    auto derivative(prefix_t oper, Number arg)
+        -> Number;
+
+    template<typename Number>
+    auto derivative(postfix_t oper, Number arg)
+        -> Number;
+
     #include "details/operation.inl"
 }}
 
@@ -21,8 +21,10 @@
 ////////////////////////////////////////////////////////////
 // Headers
 ////////////////////////////////////////////////////////////
+#include <cstddef>
 #include <cstdint>
 #include <string>
+#include <type_traits>
 #include <POLDER/details/config.h>
 
 namespace polder
@@ -82,14 +84,100 @@ namespace evaluation
         FAC         // ! (Factorial)
     };
 
+    /**
+     * Associativity of infix operators.
+     */
+    enum struct associativity_t:
+        std::uint_fast8_t
+    {
+        left,
+        right
+    };
+
     ////////////////////////////////////////////////////////////
-    // Priority of infix operators
+    // Precedence of the operators
+
+    namespace details
+    {
+        struct infix_precedence
+        {
+            unsigned int priority;
+            associativity_t associativity;
+        };
+
+        // Indexed by infix_t, in declaration order
+        constexpr infix_precedence infix_table[] = {
+            { 7,  associativity_t::left },   // =
+            { 7,  associativity_t::left },   // !=, <>
+            { 8,  associativity_t::left },   // >=
+            { 8,  associativity_t::left },   // <=
+            { 3,  associativity_t::left },   // &&
+            { 1,  associativity_t::left },   // ||
+            { 2,  associativity_t::left },   // ^^
+            { 12, associativity_t::left },   // **
+            { 7,  associativity_t::left },   // <=>
+            { 9,  associativity_t::left },   // <<
+            { 9,  associativity_t::left },   // >>
+            { 10, associativity_t::left },   // +
+            { 10, associativity_t::left },   // -
+            { 11, associativity_t::left },   // *
+            { 11, associativity_t::left },   // /
+            { 11, associativity_t::left },   // %
+            { 6,  associativity_t::left },   // &
+            { 4,  associativity_t::left },   // |
+            { 8,  associativity_t::left },   // >
+            { 8,  associativity_t::left },   // <
+            { 5,  associativity_t::left },   // ^
+            { 11, associativity_t::left },   // //
+        };
+
+        static_assert(sizeof infix_table / sizeof *infix_table
+                      == std::size_t(infix_t::IDIV) + 1,
+                      "every infix operator needs a precedence");
+
+        // The unary operators bind tighter than any infix
+        // operator, and the prefix ones tighter than the
+        // postfix ones: -3! is (-3)!
+        constexpr unsigned int postfix_priority = 13;
+        constexpr unsigned int prefix_priority = 14;
+    }
+
+    /**
+     * Priority of the operators: an operator of higher
+     * priority binds tighter to its operands.
+     */
+    constexpr auto priority(infix_t oper)
+        -> unsigned int
+    {
+        return details::infix_table[
+            std::underlying_type_t<infix_t>(oper)
+        ].priority;
+    }
+
+    constexpr auto priority(prefix_t)
+        -> unsigned int
+    {
+        return details::prefix_priority;
+    }
+
+    constexpr auto priority(postfix_t)
+        -> unsigned int
+    {
+        return details::postfix_priority;
+    }
 
     /**
-     * Priority of infix operators.
+     * Associativity of infix operators: a sequence of
+     * operators of the same priority is grouped from the
+     * left or from the right.
      */
-    auto priority(infix_t oper)
-        -> unsigned int;
+    constexpr auto associativity(infix_t oper)
+        -> associativity_t
+    {
+        return details::infix_table[
+            std::underlying_type_t<infix_t>(oper)
+        ].associativity;
+    }
 
     ////////////////////////////////////////////////////////////
     // String conversion functions
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_EVALUATION_SHARED_EVALUATOR_H_
+#define POLDER_EVALUATION_SHARED_EVALUATOR_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <POLDER/details/config.h>
+#include <POLDER/evaluation/evaluator.h>
+#include <POLDER/evaluation/expression.h>
+
+namespace polder
+{
+namespace evaluation
+{
+    /**
+     * @brief Evaluator shared between threads.
+     *
+     * An evaluator whose functions can be connected and
+     * disconnected while other threads evaluate expressions.
+     * The functions are read from an immutable snapshot. A
+     * writer copies the current snapshot, modifies the copy
+     * and publishes it in place of the current one.
+     *
+     * Evaluate and compile never lock: they register as
+     * readers of the current epoch in a counter shared with
+     * a few other threads, read the published snapshot, and
+     * unregister when they are done. A replaced snapshot is
+     * retired, then destroyed along with its functions once
+     * the readers which may use it are gone: by the writer
+     * if there are none, otherwise by the last of them. No
+     * function is kept alive after being disconnected or
+     * replaced once no evaluation is running, and a writer
+     * never waits for the readers, so a connected function
+     * can itself connect or disconnect functions.
+     *
+     * Every snapshot has its own cache of compiled expressions,
+     * so publishing a new snapshot empties the cache. When the
+     * cache is enabled, every evaluation locks its mutex: it
+     * is disabled by default. Writing is meant to be rare: it
+     * copies every function.
+     */
+    template<typename Number>
+    class shared_evaluator
+    {
+        public:
+
+            using snapshot_type = std::shared_ptr<const evaluator<Number>>;
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+
+            shared_evaluator();
+
+            // Shares a copy of the given evaluator
+            explicit shared_evaluator(const evaluator<Number>& eval);
+
+            shared_evaluator(const shared_evaluator&) = delete;
+            auto operator=(const shared_evaluator&)
+                -> shared_evaluator& = delete;
+
+            ////////////////////////////////////////////////////////////
+            // Readers
+
+            /**
+             * @brief Current snapshot of the evaluator.
+             *
+             * The snapshot is never modified and can be used
+             * without any synchronization. Unlike evaluate,
+             * this function locks the mutex of the writers.
+             */
+            auto snapshot() const
+                -> snapshot_type;
+
+            /**
+             * @brief Evaluate an expression with the current snapshot.
+             */
+            auto evaluate(const std::string& expression) const
+                -> Number;
+
+            /**
+             * @brief Calls evaluate.
+             */
+            auto operator()(const std::string& expression) const
+                -> Number;
+
+            /**
+             * @brief Compile an expression with the current snapshot.
+             *
+             * A compiled expression keeps its own copy of the
+             * functions it calls, and is not affected by the
+             * functions connected afterwards.
+             */
+            auto compile(const std::string& expression) const
+                -> evaluation::expression<Number>;
+
+            auto compile(const std::string& expression,
+                         const std::vector<std::string>& variables) const
+                -> evaluation::expression<Number>;
+
+            ////////////////////////////////////////////////////////////
+            // Writers
+
+            /**
+             * @brief Register a function.
+             *
+             * Unlike evaluator::connect, a function already
+             * connected to the name is replaced, along with its
+             * derivatives, so that a function can be reloaded
+             * while the other threads evaluate expressions.
+             */
+            template<typename Func>
+            auto connect(const std::string& name, Func&& function, bool pure=false)
+                -> void;
+
+            template<typename... Partials>
+            auto connect_derivatives(const std::string& name, Partials&&... partials)
+                -> void;
+
+            auto disconnect(const std::string& name)
+                -> void;
+
+            auto set_cache_capacity(std::size_t capacity)
+                -> void;
+
+        private:
+
+            // Number of reader counters per epoch, threads
+            // sharing a counter compete for its cache line
+            static constexpr std::size_t nb_stripes = 8;
+
+            // Counter alone in its cache line
+            struct reader_count
+            {
+                std::atomic<std::size_t> count{0};
+                char padding[64 - sizeof(std::atomic<std::size_t>)];
+            };
+
+            /**
+             * Calls func with the published snapshot, which is
+             * not destroyed before func returns.
+             */
+            template<typename Function>
+            auto with_snapshot(Function func) const
+                -> decltype(func(std::declval<const evaluator<Number>&>()));
+
+            /**
+             * Publishes a modified copy of the current snapshot.
+             * Nothing is published if the modification throws.
+             */
+            template<typename Modifier>
+            auto update(Modifier modify)
+                -> void;
+
+            // Destroys the retired snapshots which are not
+            // used by any reader anymore
+            auto reclaim() const
+                -> void;
+
+            // Must be called with the mutex locked; the
+            // snapshots to destroy are moved to garbage
+            auto collect_retired(std::list<snapshot_type>& garbage) const
+                -> void;
+
+            auto has_readers(std::size_t epoch) const
+                -> bool;
+
+            // Counter used by the current thread in every epoch
+            static auto reader_stripe()
+                -> std::size_t;
+
+            // Locked by the writers and by the readers
+            // destroying the retired snapshots
+            mutable std::mutex _mutex;
+            snapshot_type _current;
+
+            // Snapshot read by the readers, owned by _current
+            std::atomic<const evaluator<Number>*> _published;
+
+            // The readers register in the counters of the
+            // parity of the epoch; a snapshot retired before
+            // the epoch changes can be destroyed once the
+            // counters of both parities were seen at zero
+            mutable std::atomic<std::size_t> _epoch;
+            mutable reader_count _readers[2][nb_stripes];
+
+            // Retired snapshots waiting for the epoch to change,
+            // and snapshots waiting for the readers of the
+            // previous epoch to be gone
+            mutable std::list<snapshot_type> _retired;
+            mutable std::list<snapshot_type> _retiring;
+            mutable bool _epoch_changed;
+            mutable std::atomic<bool> _has_retired;
+    };
+
+    #include "details/shared_evaluator.inl"
+}}
+
+#endif // POLDER_EVALUATION_SHARED_EVALUATOR_H_
@@ -21,7 +21,9 @@
 ////////////////////////////////////////////////////////////
 // Headers
 ////////////////////////////////////////////////////////////
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -32,6 +34,38 @@ namespace polder
 {
 namespace evaluation
 {
+    /**
+     * Non-owning view of a name in an expression string. The
+     * tokens refer to the names in the expression instead of
+     * copying them, so the expression string has to outlive
+     * the tokens.
+     */
+    struct name_view
+    {
+        const char* data;
+        std::size_t size;
+
+        auto str() const
+            -> std::string;
+    };
+
+    auto operator==(name_view lhs, const std::string& rhs)
+        -> bool;
+    auto operator==(const std::string& lhs, name_view rhs)
+        -> bool;
+
+    // Heterogeneous lookup in the callbacks registry
+    auto operator<(name_view lhs, const std::string& rhs)
+        -> bool;
+    auto operator<(const std::string& lhs, name_view rhs)
+        -> bool;
+
+    auto operator+(const std::string& lhs, name_view rhs)
+        -> std::string;
+
+    auto operator<<(std::ostream& stream, name_view name)
+        -> std::ostream&;
+
     /**
      * Token types that can be used by the evaluator.
      */
@@ -40,6 +74,7 @@ namespace evaluation
     {
         operand,
         name,
+        variable,
         infix,
         prefix,
         postfix,
@@ -50,8 +85,8 @@ namespace evaluation
 
     /**
      * Token used by the evaluator. It can either represent
-     * a parenthesis, an operator or a number. Number types
-     * are restricted to built-in types.
+     * a parenthesis, an operator, a function, a variable or
+     * a number. Number types are restricted to built-in types.
      */
     template<typename Number>
     struct token
@@ -64,7 +99,8 @@ namespace evaluation
         explicit token(token_t type);
 
         explicit token(Number num);
-        explicit token(std::string name);
+        // type is either token_t::name or token_t::variable
+        explicit token(name_view name, token_t type=token_t::name);
         explicit token(infix_t oper);
         explicit token(prefix_t oper);
         explicit token(postfix_t oper);
@@ -78,6 +114,8 @@ namespace evaluation
             -> bool;
         auto is_name() const
             -> bool;
+        auto is_variable() const
+            -> bool;
         auto is_infix() const
             -> bool;
         auto is_prefix() const
@@ -99,7 +137,7 @@ namespace evaluation
         union
         {
             Number data;
-            std::string name;
+            name_view name;
             infix_t infix;
             prefix_t prefix;
             postfix_t postfix;
@@ -98,6 +98,42 @@ namespace polder
 
             std::string _msg;   /**< Error message */
     };
+
+
+    /**
+     * @brief Input/output failure
+     *
+     * Thrown when a file can not be opened or mapped,
+     * or when its content is not what was expected.
+     */
+    class POLDER_API io_error:
+        public std::exception
+    {
+        public:
+
+            /**
+             * @brief Creates a new exception
+             * @param msg Error message to be displayed
+             */
+            explicit io_error(const std::string& msg="Input/output error.");
+
+            /**
+             * @brief Destructor
+             */
+            virtual ~io_error() noexcept;
+
+            /**
+             * @brief Returns the error message
+             * @return Error message
+             */
+            virtual auto what() const noexcept
+                -> const char*
+                override;
+
+        protected:
+
+            std::string _msg;   /**< Error message */
+    };
 }
 
 #endif // POLDER_EXCEPTIONS_H_
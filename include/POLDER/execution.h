@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_EXECUTION_H_
+#define POLDER_EXECUTION_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <POLDER/details/config.h>
+#include <POLDER/thread_pool.h>
+
+namespace polder
+{
+namespace execution
+{
+    /**
+     * @brief Sequential execution policy
+     *
+     * The algorithms taking this policy run in the
+     * calling thread only.
+     */
+    struct sequenced_policy {};
+
+    /**
+     * @brief Parallel execution policy
+     *
+     * The algorithms taking this policy split their work
+     * across the threads of a thread_pool. When the amount
+     * of work (roughly, the number of elementary operations)
+     * is under a threshold, they run sequentially since
+     * dispatching the work would cost more than it saves.
+     */
+    class parallel_policy
+    {
+        public:
+
+            /**
+             * @brief Default threshold
+             */
+            static constexpr std::size_t default_threshold = 1u << 15u;
+
+            constexpr parallel_policy() = default;
+
+            /**
+             * @brief Returns a policy running on the given pool
+             */
+            auto on(thread_pool& pool) const
+                -> parallel_policy;
+
+            /**
+             * @brief Returns a policy with the given threshold
+             */
+            auto with_threshold(std::size_t threshold) const
+                -> parallel_policy;
+
+            /**
+             * @brief Pool the work runs on
+             *
+             * Defaults to thread_pool::default_pool().
+             */
+            auto pool() const
+                -> thread_pool&;
+
+            /**
+             * @brief Minimal amount of work to run in parallel
+             */
+            auto threshold() const
+                -> std::size_t;
+
+        private:
+
+            thread_pool* _pool = nullptr;
+            std::size_t _threshold = default_threshold;
+    };
+
+    constexpr sequenced_policy seq{};
+    constexpr parallel_policy par{};
+
+    template<typename T>
+    struct is_execution_policy:
+        std::false_type
+    {};
+
+    template<>
+    struct is_execution_policy<sequenced_policy>:
+        std::true_type
+    {};
+
+    template<>
+    struct is_execution_policy<parallel_policy>:
+        std::true_type
+    {};
+
+    ////////////////////////////////////////////////////////////
+    // Parallel building blocks
+
+    /**
+     * @brief Decides once whether some work runs in parallel
+     *
+     * Returns a policy under which every parallel algorithm
+     * runs in parallel if work reaches the threshold of the
+     * given policy, and sequentially otherwise. It is meant
+     * for algorithms whose chunks are too small to compare to
+     * the threshold while the whole algorithm is large.
+     */
+    inline auto for_work(sequenced_policy policy, std::size_t work)
+        -> sequenced_policy;
+
+    inline auto for_work(const parallel_policy& policy, std::size_t work)
+        -> parallel_policy;
+
+    /**
+     * @brief Splits [0, size) into chunks
+     *
+     * Calls func(begin, end) once per chunk. Chunks may be
+     * run concurrently and the function returns when all of
+     * them have been processed. If one of the calls throws,
+     * one of the exceptions is rethrown.
+     */
+    template<typename Function>
+    auto parallel_for(sequenced_policy policy, std::size_t size, Function&& func)
+        -> void;
+
+    template<typename Function>
+    auto parallel_for(const parallel_policy& policy, std::size_t size, Function&& func)
+        -> void;
+
+    /**
+     * @brief Maps chunks of [0, size) and reduces the results
+     *
+     * Calls map(begin, end) once per non-empty chunk then
+     * combines the results with reduce, in the order of the
+     * chunks. size shall not be 0.
+     */
+    template<typename Result, typename Map, typename Reduce>
+    auto parallel_reduce(sequenced_policy policy, std::size_t size,
+                         Map&& map, Reduce&& reduce)
+        -> Result;
+
+    template<typename Result, typename Map, typename Reduce>
+    auto parallel_reduce(const parallel_policy& policy, std::size_t size,
+                         Map&& map, Reduce&& reduce)
+        -> Result;
+
+    #include "details/execution.inl"
+}
+
+    using execution::seq;
+    using execution::par;
+}
+
+#endif // POLDER_EXECUTION_H_
@@ -88,6 +88,13 @@ auto stride_iterator<Iterator, Distance>::operator->() const
     return &(operator*());
 }
 
+template<typename Iterator, typename Distance>
+auto stride_iterator<Iterator, Distance>::operator[](difference_type n) const
+    -> reference
+{
+    return *std::next(_it, n * stride());
+}
+
 ////////////////////////////////////////////////////////////
 // Increment/decrement operators
 
@@ -125,6 +132,57 @@ auto stride_iterator<Iterator, Distance>::operator--(int)
     return tmp;
 }
 
+template<typename Iterator, typename Distance>
+auto stride_iterator<Iterator, Distance>::operator+=(difference_type n)
+    -> stride_iterator&
+{
+    std::advance(_it, n * stride());
+    return *this;
+}
+
+template<typename Iterator, typename Distance>
+auto stride_iterator<Iterator, Distance>::operator-=(difference_type n)
+    -> stride_iterator&
+{
+    std::advance(_it, -n * stride());
+    return *this;
+}
+
+////////////////////////////////////////////////////////////
+// Arithmetic operators
+
+template<typename Iterator, typename Distance>
+auto operator+(stride_iterator<Iterator, Distance> it,
+               typename stride_iterator<Iterator, Distance>::difference_type n)
+    -> stride_iterator<Iterator, Distance>
+{
+    return it += n;
+}
+
+template<typename Iterator, typename Distance>
+auto operator+(typename stride_iterator<Iterator, Distance>::difference_type n,
+               stride_iterator<Iterator, Distance> it)
+    -> stride_iterator<Iterator, Distance>
+{
+    return it += n;
+}
+
+template<typename Iterator, typename Distance>
+auto operator-(stride_iterator<Iterator, Distance> it,
+               typename stride_iterator<Iterator, Distance>::difference_type n)
+    -> stride_iterator<Iterator, Distance>
+{
+    return it -= n;
+}
+
+template<typename Iterator1, typename Iterator2, typename Distance>
+auto operator-(const stride_iterator<Iterator1, Distance>& lhs,
+               const stride_iterator<Iterator2, Distance>& rhs)
+    -> decltype(lhs.base() - rhs.base())
+{
+    return (lhs.base() - rhs.base()) / lhs.stride();
+}
+
 ////////////////////////////////////////////////////////////
 // Comparison operators
 
@@ -33,6 +33,11 @@ namespace polder
      * iterator by an amount give at construction. It is
      * useful to implement a matrix over a vector and
      * have line iterators.
+     *
+     * The random access operations are only available when
+     * the adapted iterator is a random access iterator, and
+     * the distance between two stride iterators only makes
+     * sense when they share the same stride.
      */
     template<
         typename Iterator,
@@ -43,7 +48,7 @@ namespace polder
         private:
 
             Iterator _it;
-            const Distance _stride = 1;
+            Distance _stride = 1;
 
         public:
 
@@ -88,6 +93,8 @@ namespace polder
                 -> reference;
             auto operator->() const
                 -> pointer;
+            auto operator[](difference_type n) const
+                -> reference;
 
             ////////////////////////////////////////////////////////////
             // Increment/decrement operators
@@ -101,8 +108,36 @@ namespace polder
                 -> stride_iterator&;
             auto operator--(int)
                 -> stride_iterator;
+
+            auto operator+=(difference_type n)
+                -> stride_iterator&;
+            auto operator-=(difference_type n)
+                -> stride_iterator&;
     };
 
+    ////////////////////////////////////////////////////////////
+    // Arithmetic operators
+
+    template<typename Iterator, typename Distance>
+    auto operator+(stride_iterator<Iterator, Distance> it,
+                   typename stride_iterator<Iterator, Distance>::difference_type n)
+        -> stride_iterator<Iterator, Distance>;
+
+    template<typename Iterator, typename Distance>
+    auto operator+(typename stride_iterator<Iterator, Distance>::difference_type n,
+                   stride_iterator<Iterator, Distance> it)
+        -> stride_iterator<Iterator, Distance>;
+
+    template<typename Iterator, typename Distance>
+    auto operator-(stride_iterator<Iterator, Distance> it,
+                   typename stride_iterator<Iterator, Distance>::difference_type n)
+        -> stride_iterator<Iterator, Distance>;
+
+    template<typename Iterator1, typename Iterator2, typename Distance>
+    auto operator-(const stride_iterator<Iterator1, Distance>& lhs,
+                   const stride_iterator<Iterator2, Distance>& rhs)
+        -> decltype(lhs.base() - rhs.base());
+
     ////////////////////////////////////////////////////////////
     // Comparison operators
 
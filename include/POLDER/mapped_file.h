@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file POLDER/mapped_file.h
+ * @brief Read-only memory-mapped files.
+ */
+
+#ifndef POLDER_MAPPED_FILE_H_
+#define POLDER_MAPPED_FILE_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <string>
+#include <POLDER/details/config.h>
+
+namespace polder
+{
+    /**
+     * @brief Whole file mapped read-only in memory
+     *
+     * The pages of the file are loaded by the operating system
+     * when they are first read and can be shared between the
+     * processes mapping the same file, so that opening a big
+     * file neither copies it nor reads it upfront.
+     *
+     * The beginning of the mapping is aligned on a page
+     * boundary. Moving a mapped_file does not move the mapped
+     * memory, so that the pointers to its data stay valid.
+     */
+    class POLDER_API mapped_file
+    {
+        public:
+
+            mapped_file() noexcept;
+
+            /**
+             * @brief Maps the given file
+             *
+             * Throws polder::io_error if the file can not be
+             * opened or mapped.
+             */
+            explicit mapped_file(const std::string& path);
+
+            mapped_file(const mapped_file&) = delete;
+            mapped_file(mapped_file&& other) noexcept;
+
+            auto operator=(const mapped_file&)
+                -> mapped_file& = delete;
+            auto operator=(mapped_file&& other) noexcept
+                -> mapped_file&;
+
+            ~mapped_file();
+
+            // Beginning of the mapped memory, null
+            // when the file is empty
+            auto data() const noexcept
+                -> const unsigned char*;
+
+            // Size of the file in bytes
+            auto size() const noexcept
+                -> std::size_t;
+
+            auto is_open() const noexcept
+                -> bool;
+
+            /**
+             * @brief Unmaps the file
+             */
+            auto close() noexcept
+                -> void;
+
+        private:
+
+            const unsigned char* _data; /**< Mapped memory */
+            std::size_t _size;          /**< Size of the mapping */
+            bool _open;                 /**< Whether a file is mapped */
+    };
+}
+
+#endif // POLDER_MAPPED_FILE_H_
@@ -28,48 +28,67 @@
 #include <ostream>
 #include <vector>
 #include <POLDER/algorithm.h>
+#include <POLDER/execution.h>
 #include <POLDER/functional.h>
+#include <POLDER/memory.h>
 #include <POLDER/matrix/base.h>
+#include <POLDER/matrix/expression.h>
+#include <POLDER/matrix/gemm.h>
+#include <POLDER/matrix/lu.h>
+#include <POLDER/matrix/row.h>
+#include <POLDER/matrix/transpose.h>
+#include <POLDER/matrix/view.h>
 
 namespace polder
 {
-    template<typename T>
+    template<typename T, typename Allocator>
     class Matrix;
 
     /**
      * @brief Trait holding the Matrix types
      */
-    template<typename T>
-    struct types_t<Matrix<T>>
+    template<typename T, typename Allocator>
+    struct types_t<Matrix<T, Allocator>>
     {
         using value_type = T;
         using reference = value_type&;
         using const_reference = const value_type&;
         using pointer = value_type*;
         using const_pointer = const value_type*;
+        using allocator_type = Allocator;
+
+        // Guaranteed alignment of the first element
+        static constexpr std::size_t alignment = allocator_alignment<Allocator>::value;
     };
 
+    template<typename T, typename Allocator>
+    constexpr std::size_t types_t<Matrix<T, Allocator>>::alignment;
+
     /**
      * @brief Matrix implementation
      *
      * A Matrix is a two dimensions array of data.
      * It can be accessed as an array of arrays but
      * has some particularities described below.
+     *
+     * The elements are stored contiguously in memory
+     * obtained from Allocator. The default allocator
+     * aligns the data on default_alignment bytes so
+     * that SIMD kernels can use aligned loads; an
+     * arena_allocator can be used to take the memory
+     * of short-lived matrices from a monotonic_arena.
      */
-    template<typename T>
+    template<typename T, typename Allocator>
     class Matrix:
-        public MutableMatrix<Matrix<T>>
+        public MutableMatrix<Matrix<T, Allocator>>
     {
         public:
 
-            // Forward declaration
-            struct row;
-
             ////////////////////////////////////////////////////////////
             // Types
             ////////////////////////////////////////////////////////////
 
-            using super = MutableMatrix<Matrix<T>>;
+            using super = MutableMatrix<Matrix<T, Allocator>>;
 
             // Sizes
             using typename super::size_type;
@@ -80,16 +99,30 @@ namespace polder
             using typename super::const_reference;
             using typename super::pointer;
             using typename super::const_pointer;
+            using allocator_type = Allocator;
+            // Rows
+            using row = MatrixRow<T>;
+            using const_row = MatrixRow<const T>;
+            using column = MatrixSlice<T>;
+            using const_column = MatrixSlice<const T>;
+            // Views
+            using view_type = MatrixView<T>;
+            using const_view_type = MatrixView<const T>;
+            using transposed_type = StridedMatrixView<T>;
+            using const_transposed_type = StridedMatrixView<const T>;
             // Iterators
-            using iterator = typename std::vector<row>::iterator;
-            using const_iterator = typename std::vector<row>::const_iterator;
-            using reverse_iterator = typename std::vector<row>::reverse_iterator;
-            using const_reverse_iterator = typename std::vector<row>::const_reverse_iterator;
+            using iterator = MatrixRowIterator<T>;
+            using const_iterator = MatrixRowIterator<const T>;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
             // Flat iterators
-            using flat_iterator = typename std::vector<T>::iterator;
-            using const_flat_iterator = typename std::vector<T>::const_iterator;
-            using reverse_flat_iterator = typename std::vector<T>::reverse_iterator;
-            using const_reverse_flat_iterator = typename std::vector<T>::const_reverse_iterator;
+            using flat_iterator = typename std::vector<T, Allocator>::iterator;
+            using const_flat_iterator = typename std::vector<T, Allocator>::const_iterator;
+            using reverse_flat_iterator = typename std::vector<T, Allocator>::reverse_iterator;
+            using const_reverse_flat_iterator = typename std::vector<T, Allocator>::const_reverse_iterator;
+
+            // Guaranteed alignment of data()
+            static constexpr std::size_t alignment = types_t<Matrix>::alignment;
 
             ////////////////////////////////////////////////////////////
             // Constructors and destructor
@@ -97,16 +130,26 @@ namespace polder
 
             // Default constructor
             Matrix();
+            explicit Matrix(const Allocator& alloc);
             // Copy constructor
             Matrix(const Matrix& other);
             // Move constructor
             Matrix(Matrix&& other) noexcept;
             // Initializer list constructors
-            Matrix(std::initializer_list<T> values);
-            Matrix(std::initializer_list<std::initializer_list<T>> values);
+            Matrix(std::initializer_list<T> values,
+                   const Allocator& alloc=Allocator());
+            Matrix(std::initializer_list<std::initializer_list<T>> values,
+                   const Allocator& alloc=Allocator());
             // Constructors with size
-            Matrix(size_type height, size_type width);
-            explicit Matrix(size_type width);
+            Matrix(size_type height, size_type width,
+                   const Allocator& alloc=Allocator());
+            explicit Matrix(size_type width,
+                            const Allocator& alloc=Allocator());
+            // Evaluation of a matrix expression
+            template<typename Derived>
+            Matrix(const ImmutableMatrix<Derived>& expr);
+            template<typename Derived>
+            Matrix(const ImmutableMatrix<Derived>& expr, const Allocator& alloc);
 
             // Destructor
             ~Matrix();
@@ -115,17 +158,23 @@ namespace polder
             // Construction functions
             ////////////////////////////////////////////////////////////
 
-            static auto zeros(size_type height, size_type width)
+            static auto zeros(size_type height, size_type width,
+                              const Allocator& alloc=Allocator())
                 -> Matrix;
-            static auto zeros(size_type width)
+            static auto zeros(size_type width,
+                              const Allocator& alloc=Allocator())
                 -> Matrix;
-            static auto ones(size_type height, size_type width)
+            static auto ones(size_type height, size_type width,
+                             const Allocator& alloc=Allocator())
                 -> Matrix;
-            static auto ones(size_type width)
+            static auto ones(size_type width,
+                             const Allocator& alloc=Allocator())
                 -> Matrix;
-            static auto identity(size_type size)
+            static auto identity(size_type size,
+                                 const Allocator& alloc=Allocator())
                 -> Matrix;
-            static auto eye(size_type x, size_type y=0, int k=0)
+            static auto eye(size_type x, size_type y=0, int k=0,
+                            const Allocator& alloc=Allocator())
                 -> Matrix;
 
             ////////////////////////////////////////////////////////////
@@ -135,28 +184,39 @@ namespace polder
             // Accessors
             using super::operator[]; // Solve name hiding problem
             auto operator[](size_type index)
-                -> row&;
+                -> row;
             auto operator[](size_type index) const
-                -> const row&;
+                -> const_row;
             auto operator()(size_type y, size_type x)
                 -> reference;
             auto operator()(size_type y, size_type x) const
                 -> value_type;
 
             // Assignment operator
-            auto operator=(const Matrix<T>& other) &
+            auto operator=(const Matrix<T, Allocator>& other) &
+                -> Matrix&;
+            auto operator=(Matrix<T, Allocator>&& other) & noexcept
                 -> Matrix&;
-            auto operator=(Matrix<T>&& other) & noexcept
+            template<typename Derived>
+            auto operator=(const ImmutableMatrix<Derived>& expr) &
                 -> Matrix&;
 
             // Matrix-Matrix arithmetic operations
-            auto operator+=(const Matrix<T>& other)
+            auto operator+=(const Matrix<T, Allocator>& other)
+                -> Matrix&;
+            auto operator-=(const Matrix<T, Allocator>& other)
                 -> Matrix&;
-            auto operator-=(const Matrix<T>& other)
+            auto operator*=(const Matrix<T, Allocator>& other)
                 -> Matrix&;
-            auto operator*=(const Matrix<T>& other)
+            auto operator/=(const Matrix<T, Allocator>& other)
                 -> Matrix&;
-            auto operator/=(const Matrix<T>& other)
+
+            // Matrix-expression arithmetic operations
+            template<typename Derived>
+            auto operator+=(const ImmutableMatrix<Derived>& expr)
+                -> Matrix&;
+            template<typename Derived>
+            auto operator-=(const ImmutableMatrix<Derived>& expr)
                 -> Matrix&;
 
             // Matrix-value_type arithmetic operations
@@ -185,6 +245,8 @@ namespace polder
                 -> T*;
             auto data() const
                 -> const T*;
+            auto get_allocator() const
+                -> allocator_type;
 
             // Iterators
             auto begin()
@@ -222,11 +284,20 @@ namespace polder
             auto fill(value_type value)
                 -> void;
 
+            /**
+             * @brief Fills the Matrix with the given value
+             * @param policy Execution policy
+             * @param value Value to fill the Matrix with
+             */
+            template<typename ExecutionPolicy>
+            auto fill(ExecutionPolicy&& policy, value_type value)
+                -> void;
+
             /**
              * @brief Swap the Matrix contents with another Matrix's
              * @param other Matrix to swap contents with
              */
-            auto swap(Matrix<T>&& other)
+            auto swap(Matrix<T, Allocator>&& other)
                 -> void;
 
 
@@ -240,6 +311,9 @@ namespace polder
              */
             auto all() const
                 -> bool;
+            template<typename ExecutionPolicy>
+            auto all(ExecutionPolicy&& policy) const
+                -> bool;
 
             /**
              * @brief Checks whether there are non-zero elements
@@ -247,6 +321,9 @@ namespace polder
              */
             auto any() const
                 -> bool;
+            template<typename ExecutionPolicy>
+            auto any(ExecutionPolicy&& policy) const
+                -> bool;
 
             /**
              * @brief Least element of the Matrix
@@ -254,6 +331,9 @@ namespace polder
              */
             auto min() const
                 -> value_type;
+            template<typename ExecutionPolicy>
+            auto min(ExecutionPolicy&& policy) const
+                -> value_type;
 
             /**
              * @brief Greatest element of the Matrix
@@ -261,6 +341,9 @@ namespace polder
              */
             auto max() const
                 -> value_type;
+            template<typename ExecutionPolicy>
+            auto max(ExecutionPolicy&& policy) const
+                -> value_type;
 
             /**
              * @brief Sum of all the elements
@@ -268,6 +351,9 @@ namespace polder
              */
             auto sum() const
                 -> value_type;
+            template<typename ExecutionPolicy>
+            auto sum(ExecutionPolicy&& policy) const
+                -> value_type;
 
             /**
              * @brief Reshape the Matrix
@@ -291,6 +377,58 @@ namespace polder
             auto flatten()
                 -> void;
 
+            ////////////////////////////////////////////////////////////
+            // Views
+            ////////////////////////////////////////////////////////////
+
+            // The views are invalidated when the Matrix is
+            // reallocated, reshaped or destroyed
+
+            /**
+             * @brief View over the whole Matrix
+             */
+            auto view()
+                -> view_type;
+            auto view() const
+                -> const_view_type;
+
+            /**
+             * @brief View over a block of the Matrix
+             *
+             * No element is copied: writing to the view
+             * writes to the Matrix.
+             *
+             * @param y Row of the top-left element of the block
+             * @param x Column of the top-left element of the block
+             * @param height Number of rows of the block
+             * @param width Number of columns of the block
+             */
+            auto block(size_type y, size_type x, size_type height, size_type width)
+                -> view_type;
+            auto block(size_type y, size_type x, size_type height, size_type width) const
+                -> const_view_type;
+
+            /**
+             * @brief Column of the Matrix, without copy
+             * @param x Index of the column
+             */
+            auto col(size_type x)
+                -> column;
+            auto col(size_type x) const
+                -> const_column;
+
+            /**
+             * @brief Lazy transpose of the Matrix
+             *
+             * Contrary to transpose(), the elements are not
+             * copied: the returned view accesses the elements
+             * of the Matrix with swapped strides.
+             */
+            auto transposed()
+                -> transposed_type;
+            auto transposed() const
+                -> const_transposed_type;
+
             ////////////////////////////////////////////////////////////
             // Miscellaneous functions
             ////////////////////////////////////////////////////////////
@@ -312,6 +450,14 @@ namespace polder
             // Some of them could have been implemented
             // as free function (ex: determinant) but are
             // easier to implement as in-class functions
+
+            /**
+             * @brief Determinant of the Matrix
+             *
+             * Computed with an LU decomposition, or with the
+             * fraction-free Bareiss algorithm for integral
+             * types, so that it is exact in O(n³).
+             */
             auto determinant() const
                 -> value_type;
             auto minor(size_type y, size_type x) const
@@ -347,102 +493,9 @@ namespace polder
         private:
 
             // Member data
-            size_type _height = 0;      /**< Number of rows */
-            size_type _width  = 0;      /**< Number of columns */
-
-            std::vector<T>      _data;  /**< Matrix data */
-            std::vector<row>    _rows;  /**< Matrix rows */
-
-        public:
-
-            /**
-             * @brief Matrix row
-             *
-             * To facilitate some operations such as iterating
-             * through a Matrix or accessing the elements with
-             * an array-like syntax, we must create this class.
-             * The Matrix is an array of Matrix::row, which are
-             * themselves arrays of data.
-             */
-            struct row
-            {
-                ////////////////////////////////////////////////////////////
-                // Types
-                ////////////////////////////////////////////////////////////
-                using value_type = T;
-                using size_type = std::size_t;
-                using difference_type = std::ptrdiff_t;
-                using reference = value_type&;
-                using const_reference = const value_type&;
-                using pointer = value_type*;
-                using const_pointer = const value_type*;
-                using iterator = value_type*;
-                using const_iterator = const value_type*;
-                using reverse_iterator = std::reverse_iterator<iterator>;
-                using const_reverse_iterator = std::reverse_iterator<const_iterator>;
-
-                ////////////////////////////////////////////////////////////
-                // Constructors and destructor
-                ////////////////////////////////////////////////////////////
-
-                // Defaulted functions
-                row()           = default;
-                row(const row&) = default;
-                row(row&&)      = default;
-                ~row()          = default;
-
-                // Initialization constructor
-                row(size_type size, T* data_addr);
-
-                ////////////////////////////////////////////////////////////
-                // Operators
-                ////////////////////////////////////////////////////////////
-
-                auto operator[](size_type index)
-                    -> reference;
-                auto operator[](size_type index) const
-                    -> const_reference;
-
-                ////////////////////////////////////////////////////////////
-                // Functions
-                ////////////////////////////////////////////////////////////
-
-                // Iterators
-                auto begin()
-                    -> iterator;
-                auto begin() const
-                    -> const_iterator;
-                auto cbegin() const
-                    -> const_iterator;
-                auto end()
-                    -> iterator;
-                auto end() const
-                    -> const_iterator;
-                auto cend() const
-                    -> const_iterator;
-
-                auto rbegin()
-                    -> reverse_iterator;
-                auto rbegin() const
-                    -> const_reverse_iterator;
-                auto crbegin() const
-                    -> const_reverse_iterator;
-                auto rend()
-                    -> reverse_iterator;
-                auto rend() const
-                    -> const_reverse_iterator;
-                auto crend() const
-                    -> const_reverse_iterator;
-
-                // Capacity
-                auto size() const
-                    -> size_type;
-
-                private:
-
-                    size_type _size;    /**< Number of values */
-                    T* _data;           /**< Beginning of the data */
-            };
+            size_type _height = 0;              /**< Number of rows */
+            size_type _width  = 0;              /**< Number of columns */
+            std::vector<T, Allocator> _data;    /**< Matrix data */
     };
 
     ////////////////////////////////////////////////////////////
@@ -450,68 +503,106 @@ namespace polder
     ////////////////////////////////////////////////////////////
 
     // Matrix-Matrix comparison
-    template<typename T>
-    auto operator==(const Matrix<T>& lhs, const Matrix<T>& rhs)
+    template<typename T, typename Allocator>
+    auto operator==(const Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs)
         -> bool;
-    template<typename T>
-    auto operator!=(const Matrix<T>& lhs, const Matrix<T>& rhs)
+    template<typename T, typename Allocator>
+    auto operator!=(const Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs)
         -> bool;
 
-    // Matrix-Matrix arithmetic operations
-    template<typename T>
-    auto operator+(Matrix<T> lhs, const Matrix<T>& rhs)
-        -> Matrix<T>;
-    template<typename T>
-    auto operator-(Matrix<T> lhs, const Matrix<T>& rhs)
-        -> Matrix<T>;
-    template<typename T>
-    auto operator*(Matrix<T> lhs, const Matrix<T>& rhs)
-        -> Matrix<T>;
-    template<typename T>
-    auto operator/(Matrix<T> lhs, const Matrix<T>& rhs)
-        -> Matrix<T>;
-
-    // Matrix-value_type arithmetic operations
-    template<typename T>
-    auto operator*(Matrix<T> lhs, T rhs)
-        -> Matrix<T>;
-    template<typename T>
-    auto operator*(T lhs, Matrix<T> rhs)
-        -> Matrix<T>;
-    template<typename T>
-    auto operator/(Matrix<T> lhs, T rhs)
-        -> Matrix<T>;
+    // Matrix-Matrix arithmetic operations; the element-wise
+    // operations are lazy and live in matrix/expression.h
+    template<typename T, typename Allocator>
+    auto operator*(const Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs)
+        -> Matrix<T, Allocator>;
+    template<typename T, typename Allocator>
+    auto operator/(Matrix<T, Allocator> lhs, const Matrix<T, Allocator>& rhs)
+        -> Matrix<T, Allocator>;
+
+    namespace details
+    {
+        // Types whose elements can be located with a
+        // row stride and a column stride
+        template<typename T>
+        struct is_strided_matrix:
+            is_matrix_view<T>
+        {};
+
+        template<typename T, typename Allocator>
+        struct is_strided_matrix<Matrix<T, Allocator>>:
+            std::true_type
+        {};
+
+        template<typename Lhs, typename Rhs>
+        using enable_if_strided_t = std::enable_if_t<
+            is_strided_matrix<Lhs>::value && is_strided_matrix<Rhs>::value
+        >;
+    }
+
+    // Products involving views: the multiplication kernel reads
+    // the operands through their strides, so that the product
+    // with a transposed() view never materializes the transpose
+    template<typename Lhs, typename Rhs,
+             typename = details::enable_if_strided_t<Lhs, Rhs>>
+    auto operator*(const Lhs& lhs, const Rhs& rhs)
+        -> Matrix<typename types_t<Lhs>::value_type>;
+
+    // Matrix-Matrix arithmetic operations with an execution policy
+    template<typename ExecutionPolicy, typename T, typename Allocator>
+    auto add(ExecutionPolicy&& policy, const Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs)
+        -> Matrix<T, Allocator>;
+    template<typename ExecutionPolicy, typename T, typename Allocator>
+    auto subtract(ExecutionPolicy&& policy, const Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs)
+        -> Matrix<T, Allocator>;
+    template<typename ExecutionPolicy, typename T, typename Allocator>
+    auto multiply(ExecutionPolicy&& policy, const Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs)
+        -> Matrix<T, Allocator>;
+
+    template<typename ExecutionPolicy, typename Lhs, typename Rhs,
+             typename = details::enable_if_strided_t<Lhs, Rhs>>
+    auto multiply(ExecutionPolicy&& policy, const Lhs& lhs, const Rhs& rhs)
+        -> Matrix<typename types_t<Lhs>::value_type>;
 
     // Streams handling
-    template<typename T>
-    auto operator<<(std::ostream& stream, const Matrix<T>& mat)
+    template<typename T, typename Allocator>
+    auto operator<<(std::ostream& stream, const Matrix<T, Allocator>& mat)
         -> std::ostream&;
 
     ////////////////////////////////////////////////////////////
     // Miscellaneous functions
     ////////////////////////////////////////////////////////////
 
-    template<typename T>
-    auto adjugate(const Matrix<T>& mat)
-        -> Matrix<T>;
-    template<typename T>
-    auto cofactor(const Matrix<T> mat, std::pair<std::size_t, std::size_t> index)
-        -> typename Matrix<T>::value_type;
-    template<typename T>
-    auto determinant(const Matrix<T>& mat)
-        -> typename Matrix<T>::value_type;
-    template<typename T>
-    auto inverse(const Matrix<T>& mat)
-        -> Matrix<T>;
-    template<typename T>
-    auto minor(const Matrix<T>& mat, std::pair<std::size_t, std::size_t> index)
-        -> typename Matrix<T>::value_type;
-    template<typename T>
-    auto trace(const Matrix<T>& mat)
-        -> typename Matrix<T>::value_type;
-    template<typename T>
-    auto transpose(const Matrix<T>& mat)
-        -> Matrix<T>;
+    template<typename T, typename Allocator>
+    auto adjugate(const Matrix<T, Allocator>& mat)
+        -> Matrix<T, Allocator>;
+    template<typename T, typename Allocator>
+    auto cofactor(const Matrix<T, Allocator>& mat, std::pair<std::size_t, std::size_t> index)
+        -> typename Matrix<T, Allocator>::value_type;
+    template<typename T, typename Allocator>
+    auto determinant(const Matrix<T, Allocator>& mat)
+        -> typename Matrix<T, Allocator>::value_type;
+    template<typename T, typename Allocator>
+    auto inverse(const Matrix<T, Allocator>& mat)
+        -> Matrix<T, Allocator>;
+    template<typename T, typename Allocator>
+    auto minor(const Matrix<T, Allocator>& mat, std::pair<std::size_t, std::size_t> index)
+        -> typename Matrix<T, Allocator>::value_type;
+    template<typename T, typename Allocator>
+    auto trace(const Matrix<T, Allocator>& mat)
+        -> typename Matrix<T, Allocator>::value_type;
+    template<typename T, typename Allocator>
+    auto transpose(const Matrix<T, Allocator>& mat)
+        -> Matrix<T, Allocator>;
+
+    /**
+     * @brief Transposes a Matrix in place
+     *
+     * Square matrices are transposed without any allocation;
+     * the other ones are transposed into a new buffer.
+     */
+    template<typename T, typename Allocator>
+    auto transpose_in_place(Matrix<T, Allocator>& mat)
+        -> void;
 
     #include "details/matrix.inl"
 }
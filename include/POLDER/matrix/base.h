@@ -24,10 +24,14 @@
 #include <cstddef>
 #include <utility>
 #include <POLDER/index.h>
+#include <POLDER/memory.h>
 #include "../details/config.h"
 
 namespace polder
 {
+    template<typename T, typename Allocator=aligned_allocator<T>>
+    class Matrix;
+
     /**
      * @brief Trait holding a class types
      *
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_MATRIX_BATCH_H_
+#define POLDER_MATRIX_BATCH_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include <POLDER/execution.h>
+#include <POLDER/matrix.h>
+#include <POLDER/memory.h>
+#include <POLDER/details/config.h>
+
+namespace polder
+{
+    /**
+     * @brief Batch of matrices of the same size
+     *
+     * The matrices are stored as a structure of arrays split
+     * in blocks: a block holds block_size matrices, and the
+     * elements at the position (y, x) of the matrices of a
+     * block are contiguous. The batched operations can thus
+     * process the matrices of a block at once, one per SIMD
+     * lane, with exactly the same instructions as for a single
+     * matrix, and without any allocation per matrix. Since a
+     * block is contiguous, processing it only touches a few
+     * consecutive cache lines whatever the size of the batch.
+     *
+     * The number of matrices is rounded up to a whole number
+     * of blocks; the padding matrices are zeros when the batch
+     * is created and their content is unspecified after an
+     * operation.
+     */
+    template<typename T>
+    class MatrixBatch
+    {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Types
+            ////////////////////////////////////////////////////////////
+
+            using value_type = T;
+            using size_type = std::size_t;
+            using reference = value_type&;
+            using const_reference = const value_type&;
+            using pointer = value_type*;
+            using const_pointer = const value_type*;
+
+            /**
+             * @brief Number of matrices in a block
+             *
+             * The elements of a block at a given position fill
+             * a cache line, which is also the widest SIMD vector.
+             */
+            static constexpr size_type block_size =
+                std::max<size_type>(default_alignment / sizeof(T), 1);
+
+            ////////////////////////////////////////////////////////////
+            // Constructors
+            ////////////////////////////////////////////////////////////
+
+            MatrixBatch();
+
+            // count matrices of zeros
+            MatrixBatch(size_type count, size_type height, size_type width);
+
+            ////////////////////////////////////////////////////////////
+            // Element access
+            ////////////////////////////////////////////////////////////
+
+            // Element (y, x) of the matrix index
+            auto operator()(size_type index, size_type y, size_type x)
+                -> reference;
+            auto operator()(size_type index, size_type y, size_type x) const
+                -> const_reference;
+
+            /**
+             * @brief Elements of the i-th block
+             *
+             * The element (y, x) of the matrix i * block_size + l
+             * is at the index (y * width() + x) * block_size + l
+             * of the returned array.
+             */
+            auto block(size_type i)
+                -> pointer;
+            auto block(size_type i) const
+                -> const_pointer;
+
+            auto data()
+                -> pointer;
+            auto data() const
+                -> const_pointer;
+
+            /**
+             * @brief Copies a matrix into the batch
+             *
+             * The matrix shall provide height(), width() and
+             * operator()(y, x) and have the size of the batch
+             * matrices.
+             */
+            template<typename Mat>
+            auto set(size_type index, const Mat& mat)
+                -> void;
+
+            // Copy of the matrix index
+            auto get(size_type index) const
+                -> Matrix<T>;
+
+            ////////////////////////////////////////////////////////////
+            // Miscellaneous functions
+            ////////////////////////////////////////////////////////////
+
+            // Number of matrices
+            auto count() const
+                -> size_type;
+
+            // Number of blocks, padding included
+            auto nb_blocks() const
+                -> size_type;
+
+            // Size of the matrices
+            auto height() const
+                -> size_type;
+            auto width() const
+                -> size_type;
+
+        private:
+
+            size_type _count;       /**< Number of matrices */
+            size_type _nb_blocks;   /**< Number of blocks */
+            size_type _height;      /**< Number of rows of the matrices */
+            size_type _width;       /**< Number of columns of the matrices */
+            std::vector<T, aligned_allocator<T>> _data;
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Batched operations
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Determinants of a batch of square matrices
+     *
+     * Gaussian elimination with partial pivoting, done on all
+     * the matrices of a block at once: the pivots are selected
+     * per matrix with branchless row swaps. The determinant of
+     * the matrix i is written to res[i].
+     */
+    template<typename T>
+    auto batch_determinant(const MatrixBatch<T>& batch, T* res)
+        -> void;
+    template<typename ExecutionPolicy, typename T>
+    auto batch_determinant(ExecutionPolicy&& policy, const MatrixBatch<T>& batch, T* res)
+        -> void;
+
+    /**
+     * @brief Inverses of a batch of square matrices
+     *
+     * Gauss-Jordan elimination with partial pivoting, done
+     * on all the matrices of a block at once. The matrices
+     * shall be invertible. res shall have the same size as
+     * batch and may be batch itself.
+     */
+    template<typename T>
+    auto batch_inverse(const MatrixBatch<T>& batch, MatrixBatch<T>& res)
+        -> void;
+    template<typename ExecutionPolicy, typename T>
+    auto batch_inverse(ExecutionPolicy&& policy, const MatrixBatch<T>& batch, MatrixBatch<T>& res)
+        -> void;
+
+    /**
+     * @brief Products of two batches of matrices
+     *
+     * Computes res[i] = lhs[i] * rhs[i] for every i. res shall
+     * be a batch of lhs.height() x rhs.width() matrices and
+     * shall not be one of the operands.
+     */
+    template<typename T>
+    auto batch_multiply(const MatrixBatch<T>& lhs, const MatrixBatch<T>& rhs,
+                        MatrixBatch<T>& res)
+        -> void;
+    template<typename ExecutionPolicy, typename T>
+    auto batch_multiply(ExecutionPolicy&& policy,
+                        const MatrixBatch<T>& lhs, const MatrixBatch<T>& rhs,
+                        MatrixBatch<T>& res)
+        -> void;
+
+    #include "detail/batch.inl"
+}
+
+#endif // POLDER_MATRIX_BATCH_H_
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_MATRIX_BINARY_H_
+#define POLDER_MATRIX_BINARY_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <POLDER/exceptions.h>
+#include <POLDER/mapped_file.h>
+#include <POLDER/matrix.h>
+#include <POLDER/memory.h>
+#include <POLDER/details/config.h>
+
+namespace polder
+{
+    /**
+     * @brief Type of the elements of a binary matrix file
+     */
+    enum class element_type:
+        std::uint8_t
+    {
+        int8 = 1,
+        uint8,
+        int16,
+        uint16,
+        int32,
+        uint32,
+        int64,
+        uint64,
+        float32,
+        float64
+    };
+
+    namespace details
+    {
+        template<typename T, typename=void>
+        struct element_type_of;
+
+        template<typename T>
+        struct element_type_of<T, std::enable_if_t<std::is_integral<T>::value
+                                                   && not std::is_same<T, bool>::value>>:
+            std::integral_constant<element_type, element_type(
+                (sizeof(T) == 1 ? 1 : sizeof(T) == 2 ? 3 : sizeof(T) == 4 ? 5 : 7)
+                + (std::is_signed<T>::value ? 0 : 1)
+            )>
+        {
+            static_assert(sizeof(T) <= 8, "unsupported integer size");
+        };
+
+        template<>
+        struct element_type_of<float>:
+            std::integral_constant<element_type, element_type::float32>
+        {};
+
+        template<>
+        struct element_type_of<double>:
+            std::integral_constant<element_type, element_type::float64>
+        {};
+    }
+
+    /**
+     * @brief Header of a binary matrix file
+     *
+     * A binary matrix file starts with a header of 64 bytes:
+     *
+     *   offset  size  field
+     *        0     8  magic string "POLDERMX"
+     *        8     4  byte order mark 0x01020304
+     *       12     2  format version
+     *       14     1  element type
+     *       15     1  size of an element
+     *       16     8  height
+     *       24     8  width
+     *       32     8  offset of the data
+     *       40     4  alignment of the data
+     *       44    20  reserved, zeros
+     *
+     * The integers are written in the byte order of the machine
+     * which wrote the file, which is recognized thanks to the
+     * byte order mark. The elements follow, row by row, at the
+     * given offset, which is a multiple of the alignment: since
+     * memory-mapped files start on a page boundary, the data of
+     * a mapped matrix is as aligned as the one of a Matrix.
+     */
+    struct binary_header
+    {
+        std::uint16_t version;
+        element_type type;
+        std::uint8_t element_size;
+        std::uint64_t height;
+        std::uint64_t width;
+        std::uint64_t data_offset;
+        std::uint32_t alignment;
+        bool swap_bytes;    /**< Whether the file byte order differs from ours */
+    };
+
+    // Size of the header on disk
+    constexpr std::size_t binary_header_size = 64;
+
+    ////////////////////////////////////////////////////////////
+    // Streaming reader and writer
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Writes a matrix in the binary format
+     *
+     * The stream shall be opened in binary mode. Contiguous
+     * rows are written directly from the matrix, views with
+     * a column stride are written one row at a time through
+     * a buffer, so that no copy of the whole matrix is made.
+     */
+    template<typename M, typename = std::enable_if_t<details::is_strided_matrix<M>::value>>
+    auto write_binary(std::ostream& stream, const M& mat)
+        -> void;
+
+    /**
+     * @brief Reads the header of a binary matrix file
+     *
+     * Throws polder::io_error if the stream does not start
+     * with a valid header.
+     */
+    auto read_binary_header(std::istream& stream)
+        -> binary_header;
+
+    /**
+     * @brief Reads a matrix in the binary format
+     *
+     * The elements are read directly in the storage of the
+     * returned matrix and byte-swapped in place when the file
+     * comes from a machine with another byte order. Throws
+     * polder::io_error if the elements in the file are not
+     * of type T or if the file is truncated.
+     */
+    template<typename T, typename Allocator=aligned_allocator<T>>
+    auto read_binary(std::istream& stream, const Allocator& alloc={})
+        -> Matrix<T, Allocator>;
+
+    ////////////////////////////////////////////////////////////
+    // Memory-mapped loader
+    ////////////////////////////////////////////////////////////
+
+    namespace details
+    {
+        // Base-from-member: the mapping has to be alive
+        // before the view pointing into it is built
+        struct mapped_file_holder
+        {
+            mapped_file file;
+        };
+    }
+
+    /**
+     * @brief Read-only matrix backed by a memory-mapped file
+     *
+     * A MappedMatrix is a MatrixView<const T> which owns the
+     * mapping of a binary matrix file: loading it only reads
+     * the header, and the elements are paged in by the system
+     * when they are accessed. It can be used everywhere a
+     * MatrixView<const T> can, as long as it outlives the
+     * views taken from it.
+     *
+     * Assigning a MatrixView copies the elements, which would
+     * write to the read-only mapping: a MappedMatrix can only
+     * be moved by construction.
+     */
+    template<typename T>
+    class MappedMatrix:
+        private details::mapped_file_holder,
+        public MatrixView<const T>
+    {
+        public:
+
+            MappedMatrix() = default;
+            MappedMatrix(MappedMatrix&& other) noexcept = default;
+
+            /**
+             * @brief Maps the given binary matrix file
+             *
+             * Throws polder::io_error if the file can not be
+             * mapped, is not a valid binary matrix file, does
+             * not contain elements of type T, or has not been
+             * written with the byte order of this machine.
+             */
+            explicit MappedMatrix(const std::string& path);
+
+            // Non-owning view of the elements
+            auto view() const
+                -> MatrixView<const T>;
+    };
+
+    template<typename T>
+    auto map_matrix(const std::string& path)
+        -> MappedMatrix<T>;
+
+    #include "detail/binary.inl"
+}
+
+#endif // POLDER_MATRIX_BINARY_H_
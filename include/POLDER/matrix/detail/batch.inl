@@ -0,0 +1,634 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+////////////////////////////////////////////////////////////
+// Constructors
+////////////////////////////////////////////////////////////
+
+template<typename T>
+constexpr typename MatrixBatch<T>::size_type MatrixBatch<T>::block_size;
+
+template<typename T>
+MatrixBatch<T>::MatrixBatch():
+    MatrixBatch(0, 0, 0)
+{}
+
+template<typename T>
+MatrixBatch<T>::MatrixBatch(size_type count, size_type height, size_type width):
+    _count(count),
+    _nb_blocks((count + block_size - 1) / block_size),
+    _height(height),
+    _width(width),
+    _data(_nb_blocks * height * width * block_size)
+{}
+
+////////////////////////////////////////////////////////////
+// Element access
+////////////////////////////////////////////////////////////
+
+template<typename T>
+auto MatrixBatch<T>::operator()(size_type index, size_type y, size_type x)
+    -> reference
+{
+    return block(index / block_size)[(y * _width + x) * block_size + index % block_size];
+}
+
+template<typename T>
+auto MatrixBatch<T>::operator()(size_type index, size_type y, size_type x) const
+    -> const_reference
+{
+    return block(index / block_size)[(y * _width + x) * block_size + index % block_size];
+}
+
+template<typename T>
+auto MatrixBatch<T>::block(size_type i)
+    -> pointer
+{
+    return _data.data() + i * _height * _width * block_size;
+}
+
+template<typename T>
+auto MatrixBatch<T>::block(size_type i) const
+    -> const_pointer
+{
+    return _data.data() + i * _height * _width * block_size;
+}
+
+template<typename T>
+auto MatrixBatch<T>::data()
+    -> pointer
+{
+    return _data.data();
+}
+
+template<typename T>
+auto MatrixBatch<T>::data() const
+    -> const_pointer
+{
+    return _data.data();
+}
+
+template<typename T>
+template<typename Mat>
+auto MatrixBatch<T>::set(size_type index, const Mat& mat)
+    -> void
+{
+    POLDER_ASSERT(index < _count);
+    POLDER_ASSERT(mat.height() == _height && mat.width() == _width);
+    for (size_type y = 0 ; y < _height ; ++y)
+    {
+        for (size_type x = 0 ; x < _width ; ++x)
+        {
+            (*this)(index, y, x) = mat(y, x);
+        }
+    }
+}
+
+template<typename T>
+auto MatrixBatch<T>::get(size_type index) const
+    -> Matrix<T>
+{
+    POLDER_ASSERT(index < _count);
+    Matrix<T> res(_height, _width);
+    for (size_type y = 0 ; y < _height ; ++y)
+    {
+        for (size_type x = 0 ; x < _width ; ++x)
+        {
+            res(y, x) = (*this)(index, y, x);
+        }
+    }
+    return res;
+}
+
+////////////////////////////////////////////////////////////
+// Miscellaneous functions
+////////////////////////////////////////////////////////////
+
+template<typename T>
+auto MatrixBatch<T>::count() const
+    -> size_type
+{
+    return _count;
+}
+
+template<typename T>
+auto MatrixBatch<T>::nb_blocks() const
+    -> size_type
+{
+    return _nb_blocks;
+}
+
+template<typename T>
+auto MatrixBatch<T>::height() const
+    -> size_type
+{
+    return _height;
+}
+
+template<typename T>
+auto MatrixBatch<T>::width() const
+    -> size_type
+{
+    return _width;
+}
+
+
+
+////////////////////////////////////////////////////////////
+// Batched kernels
+////////////////////////////////////////////////////////////
+
+namespace details
+{
+    // The kernels process the blocks [first, last) of a batch;
+    // every loop on l works on the block_size lanes of a block
+    // and is vectorized by the compiler. The pivots differ from
+    // one lane to another, so the rows are swapped with selects
+    // instead of branches.
+    //
+    // The lane loops are not unrolled: a complete unrolling would
+    // happen before the loop vectorizer and leave the work to the
+    // basic block vectorizer, which gives up on the selects.
+
+    // The rows of a work buffer may alias as far as the compiler
+    // knows: loading a block of lanes in a local array first lets
+    // it vectorize the computations which write to another row
+    template<typename T, std::size_t L>
+    auto batch_load(const T* src, T* dest)
+        -> void
+    {
+        #pragma GCC unroll 1
+        for (std::size_t l = 0 ; l < L ; ++l)
+        {
+            dest[l] = src[l];
+        }
+    }
+
+    // Moves the row with the biggest pivot in column k to the
+    // row k, lane by lane, and flips the sign of the lanes
+    // whose rows have been swapped
+    template<typename T, std::size_t L>
+    auto batch_select_pivot(T* work, std::size_t nb_rows, std::size_t nb_cols,
+                            std::size_t k, T* sign)
+        -> void
+    {
+        T* pivot_row = work + k * nb_cols * L;
+        for (std::size_t r = k + 1 ; r < nb_rows ; ++r)
+        {
+            T* row = work + r * nb_cols * L;
+            // The mask is stored as T so that the selects
+            // are plain SIMD comparisons and blends
+            T swap[L];
+            #pragma GCC unroll 1
+            for (std::size_t l = 0 ; l < L ; ++l)
+            {
+                swap[l] = std::abs(row[k*L+l]) > std::abs(pivot_row[k*L+l]) ? T(1) : T(0);
+            }
+            for (std::size_t j = k ; j < nb_cols ; ++j)
+            {
+                T lhs[L], rhs[L];
+                batch_load<T, L>(pivot_row + j * L, lhs);
+                batch_load<T, L>(row + j * L, rhs);
+                #pragma GCC unroll 1
+                for (std::size_t l = 0 ; l < L ; ++l)
+                {
+                    pivot_row[j*L+l] = swap[l] != T(0) ? rhs[l] : lhs[l];
+                    row[j*L+l] = swap[l] != T(0) ? lhs[l] : rhs[l];
+                }
+            }
+            #pragma GCC unroll 1
+            for (std::size_t l = 0 ; l < L ; ++l)
+            {
+                sign[l] = swap[l] != T(0) ? -sign[l] : sign[l];
+            }
+        }
+    }
+
+    template<typename T>
+    auto batch_determinant_blocks(std::size_t n, const T* src,
+                                  std::size_t first, std::size_t last,
+                                  std::size_t count, T* res)
+        -> void
+    {
+        constexpr std::size_t L = MatrixBatch<T>::block_size;
+        std::vector<T, aligned_allocator<T>> buffer(n * n * L);
+        T* work = buffer.data();
+
+        for (std::size_t block = first ; block < last ; ++block)
+        {
+            const std::size_t offset = block * L;
+            std::copy_n(src + block * n * n * L, n * n * L, work);
+
+            T det[L];
+            std::fill_n(det, L, T(1));
+            for (std::size_t k = 0 ; k < n ; ++k)
+            {
+                batch_select_pivot<T, L>(work, n, n, k, det);
+
+                const T* pivot_row = work + k * n * L;
+                #pragma GCC unroll 1
+                for (std::size_t l = 0 ; l < L ; ++l)
+                {
+                    det[l] *= pivot_row[k*L+l];
+                }
+
+                for (std::size_t r = k + 1 ; r < n ; ++r)
+                {
+                    T* row = work + r * n * L;
+                    T factor[L];
+                    #pragma GCC unroll 1
+                    for (std::size_t l = 0 ; l < L ; ++l)
+                    {
+                        // A null pivot means that the whole column is
+                        // null and that the determinant is already 0;
+                        // dividing by 1 then keeps the factor null
+                        const T pivot = pivot_row[k*L+l];
+                        factor[l] = row[k*L+l] / (pivot != T(0) ? pivot : T(1));
+                    }
+                    for (std::size_t j = k + 1 ; j < n ; ++j)
+                    {
+                        T pivots[L];
+                        batch_load<T, L>(pivot_row + j * L, pivots);
+                        #pragma GCC unroll 1
+                        for (std::size_t l = 0 ; l < L ; ++l)
+                        {
+                            row[j*L+l] -= factor[l] * pivots[l];
+                        }
+                    }
+                }
+            }
+
+            std::copy_n(det, std::min(L, count - offset), res + offset);
+        }
+    }
+
+    template<typename T>
+    auto batch_inverse_blocks(std::size_t n, const T* src, T* dest,
+                              std::size_t first, std::size_t last)
+        -> void
+    {
+        constexpr std::size_t L = MatrixBatch<T>::block_size;
+        const std::size_t nb_cols = 2 * n;
+        std::vector<T, aligned_allocator<T>> buffer(n * nb_cols * L);
+        T* work = buffer.data();
+
+        for (std::size_t block = first ; block < last ; ++block)
+        {
+            // Augment every matrix with the identity
+            const T* src_block = src + block * n * n * L;
+            for (std::size_t y = 0 ; y < n ; ++y)
+            {
+                for (std::size_t x = 0 ; x < n ; ++x)
+                {
+                    std::copy_n(src_block + (y * n + x) * L, L,
+                                work + (y * nb_cols + x) * L);
+                    std::fill_n(work + (y * nb_cols + n + x) * L, L,
+                                x == y ? T(1) : T(0));
+                }
+            }
+
+            // The sign of the permutation is not needed
+            T sign[L];
+            std::fill_n(sign, L, T(1));
+            for (std::size_t k = 0 ; k < n ; ++k)
+            {
+                batch_select_pivot<T, L>(work, n, nb_cols, k, sign);
+
+                T* pivot_row = work + k * nb_cols * L;
+                T inv[L];
+                #pragma GCC unroll 1
+                for (std::size_t l = 0 ; l < L ; ++l)
+                {
+                    inv[l] = T(1) / pivot_row[k*L+l];
+                }
+                for (std::size_t j = k ; j < nb_cols ; ++j)
+                {
+                    #pragma GCC unroll 1
+                    for (std::size_t l = 0 ; l < L ; ++l)
+                    {
+                        pivot_row[j*L+l] *= inv[l];
+                    }
+                }
+
+                for (std::size_t r = 0 ; r < n ; ++r)
+                {
+                    if (r == k)
+                    {
+                        continue;
+                    }
+
+                    T* row = work + r * nb_cols * L;
+                    T factor[L];
+                    std::copy_n(row + k * L, L, factor);
+                    for (std::size_t j = k ; j < nb_cols ; ++j)
+                    {
+                        T pivots[L];
+                        batch_load<T, L>(pivot_row + j * L, pivots);
+                        #pragma GCC unroll 1
+                        for (std::size_t l = 0 ; l < L ; ++l)
+                        {
+                            row[j*L+l] -= factor[l] * pivots[l];
+                        }
+                    }
+                }
+            }
+
+            T* dest_block = dest + block * n * n * L;
+            for (std::size_t y = 0 ; y < n ; ++y)
+            {
+                std::copy_n(work + (y * nb_cols + n) * L, n * L,
+                            dest_block + y * n * L);
+            }
+        }
+    }
+
+    template<typename T>
+    auto batch_multiply_blocks(std::size_t m, std::size_t n, std::size_t k,
+                               const T* lhs, const T* rhs, T* res,
+                               std::size_t first, std::size_t last)
+        -> void
+    {
+        constexpr std::size_t L = MatrixBatch<T>::block_size;
+        for (std::size_t block = first ; block < last ; ++block)
+        {
+            const T* lhs_block = lhs + block * m * k * L;
+            const T* rhs_block = rhs + block * k * n * L;
+            T* res_block = res + block * m * n * L;
+            for (std::size_t i = 0 ; i < m ; ++i)
+            {
+                for (std::size_t j = 0 ; j < n ; ++j)
+                {
+                    T acc[L] = {};
+                    for (std::size_t p = 0 ; p < k ; ++p)
+                    {
+                        const T* a = lhs_block + (i * k + p) * L;
+                        const T* b = rhs_block + (p * n + j) * L;
+                        #pragma GCC unroll 1
+                        for (std::size_t l = 0 ; l < L ; ++l)
+                        {
+                            acc[l] += a[l] * b[l];
+                        }
+                    }
+                    std::copy_n(acc, L, res_block + (i * n + j) * L);
+                }
+            }
+        }
+    }
+
+#if POLDER_X86_DISPATCH
+
+    // The generic kernels are inlined in these functions
+    // and thus compiled for the wider instruction sets
+
+    template<typename T>
+    POLDER_TARGET("avx2,fma") POLDER_FLATTEN
+    auto batch_determinant_blocks_avx2(std::size_t n, const T* src,
+                                       std::size_t first, std::size_t last,
+                                       std::size_t count, T* res)
+        -> void
+    {
+        batch_determinant_blocks(n, src, first, last, count, res);
+    }
+
+    template<typename T>
+    POLDER_TARGET("avx512f") POLDER_FLATTEN
+    auto batch_determinant_blocks_avx512(std::size_t n, const T* src,
+                                         std::size_t first, std::size_t last,
+                                         std::size_t count, T* res)
+        -> void
+    {
+        batch_determinant_blocks(n, src, first, last, count, res);
+    }
+
+    template<typename T>
+    POLDER_TARGET("avx2,fma") POLDER_FLATTEN
+    auto batch_inverse_blocks_avx2(std::size_t n, const T* src, T* dest,
+                                   std::size_t first, std::size_t last)
+        -> void
+    {
+        batch_inverse_blocks(n, src, dest, first, last);
+    }
+
+    template<typename T>
+    POLDER_TARGET("avx512f") POLDER_FLATTEN
+    auto batch_inverse_blocks_avx512(std::size_t n, const T* src, T* dest,
+                                     std::size_t first, std::size_t last)
+        -> void
+    {
+        batch_inverse_blocks(n, src, dest, first, last);
+    }
+
+    template<typename T>
+    POLDER_TARGET("avx2,fma") POLDER_FLATTEN
+    auto batch_multiply_blocks_avx2(std::size_t m, std::size_t n, std::size_t k,
+                                    const T* lhs, const T* rhs, T* res,
+                                    std::size_t first, std::size_t last)
+        -> void
+    {
+        batch_multiply_blocks(m, n, k, lhs, rhs, res, first, last);
+    }
+
+    template<typename T>
+    POLDER_TARGET("avx512f") POLDER_FLATTEN
+    auto batch_multiply_blocks_avx512(std::size_t m, std::size_t n, std::size_t k,
+                                      const T* lhs, const T* rhs, T* res,
+                                      std::size_t first, std::size_t last)
+        -> void
+    {
+        batch_multiply_blocks(m, n, k, lhs, rhs, res, first, last);
+    }
+
+#endif
+
+    ////////////////////////////////////////////////////////////
+    // Kernel selection
+
+    enum class batch_isa
+    {
+        generic,
+        avx2,
+        avx512
+    };
+
+    inline auto get_batch_isa()
+        -> batch_isa
+    {
+        // The CPU is only queried once
+        static const batch_isa isa = [] {
+#if POLDER_X86_DISPATCH
+            if (has_avx512()) return batch_isa::avx512;
+            if (has_avx2()) return batch_isa::avx2;
+#endif
+            return batch_isa::generic;
+        }();
+        return isa;
+    }
+
+    template<typename T>
+    auto batch_determinant_dispatch(std::size_t n, const T* src,
+                                    std::size_t first, std::size_t last,
+                                    std::size_t count, T* res)
+        -> void
+    {
+        switch (get_batch_isa())
+        {
+#if POLDER_X86_DISPATCH
+            case batch_isa::avx512:
+                batch_determinant_blocks_avx512(n, src, first, last, count, res);
+                return;
+            case batch_isa::avx2:
+                batch_determinant_blocks_avx2(n, src, first, last, count, res);
+                return;
+#endif
+            default:
+                batch_determinant_blocks(n, src, first, last, count, res);
+        }
+    }
+
+    template<typename T>
+    auto batch_inverse_dispatch(std::size_t n, const T* src, T* dest,
+                                std::size_t first, std::size_t last)
+        -> void
+    {
+        switch (get_batch_isa())
+        {
+#if POLDER_X86_DISPATCH
+            case batch_isa::avx512:
+                batch_inverse_blocks_avx512(n, src, dest, first, last);
+                return;
+            case batch_isa::avx2:
+                batch_inverse_blocks_avx2(n, src, dest, first, last);
+                return;
+#endif
+            default:
+                batch_inverse_blocks(n, src, dest, first, last);
+        }
+    }
+
+    template<typename T>
+    auto batch_multiply_dispatch(std::size_t m, std::size_t n, std::size_t k,
+                                 const T* lhs, const T* rhs, T* res,
+                                 std::size_t first, std::size_t last)
+        -> void
+    {
+        switch (get_batch_isa())
+        {
+#if POLDER_X86_DISPATCH
+            case batch_isa::avx512:
+                batch_multiply_blocks_avx512(m, n, k, lhs, rhs, res, first, last);
+                return;
+            case batch_isa::avx2:
+                batch_multiply_blocks_avx2(m, n, k, lhs, rhs, res, first, last);
+                return;
+#endif
+            default:
+                batch_multiply_blocks(m, n, k, lhs, rhs, res, first, last);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////
+// Batched operations
+////////////////////////////////////////////////////////////
+
+template<typename T>
+auto batch_determinant(const MatrixBatch<T>& batch, T* res)
+    -> void
+{
+    batch_determinant(execution::seq, batch, res);
+}
+
+template<typename ExecutionPolicy, typename T>
+auto batch_determinant(ExecutionPolicy&& policy, const MatrixBatch<T>& batch, T* res)
+    -> void
+{
+    static_assert(std::is_floating_point<T>::value,
+                  "batch_determinant only handles floating point matrices");
+    POLDER_ASSERT(batch.height() == batch.width());
+
+    const std::size_t n = batch.height();
+    const auto block_policy = execution::for_work(policy, batch.count() * n * n * n);
+    execution::parallel_for(block_policy, batch.nb_blocks(),
+        [&](std::size_t first, std::size_t last)
+        {
+            details::batch_determinant_dispatch(n, batch.data(), first, last,
+                                                batch.count(), res);
+        }
+    );
+}
+
+template<typename T>
+auto batch_inverse(const MatrixBatch<T>& batch, MatrixBatch<T>& res)
+    -> void
+{
+    batch_inverse(execution::seq, batch, res);
+}
+
+template<typename ExecutionPolicy, typename T>
+auto batch_inverse(ExecutionPolicy&& policy, const MatrixBatch<T>& batch, MatrixBatch<T>& res)
+    -> void
+{
+    static_assert(std::is_floating_point<T>::value,
+                  "batch_inverse only handles floating point matrices");
+    POLDER_ASSERT(batch.height() == batch.width());
+    POLDER_ASSERT(res.count() == batch.count());
+    POLDER_ASSERT(res.height() == batch.height() && res.width() == batch.width());
+
+    // Every block is copied before being inverted,
+    // so the result can overwrite the batch
+    const std::size_t n = batch.height();
+    const auto block_policy = execution::for_work(policy, batch.count() * n * n * n);
+    execution::parallel_for(block_policy, batch.nb_blocks(),
+        [&](std::size_t first, std::size_t last)
+        {
+            details::batch_inverse_dispatch(n, batch.data(), res.data(), first, last);
+        }
+    );
+}
+
+template<typename T>
+auto batch_multiply(const MatrixBatch<T>& lhs, const MatrixBatch<T>& rhs,
+                    MatrixBatch<T>& res)
+    -> void
+{
+    batch_multiply(execution::seq, lhs, rhs, res);
+}
+
+template<typename ExecutionPolicy, typename T>
+auto batch_multiply(ExecutionPolicy&& policy,
+                    const MatrixBatch<T>& lhs, const MatrixBatch<T>& rhs,
+                    MatrixBatch<T>& res)
+    -> void
+{
+    POLDER_ASSERT(lhs.count() == rhs.count() && res.count() == lhs.count());
+    POLDER_ASSERT(lhs.width() == rhs.height());
+    POLDER_ASSERT(res.height() == lhs.height() && res.width() == rhs.width());
+    POLDER_ASSERT(&res != &lhs && &res != &rhs);
+
+    const std::size_t m = lhs.height();
+    const std::size_t n = rhs.width();
+    const std::size_t k = lhs.width();
+    const auto block_policy = execution::for_work(policy, lhs.count() * m * n * k);
+    execution::parallel_for(block_policy, lhs.nb_blocks(),
+        [&](std::size_t first, std::size_t last)
+        {
+            details::batch_multiply_dispatch(m, n, k, lhs.data(), rhs.data(), res.data(),
+                                             first, last);
+        }
+    );
+}
@@ -0,0 +1,301 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+namespace details
+{
+    constexpr char binary_magic[8] = { 'P', 'O', 'L', 'D', 'E', 'R', 'M', 'X' };
+    constexpr std::uint32_t binary_byte_order_mark = 0x01020304;
+    constexpr std::uint32_t binary_swapped_byte_order_mark = 0x04030201;
+    constexpr std::uint16_t binary_version = 1;
+
+    template<typename T>
+    auto byteswap(T& value)
+        -> void
+    {
+        auto bytes = reinterpret_cast<unsigned char*>(&value);
+        std::reverse(bytes, bytes + sizeof(T));
+    }
+
+    template<typename T>
+    auto store(unsigned char* buffer, T value)
+        -> void
+    {
+        std::memcpy(buffer, &value, sizeof(T));
+    }
+
+    template<typename T>
+    auto load(const unsigned char* buffer, bool swap_bytes)
+        -> T
+    {
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        if (swap_bytes)
+        {
+            byteswap(value);
+        }
+        return value;
+    }
+
+    template<typename T>
+    auto make_binary_header(unsigned char* buffer, std::size_t height, std::size_t width)
+        -> binary_header
+    {
+        binary_header header;
+        header.version = binary_version;
+        header.type = element_type_of<T>::value;
+        header.element_size = sizeof(T);
+        header.height = height;
+        header.width = width;
+        header.alignment = default_alignment;
+        header.data_offset = (binary_header_size + default_alignment - 1)
+                           / default_alignment * default_alignment;
+        header.swap_bytes = false;
+
+        std::fill(buffer, buffer + binary_header_size, 0);
+        std::copy(std::begin(binary_magic), std::end(binary_magic), buffer);
+        store(buffer + 8, binary_byte_order_mark);
+        store(buffer + 12, header.version);
+        store(buffer + 14, static_cast<std::uint8_t>(header.type));
+        store(buffer + 15, header.element_size);
+        store(buffer + 16, header.height);
+        store(buffer + 24, header.width);
+        store(buffer + 32, header.data_offset);
+        store(buffer + 40, header.alignment);
+        return header;
+    }
+
+    inline auto parse_binary_header(const unsigned char* buffer)
+        -> binary_header
+    {
+        if (not std::equal(std::begin(binary_magic), std::end(binary_magic), buffer))
+        {
+            throw io_error("Not a binary matrix file.");
+        }
+
+        binary_header header;
+        const auto mark = load<std::uint32_t>(buffer + 8, false);
+        if (mark == binary_byte_order_mark)
+        {
+            header.swap_bytes = false;
+        }
+        else if (mark == binary_swapped_byte_order_mark)
+        {
+            header.swap_bytes = true;
+        }
+        else
+        {
+            throw io_error("Unknown byte order in the binary matrix file.");
+        }
+
+        header.version = load<std::uint16_t>(buffer + 12, header.swap_bytes);
+        if (header.version != binary_version)
+        {
+            throw io_error("Unsupported binary matrix file version.");
+        }
+        header.type = static_cast<element_type>(buffer[14]);
+        header.element_size = buffer[15];
+        header.height = load<std::uint64_t>(buffer + 16, header.swap_bytes);
+        header.width = load<std::uint64_t>(buffer + 24, header.swap_bytes);
+        header.data_offset = load<std::uint64_t>(buffer + 32, header.swap_bytes);
+        header.alignment = load<std::uint32_t>(buffer + 40, header.swap_bytes);
+
+        if (header.data_offset < binary_header_size)
+        {
+            throw io_error("Corrupted binary matrix file header.");
+        }
+        if (header.width != 0 && header.height > std::uint64_t(-1) / header.width)
+        {
+            throw io_error("Corrupted binary matrix file header.");
+        }
+        return header;
+    }
+
+    template<typename T>
+    auto check_element_type(const binary_header& header)
+        -> void
+    {
+        if (header.type != element_type_of<T>::value || header.element_size != sizeof(T))
+        {
+            throw io_error("The binary matrix file does not hold elements of the requested type.");
+        }
+    }
+
+    // Number of bytes of the elements of a matrix
+    // described by the header, throws on overflow
+    template<typename T>
+    auto binary_data_size(const binary_header& header)
+        -> std::size_t
+    {
+        const std::uint64_t count = header.height * header.width;
+        if (count > std::size_t(-1) / sizeof(T))
+        {
+            throw io_error("The binary matrix file is too big.");
+        }
+        return static_cast<std::size_t>(count) * sizeof(T);
+    }
+
+    template<typename T>
+    auto mapped_view(const mapped_file& file)
+        -> MatrixView<const T>
+    {
+        if (file.size() < binary_header_size)
+        {
+            throw io_error("Not a binary matrix file.");
+        }
+
+        const binary_header header = parse_binary_header(file.data());
+        check_element_type<T>(header);
+        if (header.swap_bytes)
+        {
+            throw io_error("A binary matrix file can only be mapped with its own byte order.");
+        }
+        if (header.data_offset % alignof(T) != 0)
+        {
+            throw io_error("Misaligned data in the binary matrix file.");
+        }
+        if (header.data_offset > file.size()
+            || binary_data_size<T>(header) > file.size() - header.data_offset)
+        {
+            throw io_error("Truncated binary matrix file.");
+        }
+
+        auto data = reinterpret_cast<const T*>(file.data() + header.data_offset);
+        return { data, static_cast<std::size_t>(header.height),
+                 static_cast<std::size_t>(header.width) };
+    }
+}
+
+////////////////////////////////////////////////////////////
+// Streaming reader and writer
+////////////////////////////////////////////////////////////
+
+template<typename M, typename>
+auto write_binary(std::ostream& stream, const M& mat)
+    -> void
+{
+    auto view = details::strided_view(mat);
+    using value_type = std::remove_const_t<typename types_t<decltype(view)>::value_type>;
+    const std::size_t height = view.height();
+    const std::size_t width = view.width();
+
+    unsigned char buffer[binary_header_size];
+    const binary_header header = details::make_binary_header<value_type>(buffer, height, width);
+    stream.write(reinterpret_cast<const char*>(buffer), binary_header_size);
+    for (std::size_t i = binary_header_size ; i < header.data_offset ; ++i)
+    {
+        stream.put('\0');
+    }
+
+    const auto row_size = static_cast<std::streamsize>(width * sizeof(value_type));
+    if (view.col_stride() == 1)
+    {
+        if (view.row_stride() == width)
+        {
+            stream.write(reinterpret_cast<const char*>(view.data()),
+                         row_size * static_cast<std::streamsize>(height));
+        }
+        else
+        {
+            for (std::size_t y = 0 ; y < height ; ++y)
+            {
+                stream.write(reinterpret_cast<const char*>(view.data() + y * view.row_stride()),
+                             row_size);
+            }
+        }
+    }
+    else
+    {
+        // Gather every row before writing it
+        std::vector<value_type> row(width);
+        for (std::size_t y = 0 ; y < height ; ++y)
+        {
+            for (std::size_t x = 0 ; x < width ; ++x)
+            {
+                row[x] = view(y, x);
+            }
+            stream.write(reinterpret_cast<const char*>(row.data()), row_size);
+        }
+    }
+
+    if (not stream)
+    {
+        throw io_error("Could not write the binary matrix.");
+    }
+}
+
+inline auto read_binary_header(std::istream& stream)
+    -> binary_header
+{
+    unsigned char buffer[binary_header_size];
+    stream.read(reinterpret_cast<char*>(buffer), binary_header_size);
+    if (stream.gcount() != static_cast<std::streamsize>(binary_header_size))
+    {
+        throw io_error("Not a binary matrix file.");
+    }
+    return details::parse_binary_header(buffer);
+}
+
+template<typename T, typename Allocator>
+auto read_binary(std::istream& stream, const Allocator& alloc)
+    -> Matrix<T, Allocator>
+{
+    const binary_header header = read_binary_header(stream);
+    details::check_element_type<T>(header);
+    const std::size_t size = details::binary_data_size<T>(header);
+
+    stream.ignore(static_cast<std::streamsize>(header.data_offset - binary_header_size));
+    Matrix<T, Allocator> res(static_cast<std::size_t>(header.height),
+                             static_cast<std::size_t>(header.width),
+                             alloc);
+    stream.read(reinterpret_cast<char*>(res.data()), static_cast<std::streamsize>(size));
+    if (stream.gcount() != static_cast<std::streamsize>(size))
+    {
+        throw io_error("Truncated binary matrix file.");
+    }
+
+    if (header.swap_bytes)
+    {
+        std::for_each(res.data(), res.data() + res.height() * res.width(),
+                      details::byteswap<T>);
+    }
+    return res;
+}
+
+////////////////////////////////////////////////////////////
+// Memory-mapped loader
+////////////////////////////////////////////////////////////
+
+template<typename T>
+MappedMatrix<T>::MappedMatrix(const std::string& path):
+    details::mapped_file_holder{ mapped_file(path) },
+    MatrixView<const T>(details::mapped_view<T>(file))
+{}
+
+template<typename T>
+auto MappedMatrix<T>::view() const
+    -> MatrixView<const T>
+{
+    return *this;
+}
+
+template<typename T>
+auto map_matrix(const std::string& path)
+    -> MappedMatrix<T>
+{
+    return MappedMatrix<T>(path);
+}
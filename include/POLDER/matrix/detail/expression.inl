@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+////////////////////////////////////////////////////////////
+// MatrixBinaryExpression
+////////////////////////////////////////////////////////////
+
+template<typename Lhs, typename Rhs, typename BinaryOperation>
+template<typename L, typename R>
+MatrixBinaryExpression<Lhs, Rhs, BinaryOperation>::MatrixBinaryExpression(L&& lhs, R&& rhs,
+                                                                          BinaryOperation op):
+    _lhs(std::forward<L>(lhs)),
+    _rhs(std::forward<R>(rhs)),
+    _op(op)
+{
+    POLDER_ASSERT(_lhs.height() == _rhs.height());
+    POLDER_ASSERT(_lhs.width() == _rhs.width());
+}
+
+template<typename Lhs, typename Rhs, typename BinaryOperation>
+inline auto MatrixBinaryExpression<Lhs, Rhs, BinaryOperation>::operator()(size_type y, size_type x) const
+    -> value_type
+{
+    return value_type(_op(_lhs(y, x), _rhs(y, x)));
+}
+
+template<typename Lhs, typename Rhs, typename BinaryOperation>
+inline auto MatrixBinaryExpression<Lhs, Rhs, BinaryOperation>::flat_value(size_type index) const
+    -> value_type
+{
+    return value_type(_op(details::flat_value(_lhs, index),
+                          details::flat_value(_rhs, index)));
+}
+
+template<typename Lhs, typename Rhs, typename BinaryOperation>
+inline auto MatrixBinaryExpression<Lhs, Rhs, BinaryOperation>::height() const
+    -> size_type
+{
+    return _lhs.height();
+}
+
+template<typename Lhs, typename Rhs, typename BinaryOperation>
+inline auto MatrixBinaryExpression<Lhs, Rhs, BinaryOperation>::width() const
+    -> size_type
+{
+    return _lhs.width();
+}
+
+template<typename Lhs, typename Rhs, typename BinaryOperation>
+inline auto MatrixBinaryExpression<Lhs, Rhs, BinaryOperation>::lhs() const
+    -> const std::decay_t<Lhs>&
+{
+    return _lhs;
+}
+
+template<typename Lhs, typename Rhs, typename BinaryOperation>
+inline auto MatrixBinaryExpression<Lhs, Rhs, BinaryOperation>::rhs() const
+    -> const std::decay_t<Rhs>&
+{
+    return _rhs;
+}
+
+////////////////////////////////////////////////////////////
+// MatrixUnaryExpression
+////////////////////////////////////////////////////////////
+
+template<typename Operand, typename UnaryOperation>
+template<typename T>
+MatrixUnaryExpression<Operand, UnaryOperation>::MatrixUnaryExpression(T&& operand,
+                                                                      UnaryOperation op):
+    _operand(std::forward<T>(operand)),
+    _op(op)
+{}
+
+template<typename Operand, typename UnaryOperation>
+inline auto MatrixUnaryExpression<Operand, UnaryOperation>::operator()(size_type y, size_type x) const
+    -> value_type
+{
+    return value_type(_op(_operand(y, x)));
+}
+
+template<typename Operand, typename UnaryOperation>
+inline auto MatrixUnaryExpression<Operand, UnaryOperation>::flat_value(size_type index) const
+    -> value_type
+{
+    return value_type(_op(details::flat_value(_operand, index)));
+}
+
+template<typename Operand, typename UnaryOperation>
+inline auto MatrixUnaryExpression<Operand, UnaryOperation>::height() const
+    -> size_type
+{
+    return _operand.height();
+}
+
+template<typename Operand, typename UnaryOperation>
+inline auto MatrixUnaryExpression<Operand, UnaryOperation>::width() const
+    -> size_type
+{
+    return _operand.width();
+}
+
+template<typename Operand, typename UnaryOperation>
+inline auto MatrixUnaryExpression<Operand, UnaryOperation>::operand() const
+    -> const std::decay_t<Operand>&
+{
+    return _operand;
+}
+
+namespace details
+{
+    template<typename T, typename Allocator>
+    inline auto flat_value(const Matrix<T, Allocator>& mat, std::size_t index)
+        -> T
+    {
+        return mat.data()[index];
+    }
+
+    template<typename Expression>
+    inline auto flat_value(const Expression& expr, std::size_t index)
+        -> decltype(expr.flat_value(index))
+    {
+        return expr.flat_value(index);
+    }
+
+    template<typename T, typename Allocator>
+    inline auto evaluate(const Matrix<T, Allocator>& mat)
+        -> const Matrix<T, Allocator>&
+    {
+        return mat;
+    }
+
+    template<typename Derived>
+    auto evaluate(const ImmutableMatrix<Derived>& expr)
+        -> Matrix<typename types_t<Derived>::value_type>
+    {
+        return Matrix<typename types_t<Derived>::value_type>(expr);
+    }
+
+    template<typename T, typename Expression, typename Function>
+    auto apply_expression(T* out, const Expression& expr, Function func, std::true_type)
+        -> void
+    {
+        const std::size_t size = expr.height() * expr.width();
+        for (std::size_t i = 0 ; i < size ; ++i)
+        {
+            func(out[i], flat_value(expr, i));
+        }
+    }
+
+    template<typename T, typename Expression, typename Function>
+    auto apply_expression(T* out, const Expression& expr, Function func, std::false_type)
+        -> void
+    {
+        for (std::size_t y = 0 ; y < expr.height() ; ++y)
+        {
+            for (std::size_t x = 0 ; x < expr.width() ; ++x)
+            {
+                func(*out++, expr(y, x));
+            }
+        }
+    }
+
+    template<typename T, typename Expression, typename Function>
+    inline auto apply_expression(T* out, const Expression& expr, Function func)
+        -> void
+    {
+        apply_expression(out, expr, func, has_flat_access<Expression>{});
+    }
+}
+
+////////////////////////////////////////////////////////////
+// Element-wise arithmetic operations
+////////////////////////////////////////////////////////////
+
+template<typename Lhs, typename Rhs, typename, typename, typename>
+auto operator+(Lhs&& lhs, Rhs&& rhs)
+    -> MatrixBinaryExpression<
+        details::expression_operand_t<Lhs>,
+        details::expression_operand_t<Rhs>,
+        std::plus<>
+    >
+{
+    return {
+        std::forward<Lhs>(lhs),
+        std::forward<Rhs>(rhs),
+        std::plus<>{}
+    };
+}
+
+template<typename Lhs, typename Rhs, typename, typename, typename>
+auto operator-(Lhs&& lhs, Rhs&& rhs)
+    -> MatrixBinaryExpression<
+        details::expression_operand_t<Lhs>,
+        details::expression_operand_t<Rhs>,
+        std::minus<>
+    >
+{
+    return {
+        std::forward<Lhs>(lhs),
+        std::forward<Rhs>(rhs),
+        std::minus<>{}
+    };
+}
+
+template<typename Operand, typename, typename>
+auto operator-(Operand&& operand)
+    -> MatrixUnaryExpression<
+        details::expression_operand_t<Operand>,
+        std::negate<>
+    >
+{
+    return {
+        std::forward<Operand>(operand),
+        std::negate<>{}
+    };
+}
+
+template<typename Operand, typename, typename>
+auto operator*(Operand&& operand, const typename types_t<std::decay_t<Operand>>::value_type& value)
+    -> MatrixUnaryExpression<
+        details::expression_operand_t<Operand>,
+        details::multiplies_by<typename types_t<std::decay_t<Operand>>::value_type>
+    >
+{
+    return {
+        std::forward<Operand>(operand),
+        { value }
+    };
+}
+
+template<typename Operand, typename, typename>
+auto operator*(const typename types_t<std::decay_t<Operand>>::value_type& value, Operand&& operand)
+    -> MatrixUnaryExpression<
+        details::expression_operand_t<Operand>,
+        details::multiplies_by<typename types_t<std::decay_t<Operand>>::value_type>
+    >
+{
+    return {
+        std::forward<Operand>(operand),
+        { value }
+    };
+}
+
+template<typename Operand, typename, typename>
+auto operator/(Operand&& operand, const typename types_t<std::decay_t<Operand>>::value_type& value)
+    -> MatrixUnaryExpression<
+        details::expression_operand_t<Operand>,
+        details::divides_by<typename types_t<std::decay_t<Operand>>::value_type>
+    >
+{
+    return {
+        std::forward<Operand>(operand),
+        { value }
+    };
+}
+
+////////////////////////////////////////////////////////////
+// Operations between any matrix types
+////////////////////////////////////////////////////////////
+
+template<typename Lhs, typename Rhs>
+auto operator*(const ImmutableMatrix<Lhs>& lhs, const ImmutableMatrix<Rhs>& rhs)
+    -> Matrix<typename types_t<Lhs>::value_type>
+{
+    return details::evaluate(lhs.derived()) * details::evaluate(rhs.derived());
+}
+
+template<typename Lhs, typename Rhs>
+auto operator==(const ImmutableMatrix<Lhs>& lhs, const ImmutableMatrix<Rhs>& rhs)
+    -> bool
+{
+    if (lhs.height() != rhs.height()
+        || lhs.width() != rhs.width())
+    {
+        return false;
+    }
+    for (std::size_t y = 0 ; y < lhs.height() ; ++y)
+    {
+        for (std::size_t x = 0 ; x < lhs.width() ; ++x)
+        {
+            if (lhs(y, x) != rhs(y, x))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template<typename Lhs, typename Rhs>
+inline auto operator!=(const ImmutableMatrix<Lhs>& lhs, const ImmutableMatrix<Rhs>& rhs)
+    -> bool
+{
+    return not (lhs == rhs);
+}
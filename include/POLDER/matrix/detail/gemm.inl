@@ -0,0 +1,646 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+namespace details
+{
+    ////////////////////////////////////////////////////////////
+    // Blocking parameters
+
+    // The packed block of the left operand (mc x kc) is meant
+    // to stay in the L2 cache while the packed panel of the
+    // right operand (kc x nc) is meant to stay in the L3 cache
+    constexpr std::size_t gemm_mc = 144;
+    constexpr std::size_t gemm_kc = 256;
+    constexpr std::size_t gemm_nc = 4096;
+
+    // Under this number of multiply-add operations, packing
+    // the operands costs more than it saves
+    constexpr std::size_t gemm_small_size = 32 * 32 * 32;
+
+    ////////////////////////////////////////////////////////////
+    // Micro-kernels
+
+    /**
+     * A micro-kernel computes c += a * b where a is a packed
+     * mr x kc micro-panel, b is a packed kc x nr micro-panel
+     * and c is a mr x nr row-major block.
+     *
+     * The packing buffers are aligned on default_alignment and
+     * nr is a multiple of the vector width, so the SIMD kernels
+     * read b with aligned loads.
+     */
+    template<typename T>
+    struct gemm_kernel
+    {
+        std::size_t mr;
+        std::size_t nr;
+        void (*run)(std::size_t kc, const T* a, const T* b,
+                    T* c, std::size_t ldc);
+    };
+
+    template<typename T, std::size_t MR, std::size_t NR>
+    auto gemm_kernel_generic(std::size_t kc, const T* a, const T* b,
+                             T* c, std::size_t ldc)
+        -> void
+    {
+        T acc[MR][NR] = {};
+        for (std::size_t p = 0 ; p < kc ; ++p)
+        {
+            for (std::size_t i = 0 ; i < MR ; ++i)
+            {
+                const T val = a[i];
+                for (std::size_t j = 0 ; j < NR ; ++j)
+                {
+                    acc[i][j] += val * b[j];
+                }
+            }
+            a += MR;
+            b += NR;
+        }
+
+        for (std::size_t i = 0 ; i < MR ; ++i)
+        {
+            for (std::size_t j = 0 ; j < NR ; ++j)
+            {
+                c[i*ldc+j] += acc[i][j];
+            }
+        }
+    }
+
+#if POLDER_X86_DISPATCH
+
+    // Thin wrappers around the intrinsics so that the same
+    // micro-kernel can be instantiated for float and double
+
+    struct avx2_double
+    {
+        using value_type = double;
+        using vector_type = __m256d;
+        static constexpr std::size_t width = 4;
+
+        POLDER_TARGET("avx2,fma")
+        static auto zero() -> vector_type { return _mm256_setzero_pd(); }
+        POLDER_TARGET("avx2,fma")
+        static auto load(const double* ptr) -> vector_type { return _mm256_loadu_pd(ptr); }
+        POLDER_TARGET("avx2,fma")
+        static auto load_aligned(const double* ptr) -> vector_type { return _mm256_load_pd(ptr); }
+        POLDER_TARGET("avx2,fma")
+        static auto broadcast(const double* ptr) -> vector_type { return _mm256_broadcast_sd(ptr); }
+        POLDER_TARGET("avx2,fma")
+        static auto store(double* ptr, vector_type val) -> void { _mm256_storeu_pd(ptr, val); }
+        POLDER_TARGET("avx2,fma")
+        static auto add(vector_type lhs, vector_type rhs) -> vector_type { return _mm256_add_pd(lhs, rhs); }
+        POLDER_TARGET("avx2,fma")
+        static auto fmadd(vector_type a, vector_type b, vector_type c) -> vector_type { return _mm256_fmadd_pd(a, b, c); }
+    };
+
+    struct avx2_float
+    {
+        using value_type = float;
+        using vector_type = __m256;
+        static constexpr std::size_t width = 8;
+
+        POLDER_TARGET("avx2,fma")
+        static auto zero() -> vector_type { return _mm256_setzero_ps(); }
+        POLDER_TARGET("avx2,fma")
+        static auto load(const float* ptr) -> vector_type { return _mm256_loadu_ps(ptr); }
+        POLDER_TARGET("avx2,fma")
+        static auto load_aligned(const float* ptr) -> vector_type { return _mm256_load_ps(ptr); }
+        POLDER_TARGET("avx2,fma")
+        static auto broadcast(const float* ptr) -> vector_type { return _mm256_broadcast_ss(ptr); }
+        POLDER_TARGET("avx2,fma")
+        static auto store(float* ptr, vector_type val) -> void { _mm256_storeu_ps(ptr, val); }
+        POLDER_TARGET("avx2,fma")
+        static auto add(vector_type lhs, vector_type rhs) -> vector_type { return _mm256_add_ps(lhs, rhs); }
+        POLDER_TARGET("avx2,fma")
+        static auto fmadd(vector_type a, vector_type b, vector_type c) -> vector_type { return _mm256_fmadd_ps(a, b, c); }
+    };
+
+    struct avx512_double
+    {
+        using value_type = double;
+        using vector_type = __m512d;
+        static constexpr std::size_t width = 8;
+
+        POLDER_TARGET("avx512f")
+        static auto zero() -> vector_type { return _mm512_setzero_pd(); }
+        POLDER_TARGET("avx512f")
+        static auto load(const double* ptr) -> vector_type { return _mm512_loadu_pd(ptr); }
+        POLDER_TARGET("avx512f")
+        static auto load_aligned(const double* ptr) -> vector_type { return _mm512_load_pd(ptr); }
+        POLDER_TARGET("avx512f")
+        static auto broadcast(const double* ptr) -> vector_type { return _mm512_set1_pd(*ptr); }
+        POLDER_TARGET("avx512f")
+        static auto store(double* ptr, vector_type val) -> void { _mm512_storeu_pd(ptr, val); }
+        POLDER_TARGET("avx512f")
+        static auto add(vector_type lhs, vector_type rhs) -> vector_type { return _mm512_add_pd(lhs, rhs); }
+        POLDER_TARGET("avx512f")
+        static auto fmadd(vector_type a, vector_type b, vector_type c) -> vector_type { return _mm512_fmadd_pd(a, b, c); }
+    };
+
+    struct avx512_float
+    {
+        using value_type = float;
+        using vector_type = __m512;
+        static constexpr std::size_t width = 16;
+
+        POLDER_TARGET("avx512f")
+        static auto zero() -> vector_type { return _mm512_setzero_ps(); }
+        POLDER_TARGET("avx512f")
+        static auto load(const float* ptr) -> vector_type { return _mm512_loadu_ps(ptr); }
+        POLDER_TARGET("avx512f")
+        static auto load_aligned(const float* ptr) -> vector_type { return _mm512_load_ps(ptr); }
+        POLDER_TARGET("avx512f")
+        static auto broadcast(const float* ptr) -> vector_type { return _mm512_set1_ps(*ptr); }
+        POLDER_TARGET("avx512f")
+        static auto store(float* ptr, vector_type val) -> void { _mm512_storeu_ps(ptr, val); }
+        POLDER_TARGET("avx512f")
+        static auto add(vector_type lhs, vector_type rhs) -> vector_type { return _mm512_add_ps(lhs, rhs); }
+        POLDER_TARGET("avx512f")
+        static auto fmadd(vector_type a, vector_type b, vector_type c) -> vector_type { return _mm512_fmadd_ps(a, b, c); }
+    };
+
+    // The two following kernels are identical except for their
+    // target attribute, which can not depend on a template
+    // parameter; MR rows times NV vectors of accumulators must
+    // fit in the vector registers, hence the unrolled loops
+
+    template<typename Simd, std::size_t MR, std::size_t NV>
+    POLDER_TARGET("avx2,fma")
+    auto gemm_kernel_avx2(std::size_t kc,
+                          const typename Simd::value_type* a,
+                          const typename Simd::value_type* b,
+                          typename Simd::value_type* c, std::size_t ldc)
+        -> void
+    {
+        using vector_type = typename Simd::vector_type;
+        constexpr std::size_t width = Simd::width;
+
+        vector_type acc[MR][NV];
+        #pragma GCC unroll 16
+        for (std::size_t i = 0 ; i < MR ; ++i)
+        {
+            #pragma GCC unroll 16
+            for (std::size_t v = 0 ; v < NV ; ++v)
+            {
+                acc[i][v] = Simd::zero();
+            }
+        }
+
+        for (std::size_t p = 0 ; p < kc ; ++p)
+        {
+            vector_type row[NV];
+            #pragma GCC unroll 16
+            for (std::size_t v = 0 ; v < NV ; ++v)
+            {
+                row[v] = Simd::load_aligned(b + v * width);
+            }
+            #pragma GCC unroll 16
+            for (std::size_t i = 0 ; i < MR ; ++i)
+            {
+                const vector_type val = Simd::broadcast(a + i);
+                #pragma GCC unroll 16
+                for (std::size_t v = 0 ; v < NV ; ++v)
+                {
+                    acc[i][v] = Simd::fmadd(val, row[v], acc[i][v]);
+                }
+            }
+            a += MR;
+            b += NV * width;
+        }
+
+        #pragma GCC unroll 16
+
+        for (std::size_t i = 0 ; i < MR ; ++i)
+        {
+            #pragma GCC unroll 16
+            for (std::size_t v = 0 ; v < NV ; ++v)
+            {
+                auto ptr = c + i * ldc + v * width;
+                Simd::store(ptr, Simd::add(Simd::load(ptr), acc[i][v]));
+            }
+        }
+    }
+
+    template<typename Simd, std::size_t MR, std::size_t NV>
+    POLDER_TARGET("avx512f")
+    auto gemm_kernel_avx512(std::size_t kc,
+                            const typename Simd::value_type* a,
+                            const typename Simd::value_type* b,
+                            typename Simd::value_type* c, std::size_t ldc)
+        -> void
+    {
+        using vector_type = typename Simd::vector_type;
+        constexpr std::size_t width = Simd::width;
+
+        vector_type acc[MR][NV];
+        #pragma GCC unroll 16
+        for (std::size_t i = 0 ; i < MR ; ++i)
+        {
+            #pragma GCC unroll 16
+            for (std::size_t v = 0 ; v < NV ; ++v)
+            {
+                acc[i][v] = Simd::zero();
+            }
+        }
+
+        for (std::size_t p = 0 ; p < kc ; ++p)
+        {
+            vector_type row[NV];
+            #pragma GCC unroll 16
+            for (std::size_t v = 0 ; v < NV ; ++v)
+            {
+                row[v] = Simd::load_aligned(b + v * width);
+            }
+            #pragma GCC unroll 16
+            for (std::size_t i = 0 ; i < MR ; ++i)
+            {
+                const vector_type val = Simd::broadcast(a + i);
+                #pragma GCC unroll 16
+                for (std::size_t v = 0 ; v < NV ; ++v)
+                {
+                    acc[i][v] = Simd::fmadd(val, row[v], acc[i][v]);
+                }
+            }
+            a += MR;
+            b += NV * width;
+        }
+
+        #pragma GCC unroll 16
+
+        for (std::size_t i = 0 ; i < MR ; ++i)
+        {
+            #pragma GCC unroll 16
+            for (std::size_t v = 0 ; v < NV ; ++v)
+            {
+                auto ptr = c + i * ldc + v * width;
+                Simd::store(ptr, Simd::add(Simd::load(ptr), acc[i][v]));
+            }
+        }
+    }
+
+    inline auto has_avx512()
+        -> bool
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx512f");
+    }
+
+    inline auto has_avx2()
+        -> bool
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2")
+            && __builtin_cpu_supports("fma");
+    }
+
+#endif
+
+    ////////////////////////////////////////////////////////////
+    // Micro-kernel selection
+
+    template<typename T>
+    struct gemm_kernel_selector
+    {
+        static auto select()
+            -> gemm_kernel<T>
+        {
+            return { 4, 4, &gemm_kernel_generic<T, 4, 4> };
+        }
+    };
+
+    template<>
+    struct gemm_kernel_selector<double>
+    {
+        static auto select()
+            -> gemm_kernel<double>
+        {
+#if POLDER_X86_DISPATCH
+            if (has_avx512())
+            {
+                return { 12, 16, &gemm_kernel_avx512<avx512_double, 12, 2> };
+            }
+            if (has_avx2())
+            {
+                return { 6, 8, &gemm_kernel_avx2<avx2_double, 6, 2> };
+            }
+#endif
+            return { 4, 4, &gemm_kernel_generic<double, 4, 4> };
+        }
+    };
+
+    template<>
+    struct gemm_kernel_selector<float>
+    {
+        static auto select()
+            -> gemm_kernel<float>
+        {
+#if POLDER_X86_DISPATCH
+            if (has_avx512())
+            {
+                return { 12, 32, &gemm_kernel_avx512<avx512_float, 12, 2> };
+            }
+            if (has_avx2())
+            {
+                return { 6, 16, &gemm_kernel_avx2<avx2_float, 6, 2> };
+            }
+#endif
+            return { 4, 4, &gemm_kernel_generic<float, 4, 4> };
+        }
+    };
+
+    template<typename T>
+    auto get_gemm_kernel()
+        -> const gemm_kernel<T>&
+    {
+        // The CPU is only queried once
+        static const gemm_kernel<T> kernel = gemm_kernel_selector<T>::select();
+        return kernel;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Packing functions
+
+    // Copies a mc x kc block of a into micro-panels of mr rows
+    // stored column after column, zero-padding the last one;
+    // the elements are negated when the product is subtracted
+    template<typename T>
+    auto gemm_pack_a(std::size_t mc, std::size_t kc,
+                     const T* a, std::size_t rsa, std::size_t csa,
+                     std::size_t mr, bool negate, T* buffer)
+        -> void
+    {
+        for (std::size_t i = 0 ; i < mc ; i += mr)
+        {
+            const std::size_t rows = std::min(mr, mc - i);
+            for (std::size_t p = 0 ; p < kc ; ++p)
+            {
+                std::size_t r = 0;
+                for ( ; r < rows ; ++r)
+                {
+                    const T& val = a[(i + r) * rsa + p * csa];
+                    *buffer++ = negate ? T(-val) : val;
+                }
+                for ( ; r < mr ; ++r)
+                {
+                    *buffer++ = T{};
+                }
+            }
+        }
+    }
+
+    // Copies a kc x nc panel of b into micro-panels of nr columns
+    // stored row after row, zero-padding the last one
+    template<typename T>
+    auto gemm_pack_b(std::size_t kc, std::size_t nc,
+                     const T* b, std::size_t rsb, std::size_t csb,
+                     std::size_t nr, T* buffer)
+        -> void
+    {
+        for (std::size_t j = 0 ; j < nc ; j += nr)
+        {
+            const std::size_t cols = std::min(nr, nc - j);
+            for (std::size_t p = 0 ; p < kc ; ++p)
+            {
+                const T* row = b + p * rsb + j * csb;
+                std::size_t c = 0;
+                for ( ; c < cols ; ++c)
+                {
+                    *buffer++ = row[c * csb];
+                }
+                for ( ; c < nr ; ++c)
+                {
+                    *buffer++ = T{};
+                }
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Multiplication algorithms
+
+    // Computes c += a * b for packed operands, calling the
+    // micro-kernel on every mr x nr tile of c
+    template<typename T>
+    auto gemm_macro_kernel(std::size_t mc, std::size_t nc, std::size_t kc,
+                           const T* packed_a, const T* packed_b,
+                           T* c, std::size_t ldc,
+                           const gemm_kernel<T>& kernel, T* tile)
+        -> void
+    {
+        const std::size_t mr = kernel.mr;
+        const std::size_t nr = kernel.nr;
+
+        for (std::size_t j = 0 ; j < nc ; j += nr)
+        {
+            const std::size_t cols = std::min(nr, nc - j);
+            for (std::size_t i = 0 ; i < mc ; i += mr)
+            {
+                const std::size_t rows = std::min(mr, mc - i);
+                const T* a = packed_a + i * kc;
+                const T* b = packed_b + j * kc;
+
+                if (rows == mr && cols == nr)
+                {
+                    kernel.run(kc, a, b, c + i * ldc + j, ldc);
+                }
+                else
+                {
+                    // Edge tile: compute in a buffer first
+                    std::fill(tile, tile + mr * nr, T{});
+                    kernel.run(kc, a, b, tile, nr);
+                    for (std::size_t y = 0 ; y < rows ; ++y)
+                    {
+                        for (std::size_t x = 0 ; x < cols ; ++x)
+                        {
+                            c[(i + y) * ldc + j + x] += tile[y * nr + x];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Straightforward algorithm for the small products,
+    // with a loop order friendly to row-major storage
+    template<typename T>
+    auto gemm_small(std::size_t m, std::size_t n, std::size_t k,
+                    const T* a, std::size_t rsa, std::size_t csa,
+                    const T* b, std::size_t rsb, std::size_t csb,
+                    T* c, std::size_t ldc, bool negate)
+        -> void
+    {
+        for (std::size_t i = 0 ; i < m ; ++i)
+        {
+            T* row = c + i * ldc;
+            for (std::size_t p = 0 ; p < k ; ++p)
+            {
+                const T val = negate ? T(-a[i * rsa + p * csa]) : a[i * rsa + p * csa];
+                const T* brow = b + p * rsb;
+                for (std::size_t j = 0 ; j < n ; ++j)
+                {
+                    row[j] += val * brow[j * csb];
+                }
+            }
+        }
+    }
+
+    inline auto gemm_nb_threads(execution::sequenced_policy)
+        -> std::size_t
+    {
+        return 1;
+    }
+
+    inline auto gemm_nb_threads(const execution::parallel_policy& block_policy)
+        -> std::size_t
+    {
+        return block_policy.threshold() == 0 ? block_policy.pool().size() + 1 : 1;
+    }
+
+    template<typename ExecutionPolicy, typename T>
+    auto gemm_strided(const ExecutionPolicy& policy,
+                      std::size_t m, std::size_t n, std::size_t k,
+                      const T* a, std::size_t rsa, std::size_t csa,
+                      const T* b, std::size_t rsb, std::size_t csb,
+                      T* c, std::size_t ldc, gemm_mode mode)
+        -> void
+    {
+        if (mode == gemm_mode::assign)
+        {
+            for (std::size_t i = 0 ; i < m ; ++i)
+            {
+                std::fill(c + i * ldc, c + i * ldc + n, T{});
+            }
+        }
+        if (m == 0 || n == 0 || k == 0)
+        {
+            return;
+        }
+
+        // The kernels only accumulate: subtracting the product
+        // is adding the product of -a and b
+        const bool negate = (mode == gemm_mode::subtract);
+
+        if (m * n * k <= gemm_small_size)
+        {
+            gemm_small(m, n, k, a, rsa, csa, b, rsb, csb, c, ldc, negate);
+            return;
+        }
+
+        const gemm_kernel<T>& kernel = get_gemm_kernel<T>();
+        const std::size_t mr = kernel.mr;
+        const std::size_t nr = kernel.nr;
+
+        // Whether the blocks are processed in parallel is
+        // decided once for the whole product
+        const auto block_policy = execution::for_work(policy, m * n * k);
+        const std::size_t nb_threads = gemm_nb_threads(block_policy);
+
+        // Smaller blocks of a give enough work to every thread
+        const std::size_t rows = (nb_threads == 1) ? m : (m + 4 * nb_threads - 1) / (4 * nb_threads);
+        const std::size_t mc_max = std::min(gemm_mc, (rows + mr - 1) / mr * mr);
+        const std::size_t nb_blocks = (m + mc_max - 1) / mc_max;
+
+        // Only allocate what the operands actually need
+        const std::size_t nc_max = std::min(gemm_nc, (n + nr - 1) / nr * nr);
+        const std::size_t kc_max = std::min(gemm_kc, k);
+        std::vector<T, aligned_allocator<T>> packed_b(kc_max * nc_max);
+
+        for (std::size_t jc = 0 ; jc < n ; jc += gemm_nc)
+        {
+            const std::size_t nc = std::min(gemm_nc, n - jc);
+            for (std::size_t pc = 0 ; pc < k ; pc += gemm_kc)
+            {
+                const std::size_t kc = std::min(gemm_kc, k - pc);
+
+                execution::parallel_for(block_policy, (nc + nr - 1) / nr,
+                    [&](std::size_t begin, std::size_t end)
+                    {
+                        const std::size_t first = begin * nr;
+                        const std::size_t last = std::min(end * nr, nc);
+                        gemm_pack_b(kc, last - first, b + pc * rsb + (jc + first) * csb,
+                                    rsb, csb, nr, packed_b.data() + first * kc);
+                    }
+                );
+
+                execution::parallel_for(block_policy, nb_blocks,
+                    [&](std::size_t begin, std::size_t end)
+                    {
+                        std::vector<T, aligned_allocator<T>> packed_a(mc_max * kc);
+                        std::vector<T, aligned_allocator<T>> tile(mr * nr);
+                        for (std::size_t block = begin ; block < end ; ++block)
+                        {
+                            const std::size_t ic = block * mc_max;
+                            const std::size_t mc = std::min(mc_max, m - ic);
+                            gemm_pack_a(mc, kc, a + ic * rsa + pc * csa, rsa, csa,
+                                        mr, negate, packed_a.data());
+                            gemm_macro_kernel(mc, nc, kc,
+                                              packed_a.data(), packed_b.data(),
+                                              c + ic * ldc + jc, ldc,
+                                              kernel, tile.data());
+                        }
+                    }
+                );
+            }
+        }
+    }
+}
+
+template<typename T>
+auto gemm(std::size_t m, std::size_t n, std::size_t k,
+          const T* a, std::size_t lda,
+          const T* b, std::size_t ldb,
+          T* c, std::size_t ldc,
+          gemm_mode mode)
+    -> void
+{
+    details::gemm_strided(execution::seq, m, n, k,
+                          a, lda, 1,
+                          b, ldb, 1,
+                          c, ldc, mode);
+}
+
+template<typename ExecutionPolicy, typename T>
+auto gemm(ExecutionPolicy&& policy,
+          std::size_t m, std::size_t n, std::size_t k,
+          const T* a, std::size_t lda,
+          const T* b, std::size_t ldb,
+          T* c, std::size_t ldc,
+          gemm_mode mode)
+    -> void
+{
+    details::gemm_strided(policy, m, n, k,
+                          a, lda, 1,
+                          b, ldb, 1,
+                          c, ldc, mode);
+}
+
+template<typename ExecutionPolicy, typename T>
+auto gemm(ExecutionPolicy&& policy,
+          std::size_t m, std::size_t n, std::size_t k,
+          const T* a, std::size_t rsa, std::size_t csa,
+          const T* b, std::size_t rsb, std::size_t csb,
+          T* c, std::size_t ldc,
+          gemm_mode mode)
+    -> void
+{
+    details::gemm_strided(policy, m, n, k,
+                          a, rsa, csa,
+                          b, rsb, csb,
+                          c, ldc, mode);
+}
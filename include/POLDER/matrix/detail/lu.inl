@@ -0,0 +1,516 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+namespace details
+{
+    // Number of columns factorized at once; the trailing
+    // updates are done with gemm between two panels
+    constexpr std::size_t lu_block_size = 64;
+}
+
+////////////////////////////////////////////////////////////
+// Construction
+////////////////////////////////////////////////////////////
+
+template<typename T>
+LUDecomposition<T>::LUDecomposition(const Matrix<T>& mat)
+{
+    decompose(mat);
+}
+
+template<typename T>
+LUDecomposition<T>::LUDecomposition(Matrix<T>&& mat)
+{
+    decompose(std::move(mat));
+}
+
+template<typename T>
+auto LUDecomposition<T>::decompose(const Matrix<T>& mat)
+    -> void
+{
+    POLDER_ASSERT(mat.is_square());
+    _lu = mat;
+    factorize();
+}
+
+template<typename T>
+auto LUDecomposition<T>::decompose(Matrix<T>&& mat)
+    -> void
+{
+    POLDER_ASSERT(mat.is_square());
+    _lu = std::move(mat);
+    factorize();
+}
+
+////////////////////////////////////////////////////////////
+// Results
+////////////////////////////////////////////////////////////
+
+template<typename T>
+auto LUDecomposition<T>::size() const
+    -> size_type
+{
+    return _lu.height();
+}
+
+template<typename T>
+auto LUDecomposition<T>::is_singular() const
+    -> bool
+{
+    return _singular;
+}
+
+template<typename T>
+auto LUDecomposition<T>::determinant() const
+    -> value_type
+{
+    if (_singular)
+    {
+        return T(0);
+    }
+
+    const size_type n = size();
+    T res(1);
+    for (size_type i = 0 ; i < n ; ++i)
+    {
+        res *= _lu(i, i);
+    }
+    return _odd_swaps ? -res : res;
+}
+
+template<typename T>
+template<typename Allocator>
+auto LUDecomposition<T>::solve_in_place(Matrix<T, Allocator>& b) const
+    -> void
+{
+    POLDER_ASSERT(b.height() == size());
+    POLDER_ASSERT(not _singular);
+
+    const size_type n = size();
+    const size_type m = b.width();
+    const T* lu = _lu.data();
+    T* x = b.data();
+
+    // Apply the row interchanges
+    for (size_type i = 0 ; i < n ; ++i)
+    {
+        if (_pivots[i] != i)
+        {
+            std::swap_ranges(x + i * m, x + (i + 1) * m, x + _pivots[i] * m);
+        }
+    }
+
+    // Forward substitution with L
+    for (size_type i = 1 ; i < n ; ++i)
+    {
+        T* row_i = x + i * m;
+        for (size_type j = 0 ; j < i ; ++j)
+        {
+            const T factor = lu[i * n + j];
+            if (factor == T(0)) continue;
+
+            const T* row_j = x + j * m;
+            for (size_type c = 0 ; c < m ; ++c)
+            {
+                row_i[c] -= factor * row_j[c];
+            }
+        }
+    }
+
+    // Backward substitution with U
+    for (size_type i = n ; i-- > 0 ;)
+    {
+        T* row_i = x + i * m;
+        for (size_type j = i + 1 ; j < n ; ++j)
+        {
+            const T factor = lu[i * n + j];
+            if (factor == T(0)) continue;
+
+            const T* row_j = x + j * m;
+            for (size_type c = 0 ; c < m ; ++c)
+            {
+                row_i[c] -= factor * row_j[c];
+            }
+        }
+
+        const T pivot = lu[i * n + i];
+        for (size_type c = 0 ; c < m ; ++c)
+        {
+            row_i[c] /= pivot;
+        }
+    }
+}
+
+template<typename T>
+template<typename Allocator>
+auto LUDecomposition<T>::solve(Matrix<T, Allocator> b) const
+    -> Matrix<T, Allocator>
+{
+    solve_in_place(b);
+    return b;
+}
+
+template<typename T>
+auto LUDecomposition<T>::inverse() const
+    -> Matrix<T>
+{
+    return solve(Matrix<T>::identity(size()));
+}
+
+template<typename T>
+auto LUDecomposition<T>::packed() const
+    -> const Matrix<T>&
+{
+    return _lu;
+}
+
+template<typename T>
+auto LUDecomposition<T>::pivots() const
+    -> const std::vector<size_type>&
+{
+    return _pivots;
+}
+
+////////////////////////////////////////////////////////////
+// Factorization
+////////////////////////////////////////////////////////////
+
+template<typename T>
+auto LUDecomposition<T>::factorize()
+    -> void
+{
+    const size_type n = size();
+    const size_type nb = details::lu_block_size;
+    _pivots.resize(n);
+    _singular = false;
+    _odd_swaps = false;
+
+    if (n <= 2 * nb)
+    {
+        // Not worth blocking
+        factorize_panel(0, n);
+        return;
+    }
+
+    T* base = _lu.data();
+    for (size_type k = 0 ; k < n ; k += nb)
+    {
+        const size_type end = std::min(k + nb, n);
+        factorize_panel(k, end);
+        if (end == n) break;
+
+        // Compute the block row of U right of the panel
+        for (size_type j = k ; j < end ; ++j)
+        {
+            const T* row_j = base + j * n;
+            for (size_type i = j + 1 ; i < end ; ++i)
+            {
+                T* row_i = base + i * n;
+                const T factor = row_i[j];
+                if (factor == T(0)) continue;
+
+                for (size_type c = end ; c < n ; ++c)
+                {
+                    row_i[c] -= factor * row_j[c];
+                }
+            }
+        }
+
+        // Update the trailing submatrix in place: A22 -= L21 * U12,
+        // the three blocks do not overlap
+        const size_type rest = n - end;
+        gemm(rest, rest, end - k,
+             base + end * n + k, n,
+             base + k * n + end, n,
+             base + end * n + end, n,
+             gemm_mode::subtract);
+    }
+}
+
+template<typename T>
+auto LUDecomposition<T>::factorize_panel(size_type begin, size_type end)
+    -> void
+{
+    using std::abs;
+
+    const size_type n = size();
+    T* base = _lu.data();
+
+    for (size_type j = begin ; j < end ; ++j)
+    {
+        // Find the greatest pivot in the column
+        size_type pivot_row = j;
+        auto greatest = abs(base[j * n + j]);
+        for (size_type i = j + 1 ; i < n ; ++i)
+        {
+            auto value = abs(base[i * n + j]);
+            if (greatest < value)
+            {
+                greatest = value;
+                pivot_row = i;
+            }
+        }
+
+        _pivots[j] = pivot_row;
+        if (pivot_row != j)
+        {
+            swap_rows(j, pivot_row);
+            _odd_swaps = not _odd_swaps;
+        }
+
+        const T* row_j = base + j * n;
+        const T pivot = row_j[j];
+        if (pivot == T(0))
+        {
+            // The column is already eliminated
+            _singular = true;
+            continue;
+        }
+
+        // Eliminate the column below the pivot
+        for (size_type i = j + 1 ; i < n ; ++i)
+        {
+            T* row_i = base + i * n;
+            if (row_i[j] == T(0)) continue;
+            row_i[j] /= pivot;
+            const T factor = row_i[j];
+
+            for (size_type c = j + 1 ; c < end ; ++c)
+            {
+                row_i[c] -= factor * row_j[c];
+            }
+        }
+    }
+}
+
+template<typename T>
+auto LUDecomposition<T>::swap_rows(size_type row1, size_type row2)
+    -> void
+{
+    const size_type n = size();
+    T* base = _lu.data();
+    std::swap_ranges(base + row1 * n, base + (row1 + 1) * n, base + row2 * n);
+}
+
+////////////////////////////////////////////////////////////
+// Linear systems
+////////////////////////////////////////////////////////////
+
+template<typename T, typename Allocator>
+auto solve(const Matrix<T, Allocator>& a, Matrix<T, Allocator> b)
+    -> Matrix<T, Allocator>
+{
+    return LUDecomposition<T>(a).solve(std::move(b));
+}
+
+namespace details
+{
+    ////////////////////////////////////////////////////////////
+    // Algorithms used by Matrix depending on the element type
+
+    /**
+     * Bareiss algorithm: fraction-free Gaussian elimination
+     * where every division is exact, which computes the
+     * determinant of an integer matrix in O(n³) without
+     * rounding errors.
+     */
+    template<typename T, typename Allocator>
+    auto bareiss_determinant(Matrix<T, Allocator> mat)
+        -> T
+    {
+        POLDER_ASSERT(mat.is_square());
+
+        const std::size_t n = mat.height();
+        if (n == 0)
+        {
+            return T(1);
+        }
+
+        T* base = mat.data();
+        T previous(1);
+        bool negate = false;
+        for (std::size_t k = 0 ; k + 1 < n ; ++k)
+        {
+            T* row_k = base + k * n;
+            if (row_k[k] == T(0))
+            {
+                std::size_t pivot_row = k + 1;
+                while (pivot_row < n && base[pivot_row * n + k] == T(0))
+                {
+                    ++pivot_row;
+                }
+                if (pivot_row == n)
+                {
+                    return T(0);
+                }
+                std::swap_ranges(row_k, row_k + n, base + pivot_row * n);
+                negate = not negate;
+            }
+
+            const T pivot = row_k[k];
+            for (std::size_t i = k + 1 ; i < n ; ++i)
+            {
+                T* row_i = base + i * n;
+                const T factor = row_i[k];
+                for (std::size_t j = k + 1 ; j < n ; ++j)
+                {
+                    row_i[j] = (row_i[j] * pivot - factor * row_k[j]) / previous;
+                }
+            }
+            previous = pivot;
+        }
+
+        const T res = base[n * n - 1];
+        return negate ? T(-res) : res;
+    }
+
+    template<typename T, typename Allocator>
+    auto compute_determinant(const Matrix<T, Allocator>& mat, std::true_type)
+        -> T
+    {
+        return bareiss_determinant(mat);
+    }
+
+    template<typename T, typename Allocator>
+    auto compute_determinant(const Matrix<T, Allocator>& mat, std::false_type)
+        -> T
+    {
+        return LUDecomposition<T>(mat).determinant();
+    }
+
+    /**
+     * Fraction-free Gauss-Jordan elimination of [mat | I]:
+     * the same steps as bareiss_determinant, except that the
+     * rows above the pivot are also eliminated. The left block
+     * ends up as d*I and the right block as d*inverse(mat),
+     * where d is the last pivot, so the determinant and the
+     * adjugate of an integer matrix are computed together in
+     * O(n³) without rounding errors. Returns the determinant,
+     * adj is left unspecified when it is 0.
+     */
+    template<typename T, typename Allocator>
+    auto bareiss_adjugate(Matrix<T, Allocator> mat, Matrix<T, Allocator>& adj)
+        -> T
+    {
+        POLDER_ASSERT(mat.is_square());
+
+        const std::size_t n = mat.height();
+        adj = Matrix<T, Allocator>::identity(n, mat.get_allocator());
+        if (n == 0)
+        {
+            return T(1);
+        }
+
+        T* base = mat.data();
+        T* adj_base = adj.data();
+        T previous(1);
+        bool negate = false;
+        for (std::size_t k = 0 ; k < n ; ++k)
+        {
+            T* row_k = base + k * n;
+            T* adj_row_k = adj_base + k * n;
+            if (row_k[k] == T(0))
+            {
+                std::size_t pivot_row = k + 1;
+                while (pivot_row < n && base[pivot_row * n + k] == T(0))
+                {
+                    ++pivot_row;
+                }
+                if (pivot_row == n)
+                {
+                    return T(0);
+                }
+                std::swap_ranges(row_k, row_k + n, base + pivot_row * n);
+                std::swap_ranges(adj_row_k, adj_row_k + n, adj_base + pivot_row * n);
+                negate = not negate;
+            }
+
+            const T pivot = row_k[k];
+            for (std::size_t i = 0 ; i < n ; ++i)
+            {
+                if (i == k) continue;
+
+                T* row_i = base + i * n;
+                T* adj_row_i = adj_base + i * n;
+                const T factor = row_i[k];
+                // Only the columns of the left block right of
+                // the pivot are still needed
+                for (std::size_t j = k + 1 ; j < n ; ++j)
+                {
+                    row_i[j] = (row_i[j] * pivot - factor * row_k[j]) / previous;
+                }
+                for (std::size_t j = 0 ; j < n ; ++j)
+                {
+                    adj_row_i[j] = (adj_row_i[j] * pivot - factor * adj_row_k[j]) / previous;
+                }
+            }
+            previous = pivot;
+        }
+
+        // The row interchanges change the sign of the last
+        // pivot but not the product of the row operations
+        // with mat, which is d*inverse(mat)
+        if (negate)
+        {
+            for (std::size_t i = 0 ; i < n * n ; ++i)
+            {
+                adj_base[i] = -adj_base[i];
+            }
+            return T(-previous);
+        }
+        return previous;
+    }
+
+    template<typename T, typename Allocator>
+    auto compute_inverse(const Matrix<T, Allocator>& mat, std::true_type)
+        -> Matrix<T, Allocator>
+    {
+        // Exact adjugate formula, the division
+        // truncates unless det is 1 or -1
+        Matrix<T, Allocator> res(mat.get_allocator());
+        const T det = bareiss_adjugate(mat, res);
+        POLDER_ASSERT(det != 0);
+        return res /= det;
+    }
+
+    template<typename T, typename Allocator>
+    auto compute_inverse(const Matrix<T, Allocator>& mat, std::false_type)
+        -> Matrix<T, Allocator>
+    {
+        LUDecomposition<T> lu(mat);
+        POLDER_ASSERT(not lu.is_singular());
+        return lu.solve(Matrix<T, Allocator>::identity(mat.height(), mat.get_allocator()));
+    }
+
+    template<typename T, typename Allocator>
+    auto divide_assign(Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs, std::true_type)
+        -> void
+    {
+        lhs *= inverse(rhs);
+    }
+
+    template<typename T, typename Allocator>
+    auto divide_assign(Matrix<T, Allocator>& lhs, const Matrix<T, Allocator>& rhs, std::false_type)
+        -> void
+    {
+        // x = lhs * inverse(rhs) is the solution of
+        // transpose(rhs) * transpose(x) = transpose(lhs)
+        LUDecomposition<T> lu(transpose(rhs));
+        lhs = transpose(lu.solve(transpose(lhs)));
+    }
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+namespace details
+{
+    /**
+     * Square matrices multiplied in place: the products are
+     * computed into a scratch buffer which is then swapped
+     * with the destination, so that the buffers ping-pong
+     * between the destination and the scratch without any
+     * allocation.
+     */
+    template<typename T, typename Allocator>
+    class square_workspace
+    {
+        public:
+
+            square_workspace(std::size_t size, const Allocator& alloc):
+                _scratch(size, size, alloc)
+            {}
+
+            // lhs = lhs * rhs
+            template<typename ExecutionPolicy>
+            auto multiply_assign(ExecutionPolicy&& policy,
+                                 Matrix<T, Allocator>& lhs,
+                                 const Matrix<T, Allocator>& rhs)
+                -> void
+            {
+                multiply_into(policy, lhs, rhs);
+                std::swap(lhs, _scratch);
+            }
+
+            // rhs = lhs * rhs
+            template<typename ExecutionPolicy>
+            auto multiply_left(ExecutionPolicy&& policy,
+                               const Matrix<T, Allocator>& lhs,
+                               Matrix<T, Allocator>& rhs)
+                -> void
+            {
+                multiply_into(policy, lhs, rhs);
+                std::swap(rhs, _scratch);
+            }
+
+            // mat = mat * mat
+            template<typename ExecutionPolicy>
+            auto square(ExecutionPolicy&& policy, Matrix<T, Allocator>& mat)
+                -> void
+            {
+                multiply_assign(policy, mat, mat);
+            }
+
+        private:
+
+            template<typename ExecutionPolicy>
+            auto multiply_into(ExecutionPolicy&& policy,
+                               const Matrix<T, Allocator>& lhs,
+                               const Matrix<T, Allocator>& rhs)
+                -> void
+            {
+                const std::size_t size = _scratch.height();
+                gemm(policy, size, size, size,
+                     lhs.data(), size,
+                     rhs.data(), size,
+                     _scratch.data(), size);
+            }
+
+            Matrix<T, Allocator> _scratch;
+    };
+
+    template<typename T, typename Allocator>
+    auto norm_inf(const Matrix<T, Allocator>& mat)
+        -> T
+    {
+        T res{};
+        for (const auto& row: mat)
+        {
+            T sum{};
+            for (const auto& value: row)
+            {
+                sum += std::abs(value);
+            }
+            res = std::max(res, sum);
+        }
+        return res;
+    }
+}
+
+template<typename T, typename Allocator>
+auto matrix_pow(const Matrix<T, Allocator>& mat, std::size_t exponent)
+    -> Matrix<T, Allocator>
+{
+    return matrix_pow(execution::seq, mat, exponent);
+}
+
+template<typename ExecutionPolicy, typename T, typename Allocator>
+auto matrix_pow(ExecutionPolicy&& policy, const Matrix<T, Allocator>& mat,
+                std::size_t exponent)
+    -> Matrix<T, Allocator>
+{
+    POLDER_ASSERT(mat.is_square());
+
+    const std::size_t size = mat.height();
+    if (exponent == 0)
+    {
+        return Matrix<T, Allocator>::identity(size, mat.get_allocator());
+    }
+
+    details::square_workspace<T, Allocator> workspace(size, mat.get_allocator());
+    Matrix<T, Allocator> base = mat;
+
+    // The result starts as the lowest set bit power
+    // instead of the identity, which saves a product
+    while ((exponent & 1u) == 0)
+    {
+        workspace.square(policy, base);
+        exponent >>= 1u;
+    }
+    Matrix<T, Allocator> res = base;
+    exponent >>= 1u;
+
+    while (exponent != 0)
+    {
+        workspace.square(policy, base);
+        if ((exponent & 1u) != 0)
+        {
+            workspace.multiply_assign(policy, res, base);
+        }
+        exponent >>= 1u;
+    }
+    return res;
+}
+
+template<typename T, typename Allocator>
+auto matrix_exp(const Matrix<T, Allocator>& mat)
+    -> Matrix<T, Allocator>
+{
+    return matrix_exp(execution::seq, mat);
+}
+
+template<typename ExecutionPolicy, typename T, typename Allocator>
+auto matrix_exp(ExecutionPolicy&& policy, const Matrix<T, Allocator>& mat)
+    -> Matrix<T, Allocator>
+{
+    static_assert(std::is_floating_point<T>::value,
+                  "matrix_exp only handles floating point matrices");
+    POLDER_ASSERT(mat.is_square());
+
+    // Degree of the Padé approximant
+    constexpr int q = 6;
+
+    const std::size_t size = mat.height();
+    const auto& alloc = mat.get_allocator();
+
+    // Scale the matrix so that its norm is at most 1/2
+    int scale = 0;
+    const T norm = details::norm_inf(mat);
+    if (norm > T(0.5))
+    {
+        scale = std::max(0, static_cast<int>(std::floor(std::log2(norm))) + 2);
+    }
+    Matrix<T, Allocator> a = mat;
+    a *= std::ldexp(T(1), -scale);
+
+    // N = sum(c_k * A^k) and D = sum((-1)^k * c_k * A^k)
+    // where c_k are the Padé coefficients
+    details::square_workspace<T, Allocator> workspace(size, alloc);
+    Matrix<T, Allocator> power = a;
+    Matrix<T, Allocator> numerator = Matrix<T, Allocator>::identity(size, alloc);
+    Matrix<T, Allocator> denominator = Matrix<T, Allocator>::identity(size, alloc);
+
+    T coeff = T(0.5);
+    numerator += coeff * a;
+    denominator -= coeff * a;
+    for (int k = 2 ; k <= q ; ++k)
+    {
+        coeff *= T(q - k + 1) / T(k * (2 * q - k + 1));
+        workspace.multiply_left(policy, a, power);
+        numerator += coeff * power;
+        if (k % 2 == 0)
+        {
+            denominator += coeff * power;
+        }
+        else
+        {
+            denominator -= coeff * power;
+        }
+    }
+
+    // exp(A / 2^s) ~= D^-1 * N, then undo the scaling
+    Matrix<T, Allocator> res = solve(denominator, std::move(numerator));
+    for (int k = 0 ; k < scale ; ++k)
+    {
+        workspace.square(policy, res);
+    }
+    return res;
+}
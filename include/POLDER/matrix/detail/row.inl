@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+////////////////////////////////////////////////////////////
+// MatrixRow constructors
+////////////////////////////////////////////////////////////
+
+template<typename T>
+inline MatrixRow<T>::MatrixRow(size_type size, T* data_addr):
+    _size(size),
+    _data(data_addr)
+{}
+
+template<typename T>
+template<typename U, typename>
+inline MatrixRow<T>::MatrixRow(const MatrixRow<U>& other):
+    _size(other.size()),
+    _data(other.data())
+{}
+
+////////////////////////////////////////////////////////////
+// MatrixRow operators
+////////////////////////////////////////////////////////////
+
+template<typename T>
+inline auto MatrixRow<T>::operator[](size_type index) const
+    -> reference
+{
+    return _data[index];
+}
+
+////////////////////////////////////////////////////////////
+// MatrixRow functions
+////////////////////////////////////////////////////////////
+
+// Iterators
+template<typename T>
+inline auto MatrixRow<T>::begin() const
+    -> iterator
+{
+    return _data;
+}
+
+template<typename T>
+inline auto MatrixRow<T>::cbegin() const
+    -> const_iterator
+{
+    return _data;
+}
+
+template<typename T>
+inline auto MatrixRow<T>::end() const
+    -> iterator
+{
+    return _data + _size;
+}
+
+template<typename T>
+inline auto MatrixRow<T>::cend() const
+    -> const_iterator
+{
+    return _data + _size;
+}
+
+template<typename T>
+inline auto MatrixRow<T>::rbegin() const
+    -> reverse_iterator
+{
+    return reverse_iterator(end());
+}
+
+template<typename T>
+inline auto MatrixRow<T>::crbegin() const
+    -> const_reverse_iterator
+{
+    return const_reverse_iterator(cend());
+}
+
+template<typename T>
+inline auto MatrixRow<T>::rend() const
+    -> reverse_iterator
+{
+    return reverse_iterator(begin());
+}
+
+template<typename T>
+inline auto MatrixRow<T>::crend() const
+    -> const_reverse_iterator
+{
+    return const_reverse_iterator(cbegin());
+}
+
+// Accessors
+template<typename T>
+inline auto MatrixRow<T>::data() const
+    -> pointer
+{
+    return _data;
+}
+
+// Capacity
+template<typename T>
+inline auto MatrixRow<T>::size() const
+    -> size_type
+{
+    return _size;
+}
+
+////////////////////////////////////////////////////////////
+// MatrixRowIterator constructors
+////////////////////////////////////////////////////////////
+
+template<typename T>
+inline MatrixRowIterator<T>::MatrixRowIterator(T* data, std::size_t width,
+                                               difference_type index):
+    MatrixRowIterator(data, width, index, width)
+{}
+
+template<typename T>
+inline MatrixRowIterator<T>::MatrixRowIterator(T* data, std::size_t width,
+                                               difference_type index,
+                                               std::size_t stride):
+    _data(data),
+    _width(width),
+    _index(index),
+    _stride(stride)
+{}
+
+template<typename T>
+template<typename U, typename>
+inline MatrixRowIterator<T>::MatrixRowIterator(const MatrixRowIterator<U>& other):
+    _data(other.data()),
+    _width(other.width()),
+    _index(other.index()),
+    _stride(other.stride())
+{}
+
+////////////////////////////////////////////////////////////
+// MatrixRowIterator members access
+////////////////////////////////////////////////////////////
+
+template<typename T>
+inline auto MatrixRowIterator<T>::data() const
+    -> T*
+{
+    return _data;
+}
+
+template<typename T>
+inline auto MatrixRowIterator<T>::width() const
+    -> std::size_t
+{
+    return _width;
+}
+
+template<typename T>
+inline auto MatrixRowIterator<T>::index() const
+    -> difference_type
+{
+    return _index;
+}
+
+template<typename T>
+inline auto MatrixRowIterator<T>::stride() const
+    -> std::size_t
+{
+    return _stride;
+}
+
+////////////////////////////////////////////////////////////
+// MatrixRowIterator element access
+////////////////////////////////////////////////////////////
+
+template<typename T>
+inline auto MatrixRowIterator<T>::operator*() const
+    -> reference
+{
+    return { _width, _data + _index * difference_type(_stride) };
+}
+
+template<typename T>
+inline auto MatrixRowIterator<T>::operator->() const
+    -> pointer
+{
+    return { **this };
+}
+
+template<typename T>
+inline auto MatrixRowIterator<T>::operator[](difference_type n) const
+    -> reference
+{
+    return { _width, _data + (_index + n) * difference_type(_stride) };
+}
+
+////////////////////////////////////////////////////////////
+// MatrixRowIterator increment/decrement operators
+////////////////////////////////////////////////////////////
+
+template<typename T>
+inline auto MatrixRowIterator<T>::operator++()
+    -> MatrixRowIterator&
+{
+    ++_index;
+    return *this;
+}
+
+template<typename T>
+inline auto MatrixRowIterator<T>::operator++(int)
+    -> MatrixRowIterator
+{
+    auto tmp = *this;
+    operator++();
+    return tmp;
+}
+
+template<typename T>
+inline auto MatrixRowIterator<T>::operator--()
+    -> MatrixRowIterator&
+{
+    --_index;
+    return *this;
+}
+
+template<typename T>
+inline auto MatrixRowIterator<T>::operator--(int)
+    -> MatrixRowIterator
+{
+    auto tmp = *this;
+    operator--();
+    return tmp;
+}
+
+template<typename T>
+inline auto MatrixRowIterator<T>::operator+=(difference_type n)
+    -> MatrixRowIterator&
+{
+    _index += n;
+    return *this;
+}
+
+template<typename T>
+inline auto MatrixRowIterator<T>::operator-=(difference_type n)
+    -> MatrixRowIterator&
+{
+    _index -= n;
+    return *this;
+}
+
+////////////////////////////////////////////////////////////
+// Arithmetic operators
+////////////////////////////////////////////////////////////
+
+template<typename T>
+inline auto operator+(MatrixRowIterator<T> it, std::ptrdiff_t n)
+    -> MatrixRowIterator<T>
+{
+    return it += n;
+}
+
+template<typename T>
+inline auto operator+(std::ptrdiff_t n, MatrixRowIterator<T> it)
+    -> MatrixRowIterator<T>
+{
+    return it += n;
+}
+
+template<typename T>
+inline auto operator-(MatrixRowIterator<T> it, std::ptrdiff_t n)
+    -> MatrixRowIterator<T>
+{
+    return it -= n;
+}
+
+template<typename T, typename U>
+inline auto operator-(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+    -> std::ptrdiff_t
+{
+    return lhs.index() - rhs.index();
+}
+
+////////////////////////////////////////////////////////////
+// Comparison operators
+////////////////////////////////////////////////////////////
+
+template<typename T, typename U>
+inline auto operator==(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+    -> bool
+{
+    return lhs.index() == rhs.index();
+}
+
+template<typename T, typename U>
+inline auto operator!=(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+    -> bool
+{
+    return lhs.index() != rhs.index();
+}
+
+template<typename T, typename U>
+inline auto operator<(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+    -> bool
+{
+    return lhs.index() < rhs.index();
+}
+
+template<typename T, typename U>
+inline auto operator<=(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+    -> bool
+{
+    return lhs.index() <= rhs.index();
+}
+
+template<typename T, typename U>
+inline auto operator>(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+    -> bool
+{
+    return lhs.index() > rhs.index();
+}
+
+template<typename T, typename U>
+inline auto operator>=(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+    -> bool
+{
+    return lhs.index() >= rhs.index();
+}
@@ -0,0 +1,751 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+namespace details
+{
+    template<sparse_format Format>
+    using sparse_format_t = std::integral_constant<sparse_format, Format>;
+
+    using csr_t = sparse_format_t<sparse_format::csr>;
+    using csc_t = sparse_format_t<sparse_format::csc>;
+}
+
+////////////////////////////////////////////////////////////
+// Constructors
+////////////////////////////////////////////////////////////
+
+template<typename T, sparse_format Format>
+constexpr sparse_format SparseMatrix<T, Format>::format;
+
+template<typename T, sparse_format Format>
+SparseMatrix<T, Format>::SparseMatrix():
+    SparseMatrix(0, 0)
+{}
+
+template<typename T, sparse_format Format>
+SparseMatrix<T, Format>::SparseMatrix(size_type height, size_type width):
+    _height(height),
+    _width(width),
+    _offsets((Format == sparse_format::csr ? height : width) + 1, 0)
+{}
+
+template<typename T, sparse_format Format>
+template<typename InputIterator>
+SparseMatrix<T, Format>::SparseMatrix(size_type height, size_type width,
+                                      InputIterator first, InputIterator last):
+    SparseMatrix(height, width)
+{
+    const std::vector<SparseTriplet<T>> triplets(first, last);
+
+    // Count the elements of every outer slice
+    for (const auto& triplet: triplets)
+    {
+        POLDER_ASSERT(triplet.y < _height && triplet.x < _width);
+        ++_offsets[outer_index(triplet.y, triplet.x) + 1];
+    }
+    std::partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+
+    // Distribute the elements into their slices
+    std::vector<std::pair<size_type, T>> slots(triplets.size());
+    std::vector<size_type> next(_offsets.begin(), _offsets.end() - 1);
+    for (const auto& triplet: triplets)
+    {
+        size_type& pos = next[outer_index(triplet.y, triplet.x)];
+        slots[pos++] = { inner_index(triplet.y, triplet.x), triplet.value };
+    }
+
+    // Sort every slice and sum the duplicates
+    _indices.reserve(slots.size());
+    _values.reserve(slots.size());
+    for (size_type i = 0 ; i < outer_size() ; ++i)
+    {
+        auto it = slots.begin() + _offsets[i];
+        auto end = slots.begin() + _offsets[i+1];
+        std::stable_sort(it, end, [](const auto& lhs, const auto& rhs) {
+            return lhs.first < rhs.first;
+        });
+
+        _offsets[i] = _indices.size();
+        for (; it != end ; ++it)
+        {
+            if (_indices.size() > _offsets[i] && _indices.back() == it->first)
+            {
+                _values.back() += it->second;
+            }
+            else
+            {
+                _indices.push_back(it->first);
+                _values.push_back(it->second);
+            }
+        }
+    }
+    _offsets.back() = _indices.size();
+}
+
+template<typename T, sparse_format Format>
+SparseMatrix<T, Format>::SparseMatrix(size_type height, size_type width,
+                                      std::initializer_list<SparseTriplet<T>> triplets):
+    SparseMatrix(height, width, triplets.begin(), triplets.end())
+{}
+
+template<typename T, sparse_format Format>
+SparseMatrix<T, Format>::SparseMatrix(size_type height, size_type width,
+                                      std::vector<size_type> offsets,
+                                      std::vector<size_type> indices,
+                                      std::vector<T> values):
+    _height(height),
+    _width(width),
+    _offsets(std::move(offsets)),
+    _indices(std::move(indices)),
+    _values(std::move(values))
+{
+    POLDER_ASSERT(_offsets.size() == outer_size() + 1);
+    POLDER_ASSERT(_offsets.front() == 0);
+    POLDER_ASSERT(_offsets.back() == _indices.size());
+    POLDER_ASSERT(_indices.size() == _values.size());
+}
+
+template<typename T, sparse_format Format>
+template<sparse_format OtherFormat>
+SparseMatrix<T, Format>::SparseMatrix(const SparseMatrix<T, OtherFormat>& other):
+    SparseMatrix(other.height(), other.width())
+{
+    // The inner indices of other are the outer
+    // indices of the new matrix and conversely
+    for (size_type index: other.indices())
+    {
+        ++_offsets[index + 1];
+    }
+    std::partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+
+    _indices.resize(other.nonzeros());
+    _values.resize(other.nonzeros());
+    std::vector<size_type> next(_offsets.begin(), _offsets.end() - 1);
+    for (size_type i = 0 ; i < other.outer_size() ; ++i)
+    {
+        for (size_type k = other.outer_begin(i) ; k < other.outer_end(i) ; ++k)
+        {
+            size_type& pos = next[other.indices()[k]];
+            _indices[pos] = i;
+            _values[pos] = other.values()[k];
+            ++pos;
+        }
+    }
+}
+
+template<typename T, sparse_format Format>
+template<typename Derived>
+SparseMatrix<T, Format>::SparseMatrix(const ImmutableMatrix<Derived>& mat):
+    SparseMatrix(mat.height(), mat.width())
+{
+    const Derived& dense = mat.derived();
+    const size_type inner_size = (Format == sparse_format::csr) ? _width : _height;
+    for (size_type i = 0 ; i < outer_size() ; ++i)
+    {
+        for (size_type j = 0 ; j < inner_size ; ++j)
+        {
+            const T value = (Format == sparse_format::csr) ? dense(i, j) : dense(j, i);
+            if (value != T{})
+            {
+                _indices.push_back(j);
+                _values.push_back(value);
+            }
+        }
+        _offsets[i+1] = _indices.size();
+    }
+}
+
+////////////////////////////////////////////////////////////
+// Operators
+////////////////////////////////////////////////////////////
+
+template<typename T, sparse_format Format>
+auto SparseMatrix<T, Format>::operator()(size_type y, size_type x)
+    -> reference
+{
+    const size_type outer = outer_index(y, x);
+    const size_type inner = inner_index(y, x);
+
+    auto first = _indices.begin() + _offsets[outer];
+    auto last = _indices.begin() + _offsets[outer+1];
+    auto it = std::lower_bound(first, last, inner);
+    const size_type pos = it - _indices.begin();
+    if (it == last || *it != inner)
+    {
+        // The element is not stored yet
+        _indices.insert(it, inner);
+        _values.insert(_values.begin() + pos, T{});
+        for (size_type i = outer + 1 ; i < _offsets.size() ; ++i)
+        {
+            ++_offsets[i];
+        }
+    }
+    return _values[pos];
+}
+
+template<typename T, sparse_format Format>
+auto SparseMatrix<T, Format>::operator()(size_type y, size_type x) const
+    -> value_type
+{
+    const size_type outer = outer_index(y, x);
+    const size_type inner = inner_index(y, x);
+
+    auto first = _indices.begin() + _offsets[outer];
+    auto last = _indices.begin() + _offsets[outer+1];
+    auto it = std::lower_bound(first, last, inner);
+    if (it == last || *it != inner)
+    {
+        return T{};
+    }
+    return _values[it - _indices.begin()];
+}
+
+template<typename T, sparse_format Format>
+auto SparseMatrix<T, Format>::operator*=(value_type value)
+    -> SparseMatrix&
+{
+    for (T& elem: _values)
+    {
+        elem *= value;
+    }
+    return *this;
+}
+
+template<typename T, sparse_format Format>
+auto SparseMatrix<T, Format>::operator/=(value_type value)
+    -> SparseMatrix&
+{
+    for (T& elem: _values)
+    {
+        elem /= value;
+    }
+    return *this;
+}
+
+////////////////////////////////////////////////////////////
+// Compressed storage
+////////////////////////////////////////////////////////////
+
+template<typename T, sparse_format Format>
+inline auto SparseMatrix<T, Format>::nonzeros() const
+    -> size_type
+{
+    return _values.size();
+}
+
+template<typename T, sparse_format Format>
+inline auto SparseMatrix<T, Format>::outer_size() const
+    -> size_type
+{
+    return _offsets.size() - 1;
+}
+
+template<typename T, sparse_format Format>
+inline auto SparseMatrix<T, Format>::offsets() const
+    -> const std::vector<size_type>&
+{
+    return _offsets;
+}
+
+template<typename T, sparse_format Format>
+inline auto SparseMatrix<T, Format>::indices() const
+    -> const std::vector<size_type>&
+{
+    return _indices;
+}
+
+template<typename T, sparse_format Format>
+inline auto SparseMatrix<T, Format>::values() const
+    -> const std::vector<T>&
+{
+    return _values;
+}
+
+template<typename T, sparse_format Format>
+inline auto SparseMatrix<T, Format>::outer_begin(size_type i) const
+    -> size_type
+{
+    return _offsets[i];
+}
+
+template<typename T, sparse_format Format>
+inline auto SparseMatrix<T, Format>::outer_end(size_type i) const
+    -> size_type
+{
+    return _offsets[i+1];
+}
+
+template<typename T, sparse_format Format>
+auto SparseMatrix<T, Format>::reserve(size_type nonzeros)
+    -> void
+{
+    _indices.reserve(nonzeros);
+    _values.reserve(nonzeros);
+}
+
+template<typename T, sparse_format Format>
+auto SparseMatrix<T, Format>::prune()
+    -> void
+{
+    size_type pos = 0;
+    size_type begin = 0;
+    for (size_type i = 0 ; i < outer_size() ; ++i)
+    {
+        const size_type end = _offsets[i+1];
+        for (size_type k = begin ; k < end ; ++k)
+        {
+            if (_values[k] != T{})
+            {
+                _indices[pos] = _indices[k];
+                _values[pos] = _values[k];
+                ++pos;
+            }
+        }
+        begin = end;
+        _offsets[i+1] = pos;
+    }
+    _indices.resize(pos);
+    _values.resize(pos);
+}
+
+////////////////////////////////////////////////////////////
+// Conversions
+////////////////////////////////////////////////////////////
+
+template<typename T, sparse_format Format>
+auto SparseMatrix<T, Format>::to_dense() const
+    -> Matrix<T>
+{
+    auto res = Matrix<T>::zeros(_height, _width);
+    for (size_type i = 0 ; i < outer_size() ; ++i)
+    {
+        for (size_type k = _offsets[i] ; k < _offsets[i+1] ; ++k)
+        {
+            if (Format == sparse_format::csr)
+            {
+                res(i, _indices[k]) = _values[k];
+            }
+            else
+            {
+                res(_indices[k], i) = _values[k];
+            }
+        }
+    }
+    return res;
+}
+
+////////////////////////////////////////////////////////////
+// Miscellaneous functions
+////////////////////////////////////////////////////////////
+
+template<typename T, sparse_format Format>
+inline auto SparseMatrix<T, Format>::height() const
+    -> size_type
+{
+    return _height;
+}
+
+template<typename T, sparse_format Format>
+inline auto SparseMatrix<T, Format>::width() const
+    -> size_type
+{
+    return _width;
+}
+
+template<typename T, sparse_format Format>
+inline auto SparseMatrix<T, Format>::outer_index(size_type y, size_type x) const
+    -> size_type
+{
+    return (Format == sparse_format::csr) ? y : x;
+}
+
+template<typename T, sparse_format Format>
+inline auto SparseMatrix<T, Format>::inner_index(size_type y, size_type x) const
+    -> size_type
+{
+    return (Format == sparse_format::csr) ? x : y;
+}
+
+////////////////////////////////////////////////////////////
+// Outside class operators
+////////////////////////////////////////////////////////////
+
+template<typename T, sparse_format Format>
+auto operator==(const SparseMatrix<T, Format>& lhs, const SparseMatrix<T, Format>& rhs)
+    -> bool
+{
+    if (lhs.height() != rhs.height() || lhs.width() != rhs.width())
+    {
+        return false;
+    }
+
+    // The slices are merged since they may store different
+    // elements: an element stored in one slice only has to
+    // be zero
+    const auto& lhs_indices = lhs.indices();
+    const auto& rhs_indices = rhs.indices();
+    const auto& lhs_values = lhs.values();
+    const auto& rhs_values = rhs.values();
+    for (std::size_t i = 0 ; i < lhs.outer_size() ; ++i)
+    {
+        std::size_t k = lhs.outer_begin(i);
+        std::size_t l = rhs.outer_begin(i);
+        const std::size_t k_end = lhs.outer_end(i);
+        const std::size_t l_end = rhs.outer_end(i);
+        while (k < k_end || l < l_end)
+        {
+            if (l == l_end || (k < k_end && lhs_indices[k] < rhs_indices[l]))
+            {
+                if (lhs_values[k++] != T(0))
+                {
+                    return false;
+                }
+            }
+            else if (k == k_end || rhs_indices[l] < lhs_indices[k])
+            {
+                if (rhs_values[l++] != T(0))
+                {
+                    return false;
+                }
+            }
+            else if (lhs_values[k++] != rhs_values[l++])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template<typename T, sparse_format Format>
+auto operator!=(const SparseMatrix<T, Format>& lhs, const SparseMatrix<T, Format>& rhs)
+    -> bool
+{
+    return not (lhs == rhs);
+}
+
+namespace details
+{
+    /**
+     * Gustavson's algorithm: the outer slice i of the result
+     * is the sum of the slices p of second weighted by the
+     * elements (p, u) of the slice i of first. The elements
+     * of a slice are accumulated in a dense array, and a
+     * marker array tells which positions have been touched.
+     */
+    template<typename T, sparse_format Format>
+    auto sparse_product(const SparseMatrix<T, Format>& first,
+                        const SparseMatrix<T, Format>& second,
+                        std::size_t height, std::size_t width)
+        -> SparseMatrix<T, Format>
+    {
+        const std::size_t outer_size = first.outer_size();
+        const std::size_t inner_size = (Format == sparse_format::csr) ? width : height;
+        const std::size_t unmarked = std::numeric_limits<std::size_t>::max();
+
+        std::vector<std::size_t> offsets(outer_size + 1, 0);
+        std::vector<std::size_t> indices;
+        std::vector<T> values;
+
+        std::vector<T> accumulator(inner_size);
+        std::vector<std::size_t> marker(inner_size, unmarked);
+        std::vector<std::size_t> touched;
+
+        for (std::size_t i = 0 ; i < outer_size ; ++i)
+        {
+            touched.clear();
+            for (std::size_t k = first.outer_begin(i) ; k < first.outer_end(i) ; ++k)
+            {
+                const std::size_t p = first.indices()[k];
+                const T& u = first.values()[k];
+                for (std::size_t l = second.outer_begin(p) ; l < second.outer_end(p) ; ++l)
+                {
+                    const std::size_t j = second.indices()[l];
+                    const T& v = second.values()[l];
+                    // Keep the order of the factors of lhs * rhs
+                    const T prod = (Format == sparse_format::csr) ? u * v : v * u;
+                    if (marker[j] != i)
+                    {
+                        marker[j] = i;
+                        touched.push_back(j);
+                        accumulator[j] = prod;
+                    }
+                    else
+                    {
+                        accumulator[j] += prod;
+                    }
+                }
+            }
+
+            std::sort(touched.begin(), touched.end());
+            for (std::size_t j: touched)
+            {
+                indices.push_back(j);
+                values.push_back(accumulator[j]);
+            }
+            offsets[i+1] = indices.size();
+        }
+
+        return {
+            height, width,
+            std::move(offsets),
+            std::move(indices),
+            std::move(values)
+        };
+    }
+
+    template<typename T, typename Allocator>
+    auto sparse_dense_product(const SparseMatrix<T, sparse_format::csr>& lhs,
+                              const Matrix<T, Allocator>& rhs,
+                              Matrix<T, Allocator>& res,
+                              std::size_t begin, std::size_t end, csr_t)
+        -> void
+    {
+        // Rows [begin, end) of the result
+        const std::size_t n = rhs.width();
+        for (std::size_t i = begin ; i < end ; ++i)
+        {
+            T* out = res.data() + i * n;
+            for (std::size_t k = lhs.outer_begin(i) ; k < lhs.outer_end(i) ; ++k)
+            {
+                const T& val = lhs.values()[k];
+                const T* row = rhs.data() + lhs.indices()[k] * n;
+                for (std::size_t j = 0 ; j < n ; ++j)
+                {
+                    out[j] += val * row[j];
+                }
+            }
+        }
+    }
+
+    template<typename T, typename Allocator>
+    auto sparse_dense_product(const SparseMatrix<T, sparse_format::csc>& lhs,
+                              const Matrix<T, Allocator>& rhs,
+                              Matrix<T, Allocator>& res,
+                              std::size_t begin, std::size_t end, csc_t)
+        -> void
+    {
+        // Columns [begin, end) of the result
+        const std::size_t n = rhs.width();
+        for (std::size_t p = 0 ; p < lhs.outer_size() ; ++p)
+        {
+            const T* row = rhs.data() + p * n;
+            for (std::size_t k = lhs.outer_begin(p) ; k < lhs.outer_end(p) ; ++k)
+            {
+                const T& val = lhs.values()[k];
+                T* out = res.data() + lhs.indices()[k] * n;
+                for (std::size_t j = begin ; j < end ; ++j)
+                {
+                    out[j] += val * row[j];
+                }
+            }
+        }
+    }
+
+    template<typename T, typename Allocator>
+    auto dense_sparse_product(const Matrix<T, Allocator>& lhs,
+                              const SparseMatrix<T, sparse_format::csr>& rhs,
+                              Matrix<T, Allocator>& res, csr_t)
+        -> void
+    {
+        for (std::size_t i = 0 ; i < lhs.height() ; ++i)
+        {
+            T* out = res.data() + i * res.width();
+            for (std::size_t p = 0 ; p < lhs.width() ; ++p)
+            {
+                const T& val = lhs(i, p);
+                for (std::size_t k = rhs.outer_begin(p) ; k < rhs.outer_end(p) ; ++k)
+                {
+                    out[rhs.indices()[k]] += val * rhs.values()[k];
+                }
+            }
+        }
+    }
+
+    template<typename T, typename Allocator>
+    auto dense_sparse_product(const Matrix<T, Allocator>& lhs,
+                              const SparseMatrix<T, sparse_format::csc>& rhs,
+                              Matrix<T, Allocator>& res, csc_t)
+        -> void
+    {
+        for (std::size_t i = 0 ; i < lhs.height() ; ++i)
+        {
+            const T* row = lhs.data() + i * lhs.width();
+            for (std::size_t j = 0 ; j < rhs.outer_size() ; ++j)
+            {
+                T sum{};
+                for (std::size_t k = rhs.outer_begin(j) ; k < rhs.outer_end(j) ; ++k)
+                {
+                    sum += row[rhs.indices()[k]] * rhs.values()[k];
+                }
+                res(i, j) = sum;
+            }
+        }
+    }
+
+    template<typename ExecutionPolicy, typename T>
+    auto spmv(ExecutionPolicy&& policy, const SparseMatrix<T, sparse_format::csr>& a,
+              const T* x, T* y, csr_t)
+        -> void
+    {
+        execution::parallel_for(execution::for_work(policy, a.nonzeros()), a.height(),
+            [&](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin ; i < end ; ++i)
+                {
+                    T sum{};
+                    for (std::size_t k = a.outer_begin(i) ; k < a.outer_end(i) ; ++k)
+                    {
+                        sum += a.values()[k] * x[a.indices()[k]];
+                    }
+                    y[i] = sum;
+                }
+            }
+        );
+    }
+
+    template<typename ExecutionPolicy, typename T>
+    auto spmv(ExecutionPolicy&& policy, const SparseMatrix<T, sparse_format::csc>& a,
+              const T* x, T* y, csc_t)
+        -> void
+    {
+        if (a.width() == 0)
+        {
+            std::fill(y, y + a.height(), T{});
+            return;
+        }
+
+        // Every chunk of columns scatters into its own vector
+        auto res = execution::parallel_reduce<std::vector<T>>(
+            execution::for_work(policy, a.nonzeros()), a.width(),
+            [&](std::size_t begin, std::size_t end)
+            {
+                std::vector<T> partial(a.height());
+                for (std::size_t j = begin ; j < end ; ++j)
+                {
+                    for (std::size_t k = a.outer_begin(j) ; k < a.outer_end(j) ; ++k)
+                    {
+                        partial[a.indices()[k]] += a.values()[k] * x[j];
+                    }
+                }
+                return partial;
+            },
+            [](std::vector<T> lhs, const std::vector<T>& rhs)
+            {
+                for (std::size_t i = 0 ; i < lhs.size() ; ++i)
+                {
+                    lhs[i] += rhs[i];
+                }
+                return lhs;
+            }
+        );
+        std::copy(res.begin(), res.end(), y);
+    }
+}
+
+template<typename T, sparse_format Format>
+auto operator*(const SparseMatrix<T, Format>& lhs, const SparseMatrix<T, Format>& rhs)
+    -> SparseMatrix<T, Format>
+{
+    POLDER_ASSERT(lhs.width() == rhs.height());
+    if (Format == sparse_format::csr)
+    {
+        return details::sparse_product(lhs, rhs, lhs.height(), rhs.width());
+    }
+    // The columns of the result are combinations
+    // of the columns of the left operand
+    return details::sparse_product(rhs, lhs, lhs.height(), rhs.width());
+}
+
+template<typename T, sparse_format Format, sparse_format OtherFormat>
+auto operator*(const SparseMatrix<T, Format>& lhs, const SparseMatrix<T, OtherFormat>& rhs)
+    -> SparseMatrix<T, Format>
+{
+    return lhs * SparseMatrix<T, Format>(rhs);
+}
+
+template<typename T, sparse_format Format, typename Allocator>
+auto operator*(const SparseMatrix<T, Format>& lhs, const Matrix<T, Allocator>& rhs)
+    -> Matrix<T, Allocator>
+{
+    return multiply(execution::seq, lhs, rhs);
+}
+
+template<typename T, typename Allocator, sparse_format Format>
+auto operator*(const Matrix<T, Allocator>& lhs, const SparseMatrix<T, Format>& rhs)
+    -> Matrix<T, Allocator>
+{
+    POLDER_ASSERT(lhs.width() == rhs.height());
+
+    auto res = Matrix<T, Allocator>::zeros(lhs.height(), rhs.width(), lhs.get_allocator());
+    details::dense_sparse_product(lhs, rhs, res, details::sparse_format_t<Format>{});
+    return res;
+}
+
+template<typename ExecutionPolicy, typename T, sparse_format Format, typename Allocator>
+auto multiply(ExecutionPolicy&& policy,
+              const SparseMatrix<T, Format>& lhs, const Matrix<T, Allocator>& rhs)
+    -> Matrix<T, Allocator>
+{
+    POLDER_ASSERT(lhs.width() == rhs.height());
+
+    auto res = Matrix<T, Allocator>::zeros(lhs.height(), rhs.width(), rhs.get_allocator());
+    // CSR: the rows of the result are independent,
+    // CSC: the columns of the result are independent
+    const std::size_t size = (Format == sparse_format::csr) ? lhs.height() : rhs.width();
+    execution::parallel_for(execution::for_work(policy, lhs.nonzeros() * rhs.width()), size,
+        [&](std::size_t begin, std::size_t end)
+        {
+            details::sparse_dense_product(lhs, rhs, res, begin, end,
+                                          details::sparse_format_t<Format>{});
+        }
+    );
+    return res;
+}
+
+template<typename T, sparse_format Format>
+auto spmv(const SparseMatrix<T, Format>& a, const T* x, T* y)
+    -> void
+{
+    details::spmv(execution::seq, a, x, y, details::sparse_format_t<Format>{});
+}
+
+template<typename ExecutionPolicy, typename T, sparse_format Format>
+auto spmv(ExecutionPolicy&& policy, const SparseMatrix<T, Format>& a, const T* x, T* y)
+    -> void
+{
+    details::spmv(policy, a, x, y, details::sparse_format_t<Format>{});
+}
+
+////////////////////////////////////////////////////////////
+// Miscellaneous functions
+////////////////////////////////////////////////////////////
+
+template<typename T>
+auto transpose(const CsrMatrix<T>& mat)
+    -> CscMatrix<T>
+{
+    return { mat.width(), mat.height(), mat.offsets(), mat.indices(), mat.values() };
+}
+
+template<typename T>
+auto transpose(const CscMatrix<T>& mat)
+    -> CsrMatrix<T>
+{
+    return { mat.width(), mat.height(), mat.offsets(), mat.indices(), mat.values() };
+}
@@ -0,0 +1,858 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+namespace details
+{
+    ////////////////////////////////////////////////////////////
+    // Generation of the elements at compile time
+    //
+    // std::array can't be modified in a constexpr function
+    // before C++17, so the results are built from index
+    // sequences instead, which also unrolls the loops.
+
+    template<typename T, std::size_t Height, std::size_t Width,
+             typename Function, std::size_t... Indices>
+    constexpr auto static_transform(const StaticMatrix<T, Height, Width>& mat,
+                                    Function func, std::index_sequence<Indices...>)
+        -> StaticMatrix<T, Height, Width>
+    {
+        return StaticMatrix<T, Height, Width>(std::array<T, Height * Width>{{
+            T(func(mat.flat_value(Indices)))...
+        }});
+    }
+
+    template<typename T, std::size_t Height, std::size_t Width,
+             typename Function, std::size_t... Indices>
+    constexpr auto static_transform(const StaticMatrix<T, Height, Width>& lhs,
+                                    const StaticMatrix<T, Height, Width>& rhs,
+                                    Function func, std::index_sequence<Indices...>)
+        -> StaticMatrix<T, Height, Width>
+    {
+        return StaticMatrix<T, Height, Width>(std::array<T, Height * Width>{{
+            T(func(lhs.flat_value(Indices), rhs.flat_value(Indices)))...
+        }});
+    }
+
+    template<typename T, std::size_t Height, std::size_t N, std::size_t Width>
+    constexpr auto static_dot(const StaticMatrix<T, Height, N>& lhs,
+                              const StaticMatrix<T, N, Width>& rhs,
+                              std::size_t y, std::size_t x)
+        -> T
+    {
+        T res = lhs(y, 0) * rhs(0, x);
+        for (std::size_t k = 1 ; k < N ; ++k)
+        {
+            res += lhs(y, k) * rhs(k, x);
+        }
+        return res;
+    }
+
+    template<typename T, std::size_t Height, std::size_t N, std::size_t Width,
+             std::size_t... Indices>
+    constexpr auto static_product(const StaticMatrix<T, Height, N>& lhs,
+                                  const StaticMatrix<T, N, Width>& rhs,
+                                  std::index_sequence<Indices...>)
+        -> StaticMatrix<T, Height, Width>
+    {
+        return StaticMatrix<T, Height, Width>(std::array<T, Height * Width>{{
+            static_dot(lhs, rhs, Indices / Width, Indices % Width)...
+        }});
+    }
+
+    template<typename T, std::size_t Height, std::size_t Width, std::size_t... Indices>
+    constexpr auto static_transpose(const StaticMatrix<T, Height, Width>& mat,
+                                    std::index_sequence<Indices...>)
+        -> StaticMatrix<T, Width, Height>
+    {
+        return StaticMatrix<T, Width, Height>(std::array<T, Height * Width>{{
+            mat(Indices % Height, Indices / Height)...
+        }});
+    }
+
+    template<typename T, std::size_t Height, std::size_t Width, std::size_t... Indices>
+    constexpr auto static_identity(std::index_sequence<Indices...>)
+        -> StaticMatrix<T, Height, Width>
+    {
+        return StaticMatrix<T, Height, Width>(std::array<T, Height * Width>{{
+            T(Indices / Width == Indices % Width ? 1 : 0)...
+        }});
+    }
+
+    template<typename T, std::size_t Height, std::size_t Width, std::size_t... Indices>
+    constexpr auto static_ones(std::index_sequence<Indices...>)
+        -> StaticMatrix<T, Height, Width>
+    {
+        return StaticMatrix<T, Height, Width>(std::array<T, Height * Width>{{
+            (void(Indices), T(1))...
+        }});
+    }
+
+    // Local arrays can be modified in constexpr functions,
+    // contrary to std::array, hence the scratch buffers
+    template<typename T, std::size_t Height, std::size_t Width, std::size_t... Indices>
+    constexpr auto static_from_buffer(const T (&values)[Height * Width],
+                                      std::index_sequence<Indices...>)
+        -> StaticMatrix<T, Height, Width>
+    {
+        return StaticMatrix<T, Height, Width>(std::array<T, Height * Width>{{
+            values[Indices]...
+        }});
+    }
+
+    template<typename T>
+    constexpr auto static_abs(const T& value)
+        -> T
+    {
+        return value < T(0) ? -value : value;
+    }
+
+    template<typename T>
+    constexpr auto static_swap_rows(T* values, std::size_t row1, std::size_t row2,
+                                    std::size_t width)
+        -> void
+    {
+        for (std::size_t j = 0 ; j < width ; ++j)
+        {
+            T tmp = values[row1 * width + j];
+            values[row1 * width + j] = values[row2 * width + j];
+            values[row2 * width + j] = tmp;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////
+// Constructors
+////////////////////////////////////////////////////////////
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr StaticMatrix<T, Height, Width>::StaticMatrix():
+    _data{}
+{}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr StaticMatrix<T, Height, Width>::StaticMatrix(const T (&values)[Height][Width]):
+    StaticMatrix(values, std::make_index_sequence<Height * Width>{})
+{}
+
+template<typename T, std::size_t Height, std::size_t Width>
+template<std::size_t... Indices>
+constexpr StaticMatrix<T, Height, Width>::StaticMatrix(const T (&values)[Height][Width],
+                                                       std::index_sequence<Indices...>):
+    _data{{ values[Indices / Width][Indices % Width]... }}
+{}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr StaticMatrix<T, Height, Width>::StaticMatrix(const std::array<T, Height * Width>& values):
+    _data(values)
+{}
+
+template<typename T, std::size_t Height, std::size_t Width>
+template<typename Derived>
+StaticMatrix<T, Height, Width>::StaticMatrix(const ImmutableMatrix<Derived>& mat):
+    _data{}
+{
+    POLDER_ASSERT(mat.height() == Height);
+    POLDER_ASSERT(mat.width() == Width);
+
+    for (size_type y = 0 ; y < Height ; ++y)
+    {
+        for (size_type x = 0 ; x < Width ; ++x)
+        {
+            _data[y * Width + x] = mat(y, x);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////
+// Construction functions
+////////////////////////////////////////////////////////////
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto StaticMatrix<T, Height, Width>::zeros()
+    -> StaticMatrix
+{
+    return {};
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto StaticMatrix<T, Height, Width>::ones()
+    -> StaticMatrix
+{
+    return details::static_ones<T, Height, Width>(
+        std::make_index_sequence<Height * Width>{}
+    );
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto StaticMatrix<T, Height, Width>::identity()
+    -> StaticMatrix
+{
+    static_assert(Height == Width, "an identity matrix shall be square");
+    return details::static_identity<T, Height, Width>(
+        std::make_index_sequence<Height * Width>{}
+    );
+}
+
+////////////////////////////////////////////////////////////
+// Operators
+////////////////////////////////////////////////////////////
+
+template<typename T, std::size_t Height, std::size_t Width>
+inline auto StaticMatrix<T, Height, Width>::operator[](size_type index)
+    -> row
+{
+    return { Width, _data.data() + index * Width };
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+inline auto StaticMatrix<T, Height, Width>::operator[](size_type index) const
+    -> const_row
+{
+    return { Width, _data.data() + index * Width };
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+inline auto StaticMatrix<T, Height, Width>::operator()(size_type y, size_type x)
+    -> reference
+{
+    return _data[y * Width + x];
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto StaticMatrix<T, Height, Width>::operator()(size_type y, size_type x) const
+    -> const_reference
+{
+    return _data[y * Width + x];
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto StaticMatrix<T, Height, Width>::flat_value(size_type index) const
+    -> const_reference
+{
+    return _data[index];
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+auto StaticMatrix<T, Height, Width>::operator+=(const StaticMatrix& other)
+    -> StaticMatrix&
+{
+    for (size_type i = 0 ; i < Height * Width ; ++i)
+    {
+        _data[i] += other._data[i];
+    }
+    return *this;
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+auto StaticMatrix<T, Height, Width>::operator-=(const StaticMatrix& other)
+    -> StaticMatrix&
+{
+    for (size_type i = 0 ; i < Height * Width ; ++i)
+    {
+        _data[i] -= other._data[i];
+    }
+    return *this;
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+auto StaticMatrix<T, Height, Width>::operator*=(const StaticMatrix<T, Width, Width>& other)
+    -> StaticMatrix&
+{
+    return *this = *this * other;
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+auto StaticMatrix<T, Height, Width>::operator*=(const value_type& value)
+    -> StaticMatrix&
+{
+    for (auto& elem: _data)
+    {
+        elem *= value;
+    }
+    return *this;
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+auto StaticMatrix<T, Height, Width>::operator/=(const value_type& value)
+    -> StaticMatrix&
+{
+    for (auto& elem: _data)
+    {
+        elem /= value;
+    }
+    return *this;
+}
+
+////////////////////////////////////////////////////////////
+// STL-like functions
+////////////////////////////////////////////////////////////
+
+template<typename T, std::size_t Height, std::size_t Width>
+inline auto StaticMatrix<T, Height, Width>::data()
+    -> pointer
+{
+    return _data.data();
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+inline auto StaticMatrix<T, Height, Width>::data() const
+    -> const_pointer
+{
+    return _data.data();
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+inline auto StaticMatrix<T, Height, Width>::fbegin()
+    -> flat_iterator
+{
+    return _data.begin();
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+inline auto StaticMatrix<T, Height, Width>::fbegin() const
+    -> const_flat_iterator
+{
+    return _data.begin();
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+inline auto StaticMatrix<T, Height, Width>::cfbegin() const
+    -> const_flat_iterator
+{
+    return _data.cbegin();
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+inline auto StaticMatrix<T, Height, Width>::fend()
+    -> flat_iterator
+{
+    return _data.end();
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+inline auto StaticMatrix<T, Height, Width>::fend() const
+    -> const_flat_iterator
+{
+    return _data.end();
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+inline auto StaticMatrix<T, Height, Width>::cfend() const
+    -> const_flat_iterator
+{
+    return _data.cend();
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+auto StaticMatrix<T, Height, Width>::fill(const value_type& value)
+    -> void
+{
+    _data.fill(value);
+}
+
+////////////////////////////////////////////////////////////
+// Miscellaneous functions
+////////////////////////////////////////////////////////////
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto StaticMatrix<T, Height, Width>::height()
+    -> size_type
+{
+    return Height;
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto StaticMatrix<T, Height, Width>::width()
+    -> size_type
+{
+    return Width;
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto StaticMatrix<T, Height, Width>::size()
+    -> size_type
+{
+    return Height * Width;
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto StaticMatrix<T, Height, Width>::is_square()
+    -> bool
+{
+    return Height == Width;
+}
+
+////////////////////////////////////////////////////////////
+// Outside class operators
+////////////////////////////////////////////////////////////
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto operator==(const StaticMatrix<T, Height, Width>& lhs,
+                          const StaticMatrix<T, Height, Width>& rhs)
+    -> bool
+{
+    for (std::size_t i = 0 ; i < Height * Width ; ++i)
+    {
+        if (lhs.flat_value(i) != rhs.flat_value(i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto operator!=(const StaticMatrix<T, Height, Width>& lhs,
+                          const StaticMatrix<T, Height, Width>& rhs)
+    -> bool
+{
+    return not (lhs == rhs);
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto operator+(const StaticMatrix<T, Height, Width>& lhs,
+                         const StaticMatrix<T, Height, Width>& rhs)
+    -> StaticMatrix<T, Height, Width>
+{
+    return details::static_transform(lhs, rhs, std::plus<>{},
+                                     std::make_index_sequence<Height * Width>{});
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto operator-(const StaticMatrix<T, Height, Width>& lhs,
+                         const StaticMatrix<T, Height, Width>& rhs)
+    -> StaticMatrix<T, Height, Width>
+{
+    return details::static_transform(lhs, rhs, std::minus<>{},
+                                     std::make_index_sequence<Height * Width>{});
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto operator-(const StaticMatrix<T, Height, Width>& mat)
+    -> StaticMatrix<T, Height, Width>
+{
+    return details::static_transform(mat, std::negate<>{},
+                                     std::make_index_sequence<Height * Width>{});
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto operator*(const StaticMatrix<T, Height, Width>& mat,
+                         const typename StaticMatrix<T, Height, Width>::value_type& value)
+    -> StaticMatrix<T, Height, Width>
+{
+    return details::static_transform(mat, details::multiplies_by<T>{value},
+                                     std::make_index_sequence<Height * Width>{});
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto operator*(const typename StaticMatrix<T, Height, Width>::value_type& value,
+                         const StaticMatrix<T, Height, Width>& mat)
+    -> StaticMatrix<T, Height, Width>
+{
+    return details::static_transform(mat, details::multiplies_by<T>{value},
+                                     std::make_index_sequence<Height * Width>{});
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto operator/(const StaticMatrix<T, Height, Width>& mat,
+                         const typename StaticMatrix<T, Height, Width>::value_type& value)
+    -> StaticMatrix<T, Height, Width>
+{
+    return details::static_transform(mat, details::divides_by<T>{value},
+                                     std::make_index_sequence<Height * Width>{});
+}
+
+template<typename T, std::size_t Height, std::size_t N, std::size_t M, std::size_t Width>
+constexpr auto operator*(const StaticMatrix<T, Height, N>& lhs,
+                         const StaticMatrix<T, M, Width>& rhs)
+    -> StaticMatrix<T, Height, Width>
+{
+    static_assert(N == M, "the width of the left operand of a matrix product "
+                          "shall be the height of the right operand");
+    return details::static_product(lhs, rhs, std::make_index_sequence<Height * Width>{});
+}
+
+////////////////////////////////////////////////////////////
+// Transforms of geometric entities
+////////////////////////////////////////////////////////////
+
+template<typename T, std::size_t N>
+auto operator*(const StaticMatrix<T, N, N>& mat, const geometry::Vector<N, T>& vec)
+    -> geometry::Vector<N, T>
+{
+    geometry::Vector<N, T> res;
+    for (std::size_t y = 0 ; y < N ; ++y)
+    {
+        T value = mat(y, 0) * vec[0];
+        for (std::size_t x = 1 ; x < N ; ++x)
+        {
+            value += mat(y, x) * vec[x];
+        }
+        res[y] = value;
+    }
+    return res;
+}
+
+template<typename T, std::size_t N>
+auto operator*(const StaticMatrix<T, N, N>& mat, const geometry::Point<N, T>& pt)
+    -> geometry::Point<N, T>
+{
+    geometry::Point<N, T> res;
+    for (std::size_t y = 0 ; y < N ; ++y)
+    {
+        T value = mat(y, 0) * pt[0];
+        for (std::size_t x = 1 ; x < N ; ++x)
+        {
+            value += mat(y, x) * pt[x];
+        }
+        res[y] = value;
+    }
+    return res;
+}
+
+template<typename T, std::size_t N>
+auto operator*(const StaticMatrix<T, N + 1, N + 1>& mat, const geometry::Vector<N, T>& vec)
+    -> geometry::Vector<N, T>
+{
+    // The last coordinate is 0: the last column is ignored
+    geometry::Vector<N, T> res;
+    for (std::size_t y = 0 ; y < N ; ++y)
+    {
+        T value = mat(y, 0) * vec[0];
+        for (std::size_t x = 1 ; x < N ; ++x)
+        {
+            value += mat(y, x) * vec[x];
+        }
+        res[y] = value;
+    }
+    return res;
+}
+
+template<typename T, std::size_t N>
+auto operator*(const StaticMatrix<T, N + 1, N + 1>& mat, const geometry::Point<N, T>& pt)
+    -> geometry::Point<N, T>
+{
+    // The last coordinate is 1: the last column is added as is
+    geometry::Point<N, T> res;
+    for (std::size_t y = 0 ; y < N ; ++y)
+    {
+        T value = mat(y, N);
+        for (std::size_t x = 0 ; x < N ; ++x)
+        {
+            value += mat(y, x) * pt[x];
+        }
+        res[y] = value;
+    }
+
+    T w = mat(N, N);
+    for (std::size_t x = 0 ; x < N ; ++x)
+    {
+        w += mat(N, x) * pt[x];
+    }
+    if (w != T(1))
+    {
+        for (std::size_t y = 0 ; y < N ; ++y)
+        {
+            res[y] /= w;
+        }
+    }
+    return res;
+}
+
+////////////////////////////////////////////////////////////
+// Miscellaneous functions
+////////////////////////////////////////////////////////////
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto transpose(const StaticMatrix<T, Height, Width>& mat)
+    -> StaticMatrix<T, Width, Height>
+{
+    return details::static_transpose(mat, std::make_index_sequence<Height * Width>{});
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto trace(const StaticMatrix<T, Height, Width>& mat)
+    -> T
+{
+    static_assert(Height == Width, "only square matrices have a trace");
+    T res = mat(0, 0);
+    for (std::size_t i = 1 ; i < Height ; ++i)
+    {
+        res += mat(i, i);
+    }
+    return res;
+}
+
+template<typename T>
+constexpr auto determinant(const StaticMatrix<T, 1, 1>& mat)
+    -> T
+{
+    return mat(0, 0);
+}
+
+template<typename T>
+constexpr auto determinant(const StaticMatrix<T, 2, 2>& mat)
+    -> T
+{
+    return mat(0, 0) * mat(1, 1) - mat(0, 1) * mat(1, 0);
+}
+
+template<typename T>
+constexpr auto determinant(const StaticMatrix<T, 3, 3>& mat)
+    -> T
+{
+    return mat(0, 0) * (mat(1, 1) * mat(2, 2) - mat(1, 2) * mat(2, 1))
+         - mat(0, 1) * (mat(1, 0) * mat(2, 2) - mat(1, 2) * mat(2, 0))
+         + mat(0, 2) * (mat(1, 0) * mat(2, 1) - mat(1, 1) * mat(2, 0));
+}
+
+template<typename T>
+constexpr auto determinant(const StaticMatrix<T, 4, 4>& mat)
+    -> T
+{
+    // Laplace expansion along the 2x2 minors
+    // of the two first and two last rows
+    const T s0 = mat(0, 0) * mat(1, 1) - mat(1, 0) * mat(0, 1);
+    const T s1 = mat(0, 0) * mat(1, 2) - mat(1, 0) * mat(0, 2);
+    const T s2 = mat(0, 0) * mat(1, 3) - mat(1, 0) * mat(0, 3);
+    const T s3 = mat(0, 1) * mat(1, 2) - mat(1, 1) * mat(0, 2);
+    const T s4 = mat(0, 1) * mat(1, 3) - mat(1, 1) * mat(0, 3);
+    const T s5 = mat(0, 2) * mat(1, 3) - mat(1, 2) * mat(0, 3);
+
+    const T c5 = mat(2, 2) * mat(3, 3) - mat(3, 2) * mat(2, 3);
+    const T c4 = mat(2, 1) * mat(3, 3) - mat(3, 1) * mat(2, 3);
+    const T c3 = mat(2, 1) * mat(3, 2) - mat(3, 1) * mat(2, 2);
+    const T c2 = mat(2, 0) * mat(3, 3) - mat(3, 0) * mat(2, 3);
+    const T c1 = mat(2, 0) * mat(3, 2) - mat(3, 0) * mat(2, 2);
+    const T c0 = mat(2, 0) * mat(3, 1) - mat(3, 0) * mat(2, 1);
+
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto determinant(const StaticMatrix<T, Height, Width>& mat)
+    -> T
+{
+    static_assert(Height == Width, "only square matrices have a determinant");
+    constexpr std::size_t n = Height;
+
+    // Bareiss algorithm with partial pivoting, every
+    // division is exact for integral types
+    T values[n * n] = {};
+    for (std::size_t i = 0 ; i < n * n ; ++i)
+    {
+        values[i] = mat.flat_value(i);
+    }
+
+    T previous(1);
+    bool negate = false;
+    for (std::size_t k = 0 ; k + 1 < n ; ++k)
+    {
+        std::size_t pivot_row = k;
+        for (std::size_t i = k + 1 ; i < n ; ++i)
+        {
+            if (details::static_abs(values[pivot_row * n + k])
+                < details::static_abs(values[i * n + k]))
+            {
+                pivot_row = i;
+            }
+        }
+        if (values[pivot_row * n + k] == T(0))
+        {
+            return T(0);
+        }
+        if (pivot_row != k)
+        {
+            details::static_swap_rows(values, k, pivot_row, n);
+            negate = not negate;
+        }
+
+        const T pivot = values[k * n + k];
+        for (std::size_t i = k + 1 ; i < n ; ++i)
+        {
+            const T factor = values[i * n + k];
+            for (std::size_t j = k + 1 ; j < n ; ++j)
+            {
+                values[i * n + j] = (values[i * n + j] * pivot
+                                     - factor * values[k * n + j]) / previous;
+            }
+        }
+        previous = pivot;
+    }
+
+    const T res = values[n * n - 1];
+    return negate ? T(-res) : res;
+}
+
+template<typename T>
+constexpr auto inverse(const StaticMatrix<T, 1, 1>& mat)
+    -> StaticMatrix<T, 1, 1>
+{
+    return StaticMatrix<T, 1, 1>(std::array<T, 1>{{ T(1) / mat(0, 0) }});
+}
+
+template<typename T>
+constexpr auto inverse(const StaticMatrix<T, 2, 2>& mat)
+    -> StaticMatrix<T, 2, 2>
+{
+    const T det = determinant(mat);
+    return StaticMatrix<T, 2, 2>({
+        {  mat(1, 1) / det, -mat(0, 1) / det },
+        { -mat(1, 0) / det,  mat(0, 0) / det }
+    });
+}
+
+template<typename T>
+constexpr auto inverse(const StaticMatrix<T, 3, 3>& mat)
+    -> StaticMatrix<T, 3, 3>
+{
+    // Transposed matrix of the cofactors
+    const T c00 = mat(1, 1) * mat(2, 2) - mat(1, 2) * mat(2, 1);
+    const T c01 = mat(1, 2) * mat(2, 0) - mat(1, 0) * mat(2, 2);
+    const T c02 = mat(1, 0) * mat(2, 1) - mat(1, 1) * mat(2, 0);
+    const T det = mat(0, 0) * c00 + mat(0, 1) * c01 + mat(0, 2) * c02;
+
+    return StaticMatrix<T, 3, 3>({
+        {
+            c00 / det,
+            (mat(0, 2) * mat(2, 1) - mat(0, 1) * mat(2, 2)) / det,
+            (mat(0, 1) * mat(1, 2) - mat(0, 2) * mat(1, 1)) / det
+        },
+        {
+            c01 / det,
+            (mat(0, 0) * mat(2, 2) - mat(0, 2) * mat(2, 0)) / det,
+            (mat(0, 2) * mat(1, 0) - mat(0, 0) * mat(1, 2)) / det
+        },
+        {
+            c02 / det,
+            (mat(0, 1) * mat(2, 0) - mat(0, 0) * mat(2, 1)) / det,
+            (mat(0, 0) * mat(1, 1) - mat(0, 1) * mat(1, 0)) / det
+        }
+    });
+}
+
+template<typename T>
+constexpr auto inverse(const StaticMatrix<T, 4, 4>& mat)
+    -> StaticMatrix<T, 4, 4>
+{
+    // Same 2x2 minors as the determinant, which
+    // are reused to compute the adjugate matrix
+    const T s0 = mat(0, 0) * mat(1, 1) - mat(1, 0) * mat(0, 1);
+    const T s1 = mat(0, 0) * mat(1, 2) - mat(1, 0) * mat(0, 2);
+    const T s2 = mat(0, 0) * mat(1, 3) - mat(1, 0) * mat(0, 3);
+    const T s3 = mat(0, 1) * mat(1, 2) - mat(1, 1) * mat(0, 2);
+    const T s4 = mat(0, 1) * mat(1, 3) - mat(1, 1) * mat(0, 3);
+    const T s5 = mat(0, 2) * mat(1, 3) - mat(1, 2) * mat(0, 3);
+
+    const T c5 = mat(2, 2) * mat(3, 3) - mat(3, 2) * mat(2, 3);
+    const T c4 = mat(2, 1) * mat(3, 3) - mat(3, 1) * mat(2, 3);
+    const T c3 = mat(2, 1) * mat(3, 2) - mat(3, 1) * mat(2, 2);
+    const T c2 = mat(2, 0) * mat(3, 3) - mat(3, 0) * mat(2, 3);
+    const T c1 = mat(2, 0) * mat(3, 2) - mat(3, 0) * mat(2, 2);
+    const T c0 = mat(2, 0) * mat(3, 1) - mat(3, 0) * mat(2, 1);
+
+    const T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+
+    return StaticMatrix<T, 4, 4>({
+        {
+            ( mat(1, 1) * c5 - mat(1, 2) * c4 + mat(1, 3) * c3) / det,
+            (-mat(0, 1) * c5 + mat(0, 2) * c4 - mat(0, 3) * c3) / det,
+            ( mat(3, 1) * s5 - mat(3, 2) * s4 + mat(3, 3) * s3) / det,
+            (-mat(2, 1) * s5 + mat(2, 2) * s4 - mat(2, 3) * s3) / det
+        },
+        {
+            (-mat(1, 0) * c5 + mat(1, 2) * c2 - mat(1, 3) * c1) / det,
+            ( mat(0, 0) * c5 - mat(0, 2) * c2 + mat(0, 3) * c1) / det,
+            (-mat(3, 0) * s5 + mat(3, 2) * s2 - mat(3, 3) * s1) / det,
+            ( mat(2, 0) * s5 - mat(2, 2) * s2 + mat(2, 3) * s1) / det
+        },
+        {
+            ( mat(1, 0) * c4 - mat(1, 1) * c2 + mat(1, 3) * c0) / det,
+            (-mat(0, 0) * c4 + mat(0, 1) * c2 - mat(0, 3) * c0) / det,
+            ( mat(3, 0) * s4 - mat(3, 1) * s2 + mat(3, 3) * s0) / det,
+            (-mat(2, 0) * s4 + mat(2, 1) * s2 - mat(2, 3) * s0) / det
+        },
+        {
+            (-mat(1, 0) * c3 + mat(1, 1) * c1 - mat(1, 2) * c0) / det,
+            ( mat(0, 0) * c3 - mat(0, 1) * c1 + mat(0, 2) * c0) / det,
+            (-mat(3, 0) * s3 + mat(3, 1) * s1 - mat(3, 2) * s0) / det,
+            ( mat(2, 0) * s3 - mat(2, 1) * s1 + mat(2, 2) * s0) / det
+        }
+    });
+}
+
+template<typename T, std::size_t Height, std::size_t Width>
+constexpr auto inverse(const StaticMatrix<T, Height, Width>& mat)
+    -> StaticMatrix<T, Height, Width>
+{
+    static_assert(Height == Width, "only square matrices can be inverted");
+    static_assert(not std::is_integral<T>::value,
+                  "integral matrices bigger than 4x4 can't be inverted");
+    constexpr std::size_t n = Height;
+
+    // Gauss-Jordan elimination with partial pivoting
+    T values[n * n] = {};
+    T res[n * n] = {};
+    for (std::size_t i = 0 ; i < n * n ; ++i)
+    {
+        values[i] = mat.flat_value(i);
+        res[i] = T(i / n == i % n ? 1 : 0);
+    }
+
+    for (std::size_t k = 0 ; k < n ; ++k)
+    {
+        std::size_t pivot_row = k;
+        for (std::size_t i = k + 1 ; i < n ; ++i)
+        {
+            if (details::static_abs(values[pivot_row * n + k])
+                < details::static_abs(values[i * n + k]))
+            {
+                pivot_row = i;
+            }
+        }
+        if (pivot_row != k)
+        {
+            details::static_swap_rows(values, k, pivot_row, n);
+            details::static_swap_rows(res, k, pivot_row, n);
+        }
+
+        const T pivot = values[k * n + k];
+        for (std::size_t j = 0 ; j < n ; ++j)
+        {
+            values[k * n + j] /= pivot;
+            res[k * n + j] /= pivot;
+        }
+
+        for (std::size_t i = 0 ; i < n ; ++i)
+        {
+            if (i == k) continue;
+            const T factor = values[i * n + k];
+            if (factor == T(0)) continue;
+
+            for (std::size_t j = 0 ; j < n ; ++j)
+            {
+                values[i * n + j] -= factor * values[k * n + j];
+                res[i * n + j] -= factor * res[k * n + j];
+            }
+        }
+    }
+
+    return details::static_from_buffer<T, Height, Width>(
+        res, std::make_index_sequence<Height * Width>{}
+    );
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+namespace details
+{
+    // Under this size, a block and its transpose
+    // both fit in the L1 cache
+    constexpr std::size_t transpose_block = 16;
+
+    template<typename T>
+    auto transpose_recursive(std::size_t height, std::size_t width,
+                             const T* src, std::size_t lds,
+                             T* dst, std::size_t ldd)
+        -> void
+    {
+        if (height <= transpose_block && width <= transpose_block)
+        {
+            for (std::size_t y = 0 ; y < height ; ++y)
+            {
+                for (std::size_t x = 0 ; x < width ; ++x)
+                {
+                    dst[x * ldd + y] = src[y * lds + x];
+                }
+            }
+            return;
+        }
+
+        if (height >= width)
+        {
+            const std::size_t half = height / 2;
+            transpose_recursive(half, width, src, lds, dst, ldd);
+            transpose_recursive(height - half, width, src + half * lds, lds, dst + half, ldd);
+        }
+        else
+        {
+            const std::size_t half = width / 2;
+            transpose_recursive(height, half, src, lds, dst, ldd);
+            transpose_recursive(height, width - half, src + half, lds, dst + half * ldd, ldd);
+        }
+    }
+
+    // Swaps the height x width block lhs with the
+    // transpose of the width x height block rhs
+    template<typename T>
+    auto swap_transposed(std::size_t height, std::size_t width,
+                         T* lhs, T* rhs, std::size_t ld)
+        -> void
+    {
+        if (height <= transpose_block && width <= transpose_block)
+        {
+            using std::swap;
+            for (std::size_t y = 0 ; y < height ; ++y)
+            {
+                for (std::size_t x = 0 ; x < width ; ++x)
+                {
+                    swap(lhs[y * ld + x], rhs[x * ld + y]);
+                }
+            }
+            return;
+        }
+
+        if (height >= width)
+        {
+            const std::size_t half = height / 2;
+            swap_transposed(half, width, lhs, rhs, ld);
+            swap_transposed(height - half, width, lhs + half * ld, rhs + half, ld);
+        }
+        else
+        {
+            const std::size_t half = width / 2;
+            swap_transposed(height, half, lhs, rhs, ld);
+            swap_transposed(height, width - half, lhs + half, rhs + half * ld, ld);
+        }
+    }
+
+    template<typename T>
+    auto transpose_in_place_recursive(std::size_t size, T* data, std::size_t ld)
+        -> void
+    {
+        if (size <= transpose_block)
+        {
+            using std::swap;
+            for (std::size_t y = 0 ; y < size ; ++y)
+            {
+                for (std::size_t x = y + 1 ; x < size ; ++x)
+                {
+                    swap(data[y * ld + x], data[x * ld + y]);
+                }
+            }
+            return;
+        }
+
+        const std::size_t half = size / 2;
+        transpose_in_place_recursive(half, data, ld);
+        transpose_in_place_recursive(size - half, data + half * ld + half, ld);
+        swap_transposed(half, size - half, data + half, data + half * ld, ld);
+    }
+}
+
+template<typename T>
+auto transpose(std::size_t height, std::size_t width,
+               const T* src, std::size_t lds,
+               T* dst, std::size_t ldd)
+    -> void
+{
+    details::transpose_recursive(height, width, src, lds, dst, ldd);
+}
+
+template<typename T>
+auto transpose_in_place(std::size_t size, T* data, std::size_t ld)
+    -> void
+{
+    details::transpose_in_place_recursive(size, data, ld);
+}
@@ -0,0 +1,598 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+namespace details
+{
+    ////////////////////////////////////////////////////////////
+    // Aliasing between a view and an expression
+
+    // Memory spanned by a matrix: the address of its first
+    // element, one past its last element, and its strides
+    struct memory_layout
+    {
+        const void* first;
+        const void* last;
+        std::size_t row_stride;
+        std::size_t col_stride;
+    };
+
+    template<typename T>
+    auto make_layout(const T* data, std::size_t height, std::size_t width,
+                     std::size_t row_stride, std::size_t col_stride)
+        -> memory_layout
+    {
+        if (height == 0 || width == 0)
+        {
+            return { data, data, row_stride, col_stride };
+        }
+        const T* last = data + (height - 1) * row_stride + (width - 1) * col_stride + 1;
+        return { data, last, row_stride, col_stride };
+    }
+
+    template<typename T, typename Allocator>
+    auto layout(const Matrix<T, Allocator>& mat)
+        -> memory_layout
+    {
+        return make_layout(mat.data(), mat.height(), mat.width(), mat.width(), 1);
+    }
+
+    template<typename T>
+    auto layout(const MatrixView<T>& view)
+        -> memory_layout
+    {
+        return make_layout(view.data(), view.height(), view.width(), view.stride(), 1);
+    }
+
+    template<typename T>
+    auto layout(const StridedMatrixView<T>& view)
+        -> memory_layout
+    {
+        return make_layout(view.data(), view.height(), view.width(),
+                           view.row_stride(), view.col_stride());
+    }
+
+    /**
+     * Whether evaluating expr element by element while writing
+     * to dest may read an element after it has been written.
+     * A matrix with the same first element and strides as the
+     * destination only reads the element being written.
+     */
+    template<typename Mat>
+    auto may_alias(const memory_layout& dest, const Mat& mat)
+        -> decltype(layout(mat), bool())
+    {
+        const memory_layout src = layout(mat);
+        std::less<const void*> less;
+        if (not less(src.first, dest.last) || not less(dest.first, src.last))
+        {
+            return false;
+        }
+        return src.first != dest.first
+            || src.row_stride != dest.row_stride
+            || src.col_stride != dest.col_stride;
+    }
+
+    template<typename Lhs, typename Rhs, typename BinaryOperation>
+    auto may_alias(const memory_layout& dest,
+                   const MatrixBinaryExpression<Lhs, Rhs, BinaryOperation>& expr)
+        -> bool;
+
+    template<typename Operand, typename UnaryOperation>
+    auto may_alias(const memory_layout& dest,
+                   const MatrixUnaryExpression<Operand, UnaryOperation>& expr)
+        -> bool;
+
+    // Matrices whose memory is unknown are assumed to alias
+    template<typename Derived>
+    auto may_alias(const memory_layout&, const ImmutableMatrix<Derived>&)
+        -> bool
+    {
+        return true;
+    }
+
+    template<typename Lhs, typename Rhs, typename BinaryOperation>
+    auto may_alias(const memory_layout& dest,
+                   const MatrixBinaryExpression<Lhs, Rhs, BinaryOperation>& expr)
+        -> bool
+    {
+        return may_alias(dest, expr.lhs()) || may_alias(dest, expr.rhs());
+    }
+
+    template<typename Operand, typename UnaryOperation>
+    auto may_alias(const memory_layout& dest,
+                   const MatrixUnaryExpression<Operand, UnaryOperation>& expr)
+        -> bool
+    {
+        return may_alias(dest, expr.operand());
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Element-wise operations on views
+
+    // Calls func(view(y, x), expr(y, x)) for every
+    // element of the view in row-major order
+    template<typename View, typename Expression, typename Function>
+    auto apply_to_view(const View& view, const Expression& expr, Function func)
+        -> void
+    {
+        POLDER_ASSERT(view.height() == expr.height());
+        POLDER_ASSERT(view.width() == expr.width());
+        if (may_alias(layout(view), expr))
+        {
+            // The expression may read elements of the view
+            // after they have been overwritten
+            const Matrix<typename View::value_type> tmp(expr);
+            apply_to_view(view, tmp, func);
+            return;
+        }
+        for (std::size_t y = 0 ; y < view.height() ; ++y)
+        {
+            for (std::size_t x = 0 ; x < view.width() ; ++x)
+            {
+                func(view(y, x), expr(y, x));
+            }
+        }
+    }
+
+    template<typename View, typename Function>
+    auto apply_to_view(const View& view, Function func)
+        -> void
+    {
+        for (std::size_t y = 0 ; y < view.height() ; ++y)
+        {
+            for (std::size_t x = 0 ; x < view.width() ; ++x)
+            {
+                func(view(y, x));
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////
+// MatrixSlice
+////////////////////////////////////////////////////////////
+
+template<typename T>
+inline MatrixSlice<T>::MatrixSlice(size_type size, T* data_addr, size_type stride):
+    _size(size),
+    _data(data_addr),
+    _stride(stride)
+{}
+
+template<typename T>
+template<typename U, typename>
+inline MatrixSlice<T>::MatrixSlice(const MatrixSlice<U>& other):
+    _size(other.size()),
+    _data(other.data()),
+    _stride(other.stride())
+{}
+
+template<typename T>
+inline auto MatrixSlice<T>::operator[](size_type index) const
+    -> reference
+{
+    return _data[index * _stride];
+}
+
+template<typename T>
+inline auto MatrixSlice<T>::begin() const
+    -> iterator
+{
+    return { _data, difference_type(_stride) };
+}
+
+template<typename T>
+inline auto MatrixSlice<T>::cbegin() const
+    -> const_iterator
+{
+    return { _data, difference_type(_stride) };
+}
+
+template<typename T>
+inline auto MatrixSlice<T>::end() const
+    -> iterator
+{
+    return begin() + difference_type(_size);
+}
+
+template<typename T>
+inline auto MatrixSlice<T>::cend() const
+    -> const_iterator
+{
+    return cbegin() + difference_type(_size);
+}
+
+template<typename T>
+inline auto MatrixSlice<T>::data() const
+    -> pointer
+{
+    return _data;
+}
+
+template<typename T>
+inline auto MatrixSlice<T>::stride() const
+    -> size_type
+{
+    return _stride;
+}
+
+template<typename T>
+inline auto MatrixSlice<T>::size() const
+    -> size_type
+{
+    return _size;
+}
+
+////////////////////////////////////////////////////////////
+// MatrixView
+////////////////////////////////////////////////////////////
+
+template<typename T>
+MatrixView<T>::MatrixView(T* data, size_type height, size_type width):
+    MatrixView(data, height, width, width)
+{}
+
+template<typename T>
+MatrixView<T>::MatrixView(T* data, size_type height, size_type width, size_type stride):
+    _data(data),
+    _height(height),
+    _width(width),
+    _stride(stride)
+{
+    POLDER_ASSERT(stride >= width);
+}
+
+template<typename T>
+template<typename U, typename>
+MatrixView<T>::MatrixView(const MatrixView<U>& other):
+    _data(other.data()),
+    _height(other.height()),
+    _width(other.width()),
+    _stride(other.stride())
+{}
+
+template<typename T>
+auto MatrixView<T>::operator=(const MatrixView& other)
+    -> MatrixView&
+{
+    details::apply_to_view(*this, other, assign());
+    return *this;
+}
+
+template<typename T>
+template<typename Derived>
+auto MatrixView<T>::operator=(const ImmutableMatrix<Derived>& expr)
+    -> MatrixView&
+{
+    details::apply_to_view(*this, expr.derived(), assign());
+    return *this;
+}
+
+template<typename T>
+template<typename Derived>
+auto MatrixView<T>::operator+=(const ImmutableMatrix<Derived>& expr)
+    -> MatrixView&
+{
+    details::apply_to_view(*this, expr.derived(), plus_assign());
+    return *this;
+}
+
+template<typename T>
+template<typename Derived>
+auto MatrixView<T>::operator-=(const ImmutableMatrix<Derived>& expr)
+    -> MatrixView&
+{
+    details::apply_to_view(*this, expr.derived(), minus_assign());
+    return *this;
+}
+
+template<typename T>
+auto MatrixView<T>::operator*=(value_type value)
+    -> MatrixView&
+{
+    details::apply_to_view(*this, [value](reference elem) { elem *= value; });
+    return *this;
+}
+
+template<typename T>
+auto MatrixView<T>::operator/=(value_type value)
+    -> MatrixView&
+{
+    details::apply_to_view(*this, [value](reference elem) { elem /= value; });
+    return *this;
+}
+
+template<typename T>
+inline auto MatrixView<T>::operator[](size_type index) const
+    -> row
+{
+    return { _width, _data + index * _stride };
+}
+
+template<typename T>
+inline auto MatrixView<T>::operator()(size_type y, size_type x) const
+    -> reference
+{
+    return _data[y * _stride + x];
+}
+
+template<typename T>
+inline auto MatrixView<T>::data() const
+    -> pointer
+{
+    return _data;
+}
+
+template<typename T>
+auto MatrixView<T>::block(size_type y, size_type x, size_type height, size_type width) const
+    -> MatrixView
+{
+    POLDER_ASSERT(y + height <= _height);
+    POLDER_ASSERT(x + width <= _width);
+    return { _data + y * _stride + x, height, width, _stride };
+}
+
+template<typename T>
+auto MatrixView<T>::col(size_type x) const
+    -> column
+{
+    POLDER_ASSERT(x < _width);
+    return { _height, _data + x, _stride };
+}
+
+template<typename T>
+auto MatrixView<T>::transposed() const
+    -> StridedMatrixView<T>
+{
+    return { _data, _width, _height, 1, _stride };
+}
+
+template<typename T>
+inline auto MatrixView<T>::begin() const
+    -> iterator
+{
+    return { _data, _width, 0, _stride };
+}
+
+template<typename T>
+inline auto MatrixView<T>::end() const
+    -> iterator
+{
+    return { _data, _width, difference_type(_height), _stride };
+}
+
+template<typename T>
+inline auto MatrixView<T>::rbegin() const
+    -> reverse_iterator
+{
+    return reverse_iterator(end());
+}
+
+template<typename T>
+inline auto MatrixView<T>::rend() const
+    -> reverse_iterator
+{
+    return reverse_iterator(begin());
+}
+
+template<typename T>
+auto MatrixView<T>::fill(value_type value) const
+    -> void
+{
+    for (const auto& line: *this)
+    {
+        std::fill(line.begin(), line.end(), value);
+    }
+}
+
+template<typename T>
+inline auto MatrixView<T>::height() const
+    -> size_type
+{
+    return _height;
+}
+
+template<typename T>
+inline auto MatrixView<T>::width() const
+    -> size_type
+{
+    return _width;
+}
+
+template<typename T>
+inline auto MatrixView<T>::stride() const
+    -> size_type
+{
+    return _stride;
+}
+
+template<typename T>
+inline auto MatrixView<T>::is_contiguous() const
+    -> bool
+{
+    return _stride == _width || _height <= 1;
+}
+
+////////////////////////////////////////////////////////////
+// StridedMatrixView
+////////////////////////////////////////////////////////////
+
+template<typename T>
+StridedMatrixView<T>::StridedMatrixView(T* data, size_type height, size_type width,
+                                        size_type row_stride, size_type col_stride):
+    _data(data),
+    _height(height),
+    _width(width),
+    _row_stride(row_stride),
+    _col_stride(col_stride)
+{}
+
+template<typename T>
+template<typename U, typename>
+StridedMatrixView<T>::StridedMatrixView(const StridedMatrixView<U>& other):
+    _data(other.data()),
+    _height(other.height()),
+    _width(other.width()),
+    _row_stride(other.row_stride()),
+    _col_stride(other.col_stride())
+{}
+
+template<typename T>
+template<typename U, typename>
+StridedMatrixView<T>::StridedMatrixView(const MatrixView<U>& other):
+    _data(other.data()),
+    _height(other.height()),
+    _width(other.width()),
+    _row_stride(other.stride()),
+    _col_stride(1)
+{}
+
+template<typename T>
+auto StridedMatrixView<T>::operator=(const StridedMatrixView& other)
+    -> StridedMatrixView&
+{
+    details::apply_to_view(*this, other, assign());
+    return *this;
+}
+
+template<typename T>
+template<typename Derived>
+auto StridedMatrixView<T>::operator=(const ImmutableMatrix<Derived>& expr)
+    -> StridedMatrixView&
+{
+    details::apply_to_view(*this, expr.derived(), assign());
+    return *this;
+}
+
+template<typename T>
+template<typename Derived>
+auto StridedMatrixView<T>::operator+=(const ImmutableMatrix<Derived>& expr)
+    -> StridedMatrixView&
+{
+    details::apply_to_view(*this, expr.derived(), plus_assign());
+    return *this;
+}
+
+template<typename T>
+template<typename Derived>
+auto StridedMatrixView<T>::operator-=(const ImmutableMatrix<Derived>& expr)
+    -> StridedMatrixView&
+{
+    details::apply_to_view(*this, expr.derived(), minus_assign());
+    return *this;
+}
+
+template<typename T>
+auto StridedMatrixView<T>::operator*=(value_type value)
+    -> StridedMatrixView&
+{
+    details::apply_to_view(*this, [value](reference elem) { elem *= value; });
+    return *this;
+}
+
+template<typename T>
+auto StridedMatrixView<T>::operator/=(value_type value)
+    -> StridedMatrixView&
+{
+    details::apply_to_view(*this, [value](reference elem) { elem /= value; });
+    return *this;
+}
+
+template<typename T>
+inline auto StridedMatrixView<T>::operator[](size_type index) const
+    -> row
+{
+    return { _width, _data + index * _row_stride, _col_stride };
+}
+
+template<typename T>
+inline auto StridedMatrixView<T>::operator()(size_type y, size_type x) const
+    -> reference
+{
+    return _data[y * _row_stride + x * _col_stride];
+}
+
+template<typename T>
+inline auto StridedMatrixView<T>::data() const
+    -> pointer
+{
+    return _data;
+}
+
+template<typename T>
+auto StridedMatrixView<T>::block(size_type y, size_type x, size_type height, size_type width) const
+    -> StridedMatrixView
+{
+    POLDER_ASSERT(y + height <= _height);
+    POLDER_ASSERT(x + width <= _width);
+    return {
+        _data + y * _row_stride + x * _col_stride,
+        height, width,
+        _row_stride, _col_stride
+    };
+}
+
+template<typename T>
+auto StridedMatrixView<T>::col(size_type x) const
+    -> column
+{
+    POLDER_ASSERT(x < _width);
+    return { _height, _data + x * _col_stride, _row_stride };
+}
+
+template<typename T>
+auto StridedMatrixView<T>::transposed() const
+    -> StridedMatrixView
+{
+    return { _data, _width, _height, _col_stride, _row_stride };
+}
+
+template<typename T>
+auto StridedMatrixView<T>::fill(value_type value) const
+    -> void
+{
+    details::apply_to_view(*this, [value](reference elem) { elem = value; });
+}
+
+template<typename T>
+inline auto StridedMatrixView<T>::height() const
+    -> size_type
+{
+    return _height;
+}
+
+template<typename T>
+inline auto StridedMatrixView<T>::width() const
+    -> size_type
+{
+    return _width;
+}
+
+template<typename T>
+inline auto StridedMatrixView<T>::row_stride() const
+    -> size_type
+{
+    return _row_stride;
+}
+
+template<typename T>
+inline auto StridedMatrixView<T>::col_stride() const
+    -> size_type
+{
+    return _col_stride;
+}
@@ -0,0 +1,426 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_MATRIX_EXPRESSION_H_
+#define POLDER_MATRIX_EXPRESSION_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <POLDER/details/config.h>
+#include <POLDER/matrix/base.h>
+
+namespace polder
+{
+    namespace details
+    {
+        template<typename Derived>
+        auto is_matrix_expression_impl(const ImmutableMatrix<Derived>*)
+            -> std::true_type;
+
+        auto is_matrix_expression_impl(...)
+            -> std::false_type;
+    }
+
+    /**
+     * @brief Whether a type is a matrix type
+     *
+     * Every class deriving from ImmutableMatrix, be it a
+     * Matrix or a lazy matrix expression, can be used in
+     * the element-wise arithmetic operations.
+     */
+    template<typename T>
+    using is_matrix_expression = decltype(
+        details::is_matrix_expression_impl(std::declval<T*>())
+    );
+
+    namespace details
+    {
+        // Lvalue operands are stored by reference while
+        // rvalue operands are moved into the expression
+        template<typename T>
+        using expression_operand_t = std::conditional_t<
+            std::is_lvalue_reference<T>::value,
+            const std::remove_reference_t<T>&,
+            std::remove_cv_t<std::remove_reference_t<T>>
+        >;
+
+        template<typename T>
+        using enable_if_matrix_t = std::enable_if_t<
+            is_matrix_expression<std::decay_t<T>>::value
+        >;
+
+        // Matrix types whose dimensions are known at compile
+        // time have their own eager element-wise operations,
+        // the lazy ones are only used when a dynamic matrix
+        // is involved
+        template<typename T>
+        struct is_static_matrix:
+            std::false_type
+        {};
+
+        template<typename... Operands>
+        using enable_if_lazy_t = std::enable_if_t<
+            not std::is_same<
+                std::integer_sequence<bool, true, is_static_matrix<std::decay_t<Operands>>::value...>,
+                std::integer_sequence<bool, is_static_matrix<std::decay_t<Operands>>::value..., true>
+            >::value
+        >;
+
+        // Function objects for the operations with a scalar
+
+        template<typename T>
+        struct multiplies_by
+        {
+            T value;
+
+            template<typename U>
+            constexpr auto operator()(const U& arg) const
+                -> decltype(arg * value)
+            {
+                return arg * value;
+            }
+        };
+
+        template<typename T>
+        struct divides_by
+        {
+            T value;
+
+            template<typename U>
+            constexpr auto operator()(const U& arg) const
+                -> decltype(arg / value)
+            {
+                return arg / value;
+            }
+        };
+    }
+
+    template<typename Lhs, typename Rhs, typename BinaryOperation>
+    class MatrixBinaryExpression;
+
+    template<typename Operand, typename UnaryOperation>
+    class MatrixUnaryExpression;
+
+    /**
+     * @brief Trait holding the MatrixBinaryExpression types
+     */
+    template<typename Lhs, typename Rhs, typename BinaryOperation>
+    struct types_t<MatrixBinaryExpression<Lhs, Rhs, BinaryOperation>>
+    {
+        using value_type = typename types_t<std::decay_t<Lhs>>::value_type;
+        using reference = value_type;
+        using const_reference = value_type;
+        using pointer = const value_type*;
+        using const_pointer = const value_type*;
+    };
+
+    /**
+     * @brief Trait holding the MatrixUnaryExpression types
+     */
+    template<typename Operand, typename UnaryOperation>
+    struct types_t<MatrixUnaryExpression<Operand, UnaryOperation>>
+    {
+        using value_type = typename types_t<std::decay_t<Operand>>::value_type;
+        using reference = value_type;
+        using const_reference = value_type;
+        using pointer = const value_type*;
+        using const_pointer = const value_type*;
+    };
+
+    /**
+     * @brief Lazy element-wise operation between two matrices
+     *
+     * The elements are only computed when they are accessed,
+     * which generally happens when the expression is assigned
+     * to a Matrix. A chain of element-wise operations is then
+     * computed in a single loop without any temporary Matrix.
+     *
+     * Since lvalue operands are stored by reference, an
+     * expression shall not outlive them.
+     */
+    template<typename Lhs, typename Rhs, typename BinaryOperation>
+    class MatrixBinaryExpression:
+        public ImmutableMatrix<MatrixBinaryExpression<Lhs, Rhs, BinaryOperation>>
+    {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Types
+            ////////////////////////////////////////////////////////////
+
+            using super = ImmutableMatrix<MatrixBinaryExpression<Lhs, Rhs, BinaryOperation>>;
+
+            using typename super::size_type;
+            using typename super::value_type;
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+            ////////////////////////////////////////////////////////////
+
+            template<typename L, typename R>
+            MatrixBinaryExpression(L&& lhs, R&& rhs, BinaryOperation op);
+
+            ////////////////////////////////////////////////////////////
+            // Element access
+            ////////////////////////////////////////////////////////////
+
+            using super::operator[];
+            auto operator()(size_type y, size_type x) const
+                -> value_type;
+
+            /**
+             * @brief Element at the given row-major position
+             *
+             * Only usable when both operands have a flat layout.
+             */
+            auto flat_value(size_type index) const
+                -> value_type;
+
+            ////////////////////////////////////////////////////////////
+            // Capacity
+            ////////////////////////////////////////////////////////////
+
+            auto height() const
+                -> size_type;
+            auto width() const
+                -> size_type;
+
+            auto lhs() const
+                -> const std::decay_t<Lhs>&;
+            auto rhs() const
+                -> const std::decay_t<Rhs>&;
+
+        private:
+
+            Lhs _lhs;
+            Rhs _rhs;
+            BinaryOperation _op;
+    };
+
+    /**
+     * @brief Lazy element-wise operation on a matrix
+     *
+     * Same as MatrixBinaryExpression for unary operations,
+     * which includes the operations with a scalar.
+     */
+    template<typename Operand, typename UnaryOperation>
+    class MatrixUnaryExpression:
+        public ImmutableMatrix<MatrixUnaryExpression<Operand, UnaryOperation>>
+    {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Types
+            ////////////////////////////////////////////////////////////
+
+            using super = ImmutableMatrix<MatrixUnaryExpression<Operand, UnaryOperation>>;
+
+            using typename super::size_type;
+            using typename super::value_type;
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+            ////////////////////////////////////////////////////////////
+
+            template<typename T>
+            MatrixUnaryExpression(T&& operand, UnaryOperation op);
+
+            ////////////////////////////////////////////////////////////
+            // Element access
+            ////////////////////////////////////////////////////////////
+
+            using super::operator[];
+            auto operator()(size_type y, size_type x) const
+                -> value_type;
+
+            auto flat_value(size_type index) const
+                -> value_type;
+
+            ////////////////////////////////////////////////////////////
+            // Capacity
+            ////////////////////////////////////////////////////////////
+
+            auto height() const
+                -> size_type;
+            auto width() const
+                -> size_type;
+
+            auto operand() const
+                -> const std::decay_t<Operand>&;
+
+        private:
+
+            Operand _operand;
+            UnaryOperation _op;
+    };
+
+    namespace details
+    {
+        ////////////////////////////////////////////////////////////
+        // Flat access to the elements
+
+        /**
+         * Whether the elements of a matrix type can be accessed
+         * through a single row-major index, in which case the
+         * expressions can be evaluated with a single loop.
+         */
+        template<typename T>
+        struct has_flat_access:
+            std::false_type
+        {};
+
+        template<typename T, typename Allocator>
+        struct has_flat_access<Matrix<T, Allocator>>:
+            std::true_type
+        {};
+
+        template<typename Lhs, typename Rhs, typename BinaryOperation>
+        struct has_flat_access<MatrixBinaryExpression<Lhs, Rhs, BinaryOperation>>:
+            std::integral_constant<bool,
+                has_flat_access<std::decay_t<Lhs>>::value &&
+                has_flat_access<std::decay_t<Rhs>>::value
+            >
+        {};
+
+        template<typename Operand, typename UnaryOperation>
+        struct has_flat_access<MatrixUnaryExpression<Operand, UnaryOperation>>:
+            has_flat_access<std::decay_t<Operand>>
+        {};
+
+        template<typename T, typename Allocator>
+        auto flat_value(const Matrix<T, Allocator>& mat, std::size_t index)
+            -> T;
+
+        template<typename Expression>
+        auto flat_value(const Expression& expr, std::size_t index)
+            -> decltype(expr.flat_value(index));
+
+        ////////////////////////////////////////////////////////////
+        // Evaluation
+
+        /**
+         * Returns a Matrix holding the values of the given
+         * matrix type; a Matrix is returned as is.
+         */
+        template<typename T, typename Allocator>
+        auto evaluate(const Matrix<T, Allocator>& mat)
+            -> const Matrix<T, Allocator>&;
+
+        template<typename Derived>
+        auto evaluate(const ImmutableMatrix<Derived>& expr)
+            -> Matrix<typename types_t<Derived>::value_type>;
+
+        /**
+         * Calls func(out[i], value) for every value of the
+         * expression in row-major order. It is done in a single
+         * flat loop when the expression allows it.
+         */
+        template<typename T, typename Expression, typename Function>
+        auto apply_expression(T* out, const Expression& expr, Function func)
+            -> void;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Element-wise arithmetic operations
+    ////////////////////////////////////////////////////////////
+
+    template<typename Lhs, typename Rhs,
+             typename = details::enable_if_matrix_t<Lhs>,
+             typename = details::enable_if_matrix_t<Rhs>,
+             typename = details::enable_if_lazy_t<Lhs, Rhs>>
+    auto operator+(Lhs&& lhs, Rhs&& rhs)
+        -> MatrixBinaryExpression<
+            details::expression_operand_t<Lhs>,
+            details::expression_operand_t<Rhs>,
+            std::plus<>
+        >;
+
+    template<typename Lhs, typename Rhs,
+             typename = details::enable_if_matrix_t<Lhs>,
+             typename = details::enable_if_matrix_t<Rhs>,
+             typename = details::enable_if_lazy_t<Lhs, Rhs>>
+    auto operator-(Lhs&& lhs, Rhs&& rhs)
+        -> MatrixBinaryExpression<
+            details::expression_operand_t<Lhs>,
+            details::expression_operand_t<Rhs>,
+            std::minus<>
+        >;
+
+    template<typename Operand,
+             typename = details::enable_if_matrix_t<Operand>,
+             typename = details::enable_if_lazy_t<Operand>>
+    auto operator-(Operand&& operand)
+        -> MatrixUnaryExpression<
+            details::expression_operand_t<Operand>,
+            std::negate<>
+        >;
+
+    // Matrix-value_type arithmetic operations
+
+    template<typename Operand,
+             typename = details::enable_if_matrix_t<Operand>,
+             typename = details::enable_if_lazy_t<Operand>>
+    auto operator*(Operand&& operand, const typename types_t<std::decay_t<Operand>>::value_type& value)
+        -> MatrixUnaryExpression<
+            details::expression_operand_t<Operand>,
+            details::multiplies_by<typename types_t<std::decay_t<Operand>>::value_type>
+        >;
+
+    template<typename Operand,
+             typename = details::enable_if_matrix_t<Operand>,
+             typename = details::enable_if_lazy_t<Operand>>
+    auto operator*(const typename types_t<std::decay_t<Operand>>::value_type& value, Operand&& operand)
+        -> MatrixUnaryExpression<
+            details::expression_operand_t<Operand>,
+            details::multiplies_by<typename types_t<std::decay_t<Operand>>::value_type>
+        >;
+
+    template<typename Operand,
+             typename = details::enable_if_matrix_t<Operand>,
+             typename = details::enable_if_lazy_t<Operand>>
+    auto operator/(Operand&& operand, const typename types_t<std::decay_t<Operand>>::value_type& value)
+        -> MatrixUnaryExpression<
+            details::expression_operand_t<Operand>,
+            details::divides_by<typename types_t<std::decay_t<Operand>>::value_type>
+        >;
+
+    ////////////////////////////////////////////////////////////
+    // Operations between any matrix types
+    ////////////////////////////////////////////////////////////
+
+    // Products are not element-wise: the operands are
+    // evaluated then multiplied as Matrix instances
+    template<typename Lhs, typename Rhs>
+    auto operator*(const ImmutableMatrix<Lhs>& lhs, const ImmutableMatrix<Rhs>& rhs)
+        -> Matrix<typename types_t<Lhs>::value_type>;
+
+    template<typename Lhs, typename Rhs>
+    auto operator==(const ImmutableMatrix<Lhs>& lhs, const ImmutableMatrix<Rhs>& rhs)
+        -> bool;
+    template<typename Lhs, typename Rhs>
+    auto operator!=(const ImmutableMatrix<Lhs>& lhs, const ImmutableMatrix<Rhs>& rhs)
+        -> bool;
+
+    #include "detail/expression.inl"
+}
+
+#endif // POLDER_MATRIX_EXPRESSION_H_
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_MATRIX_GEMM_H_
+#define POLDER_MATRIX_GEMM_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <POLDER/details/config.h>
+#include <POLDER/execution.h>
+#include <POLDER/memory.h>
+
+#if POLDER_X86_DISPATCH
+    #include <immintrin.h>
+#endif
+
+namespace polder
+{
+    /**
+     * @brief How the product is stored in c
+     *
+     * Accumulating the product directly into c avoids
+     * computing it in a temporary matrix first.
+     */
+    enum class gemm_mode
+    {
+        assign,     /**< c = a * b */
+        add,        /**< c += a * b */
+        subtract    /**< c -= a * b */
+    };
+
+    /**
+     * @brief General matrix multiplication
+     *
+     * Computes c = a * b where a is a m x k matrix, b is a
+     * k x n matrix and c is a m x n matrix. The matrices are
+     * stored in row-major order and the ld* parameters are
+     * the distance between the beginnings of two rows.
+     *
+     * The operands are packed into cache-friendly blocks and
+     * the multiplication itself is done by a micro-kernel.
+     * For float and double, an AVX2 or AVX-512 micro-kernel
+     * is selected at runtime when the CPU supports it; the
+     * other types use a portable micro-kernel.
+     *
+     * @param m Height of a and c
+     * @param n Width of b and c
+     * @param k Width of a and height of b
+     * @param mode Whether the product replaces c or is
+     *        added to or subtracted from it
+     */
+    template<typename T>
+    auto gemm(std::size_t m, std::size_t n, std::size_t k,
+              const T* a, std::size_t lda,
+              const T* b, std::size_t ldb,
+              T* c, std::size_t ldc,
+              gemm_mode mode=gemm_mode::assign)
+        -> void;
+
+    /**
+     * @brief General matrix multiplication
+     *
+     * Same as above, except that the blocks of the product
+     * may be computed by several threads, depending on the
+     * execution policy.
+     */
+    template<typename ExecutionPolicy, typename T>
+    auto gemm(ExecutionPolicy&& policy,
+              std::size_t m, std::size_t n, std::size_t k,
+              const T* a, std::size_t lda,
+              const T* b, std::size_t ldb,
+              T* c, std::size_t ldc,
+              gemm_mode mode=gemm_mode::assign)
+        -> void;
+
+    /**
+     * @brief General matrix multiplication with arbitrary strides
+     *
+     * Same as above, except that every element of a and b is
+     * located through a row stride (rs*) and a column stride
+     * (cs*). A transposed row-major matrix is then simply a
+     * matrix whose row stride is 1, so a product involving a
+     * transposed operand does not need to transpose it first:
+     * the packing step reads it in the right order.
+     */
+    template<typename ExecutionPolicy, typename T>
+    auto gemm(ExecutionPolicy&& policy,
+              std::size_t m, std::size_t n, std::size_t k,
+              const T* a, std::size_t rsa, std::size_t csa,
+              const T* b, std::size_t rsb, std::size_t csb,
+              T* c, std::size_t ldc,
+              gemm_mode mode=gemm_mode::assign)
+        -> void;
+
+    #include "detail/gemm.inl"
+}
+
+#endif // POLDER_MATRIX_GEMM_H_
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_MATRIX_LU_H_
+#define POLDER_MATRIX_LU_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <POLDER/details/config.h>
+#include <POLDER/matrix/base.h>
+#include <POLDER/matrix/gemm.h>
+
+namespace polder
+{
+    /**
+     * @brief LU decomposition with partial pivoting
+     *
+     * Factorizes a square matrix A into P*A = L*U where P is
+     * a permutation matrix, L is a lower triangular matrix
+     * with a unit diagonal and U is an upper triangular
+     * matrix. L and U are stored in place in a single Matrix.
+     *
+     * The factorization is done by blocks of columns so that
+     * most of the work is a matrix product. It costs O(n³)
+     * once, after which determinant, solve and inverse are
+     * cheap. The same object can be used to factorize several
+     * matrices, in which case it reuses its memory.
+     *
+     * T has to be a field: integral types are rejected.
+     */
+    template<typename T>
+    class LUDecomposition
+    {
+        static_assert(not std::is_integral<T>::value,
+                      "LU decomposition requires a type with an exact division");
+
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Types
+            ////////////////////////////////////////////////////////////
+
+            using value_type = T;
+            using size_type = std::size_t;
+
+            ////////////////////////////////////////////////////////////
+            // Construction
+            ////////////////////////////////////////////////////////////
+
+            LUDecomposition() = default;
+            explicit LUDecomposition(const Matrix<T>& mat);
+            explicit LUDecomposition(Matrix<T>&& mat);
+
+            /**
+             * @brief Factorizes a new matrix
+             * @param mat Square matrix to factorize
+             */
+            auto decompose(const Matrix<T>& mat)
+                -> void;
+            auto decompose(Matrix<T>&& mat)
+                -> void;
+
+            ////////////////////////////////////////////////////////////
+            // Results
+            ////////////////////////////////////////////////////////////
+
+            /**
+             * @brief Size of the factorized matrix
+             */
+            auto size() const
+                -> size_type;
+
+            /**
+             * @brief Whether the factorized matrix is singular
+             *
+             * Only exactly null pivots make the matrix singular;
+             * nearly singular floating point matrices are not
+             * detected.
+             */
+            auto is_singular() const
+                -> bool;
+
+            /**
+             * @brief Determinant of the factorized matrix
+             */
+            auto determinant() const
+                -> value_type;
+
+            /**
+             * @brief Solves A*x = b
+             *
+             * b may have several columns, in which case every
+             * column is solved independently. A shall not be
+             * singular.
+             *
+             * @param b Right-hand side, overwritten with x
+             */
+            template<typename Allocator>
+            auto solve_in_place(Matrix<T, Allocator>& b) const
+                -> void;
+            template<typename Allocator>
+            auto solve(Matrix<T, Allocator> b) const
+                -> Matrix<T, Allocator>;
+
+            /**
+             * @brief Inverse of the factorized matrix
+             */
+            auto inverse() const
+                -> Matrix<T>;
+
+            /**
+             * @brief L and U packed into a single matrix
+             *
+             * U is the upper triangle including the diagonal
+             * while L is the strict lower triangle, its unit
+             * diagonal not being stored.
+             */
+            auto packed() const
+                -> const Matrix<T>&;
+
+            /**
+             * @brief Row interchanges
+             *
+             * Row i has been swapped with row pivots()[i]
+             * during the i-th step of the factorization.
+             */
+            auto pivots() const
+                -> const std::vector<size_type>&;
+
+        private:
+
+            auto factorize()
+                -> void;
+            auto factorize_panel(size_type begin, size_type end)
+                -> void;
+            auto swap_rows(size_type row1, size_type row2)
+                -> void;
+
+            Matrix<T> _lu;                      /**< L and U */
+            std::vector<size_type> _pivots;     /**< Row interchanges */
+            bool _singular = false;             /**< Whether a pivot is 0 */
+            bool _odd_swaps = false;            /**< Parity of the row interchanges */
+    };
+
+    /**
+     * @brief Solves the linear system a*x = b
+     *
+     * @param a Square non-singular matrix
+     * @param b Right-hand side, possibly with several columns
+     * @return x
+     */
+    template<typename T, typename Allocator>
+    auto solve(const Matrix<T, Allocator>& a, Matrix<T, Allocator> b)
+        -> Matrix<T, Allocator>;
+
+    #include "detail/lu.inl"
+}
+
+#endif // POLDER_MATRIX_LU_H_
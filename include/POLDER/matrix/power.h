@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_MATRIX_POWER_H_
+#define POLDER_MATRIX_POWER_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <POLDER/execution.h>
+#include <POLDER/matrix.h>
+#include <POLDER/details/config.h>
+
+namespace polder
+{
+    /**
+     * @brief Integral power of a square matrix
+     *
+     * Binary exponentiation: the matrix is squared once per
+     * bit of the exponent and multiplied into the result once
+     * per set bit, which costs O(log n) products. Every
+     * product is written into a preallocated buffer which is
+     * then swapped with its destination, so that the whole
+     * computation allocates three matrices whatever the
+     * exponent.
+     *
+     * The power 0 of a matrix is the identity matrix.
+     */
+    template<typename T, typename Allocator>
+    auto matrix_pow(const Matrix<T, Allocator>& mat, std::size_t exponent)
+        -> Matrix<T, Allocator>;
+    template<typename ExecutionPolicy, typename T, typename Allocator>
+    auto matrix_pow(ExecutionPolicy&& policy, const Matrix<T, Allocator>& mat,
+                    std::size_t exponent)
+        -> Matrix<T, Allocator>;
+
+    /**
+     * @brief Exponential of a square matrix
+     *
+     * Scaling and squaring method: the matrix is divided by
+     * a power of 2, 2^s, so that its infinity norm is at most
+     * 1/2, its exponential is approximated by a [6/6] Padé
+     * approximant, which is accurate to the double precision
+     * for such a norm, then squared s times. The products
+     * reuse the same buffers as matrix_pow.
+     *
+     * T shall be a floating point type.
+     */
+    template<typename T, typename Allocator>
+    auto matrix_exp(const Matrix<T, Allocator>& mat)
+        -> Matrix<T, Allocator>;
+    template<typename ExecutionPolicy, typename T, typename Allocator>
+    auto matrix_exp(ExecutionPolicy&& policy, const Matrix<T, Allocator>& mat)
+        -> Matrix<T, Allocator>;
+
+    #include "detail/power.inl"
+}
+
+#endif // POLDER_MATRIX_POWER_H_
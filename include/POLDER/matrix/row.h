@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_MATRIX_ROW_H_
+#define POLDER_MATRIX_ROW_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <POLDER/details/config.h>
+
+namespace polder
+{
+    /**
+     * @brief Row of a row-major matrix
+     *
+     * A row is a lightweight view made of a pointer to its
+     * first element and of a size. Rows are not stored in
+     * the matrices but computed on the fly, and they are
+     * only valid as long as the matrix storage is.
+     *
+     * MatrixRow<const T> is the const counterpart of
+     * MatrixRow<T>.
+     */
+    template<typename T>
+    struct MatrixRow
+    {
+        ////////////////////////////////////////////////////////////
+        // Types
+        ////////////////////////////////////////////////////////////
+
+        using value_type = std::remove_const_t<T>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = const value_type&;
+        using pointer = T*;
+        using const_pointer = const value_type*;
+        using iterator = T*;
+        using const_iterator = const value_type*;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        ////////////////////////////////////////////////////////////
+        // Constructors
+        ////////////////////////////////////////////////////////////
+
+        MatrixRow() = default;
+        MatrixRow(size_type size, T* data_addr);
+
+        // A row can be made read-only
+        template<typename U,
+                 typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+        MatrixRow(const MatrixRow<U>& other);
+
+        ////////////////////////////////////////////////////////////
+        // Operators
+        ////////////////////////////////////////////////////////////
+
+        auto operator[](size_type index) const
+            -> reference;
+
+        ////////////////////////////////////////////////////////////
+        // Functions
+        ////////////////////////////////////////////////////////////
+
+        // Iterators
+        auto begin() const
+            -> iterator;
+        auto cbegin() const
+            -> const_iterator;
+        auto end() const
+            -> iterator;
+        auto cend() const
+            -> const_iterator;
+
+        auto rbegin() const
+            -> reverse_iterator;
+        auto crbegin() const
+            -> const_reverse_iterator;
+        auto rend() const
+            -> reverse_iterator;
+        auto crend() const
+            -> const_reverse_iterator;
+
+        // Accessors
+        auto data() const
+            -> pointer;
+
+        // Capacity
+        auto size() const
+            -> size_type;
+
+        private:
+
+            size_type _size = 0;    /**< Number of values */
+            T* _data = nullptr;     /**< Beginning of the data */
+    };
+
+    /**
+     * @brief Iterator over the rows of a row-major matrix
+     *
+     * Dereferencing the iterator computes a MatrixRow from
+     * the beginning of the matrix data, the width of the
+     * matrix and the index of the row. The distance between
+     * two rows is the width of the matrix unless another
+     * stride is given, which is the case for the rows of a
+     * MatrixView over a bigger matrix.
+     */
+    template<typename T>
+    class MatrixRowIterator
+    {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Public types
+
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type        = MatrixRow<T>;
+            using difference_type   = std::ptrdiff_t;
+            using reference         = MatrixRow<T>;
+
+            // Proxy giving operator-> something to point to
+            struct pointer
+            {
+                MatrixRow<T> row;
+
+                auto operator->() const
+                    -> const MatrixRow<T>*
+                {
+                    return &row;
+                }
+            };
+
+            ////////////////////////////////////////////////////////////
+            // Constructors
+
+            MatrixRowIterator() = default;
+            MatrixRowIterator(T* data, std::size_t width, difference_type index);
+            MatrixRowIterator(T* data, std::size_t width, difference_type index,
+                              std::size_t stride);
+
+            template<typename U,
+                     typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+            MatrixRowIterator(const MatrixRowIterator<U>& other);
+
+            ////////////////////////////////////////////////////////////
+            // Members access
+
+            auto data() const
+                -> T*;
+            auto width() const
+                -> std::size_t;
+            auto index() const
+                -> difference_type;
+            auto stride() const
+                -> std::size_t;
+
+            ////////////////////////////////////////////////////////////
+            // Element access
+
+            auto operator*() const
+                -> reference;
+            auto operator->() const
+                -> pointer;
+            auto operator[](difference_type n) const
+                -> reference;
+
+            ////////////////////////////////////////////////////////////
+            // Increment/decrement operators
+
+            auto operator++()
+                -> MatrixRowIterator&;
+            auto operator++(int)
+                -> MatrixRowIterator;
+            auto operator--()
+                -> MatrixRowIterator&;
+            auto operator--(int)
+                -> MatrixRowIterator;
+
+            auto operator+=(difference_type n)
+                -> MatrixRowIterator&;
+            auto operator-=(difference_type n)
+                -> MatrixRowIterator&;
+
+        private:
+
+            T* _data = nullptr;         /**< Beginning of the matrix data */
+            std::size_t _width = 0;     /**< Number of elements per row */
+            difference_type _index = 0; /**< Index of the current row */
+            std::size_t _stride = 0;    /**< Distance between two rows */
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Arithmetic operators
+
+    template<typename T>
+    auto operator+(MatrixRowIterator<T> it, std::ptrdiff_t n)
+        -> MatrixRowIterator<T>;
+    template<typename T>
+    auto operator+(std::ptrdiff_t n, MatrixRowIterator<T> it)
+        -> MatrixRowIterator<T>;
+    template<typename T>
+    auto operator-(MatrixRowIterator<T> it, std::ptrdiff_t n)
+        -> MatrixRowIterator<T>;
+    template<typename T, typename U>
+    auto operator-(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+        -> std::ptrdiff_t;
+
+    ////////////////////////////////////////////////////////////
+    // Comparison operators
+
+    template<typename T, typename U>
+    auto operator==(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+        -> bool;
+    template<typename T, typename U>
+    auto operator!=(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+        -> bool;
+    template<typename T, typename U>
+    auto operator<(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+        -> bool;
+    template<typename T, typename U>
+    auto operator<=(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+        -> bool;
+    template<typename T, typename U>
+    auto operator>(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+        -> bool;
+    template<typename T, typename U>
+    auto operator>=(const MatrixRowIterator<T>& lhs, const MatrixRowIterator<U>& rhs)
+        -> bool;
+
+    #include "detail/row.inl"
+}
+
+#endif // POLDER_MATRIX_ROW_H_
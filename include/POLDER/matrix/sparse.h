@@ -0,0 +1,334 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_MATRIX_SPARSE_H_
+#define POLDER_MATRIX_SPARSE_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <POLDER/execution.h>
+#include <POLDER/matrix.h>
+#include <POLDER/details/config.h>
+
+namespace polder
+{
+    /**
+     * @brief Storage order of a sparse matrix
+     *
+     * A CSR (Compressed Sparse Row) matrix stores its non-zero
+     * elements row by row while a CSC (Compressed Sparse Column)
+     * matrix stores them column by column.
+     */
+    enum class sparse_format
+    {
+        csr,
+        csc
+    };
+
+    template<typename T, sparse_format Format>
+    class SparseMatrix;
+
+    template<typename T>
+    using CsrMatrix = SparseMatrix<T, sparse_format::csr>;
+
+    template<typename T>
+    using CscMatrix = SparseMatrix<T, sparse_format::csc>;
+
+    /**
+     * @brief Trait holding the SparseMatrix types
+     */
+    template<typename T, sparse_format Format>
+    struct types_t<SparseMatrix<T, Format>>
+    {
+        using value_type = T;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = value_type*;
+        using const_pointer = const value_type*;
+    };
+
+    /**
+     * @brief Element of a sparse matrix and its position
+     */
+    template<typename T>
+    struct SparseTriplet
+    {
+        std::size_t y;
+        std::size_t x;
+        T value;
+    };
+
+    /**
+     * @brief Compressed sparse matrix
+     *
+     * Only the non-zero elements are stored, so that the memory
+     * used and the cost of the products scale with the number
+     * of non-zero elements instead of height * width.
+     *
+     * The matrix is made of "outer" slices, which are the rows
+     * of a CSR matrix and the columns of a CSC matrix. Three
+     * arrays describe them: the offsets of the beginning of
+     * every slice, followed by the total number of non-zero
+     * elements; the "inner" index of every element in its
+     * slice, sorted in every slice; and the values.
+     *
+     * Reading an element is a binary search in its slice. Writing
+     * an element which is not stored yet inserts it, which is
+     * linear in the number of non-zero elements: the efficient
+     * way to build a sparse matrix is from triplets.
+     */
+    template<typename T, sparse_format Format>
+    class SparseMatrix:
+        public MutableMatrix<SparseMatrix<T, Format>>
+    {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Types
+            ////////////////////////////////////////////////////////////
+
+            using super = MutableMatrix<SparseMatrix<T, Format>>;
+
+            // Sizes
+            using typename super::size_type;
+            using typename super::difference_type;
+            // Value
+            using typename super::value_type;
+            using typename super::reference;
+            using typename super::const_reference;
+            using typename super::pointer;
+            using typename super::const_pointer;
+
+            static constexpr sparse_format format = Format;
+
+            ////////////////////////////////////////////////////////////
+            // Constructors
+            ////////////////////////////////////////////////////////////
+
+            SparseMatrix();
+            SparseMatrix(const SparseMatrix& other) = default;
+            SparseMatrix(SparseMatrix&& other) noexcept = default;
+
+            // Matrix of zeros
+            SparseMatrix(size_type height, size_type width);
+
+            /**
+             * @brief Builds a sparse matrix from triplets
+             *
+             * The triplets may be given in any order; the
+             * values of the triplets sharing a position are
+             * summed.
+             */
+            template<typename InputIterator>
+            SparseMatrix(size_type height, size_type width,
+                         InputIterator first, InputIterator last);
+            SparseMatrix(size_type height, size_type width,
+                         std::initializer_list<SparseTriplet<T>> triplets);
+
+            /**
+             * @brief Builds a sparse matrix from its arrays
+             *
+             * The arrays are described in the class documentation;
+             * the inner indices shall be sorted in every slice.
+             */
+            SparseMatrix(size_type height, size_type width,
+                         std::vector<size_type> offsets,
+                         std::vector<size_type> indices,
+                         std::vector<T> values);
+
+            // Conversion from the other storage order
+            template<sparse_format OtherFormat>
+            explicit SparseMatrix(const SparseMatrix<T, OtherFormat>& other);
+
+            // Conversion from a dense matrix, zeros are not stored
+            template<typename Derived>
+            explicit SparseMatrix(const ImmutableMatrix<Derived>& mat);
+
+            ////////////////////////////////////////////////////////////
+            // Operators
+            ////////////////////////////////////////////////////////////
+
+            auto operator=(const SparseMatrix& other)
+                -> SparseMatrix& = default;
+            auto operator=(SparseMatrix&& other) noexcept
+                -> SparseMatrix& = default;
+
+            // Element access, the non-const overload inserts
+            // the element if it is not stored yet
+            using super::operator[]; // Solve name hiding problem
+            auto operator()(size_type y, size_type x)
+                -> reference;
+            auto operator()(size_type y, size_type x) const
+                -> value_type;
+
+            // Scaling only touches the stored elements
+            auto operator*=(value_type value)
+                -> SparseMatrix&;
+            auto operator/=(value_type value)
+                -> SparseMatrix&;
+
+            ////////////////////////////////////////////////////////////
+            // Compressed storage
+            ////////////////////////////////////////////////////////////
+
+            // Number of stored elements
+            auto nonzeros() const
+                -> size_type;
+
+            // Number of rows (CSR) or columns (CSC)
+            auto outer_size() const
+                -> size_type;
+
+            auto offsets() const
+                -> const std::vector<size_type>&;
+            auto indices() const
+                -> const std::vector<size_type>&;
+            auto values() const
+                -> const std::vector<T>&;
+
+            // Stored elements of the outer slice i
+            auto outer_begin(size_type i) const
+                -> size_type;
+            auto outer_end(size_type i) const
+                -> size_type;
+
+            auto reserve(size_type nonzeros)
+                -> void;
+
+            /**
+             * @brief Removes the stored elements equal to zero
+             */
+            auto prune()
+                -> void;
+
+            ////////////////////////////////////////////////////////////
+            // Conversions
+            ////////////////////////////////////////////////////////////
+
+            /**
+             * @brief Dense copy of the matrix
+             *
+             * Cheaper than constructing a Matrix from the sparse
+             * one since the elements are scattered directly at
+             * their place instead of being searched.
+             */
+            auto to_dense() const
+                -> Matrix<T>;
+
+            ////////////////////////////////////////////////////////////
+            // Miscellaneous functions
+            ////////////////////////////////////////////////////////////
+
+            // Capacity
+            auto height() const
+                -> size_type;
+            auto width() const
+                -> size_type;
+
+        private:
+
+            // Position of an element in the outer/inner space
+            auto outer_index(size_type y, size_type x) const
+                -> size_type;
+            auto inner_index(size_type y, size_type x) const
+                -> size_type;
+
+            size_type _height = 0;              /**< Number of rows */
+            size_type _width = 0;               /**< Number of columns */
+            std::vector<size_type> _offsets;    /**< Beginning of every outer slice */
+            std::vector<size_type> _indices;    /**< Inner index of every element */
+            std::vector<T> _values;             /**< Stored elements */
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Outside class operators
+    ////////////////////////////////////////////////////////////
+
+    // Elements which are not stored are zero whether or not
+    // the other matrix stores them
+    template<typename T, sparse_format Format>
+    auto operator==(const SparseMatrix<T, Format>& lhs, const SparseMatrix<T, Format>& rhs)
+        -> bool;
+    template<typename T, sparse_format Format>
+    auto operator!=(const SparseMatrix<T, Format>& lhs, const SparseMatrix<T, Format>& rhs)
+        -> bool;
+
+    // Sparse-sparse products; the result has the storage
+    // order of the left operand
+    template<typename T, sparse_format Format>
+    auto operator*(const SparseMatrix<T, Format>& lhs, const SparseMatrix<T, Format>& rhs)
+        -> SparseMatrix<T, Format>;
+    template<typename T, sparse_format Format, sparse_format OtherFormat>
+    auto operator*(const SparseMatrix<T, Format>& lhs, const SparseMatrix<T, OtherFormat>& rhs)
+        -> SparseMatrix<T, Format>;
+
+    // Sparse-dense products
+    template<typename T, sparse_format Format, typename Allocator>
+    auto operator*(const SparseMatrix<T, Format>& lhs, const Matrix<T, Allocator>& rhs)
+        -> Matrix<T, Allocator>;
+    template<typename T, typename Allocator, sparse_format Format>
+    auto operator*(const Matrix<T, Allocator>& lhs, const SparseMatrix<T, Format>& rhs)
+        -> Matrix<T, Allocator>;
+
+    template<typename ExecutionPolicy, typename T, sparse_format Format, typename Allocator>
+    auto multiply(ExecutionPolicy&& policy,
+                  const SparseMatrix<T, Format>& lhs, const Matrix<T, Allocator>& rhs)
+        -> Matrix<T, Allocator>;
+
+    /**
+     * @brief Sparse matrix-vector product
+     *
+     * Computes y = a * x where x has a.width() elements and
+     * y has a.height() elements. The rows of a CSR matrix are
+     * split between the threads; with a CSC matrix, every
+     * thread accumulates the contribution of some columns in
+     * its own vector, which are summed at the end.
+     */
+    template<typename T, sparse_format Format>
+    auto spmv(const SparseMatrix<T, Format>& a, const T* x, T* y)
+        -> void;
+    template<typename ExecutionPolicy, typename T, sparse_format Format>
+    auto spmv(ExecutionPolicy&& policy, const SparseMatrix<T, Format>& a, const T* x, T* y)
+        -> void;
+
+    ////////////////////////////////////////////////////////////
+    // Miscellaneous functions
+    ////////////////////////////////////////////////////////////
+
+    // The transpose of a CSR matrix is the CSC matrix
+    // with the same arrays, and conversely
+    template<typename T>
+    auto transpose(const CsrMatrix<T>& mat)
+        -> CscMatrix<T>;
+    template<typename T>
+    auto transpose(const CscMatrix<T>& mat)
+        -> CsrMatrix<T>;
+
+    #include "detail/sparse.inl"
+}
+
+#endif // POLDER_MATRIX_SPARSE_H_
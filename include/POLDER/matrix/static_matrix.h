@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_MATRIX_STATIC_MATRIX_H_
+#define POLDER_MATRIX_STATIC_MATRIX_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <POLDER/details/config.h>
+#include <POLDER/geometry/details/types.h>
+#include <POLDER/matrix/base.h>
+#include <POLDER/matrix/expression.h>
+#include <POLDER/matrix/row.h>
+
+namespace polder
+{
+    template<typename T, std::size_t Height, std::size_t Width>
+    class StaticMatrix;
+
+    /**
+     * @brief Trait holding the StaticMatrix types
+     */
+    template<typename T, std::size_t Height, std::size_t Width>
+    struct types_t<StaticMatrix<T, Height, Width>>
+    {
+        using value_type = T;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = value_type*;
+        using const_pointer = const value_type*;
+    };
+
+    namespace details
+    {
+        template<typename T, std::size_t Height, std::size_t Width>
+        struct is_static_matrix<StaticMatrix<T, Height, Width>>:
+            std::true_type
+        {};
+
+        template<typename T, std::size_t Height, std::size_t Width>
+        struct has_flat_access<StaticMatrix<T, Height, Width>>:
+            std::true_type
+        {};
+    }
+
+    /**
+     * @brief Matrix whose dimensions are known at compile time
+     *
+     * The elements are stored in an std::array, therefore a
+     * StaticMatrix never allocates memory. The dimensions are
+     * part of the type: operations between matrices whose
+     * dimensions do not match do not compile, and the loops
+     * over the elements have a fixed trip count that the
+     * compiler can fully unroll.
+     *
+     * Most of the read-only operations are constexpr, even the
+     * product, the determinant and the inverse. Small matrices
+     * are typically used as transforms for the geometry module
+     * vectors and points.
+     */
+    template<typename T, std::size_t Height, std::size_t Width>
+    class StaticMatrix:
+        public MutableMatrix<StaticMatrix<T, Height, Width>>
+    {
+        static_assert(Height > 0 && Width > 0,
+                      "a StaticMatrix can't have a null dimension");
+
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Types
+            ////////////////////////////////////////////////////////////
+
+            using super = MutableMatrix<StaticMatrix<T, Height, Width>>;
+
+            // Sizes
+            using typename super::size_type;
+            using typename super::difference_type;
+            // Value
+            using typename super::value_type;
+            using typename super::reference;
+            using typename super::const_reference;
+            using typename super::pointer;
+            using typename super::const_pointer;
+            // Rows
+            using row = MatrixRow<T>;
+            using const_row = MatrixRow<const T>;
+            // Flat iterators
+            using flat_iterator = typename std::array<T, Height * Width>::iterator;
+            using const_flat_iterator = typename std::array<T, Height * Width>::const_iterator;
+
+            ////////////////////////////////////////////////////////////
+            // Constructors
+            ////////////////////////////////////////////////////////////
+
+            // Matrix filled with zeros
+            constexpr StaticMatrix();
+            // Values given row by row, too many values do not compile
+            constexpr StaticMatrix(const T (&values)[Height][Width]);
+            // Values given in row-major order
+            constexpr explicit StaticMatrix(const std::array<T, Height * Width>& values);
+            // Conversion from a matrix of the same dimensions
+            template<typename Derived>
+            explicit StaticMatrix(const ImmutableMatrix<Derived>& mat);
+
+            ////////////////////////////////////////////////////////////
+            // Construction functions
+            ////////////////////////////////////////////////////////////
+
+            static constexpr auto zeros()
+                -> StaticMatrix;
+            static constexpr auto ones()
+                -> StaticMatrix;
+            static constexpr auto identity()
+                -> StaticMatrix;
+
+            ////////////////////////////////////////////////////////////
+            // Operators
+            ////////////////////////////////////////////////////////////
+
+            // Accessors
+            using super::operator[]; // Solve name hiding problem
+            auto operator[](size_type index)
+                -> row;
+            auto operator[](size_type index) const
+                -> const_row;
+            auto operator()(size_type y, size_type x)
+                -> reference;
+            constexpr auto operator()(size_type y, size_type x) const
+                -> const_reference;
+
+            // Element at the given row-major position
+            constexpr auto flat_value(size_type index) const
+                -> const_reference;
+
+            // Arithmetic operators
+            auto operator+=(const StaticMatrix& other)
+                -> StaticMatrix&;
+            auto operator-=(const StaticMatrix& other)
+                -> StaticMatrix&;
+            auto operator*=(const StaticMatrix<T, Width, Width>& other)
+                -> StaticMatrix&;
+            auto operator*=(const value_type& value)
+                -> StaticMatrix&;
+            auto operator/=(const value_type& value)
+                -> StaticMatrix&;
+
+            ////////////////////////////////////////////////////////////
+            // STL-like functions
+            ////////////////////////////////////////////////////////////
+
+            // Accessors
+            auto data()
+                -> pointer;
+            auto data() const
+                -> const_pointer;
+
+            // Flat iterators
+            auto fbegin()
+                -> flat_iterator;
+            auto fbegin() const
+                -> const_flat_iterator;
+            auto cfbegin() const
+                -> const_flat_iterator;
+            auto fend()
+                -> flat_iterator;
+            auto fend() const
+                -> const_flat_iterator;
+            auto cfend() const
+                -> const_flat_iterator;
+
+            // Modifiers
+            auto fill(const value_type& value)
+                -> void;
+
+            ////////////////////////////////////////////////////////////
+            // Miscellaneous functions
+            ////////////////////////////////////////////////////////////
+
+            // Capacity
+            static constexpr auto height()
+                -> size_type;
+            static constexpr auto width()
+                -> size_type;
+            static constexpr auto size()
+                -> size_type;
+
+            // Properties
+            static constexpr auto is_square()
+                -> bool;
+
+        private:
+
+            template<std::size_t... Indices>
+            constexpr StaticMatrix(const T (&values)[Height][Width],
+                                   std::index_sequence<Indices...>);
+
+            // Member data
+            std::array<T, Height * Width> _data;    /**< Matrix data */
+    };
+
+    ////////////////////////////////////////////////////////////
+    // Outside class operators
+    ////////////////////////////////////////////////////////////
+
+    // Comparison
+    template<typename T, std::size_t Height, std::size_t Width>
+    constexpr auto operator==(const StaticMatrix<T, Height, Width>& lhs,
+                              const StaticMatrix<T, Height, Width>& rhs)
+        -> bool;
+    template<typename T, std::size_t Height, std::size_t Width>
+    constexpr auto operator!=(const StaticMatrix<T, Height, Width>& lhs,
+                              const StaticMatrix<T, Height, Width>& rhs)
+        -> bool;
+
+    // Element-wise arithmetic operations
+    template<typename T, std::size_t Height, std::size_t Width>
+    constexpr auto operator+(const StaticMatrix<T, Height, Width>& lhs,
+                             const StaticMatrix<T, Height, Width>& rhs)
+        -> StaticMatrix<T, Height, Width>;
+    template<typename T, std::size_t Height, std::size_t Width>
+    constexpr auto operator-(const StaticMatrix<T, Height, Width>& lhs,
+                             const StaticMatrix<T, Height, Width>& rhs)
+        -> StaticMatrix<T, Height, Width>;
+    template<typename T, std::size_t Height, std::size_t Width>
+    constexpr auto operator-(const StaticMatrix<T, Height, Width>& mat)
+        -> StaticMatrix<T, Height, Width>;
+
+    // StaticMatrix-value_type arithmetic operations
+    template<typename T, std::size_t Height, std::size_t Width>
+    constexpr auto operator*(const StaticMatrix<T, Height, Width>& mat,
+                             const typename StaticMatrix<T, Height, Width>::value_type& value)
+        -> StaticMatrix<T, Height, Width>;
+    template<typename T, std::size_t Height, std::size_t Width>
+    constexpr auto operator*(const typename StaticMatrix<T, Height, Width>::value_type& value,
+                             const StaticMatrix<T, Height, Width>& mat)
+        -> StaticMatrix<T, Height, Width>;
+    template<typename T, std::size_t Height, std::size_t Width>
+    constexpr auto operator/(const StaticMatrix<T, Height, Width>& mat,
+                             const typename StaticMatrix<T, Height, Width>::value_type& value)
+        -> StaticMatrix<T, Height, Width>;
+
+    // Matrix product, the inner dimensions are
+    // checked with a static assertion
+    template<typename T, std::size_t Height, std::size_t N, std::size_t M, std::size_t Width>
+    constexpr auto operator*(const StaticMatrix<T, Height, N>& lhs,
+                             const StaticMatrix<T, M, Width>& rhs)
+        -> StaticMatrix<T, Height, Width>;
+
+    ////////////////////////////////////////////////////////////
+    // Transforms of geometric entities
+    ////////////////////////////////////////////////////////////
+
+    // Linear transforms
+    template<typename T, std::size_t N>
+    auto operator*(const StaticMatrix<T, N, N>& mat, const geometry::Vector<N, T>& vec)
+        -> geometry::Vector<N, T>;
+    template<typename T, std::size_t N>
+    auto operator*(const StaticMatrix<T, N, N>& mat, const geometry::Point<N, T>& pt)
+        -> geometry::Point<N, T>;
+
+    /*
+     * Transforms in homogeneous coordinates: a vector is
+     * extended with a 0 and is therefore not translated while
+     * a point is extended with a 1 and is divided by the last
+     * coordinate of the result when the transform is not
+     * affine.
+     */
+    template<typename T, std::size_t N>
+    auto operator*(const StaticMatrix<T, N + 1, N + 1>& mat, const geometry::Vector<N, T>& vec)
+        -> geometry::Vector<N, T>;
+    template<typename T, std::size_t N>
+    auto operator*(const StaticMatrix<T, N + 1, N + 1>& mat, const geometry::Point<N, T>& pt)
+        -> geometry::Point<N, T>;
+
+    ////////////////////////////////////////////////////////////
+    // Miscellaneous functions
+    ////////////////////////////////////////////////////////////
+
+    template<typename T, std::size_t Height, std::size_t Width>
+    constexpr auto transpose(const StaticMatrix<T, Height, Width>& mat)
+        -> StaticMatrix<T, Width, Height>;
+    template<typename T, std::size_t Height, std::size_t Width>
+    constexpr auto trace(const StaticMatrix<T, Height, Width>& mat)
+        -> T;
+
+    /*
+     * The determinant and the inverse use explicit formulas
+     * up to 4x4 matrices. Bigger matrices use a fraction-free
+     * elimination for the determinant and a Gauss-Jordan
+     * elimination for the inverse. The matrix to invert shall
+     * not be singular; for integral types, the result of the
+     * division by the determinant is truncated.
+     */
+    template<typename T>
+    constexpr auto determinant(const StaticMatrix<T, 1, 1>& mat)
+        -> T;
+    template<typename T>
+    constexpr auto determinant(const StaticMatrix<T, 2, 2>& mat)
+        -> T;
+    template<typename T>
+    constexpr auto determinant(const StaticMatrix<T, 3, 3>& mat)
+        -> T;
+    template<typename T>
+    constexpr auto determinant(const StaticMatrix<T, 4, 4>& mat)
+        -> T;
+    template<typename T, std::size_t Height, std::size_t Width>
+    constexpr auto determinant(const StaticMatrix<T, Height, Width>& mat)
+        -> T;
+
+    template<typename T>
+    constexpr auto inverse(const StaticMatrix<T, 1, 1>& mat)
+        -> StaticMatrix<T, 1, 1>;
+    template<typename T>
+    constexpr auto inverse(const StaticMatrix<T, 2, 2>& mat)
+        -> StaticMatrix<T, 2, 2>;
+    template<typename T>
+    constexpr auto inverse(const StaticMatrix<T, 3, 3>& mat)
+        -> StaticMatrix<T, 3, 3>;
+    template<typename T>
+    constexpr auto inverse(const StaticMatrix<T, 4, 4>& mat)
+        -> StaticMatrix<T, 4, 4>;
+    template<typename T, std::size_t Height, std::size_t Width>
+    constexpr auto inverse(const StaticMatrix<T, Height, Width>& mat)
+        -> StaticMatrix<T, Height, Width>;
+
+    #include "detail/static_matrix.inl"
+}
+
+#endif // POLDER_MATRIX_STATIC_MATRIX_H_
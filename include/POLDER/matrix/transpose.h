@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_MATRIX_TRANSPOSE_H_
+#define POLDER_MATRIX_TRANSPOSE_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <utility>
+#include <POLDER/details/config.h>
+
+namespace polder
+{
+    /**
+     * @brief Out-of-place matrix transposition
+     *
+     * Writes the transpose of the height x width row-major
+     * matrix src into the width x height row-major matrix
+     * dst. The ld* parameters are the distance between the
+     * beginnings of two rows.
+     *
+     * The matrix is recursively split along its biggest
+     * dimension until the blocks are small enough to fit in
+     * the L1 cache, which keeps both the reads and the writes
+     * cache-friendly whatever the cache sizes.
+     *
+     * src and dst shall not overlap.
+     */
+    template<typename T>
+    auto transpose(std::size_t height, std::size_t width,
+                   const T* src, std::size_t lds,
+                   T* dst, std::size_t ldd)
+        -> void;
+
+    /**
+     * @brief In-place transposition of a square matrix
+     *
+     * The recursion transposes the two diagonal blocks and
+     * swaps the two other ones, so that the elements are
+     * swapped across the diagonal block by block.
+     *
+     * @param size Height and width of the matrix
+     * @param ld Distance between the beginnings of two rows
+     */
+    template<typename T>
+    auto transpose_in_place(std::size_t size, T* data, std::size_t ld)
+        -> void;
+
+    #include "detail/transpose.inl"
+}
+
+#endif // POLDER_MATRIX_TRANSPOSE_H_
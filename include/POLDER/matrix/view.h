@@ -0,0 +1,456 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_MATRIX_VIEW_H_
+#define POLDER_MATRIX_VIEW_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <POLDER/functional.h>
+#include <POLDER/details/config.h>
+#include <POLDER/iterator/stride_iterator.h>
+#include <POLDER/matrix/base.h>
+#include <POLDER/matrix/expression.h>
+#include <POLDER/matrix/row.h>
+
+namespace polder
+{
+    template<typename T>
+    class MatrixView;
+
+    template<typename T>
+    class StridedMatrixView;
+
+    /**
+     * @brief Trait holding the MatrixView types
+     */
+    template<typename T>
+    struct types_t<MatrixView<T>>
+    {
+        using value_type = std::remove_const_t<T>;
+        using reference = T&;
+        using const_reference = const value_type&;
+        using pointer = T*;
+        using const_pointer = const value_type*;
+    };
+
+    /**
+     * @brief Trait holding the StridedMatrixView types
+     */
+    template<typename T>
+    struct types_t<StridedMatrixView<T>>
+    {
+        using value_type = std::remove_const_t<T>;
+        using reference = T&;
+        using const_reference = const value_type&;
+        using pointer = T*;
+        using const_pointer = const value_type*;
+    };
+
+    namespace details
+    {
+        template<typename T>
+        struct is_matrix_view:
+            std::false_type
+        {};
+
+        template<typename T>
+        struct is_matrix_view<MatrixView<T>>:
+            std::true_type
+        {};
+
+        template<typename T>
+        struct is_matrix_view<StridedMatrixView<T>>:
+            std::true_type
+        {};
+
+        // Views over const elements are immutable matrices
+        template<typename View, typename T>
+        using view_base_t = std::conditional_t<
+            std::is_const<T>::value,
+            ImmutableMatrix<View>,
+            MutableMatrix<View>
+        >;
+    }
+
+    /**
+     * @brief Strided sequence of elements of a matrix
+     *
+     * The one-dimension counterpart of StridedMatrixView: it
+     * is used for the columns of a row-major matrix and for
+     * the rows of a transposed view. Its iterators are
+     * stride_iterator over pointers.
+     */
+    template<typename T>
+    struct MatrixSlice
+    {
+        ////////////////////////////////////////////////////////////
+        // Types
+        ////////////////////////////////////////////////////////////
+
+        using value_type = std::remove_const_t<T>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = const value_type&;
+        using pointer = T*;
+        using const_pointer = const value_type*;
+        using iterator = stride_iterator<T*>;
+        using const_iterator = stride_iterator<const value_type*>;
+
+        ////////////////////////////////////////////////////////////
+        // Constructors
+        ////////////////////////////////////////////////////////////
+
+        MatrixSlice() = default;
+        MatrixSlice(size_type size, T* data_addr, size_type stride);
+
+        // A slice can be made read-only
+        template<typename U,
+                 typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+        MatrixSlice(const MatrixSlice<U>& other);
+
+        ////////////////////////////////////////////////////////////
+        // Operators
+        ////////////////////////////////////////////////////////////
+
+        auto operator[](size_type index) const
+            -> reference;
+
+        ////////////////////////////////////////////////////////////
+        // Functions
+        ////////////////////////////////////////////////////////////
+
+        // Iterators
+        auto begin() const
+            -> iterator;
+        auto cbegin() const
+            -> const_iterator;
+        auto end() const
+            -> iterator;
+        auto cend() const
+            -> const_iterator;
+
+        // Accessors
+        auto data() const
+            -> pointer;
+        auto stride() const
+            -> size_type;
+
+        // Capacity
+        auto size() const
+            -> size_type;
+
+        private:
+
+            size_type _size = 0;    /**< Number of values */
+            T* _data = nullptr;     /**< First element */
+            size_type _stride = 1;  /**< Distance between two elements */
+    };
+
+    /**
+     * @brief Non-owning view over a row-major block of memory
+     *
+     * A view is made of a pointer to its first element, of
+     * dimensions and of the distance between the beginning of
+     * two consecutive rows, the leading dimension in BLAS terms.
+     * It can view a block of a Matrix as well as any external
+     * buffer, for example a memory-mapped file. The viewed
+     * memory shall outlive the view.
+     *
+     * Copying a view is cheap and never copies the elements,
+     * but assigning a matrix or an expression to a view writes
+     * the elements in place. When the expression reads memory
+     * overlapping the view with a different layout, such as
+     * v = v.transposed() or an overlapping block, it is first
+     * evaluated into a temporary Matrix.
+     *
+     * MatrixView<const T> is a read-only view.
+     */
+    template<typename T>
+    class MatrixView:
+        public details::view_base_t<MatrixView<T>, T>
+    {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Types
+            ////////////////////////////////////////////////////////////
+
+            using super = details::view_base_t<MatrixView<T>, T>;
+
+            // Sizes
+            using typename super::size_type;
+            using typename super::difference_type;
+            // Value
+            using typename super::value_type;
+            using typename super::reference;
+            using typename super::const_reference;
+            using typename super::pointer;
+            using typename super::const_pointer;
+            // Rows
+            using row = MatrixRow<T>;
+            using column = MatrixSlice<T>;
+            // Iterators
+            using iterator = MatrixRowIterator<T>;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+
+            ////////////////////////////////////////////////////////////
+            // Constructors
+            ////////////////////////////////////////////////////////////
+
+            MatrixView() = default;
+            MatrixView(const MatrixView& other) = default;
+            MatrixView(T* data, size_type height, size_type width);
+            MatrixView(T* data, size_type height, size_type width, size_type stride);
+
+            // A view can be made read-only
+            template<typename U,
+                     typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+            MatrixView(const MatrixView<U>& other);
+
+            ////////////////////////////////////////////////////////////
+            // Assignment operators
+            ////////////////////////////////////////////////////////////
+
+            auto operator=(const MatrixView& other)
+                -> MatrixView&;
+            template<typename Derived>
+            auto operator=(const ImmutableMatrix<Derived>& expr)
+                -> MatrixView&;
+
+            template<typename Derived>
+            auto operator+=(const ImmutableMatrix<Derived>& expr)
+                -> MatrixView&;
+            template<typename Derived>
+            auto operator-=(const ImmutableMatrix<Derived>& expr)
+                -> MatrixView&;
+            auto operator*=(value_type value)
+                -> MatrixView&;
+            auto operator/=(value_type value)
+                -> MatrixView&;
+
+            ////////////////////////////////////////////////////////////
+            // Element access
+            ////////////////////////////////////////////////////////////
+
+            auto operator[](size_type index) const
+                -> row;
+            auto operator()(size_type y, size_type x) const
+                -> reference;
+
+            auto data() const
+                -> pointer;
+
+            ////////////////////////////////////////////////////////////
+            // Slicing
+            ////////////////////////////////////////////////////////////
+
+            /**
+             * @brief Sub-view of height×width elements
+             *
+             * The top-left element of the block is at the given
+             * position in the view.
+             */
+            auto block(size_type y, size_type x, size_type height, size_type width) const
+                -> MatrixView;
+            auto col(size_type x) const
+                -> column;
+
+            /**
+             * @brief Lazy transpose of the view
+             *
+             * No element is moved: the strides of the returned
+             * view are swapped instead.
+             */
+            auto transposed() const
+                -> StridedMatrixView<T>;
+
+            ////////////////////////////////////////////////////////////
+            // Iterators
+            ////////////////////////////////////////////////////////////
+
+            auto begin() const
+                -> iterator;
+            auto end() const
+                -> iterator;
+            auto rbegin() const
+                -> reverse_iterator;
+            auto rend() const
+                -> reverse_iterator;
+
+            ////////////////////////////////////////////////////////////
+            // Miscellaneous functions
+            ////////////////////////////////////////////////////////////
+
+            auto fill(value_type value) const
+                -> void;
+
+            // Capacity
+            auto height() const
+                -> size_type;
+            auto width() const
+                -> size_type;
+            auto stride() const
+                -> size_type;
+
+            // Whether the rows follow each other in memory
+            auto is_contiguous() const
+                -> bool;
+
+        private:
+
+            T* _data = nullptr;         /**< First element */
+            size_type _height = 0;      /**< Number of rows */
+            size_type _width = 0;       /**< Number of columns */
+            size_type _stride = 0;      /**< Distance between two rows */
+    };
+
+    /**
+     * @brief Non-owning view with arbitrary strides
+     *
+     * Same as MatrixView except that the elements of a row
+     * are not necessarily contiguous: the distance between
+     * two consecutive elements of a row is given by the column
+     * stride. It makes it possible to view the transpose or
+     * a column block of a matrix without moving anything.
+     *
+     * Assignment behaves as it does for MatrixView.
+     */
+    template<typename T>
+    class StridedMatrixView:
+        public details::view_base_t<StridedMatrixView<T>, T>
+    {
+        public:
+
+            ////////////////////////////////////////////////////////////
+            // Types
+            ////////////////////////////////////////////////////////////
+
+            using super = details::view_base_t<StridedMatrixView<T>, T>;
+
+            // Sizes
+            using typename super::size_type;
+            using typename super::difference_type;
+            // Value
+            using typename super::value_type;
+            using typename super::reference;
+            using typename super::const_reference;
+            using typename super::pointer;
+            using typename super::const_pointer;
+            // Rows
+            using row = MatrixSlice<T>;
+            using column = MatrixSlice<T>;
+
+            ////////////////////////////////////////////////////////////
+            // Constructors
+            ////////////////////////////////////////////////////////////
+
+            StridedMatrixView() = default;
+            StridedMatrixView(const StridedMatrixView& other) = default;
+            StridedMatrixView(T* data, size_type height, size_type width,
+                              size_type row_stride, size_type col_stride);
+
+            template<typename U,
+                     typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+            StridedMatrixView(const StridedMatrixView<U>& other);
+
+            // A MatrixView is a strided view whose column stride is 1
+            template<typename U,
+                     typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+            StridedMatrixView(const MatrixView<U>& other);
+
+            ////////////////////////////////////////////////////////////
+            // Assignment operators
+            ////////////////////////////////////////////////////////////
+
+            auto operator=(const StridedMatrixView& other)
+                -> StridedMatrixView&;
+            template<typename Derived>
+            auto operator=(const ImmutableMatrix<Derived>& expr)
+                -> StridedMatrixView&;
+
+            template<typename Derived>
+            auto operator+=(const ImmutableMatrix<Derived>& expr)
+                -> StridedMatrixView&;
+            template<typename Derived>
+            auto operator-=(const ImmutableMatrix<Derived>& expr)
+                -> StridedMatrixView&;
+            auto operator*=(value_type value)
+                -> StridedMatrixView&;
+            auto operator/=(value_type value)
+                -> StridedMatrixView&;
+
+            ////////////////////////////////////////////////////////////
+            // Element access
+            ////////////////////////////////////////////////////////////
+
+            auto operator[](size_type index) const
+                -> row;
+            auto operator()(size_type y, size_type x) const
+                -> reference;
+
+            auto data() const
+                -> pointer;
+
+            ////////////////////////////////////////////////////////////
+            // Slicing
+            ////////////////////////////////////////////////////////////
+
+            auto block(size_type y, size_type x, size_type height, size_type width) const
+                -> StridedMatrixView;
+            auto col(size_type x) const
+                -> column;
+            auto transposed() const
+                -> StridedMatrixView;
+
+            ////////////////////////////////////////////////////////////
+            // Miscellaneous functions
+            ////////////////////////////////////////////////////////////
+
+            auto fill(value_type value) const
+                -> void;
+
+            // Capacity
+            auto height() const
+                -> size_type;
+            auto width() const
+                -> size_type;
+            auto row_stride() const
+                -> size_type;
+            auto col_stride() const
+                -> size_type;
+
+        private:
+
+            T* _data = nullptr;         /**< First element */
+            size_type _height = 0;      /**< Number of rows */
+            size_type _width = 0;       /**< Number of columns */
+            size_type _row_stride = 0;  /**< Distance between two rows */
+            size_type _col_stride = 1;  /**< Distance between two columns */
+    };
+
+    #include "detail/view.inl"
+}
+
+#endif // POLDER_MATRIX_VIEW_H_
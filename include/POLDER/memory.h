@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file POLDER/memory.h
+ * @brief Allocators and memory utilities.
+ */
+
+#ifndef POLDER_MEMORY_H_
+#define POLDER_MEMORY_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <POLDER/details/config.h>
+
+namespace polder
+{
+    /**
+     * @brief Alignment used by default for the matrices
+     *
+     * A cache line, which is also the size of the widest
+     * SIMD vectors (AVX-512).
+     */
+    constexpr std::size_t default_alignment = 64;
+
+    namespace details
+    {
+        /**
+         * Allocates size bytes aligned on the given power
+         * of 2, throws std::bad_alloc on failure.
+         */
+        POLDER_API auto aligned_allocate(std::size_t size, std::size_t alignment)
+            -> void*;
+
+        POLDER_API auto aligned_deallocate(void* ptr) noexcept
+            -> void;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Aligned allocator
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Allocator returning over-aligned memory
+     *
+     * The memory blocks are aligned on the given power of 2,
+     * which allows to use aligned SIMD loads and stores from
+     * the beginning of a block.
+     */
+    template<typename T, std::size_t Alignment=default_alignment>
+    class aligned_allocator
+    {
+        static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0,
+                      "the alignment shall be a power of 2");
+        static_assert(Alignment >= alignof(T),
+                      "the alignment can't be weaker than the one of T");
+
+        public:
+
+            using value_type = T;
+
+            // Alignment of the allocated blocks
+            static constexpr std::size_t alignment = Alignment;
+
+            template<typename U>
+            struct rebind
+            {
+                using other = aligned_allocator<U, Alignment>;
+            };
+
+            aligned_allocator() noexcept = default;
+
+            template<typename U>
+            aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept;
+
+            auto allocate(std::size_t n)
+                -> T*;
+            auto deallocate(T* ptr, std::size_t n) noexcept
+                -> void;
+    };
+
+    template<typename T, typename U, std::size_t Alignment>
+    auto operator==(const aligned_allocator<T, Alignment>&,
+                    const aligned_allocator<U, Alignment>&) noexcept
+        -> bool;
+    template<typename T, typename U, std::size_t Alignment>
+    auto operator!=(const aligned_allocator<T, Alignment>&,
+                    const aligned_allocator<U, Alignment>&) noexcept
+        -> bool;
+
+    ////////////////////////////////////////////////////////////
+    // Monotonic arena
+    ////////////////////////////////////////////////////////////
+
+    /**
+     * @brief Memory arena that only ever grows
+     *
+     * Allocating from the arena is only a matter of bumping a
+     * pointer; the memory is never given back to the arena
+     * one block at a time but all at once with release(), or
+     * when the arena is destroyed. Once the arena has grown
+     * big enough, the allocations between two releases do not
+     * touch the global heap at all, which makes it suitable
+     * for the short-lived temporaries of hot loops.
+     *
+     * An arena is not thread-safe.
+     */
+    class POLDER_API monotonic_arena
+    {
+        public:
+
+            /**
+             * @brief Creates an arena
+             *
+             * The first chunk of memory is only allocated when
+             * needed; the following chunks grow geometrically.
+             */
+            explicit monotonic_arena(std::size_t initial_size=4096);
+
+            monotonic_arena(const monotonic_arena&) = delete;
+            auto operator=(const monotonic_arena&)
+                -> monotonic_arena& = delete;
+
+            ~monotonic_arena();
+
+            /**
+             * @brief Allocates size bytes aligned on alignment
+             */
+            auto allocate(std::size_t size, std::size_t alignment)
+                -> void*;
+
+            /**
+             * @brief Makes the whole memory available again
+             *
+             * Only the biggest chunk is kept, so that a sequence
+             * of allocations repeated after every release ends
+             * up being served by a single chunk.
+             */
+            auto release() noexcept
+                -> void;
+
+            /**
+             * @brief Number of bytes handed out since the last release
+             */
+            auto used() const noexcept
+                -> std::size_t;
+
+            /**
+             * @brief Number of bytes owned by the arena
+             */
+            auto capacity() const noexcept
+                -> std::size_t;
+
+        private:
+
+            struct chunk
+            {
+                char* data;
+                std::size_t size;
+            };
+
+            std::vector<chunk> _chunks;     /**< Memory owned by the arena */
+            std::size_t _next_size;         /**< Size of the next chunk */
+            std::size_t _offset;            /**< Position in the last chunk */
+            std::size_t _used;              /**< Bytes handed out */
+    };
+
+    /**
+     * @brief Allocator drawing its memory from a monotonic_arena
+     *
+     * Deallocation does nothing: the memory is reclaimed when
+     * the arena is released. The arena shall outlive the
+     * allocators and the containers using it.
+     */
+    template<typename T, std::size_t Alignment=default_alignment>
+    class arena_allocator
+    {
+        static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0,
+                      "the alignment shall be a power of 2");
+        static_assert(Alignment >= alignof(T),
+                      "the alignment can't be weaker than the one of T");
+
+        public:
+
+            using value_type = T;
+
+            // Alignment of the allocated blocks
+            static constexpr std::size_t alignment = Alignment;
+
+            template<typename U>
+            struct rebind
+            {
+                using other = arena_allocator<U, Alignment>;
+            };
+
+            explicit arena_allocator(monotonic_arena& arena) noexcept;
+
+            template<typename U>
+            arena_allocator(const arena_allocator<U, Alignment>& other) noexcept;
+
+            auto allocate(std::size_t n)
+                -> T*;
+            auto deallocate(T* ptr, std::size_t n) noexcept
+                -> void;
+
+            auto arena() const noexcept
+                -> monotonic_arena&;
+
+        private:
+
+            monotonic_arena* _arena;
+    };
+
+    template<typename T, typename U, std::size_t Alignment>
+    auto operator==(const arena_allocator<T, Alignment>& lhs,
+                    const arena_allocator<U, Alignment>& rhs) noexcept
+        -> bool;
+    template<typename T, typename U, std::size_t Alignment>
+    auto operator!=(const arena_allocator<T, Alignment>& lhs,
+                    const arena_allocator<U, Alignment>& rhs) noexcept
+        -> bool;
+
+    ////////////////////////////////////////////////////////////
+    // Alignment utilities
+    ////////////////////////////////////////////////////////////
+
+    namespace details
+    {
+        template<typename Allocator>
+        constexpr auto allocator_alignment_impl(int)
+            -> decltype(Allocator::alignment)
+        {
+            return Allocator::alignment;
+        }
+
+        template<typename Allocator>
+        constexpr auto allocator_alignment_impl(...)
+            -> std::size_t
+        {
+            return alignof(typename Allocator::value_type);
+        }
+    }
+
+    /**
+     * @brief Guaranteed alignment of the memory of an allocator
+     *
+     * It is Allocator::alignment when the allocator provides it
+     * and the alignment of the allocated type otherwise.
+     */
+    template<typename Allocator>
+    struct allocator_alignment:
+        std::integral_constant<
+            std::size_t,
+            details::allocator_alignment_impl<Allocator>(0)
+        >
+    {};
+
+    /**
+     * @brief Tells the compiler that a pointer is aligned
+     *
+     * The pointer shall actually be aligned on Alignment,
+     * otherwise the behaviour is undefined.
+     */
+    template<std::size_t Alignment, typename T>
+    auto assume_aligned(T* ptr) noexcept
+        -> T*;
+
+    #include "details/memory.inl"
+}
+
+#endif // POLDER_MEMORY_H_
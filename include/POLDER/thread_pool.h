@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_THREAD_POOL_H_
+#define POLDER_THREAD_POOL_H_
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <POLDER/details/config.h>
+
+namespace polder
+{
+    /**
+     * @brief Work-stealing thread pool
+     *
+     * Every worker thread owns a queue of tasks. A worker
+     * takes the most recent tasks from its own queue and,
+     * when it is empty, steals the oldest tasks from the
+     * other workers' queues. Tasks submitted from a worker
+     * thread go to that worker's queue so that nested
+     * parallelism stays local.
+     *
+     * The threads waiting for some tasks to complete are
+     * expected to help by running pending tasks with
+     * try_run_pending_task; therefore, a pool with no
+     * worker thread at all is still a valid pool.
+     */
+    class POLDER_API thread_pool
+    {
+        public:
+
+            /**
+             * @brief Creates a pool with the given number of workers
+             */
+            explicit thread_pool(std::size_t nb_threads);
+
+            thread_pool(const thread_pool&) = delete;
+            auto operator=(const thread_pool&)
+                -> thread_pool& = delete;
+
+            /**
+             * @brief Joins the worker threads
+             *
+             * The tasks still pending when the pool is destroyed
+             * are run before the worker threads are joined.
+             */
+            ~thread_pool();
+
+            /**
+             * @brief Number of worker threads
+             */
+            auto size() const noexcept
+                -> std::size_t;
+
+            /**
+             * @brief Schedules a task to be run by the pool
+             */
+            auto submit(std::function<void()> task)
+                -> void;
+
+            /**
+             * @brief Runs one pending task in the calling thread
+             * @return Whether a task was run
+             */
+            auto try_run_pending_task()
+                -> bool;
+
+            /**
+             * @brief Pool used when none is explicitly given
+             *
+             * It has one worker less than the number of hardware
+             * threads since the calling thread takes part in the
+             * computations.
+             */
+            static auto default_pool()
+                -> thread_pool&;
+
+        private:
+
+            struct task_queue
+            {
+                std::mutex mutex;
+                std::deque<std::function<void()>> tasks;
+            };
+
+            auto pop_task(std::size_t index, std::function<void()>& task)
+                -> bool;
+            auto steal_task(std::size_t index, std::function<void()>& task)
+                -> bool;
+            auto worker_loop(std::size_t index)
+                -> void;
+            auto worker_index() const
+                -> std::size_t;
+
+            std::vector<std::unique_ptr<task_queue>> _queues;   /**< One queue per worker */
+            std::vector<std::thread> _threads;                  /**< Worker threads */
+
+            std::atomic<std::size_t> _pending;                  /**< Number of queued tasks */
+            std::atomic<std::size_t> _next_queue;               /**< Round-robin submission */
+            bool _done;                                         /**< Whether the pool is stopping */
+
+            std::mutex _sleep_mutex;
+            std::condition_variable _sleep_condition;
+    };
+}
+
+#endif // POLDER_THREAD_POOL_H_
@@ -35,7 +35,9 @@ namespace evaluation
             "several dots in the same number",
             "stray comma outside of a function's parameter list",
             "trying to close a non-opened parenthesis",
-            "mismatched parenthesis in the expression"
+            "mismatched parenthesis in the expression",
+            "unknown name in the expression",
+            "unknown derivative of a function of the expression"
         };
     }
 
@@ -24,31 +24,6 @@ namespace evaluation
 {
     namespace
     {
-        constexpr unsigned int infix_priority[] = {
-            7,   // =
-            7,   // !=, <>
-            8,   // >=
-            8,   // <=
-            3,   // &&
-            1,   // ||
-            2,   // ^^
-            12,  // **
-            7,   // <=>
-            9,   // <<
-            9,   // >>
-            10,  // +
-            10,  // -
-            11,  // *
-            11,  // /
-            11,  // %
-            6,   // &
-            4,   // |
-            8,   // >
-            8,   // <
-            5,   // ^
-            11,  // //
-        };
-
         constexpr const char* infix_str[] = {
             "=",
             "!=",
@@ -85,17 +60,6 @@ namespace evaluation
         };
     }
 
-    ////////////////////////////////////////////////////////////
-    // Priority of infix operators
-
-    auto priority(infix_t oper)
-        -> unsigned int
-    {
-        return infix_priority[
-            std::underlying_type_t<infix_t>(oper)
-        ];
-    }
-
     ////////////////////////////////////////////////////////////
     // String conversion functions
 
@@ -50,4 +50,18 @@ auto not_implemented::what() const noexcept
 }
 
 
+io_error::io_error(const std::string& msg):
+    _msg(msg)
+{}
+
+io_error::~io_error() noexcept
+    = default;
+
+auto io_error::what() const noexcept
+    -> const char*
+{
+    return _msg.c_str();
+}
+
+
 } // namespace polder
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#include <utility>
+#include <POLDER/exceptions.h>
+#include <POLDER/mapped_file.h>
+
+#ifdef POLDER_OS_WINDOWS
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace polder
+{
+    namespace
+    {
+        auto mapping_error(const std::string& path)
+            -> io_error
+        {
+            return io_error("Could not map the file \"" + path + "\".");
+        }
+
+        auto unmap(const unsigned char* data, std::size_t size) noexcept
+            -> void
+        {
+            if (data == nullptr)
+            {
+                return;
+            }
+        #ifdef POLDER_OS_WINDOWS
+            (void) size;
+            UnmapViewOfFile(data);
+        #else
+            munmap(const_cast<unsigned char*>(data), size);
+        #endif
+        }
+    }
+
+    mapped_file::mapped_file() noexcept:
+        _data(nullptr),
+        _size(0),
+        _open(false)
+    {}
+
+    mapped_file::mapped_file(const std::string& path):
+        mapped_file()
+    {
+    #ifdef POLDER_OS_WINDOWS
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                                  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                                  nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            throw mapping_error(path);
+        }
+
+        LARGE_INTEGER size;
+        if (not GetFileSizeEx(file, &size))
+        {
+            CloseHandle(file);
+            throw mapping_error(path);
+        }
+
+        if (size.QuadPart > 0)
+        {
+            // The view keeps the file and the mapping
+            // alive once their handles are closed
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY,
+                                                0, 0, nullptr);
+            CloseHandle(file);
+            if (mapping == nullptr)
+            {
+                throw mapping_error(path);
+            }
+
+            void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if (data == nullptr)
+            {
+                throw mapping_error(path);
+            }
+            _data = static_cast<const unsigned char*>(data);
+            _size = static_cast<std::size_t>(size.QuadPart);
+        }
+        else
+        {
+            CloseHandle(file);
+        }
+    #else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+        {
+            throw mapping_error(path);
+        }
+
+        struct stat infos;
+        if (::fstat(fd, &infos) == -1)
+        {
+            ::close(fd);
+            throw mapping_error(path);
+        }
+
+        // mmap fails on empty files
+        if (infos.st_size > 0)
+        {
+            const std::size_t size = static_cast<std::size_t>(infos.st_size);
+            void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (data == MAP_FAILED)
+            {
+                throw mapping_error(path);
+            }
+            _data = static_cast<const unsigned char*>(data);
+            _size = size;
+        }
+        else
+        {
+            ::close(fd);
+        }
+    #endif
+        _open = true;
+    }
+
+    mapped_file::mapped_file(mapped_file&& other) noexcept:
+        _data(std::exchange(other._data, nullptr)),
+        _size(std::exchange(other._size, 0)),
+        _open(std::exchange(other._open, false))
+    {}
+
+    auto mapped_file::operator=(mapped_file&& other) noexcept
+        -> mapped_file&
+    {
+        if (this != &other)
+        {
+            close();
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0);
+            _open = std::exchange(other._open, false);
+        }
+        return *this;
+    }
+
+    mapped_file::~mapped_file()
+    {
+        close();
+    }
+
+    auto mapped_file::data() const noexcept
+        -> const unsigned char*
+    {
+        return _data;
+    }
+
+    auto mapped_file::size() const noexcept
+        -> std::size_t
+    {
+        return _size;
+    }
+
+    auto mapped_file::is_open() const noexcept
+        -> bool
+    {
+        return _open;
+    }
+
+    auto mapped_file::close() noexcept
+        -> void
+    {
+        unmap(_data, _size);
+        _data = nullptr;
+        _size = 0;
+        _open = false;
+    }
+}
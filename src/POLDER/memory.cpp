@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <POLDER/memory.h>
+
+namespace polder
+{
+    namespace
+    {
+        auto align_up(std::uintptr_t value, std::size_t alignment)
+            -> std::uintptr_t
+        {
+            return (value + alignment - 1) & ~std::uintptr_t(alignment - 1);
+        }
+    }
+
+    namespace details
+    {
+        // The address returned by operator new is stored
+        // right before the aligned block
+
+        auto aligned_allocate(std::size_t size, std::size_t alignment)
+            -> void*
+        {
+            alignment = std::max(alignment, alignof(void*));
+            if (size > std::size_t(-1) - alignment - sizeof(void*))
+            {
+                throw std::bad_alloc();
+            }
+
+            void* raw = ::operator new(size + alignment + sizeof(void*));
+            auto address = align_up(reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*),
+                                    alignment);
+            void** res = reinterpret_cast<void**>(address);
+            res[-1] = raw;
+            return res;
+        }
+
+        auto aligned_deallocate(void* ptr) noexcept
+            -> void
+        {
+            if (ptr != nullptr)
+            {
+                ::operator delete(static_cast<void**>(ptr)[-1]);
+            }
+        }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // monotonic_arena
+    ////////////////////////////////////////////////////////////
+
+    monotonic_arena::monotonic_arena(std::size_t initial_size):
+        _next_size(std::max<std::size_t>(initial_size, 64)),
+        _offset(0),
+        _used(0)
+    {}
+
+    monotonic_arena::~monotonic_arena()
+    {
+        for (const chunk& c: _chunks)
+        {
+            ::operator delete(c.data);
+        }
+    }
+
+    auto monotonic_arena::allocate(std::size_t size, std::size_t alignment)
+        -> void*
+    {
+        if (not _chunks.empty())
+        {
+            const chunk& last = _chunks.back();
+            auto base = reinterpret_cast<std::uintptr_t>(last.data);
+            std::size_t offset = align_up(base + _offset, alignment) - base;
+            if (offset <= last.size && size <= last.size - offset)
+            {
+                _offset = offset + size;
+                _used += size;
+                return last.data + offset;
+            }
+        }
+
+        // Not enough room in the current chunk
+        if (size > std::size_t(-1) / 2 - alignment)
+        {
+            throw std::bad_alloc();
+        }
+        std::size_t chunk_size = std::max(_next_size, size + alignment);
+        _chunks.reserve(_chunks.size() + 1);
+        _chunks.push_back({ static_cast<char*>(::operator new(chunk_size)), chunk_size });
+        _next_size = chunk_size * 2;
+
+        const chunk& last = _chunks.back();
+        auto base = reinterpret_cast<std::uintptr_t>(last.data);
+        std::size_t offset = align_up(base, alignment) - base;
+        _offset = offset + size;
+        _used += size;
+        return last.data + offset;
+    }
+
+    auto monotonic_arena::release() noexcept
+        -> void
+    {
+        if (_chunks.size() > 1)
+        {
+            // The last chunk is the biggest one
+            chunk biggest = _chunks.back();
+            _chunks.pop_back();
+            for (const chunk& c: _chunks)
+            {
+                ::operator delete(c.data);
+            }
+            _chunks.clear();
+            _chunks.push_back(biggest);
+        }
+        _offset = 0;
+        _used = 0;
+    }
+
+    auto monotonic_arena::used() const noexcept
+        -> std::size_t
+    {
+        return _used;
+    }
+
+    auto monotonic_arena::capacity() const noexcept
+        -> std::size_t
+    {
+        std::size_t res = 0;
+        for (const chunk& c: _chunks)
+        {
+            res += c.size;
+        }
+        return res;
+    }
+}
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <utility>
+#include <POLDER/thread_pool.h>
+
+namespace polder
+{
+    namespace
+    {
+        // Pool and queue owned by the current thread,
+        // if the current thread is a worker thread
+        thread_local const thread_pool* current_pool = nullptr;
+        thread_local std::size_t current_index = 0;
+    }
+
+    thread_pool::thread_pool(std::size_t nb_threads):
+        _pending(0),
+        _next_queue(0),
+        _done(false)
+    {
+        for (std::size_t i = 0 ; i < nb_threads ; ++i)
+        {
+            _queues.emplace_back(new task_queue);
+        }
+        for (std::size_t i = 0 ; i < nb_threads ; ++i)
+        {
+            _threads.emplace_back(&thread_pool::worker_loop, this, i);
+        }
+    }
+
+    thread_pool::~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_sleep_mutex);
+            _done = true;
+        }
+        _sleep_condition.notify_all();
+
+        for (auto& thread: _threads)
+        {
+            thread.join();
+        }
+
+        // Without workers, nobody ran the tasks
+        while (try_run_pending_task())
+        {}
+    }
+
+    auto thread_pool::size() const noexcept
+        -> std::size_t
+    {
+        return _threads.size();
+    }
+
+    auto thread_pool::submit(std::function<void()> task)
+        -> void
+    {
+        if (_queues.empty())
+        {
+            // No worker: run the task right away
+            task();
+            return;
+        }
+
+        std::size_t index = worker_index();
+        if (index == _queues.size())
+        {
+            index = _next_queue++ % _queues.size();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+            _queues[index]->tasks.push_back(std::move(task));
+            ++_pending;
+        }
+
+        // Taking the lock avoids missing a worker that
+        // is about to go to sleep
+        {
+            std::lock_guard<std::mutex> lock(_sleep_mutex);
+        }
+        _sleep_condition.notify_one();
+    }
+
+    auto thread_pool::try_run_pending_task()
+        -> bool
+    {
+        std::function<void()> task;
+        std::size_t index = worker_index();
+        if ((index != _queues.size() && pop_task(index, task))
+            || steal_task(index, task))
+        {
+            task();
+            return true;
+        }
+        return false;
+    }
+
+    auto thread_pool::default_pool()
+        -> thread_pool&
+    {
+        static thread_pool pool(
+            std::max(std::thread::hardware_concurrency(), 1u) - 1u
+        );
+        return pool;
+    }
+
+    auto thread_pool::pop_task(std::size_t index, std::function<void()>& task)
+        -> bool
+    {
+        // Most recent task first, its data is likely in the cache
+        task_queue& queue = *_queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            return false;
+        }
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        --_pending;
+        return true;
+    }
+
+    auto thread_pool::steal_task(std::size_t index, std::function<void()>& task)
+        -> bool
+    {
+        // Oldest task first, it is likely the biggest one
+        for (std::size_t i = 1 ; i <= _queues.size() ; ++i)
+        {
+            task_queue& queue = *_queues[(index + i) % _queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (not queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                --_pending;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto thread_pool::worker_loop(std::size_t index)
+        -> void
+    {
+        current_pool = this;
+        current_index = index;
+
+        while (true)
+        {
+            std::function<void()> task;
+            if (pop_task(index, task) || steal_task(index, task))
+            {
+                task();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(_sleep_mutex);
+            _sleep_condition.wait(lock, [this] {
+                return _done || _pending.load() != 0;
+            });
+            if (_done && _pending.load() == 0)
+            {
+                return;
+            }
+        }
+    }
+
+    auto thread_pool::worker_index() const
+        -> std::size_t
+    {
+        // size() when the current thread is not a worker
+        return (current_pool == this) ? current_index : _queues.size();
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "allocations.h"
+
+std::atomic<bool> counting(false);
+std::atomic<std::size_t> nb_allocations(0);
+
+// Replacing the global allocation functions is the only way
+// to see the allocations made by the standard containers; the
+// array and nothrow forms call these ones. They are defined
+// in their own file so that they are never inlined in the
+// code which uses them
+auto operator new(std::size_t size)
+    -> void*
+{
+    if (counting.load(std::memory_order_relaxed))
+    {
+        nb_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+auto operator delete(void* ptr) noexcept
+    -> void
+{
+    std::free(ptr);
+}
+
+auto operator delete(void* ptr, std::size_t) noexcept
+    -> void
+{
+    std::free(ptr);
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#ifndef POLDER_TESTSUITE_BENCHMARK_ALLOCATIONS_H_
+#define POLDER_TESTSUITE_BENCHMARK_ALLOCATIONS_H_
+
+#include <atomic>
+#include <cstddef>
+
+// Number of calls to operator new, only counted while
+// counting is true so that the rest of the program is not
+// slowed; the allocation functions are replaced in
+// allocations.cpp
+extern std::atomic<bool> counting;
+extern std::atomic<std::size_t> nb_allocations;
+
+#endif // POLDER_TESTSUITE_BENCHMARK_ALLOCATIONS_H_
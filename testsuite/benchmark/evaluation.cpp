@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include <POLDER/evaluation.h>
+#include "allocations.h"
+
+using namespace polder;
+
+namespace
+{
+    struct result
+    {
+        double duration;        // Average duration in nanoseconds
+        double allocations;     // Average number of allocations
+    };
+
+    template<typename Function>
+    auto measure(std::size_t times, Function func)
+        -> result
+    {
+        nb_allocations = 0;
+        counting = true;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0 ; i < times ; ++i)
+        {
+            func();
+        }
+        auto end = std::chrono::steady_clock::now();
+        counting = false;
+
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+        return {
+            elapsed.count() / times,
+            double(nb_allocations.load()) / times
+        };
+    }
+
+    auto report(const char* name, const result& res)
+        -> void
+    {
+        std::cout << name << ": " << res.duration << " ns, "
+                  << res.allocations << " allocations per evaluation\n";
+    }
+}
+
+// The benchmarks are hidden: run them with
+// polder-evaluation-benchmark "[benchmark]"
+TEST_CASE( "evaluation allocations benchmark", "[.][benchmark][evaluate]" )
+{
+    const std::size_t times = 100000;
+
+    evaluator<double> eval;
+    eval.connect("max", [](double a, double b) {
+        return a > b ? a : b;
+    });
+
+    // Keeps the compiler from optimizing the loops away
+    double sink = 0.0;
+
+    // Long names and numbers would not fit in a small string
+    const std::string long_expr = "maximum_of_both(1.2345678901234567, 3.1415926535897932)"
+                                  " * 2 + maximum_of_both(12345678901234567, 3)";
+    auto tokens = measure(times, [&] {
+        sink += evaluation::tokenize<double>(long_expr).size();
+    });
+
+    const std::string formula = "2 * 1.5**2 + max(1.5, 3) - 5 / (1.5 + 1)";
+    auto parse = measure(times, [&] {
+        sink += eval(formula);
+    });
+
+    // Every evaluation but the first one is a cache hit
+    evaluator<double> cached_eval = eval;
+    cached_eval.set_cache_capacity(16);
+    auto cached = measure(times, [&] {
+        sink += cached_eval(formula);
+    });
+
+    auto compiled = eval.compile("2 * x**2 + max(x, 3) - 5 / (x + 1)", { "x" });
+    auto small = measure(times, [&] {
+        sink += compiled({ 1.5 });
+    });
+
+    // Deeper than what fits in the small stack
+    std::string expr = "x";
+    for (int i = 0 ; i < 40 ; ++i)
+    {
+        expr = "x - (" + expr + ")";
+    }
+    auto deep_compiled = eval.compile(expr, { "x" });
+    std::vector<double> stack(deep_compiled.max_depth());
+    const double x = 1.5;
+    auto deep = measure(times, [&] {
+        sink += deep_compiled.evaluate(&x, 1, stack);
+    });
+
+    // The parameter buffer of the calls with more than 8
+    // parameters is allocated by the first evaluation only
+    eval.connect("sum", [](double a, double b, double c, double d, double e,
+                           double f, double g, double h, double i, double j) {
+        return a + b + c + d + e + f + g + h + i + j;
+    });
+    evaluation::closure<double> variadic(
+        eval.compile("sum(x, 2, 3, 4, 5, 6, 7, 8, 9, x)", { "x" })
+    );
+    sink += variadic({ x });
+    auto many_params = measure(times, [&] {
+        sink += variadic(&x, 1);
+    });
+
+    CHECK( sink != 0.0 );
+    CHECK( tokens.allocations == 1.0 );
+    CHECK( small.allocations == 0.0 );
+    CHECK( cached.allocations < 1.0 );
+    CHECK( deep.allocations == 0.0 );
+    CHECK( many_params.allocations == 0.0 );
+
+    report("tokenize", tokens);
+    report("evaluate(string)", parse);
+    report("evaluate(string), cached", cached);
+    report("compiled expression", small);
+    report("deep compiled expression, reused stack", deep);
+    report("closure with more than 8 parameters", many_params);
+}
+
+TEST_CASE( "evaluation backends benchmark", "[.][benchmark][evaluate]" )
+{
+    const std::size_t times = 100000;
+
+    // The variable is a function which is not pure so that
+    // nothing is folded and the three backends compute the
+    // same formulas: the tree-walking evaluator does not
+    // handle variables
+    double x = 1.5;
+    evaluator<double> eval;
+    eval.connect("x", [&x] { return x; });
+    eval.connect("max", [](double a, double b) {
+        return a > b ? a : b;
+    });
+
+    const char* formulas[] = {
+        "2 * x()**2 + max(x(), 3) - 5 / (x() + 1)",
+        "((((3 * x() + 2) * x() - 5) * x() + 1) * x() - 7)",
+        "x() < 2 && !(x() >= 3) || x() = 1",
+    };
+
+    double sink = 0.0;
+    for (const char* formula: formulas)
+    {
+        const std::string expr = formula;
+        std::cout << expr << '\n';
+
+        auto parse = measure(times, [&] {
+            auto tokens = evaluation::tokenize<double>(expr);
+            evaluation::parse(tokens, [&](const evaluation::token<double>&) {
+                sink += 1.0;
+            });
+        });
+        auto tree = measure(times, [&] {
+            sink += eval(expr);
+        });
+
+        auto compiled = eval.compile(expr);
+        auto bytecode = measure(times, [&] {
+            sink += compiled();
+        });
+
+        evaluation::closure<double> fast(compiled);
+        auto closure = measure(times, [&] {
+            sink += fast();
+        });
+
+        CHECK( fast() == compiled() );
+        CHECK( bytecode.allocations == 0.0 );
+        CHECK( closure.allocations == 0.0 );
+
+        report("    parsing only", parse);
+        report("    tree-walking, with parsing", tree);
+        report("    bytecode", bytecode);
+        report("    closure", closure);
+    }
+    CHECK( sink != 0.0 );
+}
+
+TEST_CASE( "gradient benchmark", "[.][benchmark][evaluate]" )
+{
+    const std::size_t times = 10000;
+
+    // Sum of squared residuals of a polynomial fit, the
+    // gradient is taken with respect to its 8 coefficients
+    std::string expr = "0";
+    std::vector<std::string> variables;
+    for (int point = 1 ; point <= 4 ; ++point)
+    {
+        std::string poly = "0";
+        for (int coeff = 0 ; coeff < 8 ; ++coeff)
+        {
+            poly = "(" + poly + ") * " + std::to_string(point) + " + c" + std::to_string(coeff);
+        }
+        expr += " + ((" + poly + ") - " + std::to_string(point * point) + ")**2";
+    }
+    for (int coeff = 0 ; coeff < 8 ; ++coeff)
+    {
+        variables.push_back("c" + std::to_string(coeff));
+    }
+
+    evaluator<double> eval;
+    auto compiled = eval.compile(expr, variables);
+
+    std::vector<double> values(8, 0.5);
+    std::vector<double> grad(8);
+    double sink = 0.0;
+
+    // Central differences: 2 evaluations per variable
+    auto finite = measure(times, [&] {
+        const double h = 1e-6;
+        for (std::size_t i = 0 ; i < values.size() ; ++i)
+        {
+            const double value = values[i];
+            values[i] = value + h;
+            const double upper = compiled(values.data(), values.size());
+            values[i] = value - h;
+            const double lower = compiled(values.data(), values.size());
+            values[i] = value;
+            grad[i] = (upper - lower) / (2 * h);
+        }
+        sink += grad[0];
+    });
+
+    auto reverse = measure(times, [&] {
+        sink += evaluation::gradient(compiled, values.data(), values.size(), grad.data());
+    });
+
+    report("finite differences", finite);
+    report("reverse mode", reverse);
+    CHECK( sink != 0.0 );
+}
+
+TEST_CASE( "lanes benchmark", "[.][benchmark][evaluate]" )
+{
+    using evaluation::lanes;
+
+    const std::size_t times = 100000;
+    const std::string expr = "x * y - 1 / y + x**3 + (x + 1) * (y - 2)";
+
+    // The same points are evaluated one by one and 8 at once
+    evaluator<double> scalar_eval;
+    auto scalar = scalar_eval.compile(expr, { "x", "y" });
+    evaluator<lanes<double, 8>> lanes_eval;
+    auto packed = lanes_eval.compile(expr, { "x", "y" });
+
+    lanes<double, 8> values[2];
+    for (std::size_t i = 0 ; i < 8 ; ++i)
+    {
+        values[0][i] = 0.5 + i;
+        values[1][i] = 1.5 + i;
+    }
+    double sink = 0.0;
+
+    auto one_by_one = measure(times, [&] {
+        for (std::size_t i = 0 ; i < 8 ; ++i)
+        {
+            sink += scalar({ values[0][i], values[1][i] });
+        }
+    });
+
+    auto eight_lanes = measure(times, [&] {
+        sink += packed(values, 2)[0];
+    });
+
+    report("scalar", one_by_one);
+    report("lanes<double, 8>", eight_lanes);
+    CHECK( sink != 0.0 );
+}
+
+TEST_CASE( "shared evaluator benchmark", "[.][benchmark][evaluate]" )
+{
+    const std::size_t times = 100000;
+
+    // The cache is disabled: its mutex would be the only
+    // point of contention between the readers
+    evaluation::shared_evaluator<double> eval;
+    eval.connect("sq", [](double x) {
+        return x * x;
+    }, true);
+
+    // Total time divided by the number of evaluations: it
+    // should decrease with the number of threads
+    for (std::size_t nb_threads: { 1, 2, 4 })
+    {
+        std::vector<double> sinks(nb_threads);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0 ; i < nb_threads ; ++i)
+        {
+            threads.emplace_back([&, i] {
+                for (std::size_t j = 0 ; j < times ; ++j)
+                {
+                    sinks[i] += eval("sq(3) + sq(4) * 2 - 1");
+                }
+            });
+        }
+        for (auto& thread: threads)
+        {
+            thread.join();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+        std::cout << nb_threads << " threads: "
+                  << elapsed.count() / (times * nb_threads) << " ns per evaluation\n";
+        for (double sink: sinks)
+        {
+            CHECK( sink == 40.0 * times );
+        }
+    }
+}
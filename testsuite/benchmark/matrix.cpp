@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include <catch.hpp>
+#include <POLDER/matrix.h>
+
+using namespace polder;
+
+namespace
+{
+    // Average duration of func in nanoseconds
+    template<typename Function>
+    auto measure(std::size_t times, Function func)
+        -> double
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0 ; i < times ; ++i)
+        {
+            func();
+        }
+        auto end = std::chrono::steady_clock::now();
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+        return elapsed.count() / times;
+    }
+
+    auto report(const char* name, double duration, double reference)
+        -> void
+    {
+        std::cout << name << ": " << duration << " ns ("
+                  << duration / reference << "x the raw buffer copy)\n";
+    }
+}
+
+// The benchmarks are hidden: run them with
+// polder-testsuite "[benchmark]"
+TEST_CASE( "matrix copy benchmark", "[.][benchmark][matrix]" )
+{
+    // Tall and narrow: the worst case when the
+    // rows had to be stored one by one
+    const std::size_t height = 10000;
+    const std::size_t width = 8;
+    const std::size_t times = 200;
+
+    auto mat = Matrix<double>::ones(height, width);
+    std::vector<double> buffer(mat.fbegin(), mat.fend());
+
+    // Keeps the compiler from optimizing the loops away
+    std::size_t sink = 0;
+
+    // Reference: copy of a raw buffer of the same size
+    double reference = measure(times, [&] {
+        std::vector<double> copy = buffer;
+        sink += copy.size();
+    });
+
+    double copy = measure(times, [&] {
+        Matrix<double> res = mat;
+        sink += res.size();
+    });
+
+    Matrix<double> target(height, width);
+    double assign = measure(times, [&] {
+        target = mat;
+        sink += target.size();
+    });
+
+    double construct = measure(times, [&] {
+        Matrix<double> res(height, width);
+        sink += res.size();
+    });
+
+    double reshape = measure(times, [&] {
+        target.reshape(width, height);
+        target.reshape(height, width);
+        sink += target.width();
+    });
+
+    double iterate = measure(times, [&] {
+        double sum = 0.0;
+        for (const auto& row: mat)
+        {
+            sum += row[0];
+        }
+        sink += std::size_t(sum);
+    });
+
+    CHECK( sink == times * (4 * height * width + width + height) );
+
+    std::cout << "Matrix<double>(" << height << ", " << width << ")\n";
+    report("copy construction", copy, reference);
+    report("copy assignment", assign, reference);
+    report("construction with size", construct, reference);
+    report("two reshapes", reshape, reference);
+    report("iteration over the rows", iterate, reference);
+}
@@ -15,8 +15,14 @@
  * License along with this program. If not,
  * see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstdlib>
 #include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
 #include <catch.hpp>
 #include <POLDER/evaluation.h>
 
@@ -48,6 +54,20 @@ TEST_CASE( "evaluation of mathematical expressions", "[evaluate]" )
         CHECK( eval("5!") == eval("5*4*3*2*1") );
     }
 
+    SECTION( "parsing of numbers" )
+    {
+        evaluator<long long> eval;
+
+        // Too large to be represented exactly by a double
+        CHECK( eval("12345678901234567 + 1") == 12345678901234568LL );
+        CHECK( eval("2.5 * 2") == 4 );
+
+        evaluator<double> deval;
+        CHECK( deval("0.1 + 0.2") == 0.1 + 0.2 );
+        CHECK( deval("3.14159265358979323846264338327950288419716939937510582097494459230781640628620899")
+               == 3.14159265358979323846 );
+    }
+
     SECTION( "evaluation of bitwise operations" )
     {
         evaluator<unsigned> eval;
@@ -119,4 +139,960 @@ TEST_CASE( "evaluation of mathematical expressions", "[evaluate]" )
         CHECK( eval("add(2, add(5, 3))") == 10 );
         CHECK( eval("add(add(1, 2), add(3, 4))") == 10 );
     }
+
+    SECTION( "precedence of the operators" )
+    {
+        evaluator<int> eval;
+        eval.connect("two", [] { return 2; });
+
+        using evaluation::priority;
+        static_assert(priority(evaluation::infix_t::MUL) > priority(evaluation::infix_t::ADD), "");
+        static_assert(priority(evaluation::prefix_t::NOT) > priority(evaluation::postfix_t::FAC), "");
+
+        CHECK( eval("2 ** 3 ** 2") == 64 );
+        CHECK( eval("10 - 4 - 3 + 1") == 4 );
+        CHECK( eval("1 + 2 * 3 ** 2 - 4") == 15 );
+        CHECK( eval("1 | 2 ^ 3 & 1") == 3 );
+        CHECK( eval("!0!") == 1 );
+        CHECK( eval("3! * 2") == 12 );
+        CHECK( eval("--3") == 3 );
+        CHECK( eval("2 * -two()") == -4 );
+        CHECK( eval("-(2 + 1) * 2 + two()**3!") == 58 );
+        CHECK( eval("1 < 2 && 3 > 4 || 5 >= 5") == 1 );
+
+        CHECK( eval.compile("!0!")() == 1 );
+        CHECK( eval.compile("1 | 2 ^ 3 & 1")() == 3 );
+    }
+
+    SECTION( "parsing errors" )
+    {
+        evaluator<int> eval;
+        eval.connect("add", std::plus<int>{});
+
+        CHECK_THROWS_AS( eval(""), evaluation::error );
+        CHECK_THROWS_AS( eval("2 3"), evaluation::error );
+        CHECK_THROWS_AS( eval("()"), evaluation::error );
+        CHECK_THROWS_AS( eval("(1, 2)"), evaluation::error );
+        CHECK_THROWS_AS( eval("1 * / 2"), evaluation::error );
+        CHECK_THROWS_AS( eval("add(1,)"), evaluation::error );
+        CHECK_THROWS_AS( eval.compile("add(1 2)"), evaluation::error );
+    }
+}
+
+TEST_CASE( "compiled expressions", "[evaluate][compile]" )
+{
+    SECTION( "compiled expressions give the same results" )
+    {
+        evaluator<double> eval;
+
+        const char* expressions[] = {
+            "4",
+            "-4 + -4.2",
+            "2 + 7 * 3",
+            "7 + 3 - 2 * 5 / 8 + 4 * 3 - 9",
+            "-1 * 5 * 4/2 - 8*9 - 16+1",
+            "2 * 8 / 4**2 * 2.5",
+            "2 * (3 + 7)",
+            "5!!=!8",
+            "5! = 5*4*3*2*1"
+        };
+
+        for (const char* expr: expressions)
+        {
+            auto compiled = eval.compile(expr);
+            CHECK( compiled() == eval(expr) );
+            CHECK( compiled() == compiled.evaluate() );
+        }
+    }
+
+    SECTION( "functions are resolved once" )
+    {
+        evaluator<int> eval;
+        eval.connect("add", std::plus<int>{});
+        eval.connect("abs", [](int n) {
+            return std::abs(n);
+        });
+
+        auto compiled = eval.compile("add(add(1, 2), abs(-3)) + add(3, 4)");
+        CHECK( compiled() == 13 );
+        CHECK( compiled.functions().size() == 2 );
+        CHECK( compiled.constants().size() == 5 );
+        CHECK( compiled.max_depth() == 3 );
+
+        // The expression keeps its own callbacks
+        eval.disconnect("add");
+        CHECK( compiled() == 13 );
+    }
+
+    SECTION( "compilation errors" )
+    {
+        evaluator<int> eval;
+        eval.connect("add", std::plus<int>{});
+
+        CHECK_THROWS_AS( eval.compile("foo(1)"), evaluation::error );
+        CHECK_THROWS_AS( eval.compile("add(1)"), evaluation::error );
+        CHECK_THROWS_AS( eval.compile("1 +"), evaluation::error );
+        CHECK_THROWS_AS( eval.compile("(1 + 2"), evaluation::error );
+    }
+
+    SECTION( "deep expressions" )
+    {
+        evaluator<int> eval;
+
+        std::string expr = "x";
+        for (int i = 0 ; i < 50 ; ++i)
+        {
+            expr = "x + (" + expr + ")";
+        }
+        auto compiled = eval.compile(expr, { "x" });
+        CHECK( compiled.max_depth() > compiled.small_stack_size );
+        CHECK( compiled({ 2 }) == 102 );
+    }
+
+    SECTION( "reusable stack" )
+    {
+        evaluator<int> eval;
+
+        std::string expr = "x";
+        for (int i = 0 ; i < 40 ; ++i)
+        {
+            expr = "x - (" + expr + ")";
+        }
+        auto compiled = eval.compile(expr, { "x" });
+
+        std::vector<int> stack;
+        for (int x = 0 ; x < 5 ; ++x)
+        {
+            CHECK( compiled.evaluate(&x, 1, stack) == x );
+        }
+        CHECK( stack.size() == compiled.max_depth() );
+    }
+
+    SECTION( "functions with many parameters" )
+    {
+        evaluator<int> eval;
+        eval.connect("sum", [](int a, int b, int c, int d, int e, int f,
+                               int g, int h, int i, int j, int k, int l,
+                               int m, int n, int o, int p, int q, int r,
+                               int s, int t) {
+            return a + b + c + d + e + f + g + h + i + j
+                 + k + l + m + n + o + p + q + r + s + t;
+        });
+
+        const std::string expr = "sum(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, "
+                                 "11, 12, 13, 14, 15, 16, 17, 18, 19, 20) * 2";
+        CHECK( eval(expr) == 420 );
+        CHECK( eval.compile(expr)() == 420 );
+    }
+
+    SECTION( "concurrent evaluation" )
+    {
+        evaluator<double> eval;
+        eval.connect("sq", [](double x) {
+            return x * x;
+        });
+        const auto compiled = eval.compile("sq(3) + sq(4) * 2");
+
+        std::vector<double> results(4);
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0 ; i < results.size() ; ++i)
+        {
+            threads.emplace_back([&, i] {
+                double sum = 0.0;
+                for (int j = 0 ; j < 1000 ; ++j)
+                {
+                    sum += compiled();
+                }
+                results[i] = sum;
+            });
+        }
+        for (auto& thread: threads)
+        {
+            thread.join();
+        }
+        for (double res: results)
+        {
+            CHECK( res == 41000.0 );
+        }
+    }
+}
+
+TEST_CASE( "expressions with variables", "[evaluate][compile]" )
+{
+    SECTION( "variables are resolved to slots" )
+    {
+        evaluator<double> eval;
+
+        auto compiled = eval.compile("a * x**2 + b", { "x", "a", "b" });
+        CHECK( compiled.variable_names().size() == 3 );
+        CHECK( compiled({ 2.0, 3.0, 1.0 }) == 13.0 );
+        CHECK( compiled({ -1.0, 0.5, 2.0 }) == 2.5 );
+
+        const double vars[] = { 3.0, 1.0, -9.0 };
+        CHECK( compiled.evaluate(vars, 3) == 0.0 );
+    }
+
+    SECTION( "variables mixed with functions and operators" )
+    {
+        evaluator<int> eval;
+        eval.connect("max", [](int a, int b) {
+            return a > b ? a : b;
+        });
+
+        auto compiled = eval.compile("-x + max(x, y) * 2 - y!", { "x", "y" });
+        for (int x = -3 ; x < 3 ; ++x)
+        {
+            for (int y = 0 ; y < 4 ; ++y)
+            {
+                int fac = 1;
+                for (int i = 2 ; i <= y ; ++i)
+                {
+                    fac *= i;
+                }
+                CHECK( compiled({ x, y }) == -x + std::max(x, y) * 2 - fac );
+            }
+        }
+    }
+
+    SECTION( "unknown variables" )
+    {
+        evaluator<double> eval;
+
+        CHECK_THROWS_AS( eval.compile("x + y", { "x" }), evaluation::error );
+        CHECK_THROWS_AS( eval.compile("x + 1"), evaluation::error );
+        CHECK_THROWS_AS( eval("x + 1"), evaluation::error );
+    }
+}
+
+TEST_CASE( "column-wise evaluation", "[evaluate][compile]" )
+{
+    SECTION( "columns match row by row evaluation" )
+    {
+        evaluator<double> eval;
+        eval.connect("max", [](double a, double b) {
+            return a > b ? a : b;
+        });
+
+        auto compiled = eval.compile("a * x**2 + max(x, a) - -b / 3", { "x", "a", "b" });
+
+        // Not a multiple of the block size
+        const std::size_t size = 1000;
+        std::vector<double> x(size), a(size), b(size);
+        for (std::size_t i = 0 ; i < size ; ++i)
+        {
+            x[i] = i * 0.25 - 100.0;
+            a[i] = (i % 7) - 3.0;
+            b[i] = i * 1.5;
+        }
+        const double* columns[] = { x.data(), a.data(), b.data() };
+
+        std::vector<double> res(size);
+        compiled.evaluate_columns(columns, size, res.data());
+        for (std::size_t i = 0 ; i < size ; ++i)
+        {
+            CHECK( res[i] == compiled({ x[i], a[i], b[i] }) );
+        }
+
+        std::vector<double> par_res(size);
+        compiled.evaluate_columns(execution::par.with_threshold(1), columns, size, par_res.data());
+        CHECK( par_res == res );
+    }
+
+    SECTION( "padding rows do not raise errors" )
+    {
+        evaluator<int> eval;
+
+        // The last block only has one row, its padding must
+        // not divide by zero
+        auto compiled = eval.compile("100 // x + 3", { "x" });
+        const std::size_t size = 257;
+        std::vector<int> x(size, 0);
+        x.back() = 7;
+        for (std::size_t i = 0 ; i + 1 < size ; ++i)
+        {
+            x[i] = static_cast<int>(i % 50) + 1;
+        }
+        const int* columns[] = { x.data() };
+
+        std::vector<int> res(size);
+        compiled.evaluate_columns(columns, size, res.data());
+        for (std::size_t i = 0 ; i < size ; ++i)
+        {
+            CHECK( res[i] == 100 / x[i] + 3 );
+        }
+    }
+}
+
+TEST_CASE( "simplification of compiled expressions", "[evaluate][compile]" )
+{
+    using evaluation::opcode;
+
+    SECTION( "constant folding" )
+    {
+        evaluator<double> eval;
+        eval.connect("pi", [] {
+            return 3.141592653589793;
+        }, true);
+
+        auto compiled = eval.compile("2 * pi() / 360 * x", { "x" });
+        CHECK( compiled.instructions().size() == 3 );
+        CHECK( compiled({ 90.0 }) == Approx(3.141592653589793 / 2.0) );
+
+        auto constant = eval.compile("-((3 + 4)!) / 2");
+        CHECK( constant.instructions().size() == 1 );
+        CHECK( constant() == -2520.0 );
+    }
+
+    SECTION( "impure functions are not folded" )
+    {
+        int nb_calls = 0;
+        evaluator<int> eval;
+        eval.connect("next", [&nb_calls](int n) {
+            return n + nb_calls++;
+        });
+
+        auto compiled = eval.compile("next(1) + 1");
+        CHECK( compiled.instructions().size() == 4 );
+        CHECK( compiled() == 2 );
+        CHECK( compiled() == 3 );
+    }
+
+    SECTION( "algebraic identities" )
+    {
+        evaluator<double> eval;
+
+        const char* identities[] = {
+            "x * 1",
+            "1 * x",
+            "x + 0",
+            "0 + x",
+            "x - 0",
+            "x / 1",
+            "x ** 1",
+            "(x * (2 - 1)) + (3 - 3)",
+        };
+        for (const char* expr: identities)
+        {
+            auto compiled = eval.compile(expr, { "x" });
+            CHECK( compiled.instructions().size() == 1 );
+            CHECK( compiled({ 7.5 }) == 7.5 );
+        }
+
+        auto squared = eval.compile("(x + 1) ** 2", { "x" });
+        CHECK( squared.instructions().back().code == opcode::infix );
+        CHECK( squared.instructions().back().infix == evaluation::infix_t::MUL );
+        CHECK( squared.instructions()[squared.instructions().size() - 2].code == opcode::duplicate );
+        for (double x = -3.0 ; x < 3.0 ; x += 0.5)
+        {
+            CHECK( squared({ x }) == (x + 1) * (x + 1) );
+        }
+
+        const double x[] = { 1.0, 2.0, 3.0 };
+        const double* columns[] = { x };
+        double res[3];
+        squared.evaluate_columns(columns, 3, res);
+        CHECK( res[0] == 4.0 );
+        CHECK( res[1] == 9.0 );
+        CHECK( res[2] == 16.0 );
+    }
+}
+
+TEST_CASE( "cache of compiled expressions", "[evaluate][cache]" )
+{
+    SECTION( "hits and misses" )
+    {
+        evaluator<double> eval;
+        CHECK( eval.cache_capacity() == 0 );
+
+        // The cache is disabled by default
+        CHECK( eval("1 + 2") == 3.0 );
+        CHECK( eval.cache_misses() == 0 );
+        CHECK( eval.cache_size() == 0 );
+
+        eval.set_cache_capacity(2);
+        CHECK( eval("1 + 2") == 3.0 );
+        CHECK( eval("1 + 2") == 3.0 );
+        CHECK( eval("2 * 3") == 6.0 );
+        CHECK( eval.cache_hits() == 1 );
+        CHECK( eval.cache_misses() == 2 );
+        CHECK( eval.cache_size() == 2 );
+
+        // "1 + 2" is used more recently than "2 * 3"
+        CHECK( eval("1 + 2") == 3.0 );
+        CHECK( eval("5 - 1") == 4.0 );
+        CHECK( eval.cache_size() == 2 );
+        CHECK( eval("1 + 2") == 3.0 );
+        CHECK( eval.cache_hits() == 3 );
+        CHECK( eval("2 * 3") == 6.0 );
+        CHECK( eval.cache_misses() == 4 );
+
+        // Invalid expressions are not cached
+        CHECK_THROWS( eval("1 +") );
+        CHECK_THROWS( eval("1 +") );
+        CHECK( eval.cache_misses() == 6 );
+
+        eval.set_cache_capacity(1);
+        CHECK( eval.cache_size() == 1 );
+        eval.clear_cache();
+        CHECK( eval.cache_size() == 0 );
+    }
+
+    SECTION( "invalidation" )
+    {
+        evaluator<double> eval;
+        eval.set_cache_capacity(8);
+        eval.connect("f", [](double x) { return x + 1; });
+        eval.connect("g", [](double x) { return x * 2; });
+
+        CHECK( eval("f(1)") == 2.0 );
+        CHECK( eval("g(1)") == 2.0 );
+        CHECK( eval("3") == 3.0 );
+        CHECK( eval.cache_size() == 3 );
+
+        eval.disconnect("f");
+        CHECK( eval.cache_size() == 2 );
+        CHECK_THROWS( eval("f(1)") );
+
+        eval.connect("f", [](double x) { return x - 1; });
+        CHECK( eval("f(1)") == 0.0 );
+        CHECK( eval("g(1)") == 2.0 );
+        CHECK( eval.cache_hits() == 1 );
+    }
+
+    SECTION( "concurrent evaluation" )
+    {
+        evaluator<double> eval;
+        eval.set_cache_capacity(4);
+        eval.connect("sqr", [](double x) { return x * x; });
+
+        const char* formulas[] = { "sqr(2) + 1", "3 * 4", "sqr(3)", "10 // 3", "2 ** 5" };
+        const double results[] = { 5.0, 12.0, 9.0, 3.0, 32.0 };
+
+        std::vector<std::thread> threads;
+        std::vector<int> failures(4, 0);
+        for (int i = 0 ; i < 4 ; ++i)
+        {
+            threads.emplace_back([&, i] {
+                for (int j = 0 ; j < 500 ; ++j)
+                {
+                    int k = (i + j) % 5;
+                    if (eval(formulas[k]) != results[k])
+                    {
+                        ++failures[i];
+                    }
+                }
+            });
+        }
+        for (auto& thread: threads)
+        {
+            thread.join();
+        }
+
+        CHECK( std::count(failures.begin(), failures.end(), 0) == 4 );
+        CHECK( eval.cache_hits() + eval.cache_misses() == 2000 );
+        CHECK( eval.cache_size() <= 4 );
+    }
+}
+
+TEST_CASE( "closure-compiled expressions", "[evaluate][closure]" )
+{
+    SECTION( "closures compute the same results as expressions" )
+    {
+        evaluator<double> eval;
+        eval.connect("max", [](double a, double b) {
+            return a > b ? a : b;
+        });
+        eval.connect("clamp", [](double x, double low, double high) {
+            return x < low ? low : (x > high ? high : x);
+        });
+        eval.connect("two", [] { return 2.0; });
+
+        const char* formulas[] = {
+            "x",
+            "42",
+            "2 * x**2 + max(x, 3) - 5 / (x + 1)",
+            "-x + ~~3 + (y - 1)**2",
+            "clamp(x * y, -two(), 2) <=> 0",
+            "x < y && !(y >= 3) || x = 1",
+            "((((3*x + 2)*x - 5)*x + 1)*x - 7) // 2",
+        };
+        for (const char* formula: formulas)
+        {
+            auto compiled = eval.compile(formula, { "x", "y" });
+            evaluation::closure<double> fast(compiled);
+            CHECK( fast.nb_variables() == 2 );
+            for (double x = -2.0 ; x <= 2.0 ; x += 0.5)
+            {
+                for (double y = 0.0 ; y <= 4.0 ; y += 1.0)
+                {
+                    CHECK( fast({ x, y }) == compiled({ x, y }) );
+                }
+            }
+        }
+    }
+
+    SECTION( "functions of any arity" )
+    {
+        evaluator<int> eval;
+        eval.connect("sum", [](int a, int b, int c, int d, int e,
+                               int f, int g, int h, int i, int j) {
+            return a + b + c + d + e + f + g + h + i + j;
+        });
+        eval.connect("fac", [](int n) {
+            int res = 1;
+            for (int i = 2 ; i <= n ; ++i)
+            {
+                res *= i;
+            }
+            return res;
+        });
+
+        evaluation::closure<int> fast(
+            eval.compile("sum(1, 2, 3, 4, 5, 6, 7, 8, 9, n) - fac(n) + n!", { "n" })
+        );
+        for (int n = 0 ; n < 6 ; ++n)
+        {
+            CHECK( fast({ n }) == 45 + n );
+        }
+
+        // The parameters of nested calls do not overwrite
+        // the parameters of the calls containing them
+        evaluation::closure<int> nested(
+            eval.compile("sum(n, sum(1, 2, 3, 4, 5, 6, 7, 8, 9, n), 3, 4, 5, 6, 7, 8, 9, n)", { "n" })
+        );
+        for (int n = 0 ; n < 6 ; ++n)
+        {
+            CHECK( nested({ n }) == 87 + 3 * n );
+        }
+    }
+
+    SECTION( "closures without variables" )
+    {
+        evaluator<int> eval;
+        evaluation::closure<int> fast(eval.compile("(3 + 4) * 2 - 1"));
+        CHECK( fast.nb_variables() == 0 );
+        CHECK( fast() == 13 );
+    }
+}
+
+TEST_CASE( "automatic differentiation", "[evaluate][differentiation]" )
+{
+    SECTION( "gradients of operators" )
+    {
+        evaluator<double> eval;
+        auto compiled = eval.compile("a * x**2 + b / x - x**a + -y", { "x", "y", "a", "b" });
+
+        for (double x = 0.5 ; x < 3.0 ; x += 0.5)
+        {
+            const double y = 1.5, a = 3.0, b = -2.0;
+            const double values[] = { x, y, a, b };
+
+            double grad[4];
+            double res = evaluation::gradient(compiled, values, 4, grad);
+            CHECK( res == Approx(compiled(values, 4)) );
+            CHECK( grad[0] == Approx(2*a*x - b/(x*x) - a*std::pow(x, a-1)) );
+            CHECK( grad[1] == Approx(-1.0) );
+            CHECK( grad[2] == Approx(x*x - std::pow(x, a) * std::log(x)) );
+            CHECK( grad[3] == Approx(1.0 / x) );
+
+            // Forward mode gives the same partial derivatives
+            for (int i = 0 ; i < 4 ; ++i)
+            {
+                double direction[4] = {};
+                direction[i] = 1.0;
+                auto dual = evaluation::differentiate(compiled, values, 4, direction);
+                CHECK( dual.value == Approx(res) );
+                CHECK( dual.derivative == Approx(grad[i]) );
+            }
+        }
+    }
+
+    SECTION( "piecewise constant operators" )
+    {
+        evaluator<double> eval;
+        auto compiled = eval.compile("(x > 1) * x + (x // 1)", { "x" });
+
+        double grad[1];
+        CHECK( evaluation::gradient(compiled, { 2.5 }, grad) == 4.5 );
+        CHECK( grad[0] == 1.0 );
+        CHECK( evaluation::gradient(compiled, { 0.5 }, grad) == 0.0 );
+        CHECK( grad[0] == 0.0 );
+    }
+
+    SECTION( "derivatives of connected functions" )
+    {
+        evaluator<double> eval;
+        eval.connect("sin", [](double x) { return std::sin(x); });
+        eval.connect_derivatives("sin", [](double x) { return std::cos(x); });
+        eval.connect("hypot", [](double x, double y) { return std::hypot(x, y); });
+        eval.connect_derivatives("hypot",
+            [](double x, double y) { return x / std::hypot(x, y); },
+            [](double x, double y) { return y / std::hypot(x, y); }
+        );
+
+        auto compiled = eval.compile("hypot(sin(x), y) * x", { "x", "y" });
+        const double x = 0.7, y = 2.0;
+        const double h = std::hypot(std::sin(x), y);
+
+        double grad[2];
+        CHECK( evaluation::gradient(compiled, { x, y }, grad) == Approx(h * x) );
+        CHECK( grad[0] == Approx(h + x * std::sin(x) * std::cos(x) / h) );
+        CHECK( grad[1] == Approx(x * y / h) );
+
+        const double values[] = { x, y };
+        const double direction[] = { 1.0, 1.0 };
+        auto dual = evaluation::differentiate(compiled, values, 2, direction);
+        CHECK( dual.derivative == Approx(grad[0] + grad[1]) );
+    }
+
+    SECTION( "infinite partial derivatives" )
+    {
+        evaluator<double> eval;
+        eval.connect("sqrt", [](double x) { return std::sqrt(x); });
+        eval.connect_derivatives("sqrt", [](double x) { return 0.5 / std::sqrt(x); });
+        auto compiled = eval.compile("x * sqrt(y)", { "x", "y" });
+
+        // The partial derivative of sqrt is infinite in 0 but
+        // nothing propagates through it when x is 0
+        double grad[2];
+        CHECK( evaluation::gradient(compiled, { 0.0, 0.0 }, grad) == 0.0 );
+        CHECK( grad[0] == 0.0 );
+        CHECK( grad[1] == 0.0 );
+
+        // Forward mode gives the same partial derivative for x
+        const double values[] = { 0.0, 0.0 };
+        const double direction[] = { 1.0, 0.0 };
+        auto dual = evaluation::differentiate(compiled, values, 2, direction);
+        CHECK( dual.derivative == grad[0] );
+    }
+
+    SECTION( "missing derivatives" )
+    {
+        evaluator<double> eval;
+        eval.connect("f", [](double x) { return 2 * x; });
+        auto compiled = eval.compile("f(x) + 1", { "x" });
+
+        double grad[1];
+        CHECK_THROWS_AS( evaluation::gradient(compiled, { 1.0 }, grad), evaluation::error );
+        CHECK_THROWS_AS( eval.connect_derivatives("g", [](double) { return 0.0; }),
+                         evaluation::error );
+    }
+}
+
+TEST_CASE( "evaluation of lanes of numbers", "[evaluate][lanes]" )
+{
+    using pack = evaluation::lanes<double, 4>;
+
+    SECTION( "lanes are evaluated independently" )
+    {
+        evaluator<pack> eval;
+        eval.connect("max", evaluation::lanewise<4>([](double a, double b) {
+            return a > b ? a : b;
+        }));
+
+        CHECK( eval("2 * 3 + 1") == pack(7.0) );
+
+        const char* formulas[] = {
+            "2 * x**2 + max(x, 3) - 5 / (x + 1)",
+            "(x < 1) + (x >= 2) * 10 - -x",
+            "x // 2 + x % 3 + 2**x",
+        };
+        for (const char* formula: formulas)
+        {
+            evaluator<double> scalar_eval;
+            scalar_eval.connect("max", [](double a, double b) {
+                return a > b ? a : b;
+            });
+            auto scalar = scalar_eval.compile(formula, { "x" });
+            auto compiled = eval.compile(formula, { "x" });
+
+            pack x;
+            for (std::size_t i = 0 ; i < pack::size() ; ++i)
+            {
+                x[i] = 0.5 + 1.5 * i;
+            }
+
+            pack res = compiled({ x });
+            evaluation::closure<pack> fast(compiled);
+            CHECK( fast({ x }) == res );
+            for (std::size_t i = 0 ; i < pack::size() ; ++i)
+            {
+                CHECK( res[i] == scalar({ x[i] }) );
+            }
+        }
+    }
+
+    SECTION( "errors with lanes" )
+    {
+        evaluator<pack> eval;
+        CHECK_THROWS_AS( eval("(1, 2)"), evaluation::error );
+    }
+}
+
+TEST_CASE( "evaluation of intervals", "[evaluate][interval]" )
+{
+    using evaluation::interval;
+
+    SECTION( "arithmetic operations" )
+    {
+        evaluator<interval<double>> eval;
+
+        auto compiled = eval.compile("x * y - 1 / y + x**3", { "x", "y" });
+        const interval<double> values[] = { { -1.0, 2.0 }, { 1.0, 4.0 } };
+        interval<double> res = compiled(values, 2);
+        CHECK( res.lower == -6.0 );
+        CHECK( res.upper == 15.75 );
+
+        // Every value taken by the expression is in the interval
+        evaluator<double> scalar_eval;
+        auto scalar = scalar_eval.compile("x * y - 1 / y + x**3", { "x", "y" });
+        for (double x = -1.0 ; x <= 2.0 ; x += 0.25)
+        {
+            for (double y = 1.0 ; y <= 4.0 ; y += 0.25)
+            {
+                CHECK( res.contains(scalar({ x, y })) );
+            }
+        }
+
+        CHECK( eval("2 + 3 * 4") == interval<double>(14.0) );
+        CHECK( eval.compile("x**2", { "x" })({ { -2.0, 1.0 } }) == interval<double>(0.0, 4.0) );
+        CHECK( eval.compile("x * x", { "x" })({ { -2.0, 1.0 } }) == interval<double>(-2.0, 4.0) );
+        CHECK( eval.compile("1 / x", { "x" })({ { -1.0, 1.0 } }) == interval<double>::whole() );
+    }
+
+    SECTION( "comparisons and logical operators" )
+    {
+        evaluator<interval<double>> eval;
+        auto compiled = eval.compile("x < 3", { "x" });
+
+        CHECK( compiled({ { 0.0, 2.0 } }) == interval<double>(1.0) );
+        CHECK( compiled({ { 4.0, 5.0 } }) == interval<double>(0.0) );
+        CHECK( compiled({ { 2.0, 4.0 } }) == interval<double>(0.0, 1.0) );
+
+        auto logic = eval.compile("x > 0 && !(x = 5)", { "x" });
+        CHECK( logic({ { 1.0, 2.0 } }) == interval<double>(1.0) );
+        CHECK( logic({ { -2.0, -1.0 } }) == interval<double>(0.0) );
+        CHECK( logic({ { 4.0, 6.0 } }) == interval<double>(0.0, 1.0) );
+    }
+
+    SECTION( "connected functions" )
+    {
+        evaluator<interval<double>> eval;
+        eval.connect("sqrt", [](interval<double> x) {
+            return interval<double>(std::sqrt(x.lower), std::sqrt(x.upper));
+        });
+
+        auto compiled = eval.compile("sqrt(x) + 1", { "x" });
+        CHECK( compiled({ { 4.0, 9.0 } }) == interval<double>(3.0, 4.0) );
+    }
+}
+
+TEST_CASE( "shared evaluator", "[evaluate][shared]" )
+{
+    using evaluation::shared_evaluator;
+
+    SECTION( "connect and disconnect" )
+    {
+        shared_evaluator<double> eval;
+        eval.connect("sq", [](double x) {
+            return x * x;
+        });
+        CHECK( eval("sq(3) + 1") == 10.0 );
+        CHECK( eval.compile("sq(x)", { "x" })({ 4.0 }) == 16.0 );
+
+        eval.connect_derivatives("sq", [](double x) {
+            return 2 * x;
+        });
+        auto compiled = eval.compile("sq(x)", { "x" });
+        double grad = 0.0;
+        evaluation::gradient(compiled, { 3.0 }, &grad);
+        CHECK( grad == 6.0 );
+
+        eval.disconnect("sq");
+        CHECK_THROWS_AS( eval("sq(3)"), evaluation::error );
+        CHECK_THROWS_AS( eval.connect_derivatives("sq", [](double) { return 0.0; }),
+                         evaluation::error );
+    }
+
+    SECTION( "snapshots are not modified" )
+    {
+        evaluator<double> base;
+        base.connect("f", [](double x) {
+            return x + 1;
+        });
+        shared_evaluator<double> eval(base);
+
+        auto before = eval.snapshot();
+        eval.connect("f", [](double x) {
+            return x + 2;
+        });
+        eval.connect("g", [](double x) {
+            return -x;
+        });
+
+        CHECK( before->evaluate("f(1)") == 2.0 );
+        CHECK_THROWS_AS( before->evaluate("g(1)"), evaluation::error );
+        CHECK( eval("f(1)") == 3.0 );
+        CHECK( eval("g(1)") == -1.0 );
+    }
+
+    SECTION( "the cache follows the functions" )
+    {
+        shared_evaluator<double> eval;
+        eval.set_cache_capacity(8);
+        eval.connect("f", [](double) {
+            return 1.0;
+        });
+        CHECK( eval("f(0) * 2") == 2.0 );
+        CHECK( eval("f(0) * 2") == 2.0 );
+        CHECK( eval.snapshot()->cache_hits() == 1 );
+
+        eval.connect("f", [](double) {
+            return 5.0;
+        });
+        CHECK( eval.snapshot()->cache_capacity() == 8 );
+        CHECK( eval("f(0) * 2") == 10.0 );
+    }
+
+    SECTION( "nested evaluations" )
+    {
+        shared_evaluator<double> eval;
+        eval.connect("one", [] {
+            return 1.0;
+        });
+
+        // A function evaluating an expression with the same
+        // evaluator, after a write in the middle of it
+        eval.connect("nested", [&eval](double x) {
+            eval.connect("two", [] {
+                return 2.0;
+            });
+            return eval("one() + two()") + x;
+        });
+        CHECK( eval("nested(10) * one()") == 13.0 );
+        CHECK( eval("two()") == 2.0 );
+    }
+
+    SECTION( "more evaluators than local snapshots" )
+    {
+        std::vector<std::unique_ptr<shared_evaluator<double>>> evals;
+        for (int i = 0 ; i < 10 ; ++i)
+        {
+            evals.emplace_back(new shared_evaluator<double>);
+            evals.back()->connect("f", [i] {
+                return double(i);
+            });
+        }
+        for (int round = 0 ; round < 3 ; ++round)
+        {
+            for (int i = 0 ; i < 10 ; ++i)
+            {
+                CHECK( (*evals[i])("f()") == double(i) );
+            }
+        }
+
+        // A destroyed evaluator is never confused with a new one
+        evals.front().reset(new shared_evaluator<double>);
+        CHECK_THROWS_AS( (*evals.front())("f()"), evaluation::error );
+    }
+
+    SECTION( "disconnected functions are destroyed" )
+    {
+        auto state = std::make_shared<double>(1.0);
+        std::weak_ptr<double> watcher = state;
+
+        shared_evaluator<double> eval;
+        eval.connect("f", [state](double x) {
+            return x + *state;
+        });
+        state.reset();
+
+        // Evaluations on this thread and on another one do not
+        // keep the function alive once they are done
+        CHECK( eval("f(1)") == 2.0 );
+        double res = 0.0;
+        std::thread([&] { res = eval("f(2)"); }).join();
+        CHECK( res == 3.0 );
+        CHECK( not watcher.expired() );
+
+        eval.disconnect("f");
+        CHECK( watcher.expired() );
+
+        // A function disconnected during an evaluation is
+        // destroyed when the evaluation is over
+        state = std::make_shared<double>(1.0);
+        watcher = state;
+        eval.connect("f", [state](double x) {
+            return x + *state;
+        });
+        state.reset();
+        eval.connect("drop", [&eval] {
+            eval.disconnect("f");
+            return 0.0;
+        });
+        CHECK( eval("f(1) + drop() + f(1)") == 4.0 );
+        CHECK( watcher.expired() );
+        CHECK_THROWS_AS( eval("f(1)"), evaluation::error );
+    }
+
+    SECTION( "concurrent readers and writers" )
+    {
+        shared_evaluator<double> eval;
+        eval.set_cache_capacity(4);
+        eval.connect("f", [](double x) {
+            return x;
+        });
+
+        // The readers must see either version of f, but never
+        // a missing or half-connected one
+        std::atomic<bool> done(false);
+        std::vector<int> failures(4, 0);
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0 ; i < failures.size() ; ++i)
+        {
+            threads.emplace_back([&, i] {
+                while (not done)
+                {
+                    double res = eval("f(2) + 1");
+                    if (res != 3.0 && res != 5.0)
+                    {
+                        ++failures[i];
+                    }
+                }
+            });
+        }
+
+        // Concurrent writers must not lose each other's functions
+        std::vector<std::thread> writers;
+        for (int i = 0 ; i < 2 ; ++i)
+        {
+            writers.emplace_back([&, i] {
+                for (int j = 0 ; j < 200 ; ++j)
+                {
+                    const std::string name = "w" + std::to_string(i) + "_" + std::to_string(j);
+                    eval.connect(name, [j] {
+                        return double(j);
+                    });
+                    eval.connect("f", [j](double x) {
+                        return (j % 2) ? x * 2 : x;
+                    });
+                }
+            });
+        }
+        for (auto& writer: writers)
+        {
+            writer.join();
+        }
+        done = true;
+        for (auto& thread: threads)
+        {
+            thread.join();
+        }
+
+        for (int res: failures)
+        {
+            CHECK( res == 0 );
+        }
+        CHECK( eval("w0_199() + w1_150()") == 349.0 );
+    }
 }
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2016-2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include <catch.hpp>
+#include <POLDER/algorithm.h>
+#include <POLDER/execution.h>
+#include <POLDER/thread_pool.h>
+
+using namespace polder;
+
+TEST_CASE( "thread pool", "[execution]" )
+{
+    SECTION( "submitted tasks are all run" )
+    {
+        std::atomic<int> count(0);
+        {
+            thread_pool pool(3);
+            CHECK( pool.size() == 3 );
+            for (int i = 0 ; i < 100 ; ++i)
+            {
+                pool.submit([&] { ++count; });
+            }
+        }
+        CHECK( count == 100 );
+    }
+
+    SECTION( "pool without worker threads" )
+    {
+        thread_pool pool(0);
+        int count = 0;
+        pool.submit([&] { ++count; });
+        CHECK( count == 1 );
+        CHECK( not pool.try_run_pending_task() );
+    }
+}
+
+TEST_CASE( "parallel algorithms", "[execution]" )
+{
+    thread_pool pool(3);
+    auto policy = par.on(pool).with_threshold(0);
+
+    SECTION( "parallel_for covers the whole range" )
+    {
+        std::vector<int> vec(1000, 0);
+        execution::parallel_for(policy, vec.size(),
+            [&](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin ; i < end ; ++i)
+                {
+                    vec[i] += int(i);
+                }
+            }
+        );
+        for (std::size_t i = 0 ; i < vec.size() ; ++i)
+        {
+            CHECK( vec[i] == int(i) );
+        }
+    }
+
+    SECTION( "nested parallel_for" )
+    {
+        std::atomic<int> count(0);
+        execution::parallel_for(policy, 10,
+            [&](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin ; i < end ; ++i)
+                {
+                    execution::parallel_for(policy, 10,
+                        [&](std::size_t begin, std::size_t end)
+                        {
+                            count += int(end - begin);
+                        }
+                    );
+                }
+            }
+        );
+        CHECK( count == 100 );
+    }
+
+    SECTION( "deciding once from the amount of work" )
+    {
+        auto small = execution::for_work(par.on(pool).with_threshold(100), 99);
+        CHECK( small.threshold() == std::numeric_limits<std::size_t>::max() );
+        CHECK( &small.pool() == &pool );
+
+        // Every chunk runs in parallel, however small
+        auto large = execution::for_work(par.on(pool).with_threshold(100), 100);
+        CHECK( large.threshold() == 0 );
+
+        std::atomic<int> nb_chunks(0);
+        execution::parallel_for(small, 1000,
+            [&](std::size_t, std::size_t)
+            {
+                ++nb_chunks;
+            }
+        );
+        CHECK( nb_chunks == 1 );
+    }
+
+    SECTION( "parallel_reduce" )
+    {
+        std::vector<long> vec(10000);
+        std::iota(vec.begin(), vec.end(), 1);
+        auto sum = execution::parallel_reduce<long>(policy, vec.size(),
+            [&](std::size_t begin, std::size_t end)
+            {
+                return std::accumulate(vec.begin() + begin, vec.begin() + end, 0L);
+            },
+            std::plus<>{}
+        );
+        CHECK( sum == 10000L * 10001L / 2 );
+    }
+
+    SECTION( "exceptions are propagated" )
+    {
+        CHECK_THROWS_AS(
+            execution::parallel_for(policy, 100,
+                [](std::size_t begin, std::size_t)
+                {
+                    if (begin != 0)
+                    {
+                        throw std::runtime_error("");
+                    }
+                }
+            ),
+            std::runtime_error
+        );
+    }
+
+    SECTION( "for_each with an execution policy" )
+    {
+        std::vector<int> vec1(1000, 1);
+        std::vector<int> vec2(1000, 2);
+        polder::for_each(policy, vec1.begin(), vec1.end(), vec2.begin(),
+                         [](int& lhs, int rhs) { lhs += rhs; });
+        polder::for_each(seq, vec1.begin(), vec1.end(), [](int& val) { val *= 2; });
+        CHECK( std::all_of(vec1.begin(), vec1.end(), [](int val) { return val == 6; }) );
+    }
+}
@@ -166,4 +166,14 @@ TEST_CASE( "stride_iterator", "[iterator]" )
     --stride_it;
     CHECK( stride_it.base() == std::begin(vec) );
     CHECK( *stride_it == 0 );
+
+    // Random access
+    CHECK( stride_it[2] == 6 );
+    auto other = stride_it + 3;
+    CHECK( *other == 9 );
+    CHECK( other - stride_it == 3 );
+    other -= 2;
+    CHECK( *other == 3 );
+    stride_it = other;
+    CHECK( *stride_it == 3 );
 }
@@ -15,11 +15,25 @@
  * License along with this program. If not,
  * see <http://www.gnu.org/licenses/>.
  */
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include <catch.hpp>
 #include <POLDER/index.h>
 #include <POLDER/itertools.h>
+#include <POLDER/geometry/point.h>
+#include <POLDER/geometry/vector.h>
+#include <POLDER/exceptions.h>
 #include <POLDER/matrix.h>
+#include <POLDER/matrix/batch.h>
+#include <POLDER/matrix/binary.h>
+#include <POLDER/matrix/power.h>
+#include <POLDER/matrix/static_matrix.h>
 #include <POLDER/rational.h>
+#include <POLDER/thread_pool.h>
 
 using namespace polder;
 
@@ -120,6 +134,52 @@ TEST_CASE( "matrix", "[matrix]" )
         }
     }
 
+    SECTION( "rows" )
+    {
+        Matrix<int> a = {
+            { 0, 1, 2 },
+            { 3, 4, 5 }
+        };
+
+        int count = 0;
+        for (auto row: a)
+        {
+            CHECK( row.size() == 3 );
+            for (int& val: row)
+            {
+                CHECK( val == count++ );
+                val *= 2;
+            }
+        }
+        CHECK( count == 6 );
+        CHECK( a[1][2] == 10 );
+
+        // Rows are computed from the current dimensions
+        a.reshape(3, 2);
+        CHECK( a.end() - a.begin() == 3 );
+        CHECK( a[2][0] == 8 );
+        CHECK( a.rbegin()->size() == 2 );
+        CHECK( (*a.rbegin())[1] == 10 );
+
+        const Matrix<int>& b = a;
+        Matrix<int>::const_row row = b[1];
+        CHECK( row[0] == 4 );
+        CHECK( std::distance(row.begin(), row.end()) == 2 );
+
+        Matrix<int>::const_iterator it = a.begin();
+        CHECK( it[1][1] == 6 );
+        CHECK( it + 3 == b.end() );
+
+        a.flatten();
+        CHECK( a.end() - a.begin() == 1 );
+        CHECK( a[0][5] == 10 );
+
+        // A copy has its own rows
+        Matrix<int> c = a;
+        c[0][0] = 42;
+        CHECK( a[0][0] == 0 );
+    }
+
     SECTION( "comparison operators" )
     {
         Matrix<int> a = {
@@ -184,6 +244,84 @@ TEST_CASE( "matrix", "[matrix]" )
         };
         CHECK( transpose(a) == b );
         CHECK( transpose(b) == a );
+
+        // Big enough to be split by the recursion,
+        // with sizes that are not powers of 2
+        Matrix<int> big(37, 85);
+        for (std::size_t i = 0 ; i < big.height() ; ++i)
+        {
+            for (std::size_t j = 0 ; j < big.width() ; ++j)
+            {
+                big(i, j) = int(i * 100 + j);
+            }
+        }
+        auto big_t = transpose(big);
+        REQUIRE( big_t.height() == 85 );
+        REQUIRE( big_t.width() == 37 );
+        CHECK( big_t == Matrix<int>(big.transposed()) );
+
+        transpose_in_place(big);
+        CHECK( big == big_t );
+
+        // In-place transpose of square matrices
+        Matrix<int> sq(45, 45);
+        for (std::size_t i = 0 ; i < sq.height() ; ++i)
+        {
+            for (std::size_t j = 0 ; j < sq.width() ; ++j)
+            {
+                sq(i, j) = int(i * 100 + j);
+            }
+        }
+        const Matrix<int> sq_t = transpose(sq);
+        const int* addr = sq.data();
+        transpose_in_place(sq);
+        CHECK( sq == sq_t );
+        CHECK( sq.data() == addr );
+    }
+
+    SECTION( "products with transposed views" )
+    {
+        const std::size_t m = 41, k = 97, n = 29;
+
+        Matrix<double> a(m, k);
+        Matrix<double> b(n, k);
+        for (std::size_t i = 0 ; i < m ; ++i)
+        {
+            for (std::size_t j = 0 ; j < k ; ++j)
+            {
+                a(i, j) = double(int(i * 7 + j * 3) % 11 - 5);
+            }
+        }
+        for (std::size_t i = 0 ; i < n ; ++i)
+        {
+            for (std::size_t j = 0 ; j < k ; ++j)
+            {
+                b(i, j) = double(int(i * 5 + j) % 13 - 6);
+            }
+        }
+
+        auto expected = a * transpose(b);
+        CHECK( a * b.transposed() == expected );
+        CHECK( transpose(b * a.transposed()) == expected );
+        const Matrix<double> at = transpose(a);
+        CHECK( at.transposed() * b.transposed() == expected );
+        CHECK( multiply(execution::seq, a, b.transposed()) == expected );
+
+        // Products of blocks
+        auto blk = a.block(1, 2, 3, 4) * b.transposed().block(2, 5, 4, 2);
+        REQUIRE( blk.height() == 3 );
+        REQUIRE( blk.width() == 2 );
+        CHECK( blk(2, 1) == expected(3, 6) - [&] {
+            double res = 0.0;
+            for (std::size_t p = 0 ; p < k ; ++p)
+            {
+                if (p < 2 || p >= 6)
+                {
+                    res += a(3, p) * b(6, p);
+                }
+            }
+            return res;
+        }() );
     }
 
     SECTION( "matrix/scalar multiplication" )
@@ -201,6 +339,72 @@ TEST_CASE( "matrix", "[matrix]" )
         CHECK( 5 * a == a * 5 );
     }
 
+    SECTION( "element-wise expressions" )
+    {
+        Matrix<int> a = {
+            { 1, 5, -2 },
+            { 2, 0, 1 }
+        };
+        Matrix<int> b = {
+            { 0, 2, 1 },
+            { 1, -3, 5 }
+        };
+        Matrix<int> c = {
+            { 3, 1, 1 },
+            { -1, 2, 0 }
+        };
+
+        // Expressions are evaluated element by element
+        auto expr = 2 * a + b - c / 2 + (-c);
+        CHECK( expr.height() == 2 );
+        CHECK( expr.width() == 3 );
+        CHECK( expr(0, 1) == 11 );
+        CHECK( expr(1, 0) == 6 );
+
+        Matrix<int> d = expr;
+        Matrix<int> e = {
+            { -2, 11, -4 },
+            { 6, -6, 7 }
+        };
+        CHECK( d == e );
+        CHECK( expr == e );
+        CHECK( e == expr );
+
+        // Temporary operands are kept alive by the expression
+        Matrix<int> f = (a + b) * 2 + Matrix<int>::ones(2, 3);
+        Matrix<int> g = {
+            { 3, 15, -1 },
+            { 7, -5, 13 }
+        };
+        CHECK( f == g );
+
+        // Assignments and compound assignments
+        Matrix<int> h;
+        h = a + b;
+        CHECK( h == (Matrix<int>{ { 1, 7, -1 }, { 3, -3, 6 } }) );
+        h = h - b;
+        CHECK( h == a );
+        h += a - b;
+        CHECK( h == 2 * a - b );
+        h -= a + a;
+        CHECK( h == -b );
+
+        // Products of expressions
+        Matrix<int> i = {
+            { 1, 0 },
+            { 2, 1 },
+            { 0, 3 }
+        };
+        CHECK( (a + b) * i == a * i + b * i );
+        CHECK( (a + b) * (i - i) == Matrix<int>::zeros(2, 2) );
+
+        // Conversion between element types
+        Matrix<double> j = a;
+        Matrix<double> k = j / 2.0;
+        CHECK( k(0, 1) == 2.5 );
+        CHECK( k(0, 2) == -1.0 );
+    }
+
     SECTION( "matrix/matrix multiplication" )
     {
         Matrix<int> a = {
@@ -241,6 +445,222 @@ TEST_CASE( "matrix", "[matrix]" )
         CHECK( a * (b + e) == a*b + a*e );
     }
 
+    SECTION( "blocked matrix/matrix multiplication" )
+    {
+        // Big enough to go through the packed algorithm,
+        // with sizes that do not fit the micro-kernels
+        const std::size_t m = 73, k = 301, n = 45;
+
+        Matrix<int> a(m, k);
+        Matrix<int> b(k, n);
+        Matrix<double> da(m, k);
+        Matrix<double> db(k, n);
+        for (std::size_t i = 0 ; i < m ; ++i)
+        {
+            for (std::size_t j = 0 ; j < k ; ++j)
+            {
+                a(i, j) = int(i * 7 + j * 3) % 11 - 5;
+                da(i, j) = a(i, j) / 4.0;
+            }
+        }
+        for (std::size_t i = 0 ; i < k ; ++i)
+        {
+            for (std::size_t j = 0 ; j < n ; ++j)
+            {
+                b(i, j) = int(i * 5 + j) % 13 - 6;
+                db(i, j) = b(i, j) / 2.0;
+            }
+        }
+
+        auto c = a * b;
+        auto dc = da * db;
+        REQUIRE( c.height() == m );
+        REQUIRE( c.width() == n );
+        for (std::size_t i = 0 ; i < m ; ++i)
+        {
+            for (std::size_t j = 0 ; j < n ; ++j)
+            {
+                int val = 0;
+                for (std::size_t p = 0 ; p < k ; ++p)
+                {
+                    val += a(i, p) * b(p, j);
+                }
+                CHECK( c(i, j) == val );
+                // Every intermediate value is exactly representable
+                CHECK( dc(i, j) == val / 8.0 );
+            }
+        }
+
+        // Accumulate the product into an existing matrix
+        Matrix<int> ones(m, n);
+        ones.fill(1);
+        Matrix<int> acc = ones;
+        gemm(m, n, k, a.data(), k, b.data(), n, acc.data(), n, gemm_mode::add);
+        CHECK( acc == c + ones );
+        gemm(m, n, k, a.data(), k, b.data(), n, acc.data(), n, gemm_mode::subtract);
+        CHECK( acc == ones );
+
+        // Same thing for a product too small to be packed
+        Matrix<int> small = { { 1, 2 }, { 3, 4 } };
+        Matrix<int> small_acc = { { 10, 10 }, { 10, 10 } };
+        gemm(2, 2, 2, small.data(), 2, small.data(), 2, small_acc.data(), 2, gemm_mode::subtract);
+        CHECK( small_acc == (Matrix<int>{ { 3, 0 }, { -5, -12 } }) );
+    }
+
+    SECTION( "parallel operations" )
+    {
+        thread_pool pool(3);
+        auto policy = par.on(pool).with_threshold(0);
+
+        Matrix<int> a(97, 131);
+        Matrix<int> b(131, 61);
+        for (std::size_t i = 0 ; i < a.size() ; ++i)
+        {
+            a.data()[i] = int(i % 17) - 8;
+        }
+        for (std::size_t i = 0 ; i < b.size() ; ++i)
+        {
+            b.data()[i] = int(i % 7) - 3;
+        }
+
+        CHECK( multiply(policy, a, b) == a * b );
+        CHECK( add(policy, a, a) == a + a );
+        CHECK( subtract(policy, b, b) == Matrix<int>::zeros(131, 61) );
+
+        CHECK( a.sum(policy) == a.sum() );
+        CHECK( a.min(policy) == -8 );
+        CHECK( a.max(policy) == 8 );
+        CHECK( not a.all(policy) );
+        CHECK( a.any(policy) );
+
+        a.fill(policy, 3);
+        CHECK( a.all(seq) );
+        CHECK( a.sum(policy) == 3 * 97 * 131 );
+    }
+
+    SECTION( "LU decomposition" )
+    {
+        Matrix<double> a = {
+            { 2.0, 1.0, 1.0, 0.0 },
+            { 4.0, 3.0, 3.0, 1.0 },
+            { 8.0, 7.0, 9.0, 5.0 },
+            { 6.0, 7.0, 9.0, 8.0 }
+        };
+        auto close = [](double lhs, double rhs) {
+            return std::abs(lhs - rhs) < 1e-9;
+        };
+
+        LUDecomposition<double> lu(a);
+        CHECK( not lu.is_singular() );
+        CHECK( lu.determinant() == Approx(8.0) );
+        CHECK( a.determinant() == Approx(8.0) );
+        CHECK( a.is_invertible() );
+
+        Matrix<double> b = {
+            { 4.0, 1.0 },
+            { 11.0, 0.0 },
+            { 29.0, 2.0 },
+            { 30.0, -1.0 }
+        };
+        auto x = solve(a, b);
+        auto ax = a * x;
+        for (std::size_t i = 0 ; i < b.height() ; ++i)
+        {
+            for (std::size_t j = 0 ; j < b.width() ; ++j)
+            {
+                CHECK( close(ax(i, j), b(i, j)) );
+            }
+        }
+
+        auto identity = a * lu.inverse();
+        for (std::size_t i = 0 ; i < a.height() ; ++i)
+        {
+            for (std::size_t j = 0 ; j < a.width() ; ++j)
+            {
+                CHECK( close(identity(i, j), i == j ? 1.0 : 0.0) );
+            }
+        }
+
+        // Division by a matrix
+        Matrix<double> c = b * Matrix<double>{ { 1.0, 2.0 }, { 3.0, 5.0 } };
+        c /= Matrix<double>{ { 1.0, 2.0 }, { 3.0, 5.0 } };
+        for (std::size_t i = 0 ; i < b.height() ; ++i)
+        {
+            for (std::size_t j = 0 ; j < b.width() ; ++j)
+            {
+                CHECK( close(c(i, j), b(i, j)) );
+            }
+        }
+
+        // Singular matrices
+        Matrix<double> d = {
+            { 1.0, 2.0, 3.0 },
+            { 2.0, 4.0, 6.0 },
+            { 1.0, 0.0, 1.0 }
+        };
+        lu.decompose(d);
+        CHECK( lu.size() == 3 );
+        CHECK( lu.is_singular() );
+        CHECK( lu.determinant() == 0.0 );
+        CHECK( not d.is_invertible() );
+
+        // Big enough to go through the blocked algorithm
+        const std::size_t n = 150;
+        Matrix<double> e(n, n);
+        Matrix<double> f(n, 1);
+        for (std::size_t i = 0 ; i < n ; ++i)
+        {
+            for (std::size_t j = 0 ; j < n ; ++j)
+            {
+                e(i, j) = double(int(i * 13 + j * 7) % 17) - 8.0;
+            }
+            e(i, i) += 3.0 * n;
+            f(i, 0) = double(i % 5);
+        }
+        auto g = e * solve(e, f);
+        for (std::size_t i = 0 ; i < n ; ++i)
+        {
+            CHECK( close(g(i, 0), f(i, 0)) );
+        }
+
+        // Exact determinant for integers
+        Matrix<long long> h = {
+            { 2, -3, 1, 5, 0 },
+            { 4, 1, -2, 0, 3 },
+            { 0, 2, 6, -1, 1 },
+            { 1, 0, 3, 2, -4 },
+            { -2, 5, 0, 1, 2 }
+        };
+        Matrix<double> dh(5, 5);
+        for (std::size_t i = 0 ; i < 5 ; ++i)
+        {
+            for (std::size_t j = 0 ; j < 5 ; ++j)
+            {
+                dh(i, j) = double(h(i, j));
+            }
+        }
+        CHECK( double(h.determinant()) == Approx(dh.determinant()) );
+
+        Matrix<int> k = {
+            { 0, 1, 2 },
+            { 1, 0, 3 },
+            { 4, -3, 8 }
+        };
+        CHECK( k.determinant() == -2 );
+
+        // Exact inverse for integers, computed along with the
+        // adjugate: the division truncates unless det is 1 or -1
+        Matrix<int> u = {
+            { 0, 1, 2 },
+            { 1, 0, 3 },
+            { 4, -3, 7 }
+        };
+        CHECK( u.determinant() == -1 );
+        CHECK( u * inverse(u) == Matrix<int>::identity(3) );
+        CHECK( inverse(k) == transpose(adjugate(k)) / k.determinant() );
+        CHECK( inverse(h) == transpose(adjugate(h)) / h.determinant() );
+    }
+
     SECTION( "miscellaneous operations" )
     {
         Matrix<rational<int>> a = {
@@ -285,3 +705,748 @@ TEST_CASE( "matrix", "[matrix]" )
     }
 }
 
+
+TEST_CASE( "static matrix", "[matrix][static_matrix]" )
+{
+    SECTION( "basic properties" )
+    {
+        StaticMatrix<int, 2, 3> a = {{
+            { 1, 2, 3 },
+            { 4, 5, 6 }
+        }};
+
+        static_assert(StaticMatrix<int, 2, 3>::height() == 2, "");
+        static_assert(StaticMatrix<int, 2, 3>::width() == 3, "");
+        static_assert(sizeof(a) == 6 * sizeof(int), "");
+
+        CHECK( a.size() == 6 );
+        CHECK( not a.is_square() );
+        CHECK( a(1, 0) == 4 );
+        CHECK( a[0][2] == 3 );
+
+        a(1, 0) = 8;
+        a[0][2] = 9;
+        CHECK( a(1, 0) == 8 );
+        CHECK( a[0][2] == 9 );
+        CHECK( a.data()[2] == 9 );
+
+        a.fill(3);
+        CHECK( a == (StaticMatrix<int, 2, 3>::ones() * 3) );
+    }
+
+    SECTION( "compile-time operations" )
+    {
+        constexpr StaticMatrix<int, 2, 3> a = {{
+            { 1, 2, 3 },
+            { 4, 5, 6 }
+        }};
+        constexpr StaticMatrix<int, 3, 2> b = {{
+            { 1, 0 },
+            { 0, 1 },
+            { 2, 2 }
+        }};
+
+        constexpr auto c = a * b;
+        static_assert(c(0, 0) == 7 && c(0, 1) == 8, "");
+        static_assert(c(1, 0) == 16 && c(1, 1) == 17, "");
+
+        constexpr auto d = transpose(a);
+        static_assert(d(2, 0) == 3 && d(0, 1) == 4, "");
+
+        constexpr auto e = a + a - a * 3;
+        static_assert(e == -a, "");
+        static_assert(a / 2 != a, "");
+
+        constexpr auto id = StaticMatrix<int, 3, 3>::identity();
+        static_assert(trace(id) == 3, "");
+        static_assert(b * StaticMatrix<int, 2, 2>::identity() == b, "");
+
+        constexpr StaticMatrix<int, 3, 3> f = {{
+            { 2, -3,  1 },
+            { 2,  0, -1 },
+            { 1,  4,  5 }
+        }};
+        static_assert(determinant(f) == 49, "");
+        static_assert(determinant(StaticMatrix<long, 6, 6>::identity() * 2) == 64, "");
+
+        constexpr StaticMatrix<double, 2, 2> g = {{
+            { 4.0, 7.0 },
+            { 2.0, 6.0 }
+        }};
+        constexpr auto h = inverse(g);
+        static_assert(h(0, 0) == 0.6 && h(1, 1) == 0.4, "");
+    }
+
+    SECTION( "determinant and inverse" )
+    {
+        auto close = [](double lhs, double rhs) {
+            return std::abs(lhs - rhs) < 1e-9;
+        };
+
+        StaticMatrix<double, 4, 4> a = {{
+            { 4.0, 3.0, 2.0, 1.0 },
+            { 1.0, 5.0, 0.0, 2.0 },
+            { 2.0, 1.0, 6.0, 3.0 },
+            { 0.0, 2.0, 1.0, 7.0 }
+        }};
+        StaticMatrix<double, 5, 5> b = {{
+            { 0.0, 3.0, 2.0, 1.0, 1.0 },
+            { 1.0, 5.0, 0.0, 2.0, 4.0 },
+            { 2.0, 1.0, 6.0, 3.0, 0.0 },
+            { 0.0, 2.0, 1.0, 7.0, 2.0 },
+            { 3.0, 0.0, 1.0, 1.0, 8.0 }
+        }};
+
+        // Compare with the dynamic implementation
+        Matrix<double> dyn_a = a;
+        Matrix<double> dyn_b = b;
+        CHECK( close(determinant(a), determinant(dyn_a)) );
+        CHECK( close(determinant(b), determinant(dyn_b)) );
+
+        auto inv_a = inverse(a);
+        auto inv_b = inverse(b);
+        auto dyn_inv_a = inverse(dyn_a);
+        auto dyn_inv_b = inverse(dyn_b);
+        for (std::size_t i = 0 ; i < 4 ; ++i)
+        {
+            for (std::size_t j = 0 ; j < 4 ; ++j)
+            {
+                CHECK( close(inv_a(i, j), dyn_inv_a(i, j)) );
+            }
+        }
+        for (std::size_t i = 0 ; i < 5 ; ++i)
+        {
+            for (std::size_t j = 0 ; j < 5 ; ++j)
+            {
+                CHECK( close(inv_b(i, j), dyn_inv_b(i, j)) );
+            }
+        }
+
+        StaticMatrix<double, 3, 3> c = {{
+            { 1.0, 2.0, 3.0 },
+            { 0.0, 1.0, 4.0 },
+            { 5.0, 6.0, 0.0 }
+        }};
+        auto prod = c * inverse(c);
+        for (std::size_t i = 0 ; i < 3 ; ++i)
+        {
+            for (std::size_t j = 0 ; j < 3 ; ++j)
+            {
+                CHECK( close(prod(i, j), i == j ? 1.0 : 0.0) );
+            }
+        }
+    }
+
+    SECTION( "interoperability with Matrix" )
+    {
+        StaticMatrix<int, 2, 2> a = {{
+            { 1, 2 },
+            { 3, 4 }
+        }};
+        Matrix<int> b = {
+            { 5, 6 },
+            { 7, 8 }
+        };
+
+        Matrix<int> c = a + b;
+        CHECK( c == Matrix<int>({ { 6, 8 }, { 10, 12 } }) );
+        CHECK( a * b == Matrix<int>({ { 19, 22 }, { 43, 50 } }) );
+
+        StaticMatrix<int, 2, 2> d(b);
+        CHECK( d(1, 0) == 7 );
+
+        a += d;
+        a *= StaticMatrix<int, 2, 2>::identity();
+        CHECK( a == StaticMatrix<int, 2, 2>({ { 6, 8 }, { 10, 12 } }) );
+    }
+
+    SECTION( "geometric transforms" )
+    {
+        using geometry::Point;
+        using geometry::Vector;
+
+        // Rotation of a quarter turn
+        StaticMatrix<double, 2, 2> rotation = {{
+            { 0.0, -1.0 },
+            { 1.0,  0.0 }
+        }};
+        CHECK( rotation * Vector<2, double>(1.0, 0.0) == Vector<2, double>(0.0, 1.0) );
+        CHECK( rotation * Point<2, double>(2.0, 3.0) == Point<2, double>(-3.0, 2.0) );
+
+        // Translation in homogeneous coordinates
+        StaticMatrix<double, 4, 4> translation = {{
+            { 1.0, 0.0, 0.0, 5.0 },
+            { 0.0, 1.0, 0.0, 6.0 },
+            { 0.0, 0.0, 1.0, 7.0 },
+            { 0.0, 0.0, 0.0, 1.0 }
+        }};
+        CHECK( translation * Point<3, double>(1.0, 2.0, 3.0) == Point<3, double>(6.0, 8.0, 10.0) );
+        CHECK( translation * Vector<3, double>(1.0, 2.0, 3.0) == Vector<3, double>(1.0, 2.0, 3.0) );
+
+        // Projection dividing by the last coordinate
+        auto scale = StaticMatrix<double, 3, 3>::identity();
+        scale(2, 2) = 0.5;
+        CHECK( scale * Point<2, double>(1.0, 2.0) == Point<2, double>(2.0, 4.0) );
+    }
+}
+
+TEST_CASE( "matrix views", "[matrix][view]" )
+{
+    Matrix<int> mat = {
+        {  1,  2,  3,  4 },
+        {  5,  6,  7,  8 },
+        {  9, 10, 11, 12 }
+    };
+
+    SECTION( "blocks" )
+    {
+        auto blk = mat.block(1, 1, 2, 2);
+        CHECK( blk.height() == 2 );
+        CHECK( blk.width() == 2 );
+        CHECK( blk.stride() == 4 );
+        CHECK( not blk.is_contiguous() );
+        CHECK( blk(0, 0) == 6 );
+        CHECK( blk(1, 1) == 11 );
+        CHECK( blk[1][0] == 10 );
+        CHECK( blk.data() == mat.data() + 5 );
+
+        // Writing through the view writes to the matrix
+        blk(0, 1) = 42;
+        CHECK( mat(1, 2) == 42 );
+
+        // Nested blocks
+        auto sub = blk.block(1, 0, 1, 2);
+        CHECK( sub(0, 0) == 10 );
+        CHECK( sub(0, 1) == 11 );
+
+        // Rows iteration
+        int sum = 0;
+        for (auto row: blk)
+        {
+            CHECK( row.size() == 2 );
+            for (int val: row)
+            {
+                sum += val;
+            }
+        }
+        CHECK( sum == 6 + 42 + 10 + 11 );
+
+        const Matrix<int>& cmat = mat;
+        MatrixView<const int> cblk = cmat.block(0, 0, 1, 4);
+        CHECK( cblk.is_contiguous() );
+        CHECK( Matrix<int>(cblk) == Matrix<int>({ { 1, 2, 3, 4 } }) );
+    }
+
+    SECTION( "columns" )
+    {
+        auto col = mat.col(2);
+        CHECK( col.size() == 3 );
+        CHECK( col.stride() == 4 );
+        CHECK( col[0] == 3 );
+        CHECK( col[2] == 11 );
+
+        std::vector<int> values(col.begin(), col.end());
+        CHECK( values == std::vector<int>({ 3, 7, 11 }) );
+        CHECK( col.end() - col.begin() == 3 );
+
+        std::fill(col.begin(), col.end(), 0);
+        CHECK( mat(0, 2) == 0 );
+        CHECK( mat(1, 2) == 0 );
+        CHECK( mat(2, 2) == 0 );
+        CHECK( mat(2, 3) == 12 );
+    }
+
+    SECTION( "lazy transpose" )
+    {
+        auto tr = mat.transposed();
+        CHECK( tr.height() == 4 );
+        CHECK( tr.width() == 3 );
+        CHECK( tr.data() == mat.data() );
+        CHECK( Matrix<int>(tr) == transpose(mat) );
+        CHECK( tr.transposed()(2, 1) == mat(2, 1) );
+
+        // Rows of the transposed view are columns of the matrix
+        std::vector<int> values(tr[1].begin(), tr[1].end());
+        CHECK( values == std::vector<int>({ 2, 6, 10 }) );
+
+        tr(3, 0) = -4;
+        CHECK( mat(0, 3) == -4 );
+
+        auto blk = tr.block(1, 1, 2, 2);
+        CHECK( blk(0, 0) == 6 );
+        CHECK( blk(1, 0) == 7 );
+        CHECK( blk(0, 1) == 10 );
+    }
+
+    SECTION( "assignment and expressions" )
+    {
+        Matrix<int> other = {
+            { 1, 1 },
+            { 1, 1 }
+        };
+
+        // Assignment writes in place
+        mat.block(0, 0, 2, 2) = other;
+        CHECK( mat == Matrix<int>({
+            {  1,  1,  3,  4 },
+            {  1,  1,  7,  8 },
+            {  9, 10, 11, 12 }
+        }) );
+
+        mat.block(0, 2, 2, 2) += other * 10;
+        CHECK( mat(0, 2) == 13 );
+        CHECK( mat(1, 3) == 18 );
+
+        mat.block(1, 0, 2, 2) = mat.block(1, 2, 2, 2) - other;
+        CHECK( mat(1, 0) == 16 );
+        CHECK( mat(2, 1) == 11 );
+
+        // Views take part in lazy expressions
+        Matrix<int> res = mat.block(0, 0, 2, 2) + mat.block(1, 2, 2, 2);
+        CHECK( res == Matrix<int>({
+            { 18, 19 },
+            { 27, 29 }
+        }) );
+
+        // The transpose of a square block
+        Matrix<int> sq = { { 1, 2 }, { 3, 4 } };
+        Matrix<int> sum = sq + sq.transposed();
+        CHECK( sum == Matrix<int>({ { 2, 5 }, { 5, 8 } }) );
+
+        mat.transposed().block(0, 0, 2, 1) *= 2;
+        CHECK( mat(0, 0) == 2 );
+        CHECK( mat(0, 1) == 2 );
+        CHECK( mat(1, 0) == 16 );
+
+        mat.block(2, 0, 1, 4).fill(0);
+        CHECK( mat(2, 0) == 0 );
+        CHECK( mat(2, 3) == 0 );
+    }
+
+    SECTION( "assignment from overlapping memory" )
+    {
+        Matrix<int> n = {
+            { 1, 2, 3 },
+            { 4, 5, 6 },
+            { 7, 8, 9 }
+        };
+
+        n.view() = n.transposed();
+        CHECK( n == Matrix<int>({
+            { 1, 4, 7 },
+            { 2, 5, 8 },
+            { 3, 6, 9 }
+        }) );
+
+        n.transposed() += n;
+        CHECK( n == Matrix<int>({
+            {  2,  6, 10 },
+            {  6, 10, 14 },
+            { 10, 14, 18 }
+        }) );
+
+        // Overlapping blocks, in both directions
+        n.block(1, 1, 2, 2) = n.block(0, 0, 2, 2);
+        CHECK( n == Matrix<int>({
+            {  2,  6, 10 },
+            {  6,  2,  6 },
+            { 10,  6, 10 }
+        }) );
+        n.block(0, 0, 2, 2) = n.block(1, 1, 2, 2) * 2;
+        CHECK( n == Matrix<int>({
+            {  4, 12, 10 },
+            { 12, 20,  6 },
+            { 10,  6, 10 }
+        }) );
+
+        // The same elements are updated in place
+        n.view() = n.view() + n;
+        CHECK( n(1, 1) == 40 );
+
+        std::vector<int> buffer = { 1, 2, 3, 4, 5, 6 };
+        MatrixView<int> row(buffer.data(), 1, 5);
+        row = MatrixView<int>(buffer.data() + 1, 1, 5);
+        CHECK( buffer == std::vector<int>({ 2, 3, 4, 5, 6, 6 }) );
+        row = MatrixView<int>(buffer.data() + 1, 1, 5) - MatrixView<int>(buffer.data(), 1, 5);
+        CHECK( buffer == std::vector<int>({ 1, 1, 1, 1, 0, 6 }) );
+    }
+
+    SECTION( "external buffers" )
+    {
+        // Any buffer can be viewed as a matrix, with
+        // some padding at the end of the rows
+        std::vector<double> buffer = {
+            1.0, 2.0, 3.0, -1.0,
+            4.0, 5.0, 6.0, -1.0
+        };
+        MatrixView<double> view(buffer.data(), 2, 3, 4);
+        CHECK( view(1, 2) == 6.0 );
+
+        view *= 2.0;
+        CHECK( buffer[6] == 12.0 );
+        CHECK( buffer[7] == -1.0 );
+
+        Matrix<double> mat2 = view;
+        CHECK( mat2.width() == 3 );
+        CHECK( mat2(1, 0) == 8.0 );
+
+        StridedMatrixView<const double> tr = view.transposed();
+        CHECK( tr(2, 1) == 12.0 );
+    }
+}
+
+TEST_CASE( "binary matrix format", "[matrix][binary]" )
+{
+    using namespace polder;
+
+    Matrix<double> mat(37, 23);
+    for (std::size_t i = 0 ; i < mat.height() ; ++i)
+    {
+        for (std::size_t j = 0 ; j < mat.width() ; ++j)
+        {
+            mat(i, j) = double(i) * 0.5 - double(j);
+        }
+    }
+
+    SECTION( "streaming" )
+    {
+        std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+        write_binary(stream, mat);
+        CHECK( stream.str().size() == 64 + mat.size() * sizeof(double) );
+
+        auto header = read_binary_header(stream);
+        CHECK( header.type == element_type::float64 );
+        CHECK( header.element_size == sizeof(double) );
+        CHECK( header.height == 37 );
+        CHECK( header.width == 23 );
+        CHECK( header.data_offset % header.alignment == 0 );
+        CHECK( not header.swap_bytes );
+
+        stream.seekg(0);
+        Matrix<double> res = read_binary<double>(stream);
+        CHECK( res == mat );
+
+        // Wrong element type
+        stream.seekg(0);
+        CHECK_THROWS_AS( read_binary<float>(stream), io_error );
+
+        // Truncated file
+        std::string truncated = stream.str();
+        truncated.resize(truncated.size() - 1);
+        std::istringstream truncated_stream(truncated, std::ios::binary);
+        CHECK_THROWS_AS( read_binary<double>(truncated_stream), io_error );
+
+        std::istringstream garbage("definitely not a matrix file, not at all, "
+                                   "this string is long enough though");
+        CHECK_THROWS_AS( read_binary_header(garbage), io_error );
+    }
+
+    SECTION( "views and byte order" )
+    {
+        // Strided views are written as plain matrices
+        std::stringstream stream(std::ios::in | std::ios::out | std::ios::binary);
+        write_binary(stream, mat.block(3, 2, 10, 7).transposed());
+        Matrix<double> res = read_binary<double>(stream);
+        CHECK( res == transpose(Matrix<double>(mat.block(3, 2, 10, 7))) );
+
+        // Rewrite the header and the elements in
+        // the other byte order
+        Matrix<std::int32_t> ints = { { 1, 2, 3 }, { 0x01020304, -5, 6 } };
+        std::stringstream native(std::ios::in | std::ios::out | std::ios::binary);
+        write_binary(native, ints);
+        std::string bytes = native.str();
+        auto swap = [&](std::size_t pos, std::size_t size) {
+            std::reverse(bytes.begin() + pos, bytes.begin() + pos + size);
+        };
+        swap(8, 4);
+        swap(12, 2);
+        swap(16, 8);
+        swap(24, 8);
+        swap(32, 8);
+        swap(40, 4);
+        for (std::size_t i = 0 ; i < ints.size() ; ++i)
+        {
+            swap(64 + i * 4, 4);
+        }
+
+        std::istringstream swapped(bytes, std::ios::binary);
+        auto header = read_binary_header(swapped);
+        CHECK( header.swap_bytes );
+        CHECK( header.height == 2 );
+        swapped.seekg(0);
+        CHECK( read_binary<std::int32_t>(swapped) == ints );
+    }
+
+    SECTION( "memory-mapped files" )
+    {
+        const char* path = "polder-binary-matrix.bin";
+        {
+            std::ofstream file(path, std::ios::binary);
+            write_binary(file, mat);
+        }
+
+        {
+            MappedMatrix<double> mapped = map_matrix<double>(path);
+            CHECK( mapped.height() == 37 );
+            CHECK( mapped.width() == 23 );
+            CHECK( mapped.is_contiguous() );
+            CHECK( reinterpret_cast<std::uintptr_t>(mapped.data()) % default_alignment == 0 );
+            CHECK( mapped(36, 22) == mat(36, 22) );
+            CHECK( Matrix<double>(mapped) == mat );
+
+            // The mapped matrix is usable as a read-only view
+            MatrixView<const double> view = mapped.view();
+            CHECK( view.block(1, 1, 2, 2)(1, 1) == mat(2, 2) );
+            CHECK( (mapped.view() * mat.transposed()) == mat * transpose(mat) );
+
+            MappedMatrix<double> moved(std::move(mapped));
+            CHECK( moved(5, 5) == mat(5, 5) );
+
+            CHECK_THROWS_AS( MappedMatrix<float>(path), io_error );
+        }
+        std::remove(path);
+
+        CHECK_THROWS_AS( map_matrix<double>("polder-no-such-file.bin"), io_error );
+    }
+}
+
+TEST_CASE( "batched small matrices", "[matrix][batch]" )
+{
+    using namespace polder;
+
+    // Deterministic and well-conditioned matrices, a
+    // few of them needing row swaps to be pivoted
+    auto make_matrix = [](std::size_t size, std::size_t seed) {
+        Matrix<double> res(size, size);
+        for (std::size_t i = 0 ; i < size ; ++i)
+        {
+            for (std::size_t j = 0 ; j < size ; ++j)
+            {
+                res(i, j) = double((i * 7 + j * 13 + seed * 5) % 11) - 5.0;
+            }
+            res(i, (i + seed) % size) += 20.0;
+        }
+        return res;
+    };
+
+    auto close = [](double lhs, double rhs) {
+        return std::abs(lhs - rhs) <= 1e-9 * std::max(1.0, std::abs(rhs));
+    };
+
+    auto matrices_close = [&](const Matrix<double>& lhs, const Matrix<double>& rhs) {
+        for (std::size_t i = 0 ; i < lhs.height() ; ++i)
+        {
+            for (std::size_t j = 0 ; j < lhs.width() ; ++j)
+            {
+                if (not close(lhs(i, j), rhs(i, j)))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    // The count is not a multiple of the block size
+    const std::size_t count = 3 * MatrixBatch<double>::block_size + 5;
+    thread_pool pool(3);
+    auto policy = execution::par.on(pool).with_threshold(1);
+
+    SECTION( "layout" )
+    {
+        MatrixBatch<double> batch(count, 2, 3);
+        CHECK( batch.count() == count );
+        CHECK( batch.nb_blocks() == 4 );
+
+        // Elements of the same position are contiguous in a block
+        const std::size_t block_size = MatrixBatch<double>::block_size;
+        Matrix<double> mat = { { 1.0, 2.0, 3.0 }, { 4.0, 5.0, 6.0 } };
+        batch.set(block_size + 1, mat);
+        CHECK( batch(block_size + 1, 1, 2) == 6.0 );
+        CHECK( batch.block(1)[5 * block_size + 1] == 6.0 );
+        CHECK( batch.block(1) - batch.data() == std::ptrdiff_t(6 * block_size) );
+        CHECK( batch.get(block_size + 1) == mat );
+        CHECK( batch.get(block_size) == Matrix<double>::zeros(2, 3) );
+    }
+
+    SECTION( "determinant and inverse" )
+    {
+        for (std::size_t size = 1 ; size <= 8 ; ++size)
+        {
+            MatrixBatch<double> batch(count, size, size);
+            for (std::size_t i = 0 ; i < count ; ++i)
+            {
+                batch.set(i, make_matrix(size, i));
+            }
+            // A singular matrix
+            batch.set(2, Matrix<double>::zeros(size, size));
+
+            std::vector<double> dets(count);
+            batch_determinant(batch, dets.data());
+            std::vector<double> par_dets(count);
+            batch_determinant(policy, batch, par_dets.data());
+            CHECK( dets == par_dets );
+
+            CHECK( dets[2] == 0.0 );
+            bool dets_ok = true;
+            for (std::size_t i = 0 ; i < count ; ++i)
+            {
+                dets_ok = dets_ok && close(dets[i], determinant(batch.get(i)));
+            }
+            CHECK( dets_ok );
+
+            batch.set(2, make_matrix(size, 2));
+            MatrixBatch<double> inv(count, size, size);
+            batch_inverse(batch, inv);
+            bool inverses_ok = true;
+            for (std::size_t i = 0 ; i < count ; ++i)
+            {
+                Matrix<double> product = batch.get(i) * inv.get(i);
+                inverses_ok = inverses_ok
+                           && matrices_close(product, Matrix<double>::identity(size));
+            }
+            CHECK( inverses_ok );
+
+            // In-place inversion
+            batch_inverse(policy, batch, batch);
+            bool in_place_ok = true;
+            for (std::size_t i = 0 ; i < count ; ++i)
+            {
+                in_place_ok = in_place_ok && batch.get(i) == inv.get(i);
+            }
+            CHECK( in_place_ok );
+        }
+    }
+
+    SECTION( "multiply" )
+    {
+        MatrixBatch<double> lhs(count, 3, 5);
+        MatrixBatch<double> rhs(count, 5, 4);
+        for (std::size_t i = 0 ; i < count ; ++i)
+        {
+            Matrix<double> a(3, 5);
+            Matrix<double> b(5, 4);
+            for (std::size_t y = 0 ; y < 3 ; ++y)
+            {
+                for (std::size_t x = 0 ; x < 5 ; ++x)
+                {
+                    a(y, x) = double(i + y * 5 + x);
+                }
+            }
+            for (std::size_t y = 0 ; y < 5 ; ++y)
+            {
+                for (std::size_t x = 0 ; x < 4 ; ++x)
+                {
+                    b(y, x) = double(i) - double(y * 4 + x);
+                }
+            }
+            lhs.set(i, a);
+            rhs.set(i, b);
+        }
+
+        MatrixBatch<double> res(count, 3, 4);
+        batch_multiply(lhs, rhs, res);
+        MatrixBatch<double> par_res(count, 3, 4);
+        batch_multiply(policy, lhs, rhs, par_res);
+
+        bool products_ok = true;
+        for (std::size_t i = 0 ; i < count ; ++i)
+        {
+            Matrix<double> expected = lhs.get(i) * rhs.get(i);
+            products_ok = products_ok
+                       && res.get(i) == expected
+                       && par_res.get(i) == expected;
+        }
+        CHECK( products_ok );
+    }
+}
+
+TEST_CASE( "matrix powers", "[matrix][power]" )
+{
+    using namespace polder;
+
+    auto matrices_close = [](const Matrix<double>& lhs, const Matrix<double>& rhs) {
+        for (std::size_t i = 0 ; i < lhs.height() ; ++i)
+        {
+            for (std::size_t j = 0 ; j < lhs.width() ; ++j)
+            {
+                if (std::abs(lhs(i, j) - rhs(i, j)) > 1e-12 * std::max(1.0, std::abs(rhs(i, j))))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    SECTION( "matrix_pow" )
+    {
+        // Fibonacci numbers
+        Matrix<long long> fib = {
+            { 1, 1 },
+            { 1, 0 }
+        };
+        CHECK( matrix_pow(fib, 0) == Matrix<long long>::identity(2) );
+        CHECK( matrix_pow(fib, 1) == fib );
+        CHECK( matrix_pow(fib, 10)(0, 1) == 55 );
+        CHECK( matrix_pow(fib, 90)(0, 1) == 2880067194370816120LL );
+
+        Matrix<int> mat = {
+            { 1, -1, 0, 2 },
+            { 0, 1, 1, 0 },
+            { 1, 0, 0, -1 },
+            { 0, 2, -1, 1 }
+        };
+        Matrix<int> expected = Matrix<int>::identity(4);
+        thread_pool pool(3);
+        auto policy = execution::par.on(pool).with_threshold(1);
+        for (std::size_t n = 0 ; n < 13 ; ++n)
+        {
+            CHECK( matrix_pow(mat, n) == expected );
+            CHECK( matrix_pow(policy, mat, n) == expected );
+            expected *= mat;
+        }
+    }
+
+    SECTION( "matrix_exp" )
+    {
+        CHECK( matrix_exp(Matrix<double>::zeros(3, 3)) == Matrix<double>::identity(3) );
+
+        // Nilpotent matrix: the series is finite
+        Matrix<double> nilpotent = {
+            { 0.0, 1.0, 2.0 },
+            { 0.0, 0.0, 3.0 },
+            { 0.0, 0.0, 0.0 }
+        };
+        Matrix<double> nilpotent_exp = {
+            { 1.0, 1.0, 3.5 },
+            { 0.0, 1.0, 3.0 },
+            { 0.0, 0.0, 1.0 }
+        };
+        CHECK( matrices_close(matrix_exp(nilpotent), nilpotent_exp) );
+
+        // Big norms need several squarings
+        Matrix<double> diagonal = {
+            { 10.0, 0.0 },
+            { 0.0, -3.0 }
+        };
+        Matrix<double> diagonal_exp = {
+            { std::exp(10.0), 0.0 },
+            { 0.0, std::exp(-3.0) }
+        };
+        CHECK( matrices_close(matrix_exp(diagonal), diagonal_exp) );
+
+        // Rotation
+        const double angle = 2.5;
+        Matrix<double> generator = {
+            { 0.0, angle },
+            { -angle, 0.0 }
+        };
+        Matrix<double> rotation = {
+            { std::cos(angle), std::sin(angle) },
+            { -std::sin(angle), std::cos(angle) }
+        };
+        CHECK( matrices_close(matrix_exp(generator), rotation) );
+        CHECK( matrices_close(matrix_exp(execution::par, generator), rotation) );
+    }
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2016-2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdint>
+#include <vector>
+#include <catch.hpp>
+#include <POLDER/matrix.h>
+#include <POLDER/memory.h>
+
+using namespace polder;
+
+namespace
+{
+    template<typename T>
+    auto is_aligned(const T* ptr, std::size_t alignment)
+        -> bool
+    {
+        return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+    }
+}
+
+TEST_CASE( "aligned allocator", "[memory]" )
+{
+    SECTION( "allocated blocks are aligned" )
+    {
+        aligned_allocator<double> alloc;
+        for (std::size_t n = 1 ; n < 100 ; n += 7)
+        {
+            double* ptr = alloc.allocate(n);
+            CHECK( is_aligned(ptr, 64) );
+            alloc.deallocate(ptr, n);
+        }
+
+        aligned_allocator<char, 256> char_alloc;
+        char* ptr = char_alloc.allocate(3);
+        CHECK( is_aligned(ptr, 256) );
+        char_alloc.deallocate(ptr, 3);
+    }
+
+    SECTION( "allocator_alignment" )
+    {
+        CHECK( allocator_alignment<aligned_allocator<float>>::value == default_alignment );
+        CHECK( allocator_alignment<aligned_allocator<float, 32>>::value == 32 );
+        CHECK( allocator_alignment<arena_allocator<int, 16>>::value == 16 );
+        CHECK( allocator_alignment<std::allocator<double>>::value == alignof(double) );
+    }
+
+    SECTION( "vector with aligned storage" )
+    {
+        std::vector<int, aligned_allocator<int>> vec;
+        for (int i = 0 ; i < 1000 ; ++i)
+        {
+            vec.push_back(i);
+            CHECK( is_aligned(vec.data(), 64) );
+        }
+        CHECK( vec[999] == 999 );
+    }
+}
+
+TEST_CASE( "monotonic arena", "[memory]" )
+{
+    SECTION( "allocations are aligned and do not overlap" )
+    {
+        monotonic_arena arena(128);
+        char* first = static_cast<char*>(arena.allocate(10, 1));
+        char* second = static_cast<char*>(arena.allocate(24, 32));
+        CHECK( is_aligned(second, 32) );
+        CHECK( second >= first + 10 );
+        CHECK( arena.used() == 34 );
+
+        // Bigger than the current chunk
+        void* big = arena.allocate(1000, 64);
+        CHECK( is_aligned(big, 64) );
+        CHECK( arena.capacity() >= 1128 );
+    }
+
+    SECTION( "release reuses the memory" )
+    {
+        monotonic_arena arena(64);
+        for (int i = 0 ; i < 10 ; ++i)
+        {
+            arena.allocate(100, 8);
+        }
+        std::size_t capacity = arena.capacity();
+
+        arena.release();
+        CHECK( arena.used() == 0 );
+        CHECK( arena.capacity() <= capacity );
+
+        // The biggest chunk is kept: the same allocations
+        // again do not need any new memory
+        capacity = arena.capacity();
+        arena.allocate(100, 8);
+        CHECK( arena.capacity() == capacity );
+    }
+
+    SECTION( "arena allocator in containers" )
+    {
+        monotonic_arena arena;
+        arena_allocator<int> alloc(arena);
+        std::vector<int, arena_allocator<int>> vec(alloc);
+        for (int i = 0 ; i < 100 ; ++i)
+        {
+            vec.push_back(i);
+        }
+        CHECK( vec[42] == 42 );
+        CHECK( is_aligned(vec.data(), 64) );
+        CHECK( arena.used() > 100 * sizeof(int) );
+
+        arena_allocator<double> other(alloc);
+        CHECK( other == arena_allocator<double>(arena) );
+    }
+}
+
+TEST_CASE( "matrix allocators", "[memory][matrix]" )
+{
+    SECTION( "default alignment" )
+    {
+        static_assert(types_t<Matrix<float>>::alignment == default_alignment, "");
+        static_assert(Matrix<float>::alignment == default_alignment, "");
+
+        Matrix<float> mat(7, 3);
+        CHECK( is_aligned(mat.data(), default_alignment) );
+        mat = Matrix<float>::ones(13, 5);
+        CHECK( is_aligned(mat.data(), default_alignment) );
+    }
+
+    SECTION( "matrices in an arena" )
+    {
+        using arena_matrix = Matrix<double, arena_allocator<double>>;
+        static_assert(types_t<arena_matrix>::alignment == default_alignment, "");
+
+        monotonic_arena arena;
+        arena_allocator<double> alloc(arena);
+
+        arena_matrix a = arena_matrix::identity(3, alloc);
+        arena_matrix b({ { 1.0, 2.0, 3.0 },
+                         { 4.0, 5.0, 6.0 },
+                         { 7.0, 8.0, 10.0 } }, alloc);
+
+        arena_matrix c = a * b;
+        CHECK( c == b );
+        CHECK( c.get_allocator() == alloc );
+
+        arena_matrix d(a + b * 2.0, alloc);
+        CHECK( d(0, 0) == 3.0 );
+        CHECK( d(2, 2) == 21.0 );
+
+        CHECK( determinant(b) == Approx(-3.0) );
+        arena_matrix e = inverse(b) * b;
+        CHECK( e(1, 1) == Approx(1.0) );
+        CHECK( e(0, 1) == Approx(0.0).margin(1e-12) );
+
+        // Interoperability with the default allocator
+        Matrix<double> f = b;
+        CHECK( f(2, 2) == 10.0 );
+
+        CHECK( arena.used() > 0 );
+    }
+}
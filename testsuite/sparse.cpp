@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2016 Morwenn
+ *
+ * POLDER is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * POLDER is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <catch.hpp>
+#include <POLDER/execution.h>
+#include <POLDER/matrix.h>
+#include <POLDER/matrix/sparse.h>
+#include <POLDER/thread_pool.h>
+
+using namespace polder;
+
+namespace
+{
+    // Deterministic sparse-ish matrix with about
+    // one non-zero element out of seven
+    auto make_dense(std::size_t height, std::size_t width, int seed)
+        -> Matrix<int>
+    {
+        auto res = Matrix<int>::zeros(height, width);
+        for (std::size_t i = 0 ; i < height ; ++i)
+        {
+            for (std::size_t j = 0 ; j < width ; ++j)
+            {
+                int val = int(i * 31 + j * 17 + seed) % 7;
+                if (val == 0)
+                {
+                    res(i, j) = int(i + j) % 5 - 2 + seed;
+                }
+            }
+        }
+        return res;
+    }
+}
+
+TEST_CASE( "sparse matrix", "[matrix][sparse]" )
+{
+    SECTION( "construction" )
+    {
+        CsrMatrix<int> empty;
+        CHECK( empty.height() == 0 );
+        CHECK( empty.nonzeros() == 0 );
+
+        // The triplets can be in any order and
+        // duplicates are summed
+        CsrMatrix<int> a(3, 4, {
+            { 2, 1, 5 },
+            { 0, 3, 1 },
+            { 0, 0, 2 },
+            { 2, 1, 1 },
+            { 1, 2, -4 }
+        });
+        CHECK( a.height() == 3 );
+        CHECK( a.width() == 4 );
+        CHECK( a.nonzeros() == 4 );
+        CHECK( a.offsets() == std::vector<std::size_t>({ 0, 2, 3, 4 }) );
+        CHECK( a.indices() == std::vector<std::size_t>({ 0, 3, 2, 1 }) );
+        CHECK( a.values() == std::vector<int>({ 2, 1, -4, 6 }) );
+
+        // Reading through a non-const matrix would
+        // insert the missing elements
+        const auto& ca = a;
+        CHECK( ca(0, 0) == 2 );
+        CHECK( ca(2, 1) == 6 );
+        CHECK( ca(1, 1) == 0 );
+        CHECK( a.nonzeros() == 4 );
+
+        Matrix<int> dense = {
+            { 2, 0,  0, 1 },
+            { 0, 0, -4, 0 },
+            { 0, 6,  0, 0 }
+        };
+        CHECK( a.to_dense() == dense );
+        CHECK( Matrix<int>(a) == dense );
+        CHECK( CsrMatrix<int>(dense) == a );
+
+        CscMatrix<int> b(dense);
+        CHECK( b.nonzeros() == 4 );
+        CHECK( b.offsets() == std::vector<std::size_t>({ 0, 1, 2, 3, 4 }) );
+        CHECK( b.indices() == std::vector<std::size_t>({ 0, 2, 1, 0 }) );
+        CHECK( b.to_dense() == dense );
+
+        // Conversions between storage orders
+        CHECK( CscMatrix<int>(a) == b );
+        CHECK( CsrMatrix<int>(b) == a );
+        CHECK( transpose(a).to_dense() == transpose(dense) );
+        CHECK( transpose(b).to_dense() == transpose(dense) );
+    }
+
+    SECTION( "element insertion" )
+    {
+        CsrMatrix<int> a(3, 3);
+        a(1, 2) = 4;
+        a(1, 0) = 3;
+        a(0, 1) = 1;
+        a(1, 2) += 1;
+        CHECK( a.nonzeros() == 3 );
+        CHECK( a.offsets() == std::vector<std::size_t>({ 0, 1, 3, 3 }) );
+        CHECK( a.to_dense() == Matrix<int>({
+            { 0, 1, 0 },
+            { 3, 0, 5 },
+            { 0, 0, 0 }
+        }) );
+
+        a(0, 1) = 0;
+        a.prune();
+        CHECK( a.nonzeros() == 2 );
+        CHECK( a.offsets() == std::vector<std::size_t>({ 0, 0, 2, 2 }) );
+
+        a *= 2;
+        CHECK( a(1, 2) == 10 );
+    }
+
+    SECTION( "comparison with stored zeros" )
+    {
+        Matrix<int> dense = {
+            { 1, 0, 0 },
+            { 0, 0, 2 },
+            { 0, 3, 0 }
+        };
+        CsrMatrix<int> a(dense);
+        CsrMatrix<int> b(dense);
+
+        // Reading with the non-const operator() stores a zero
+        CHECK( b(0, 1) == 0 );
+        CHECK( b(2, 2) == 0 );
+        CHECK( b.nonzeros() == 5 );
+        CHECK( a == b );
+        CHECK( b == a );
+        CHECK( b.to_dense() == dense );
+
+        b(2, 2) = 4;
+        CHECK( a != b );
+        CHECK( b != a );
+        a(2, 2) = 4;
+        CHECK( a == b );
+
+        b(1, 2) = 0;
+        CHECK( a != b );
+        b.prune();
+        a(1, 2) = 0;
+        CHECK( a == b );
+        CHECK( a.nonzeros() != b.nonzeros() );
+    }
+
+    SECTION( "sparse-sparse products" )
+    {
+        auto da = make_dense(23, 31, 1);
+        auto db = make_dense(31, 19, 2);
+        auto expected = da * db;
+
+        CsrMatrix<int> csr_a(da);
+        CsrMatrix<int> csr_b(db);
+        CscMatrix<int> csc_a(da);
+        CscMatrix<int> csc_b(db);
+
+        CHECK( (csr_a * csr_b).to_dense() == expected );
+        CHECK( (csc_a * csc_b).to_dense() == expected );
+        CHECK( (csr_a * csc_b).to_dense() == expected );
+        CHECK( (csc_a * csr_b).to_dense() == expected );
+    }
+
+    SECTION( "sparse-dense products" )
+    {
+        auto da = make_dense(37, 29, 3);
+        Matrix<int> db = make_dense(29, 11, 0) + Matrix<int>::ones(29, 11);
+        auto expected = da * db;
+
+        CsrMatrix<int> csr_a(da);
+        CscMatrix<int> csc_a(da);
+        CHECK( csr_a * db == expected );
+        CHECK( csc_a * db == expected );
+
+        auto expected_t = transpose(db) * transpose(da);
+        CHECK( transpose(db) * transpose(csr_a) == expected_t );
+        CHECK( transpose(db) * transpose(csc_a) == expected_t );
+
+        thread_pool pool(3);
+        auto policy = execution::par.on(pool).with_threshold(1);
+        CHECK( multiply(policy, csr_a, db) == expected );
+        CHECK( multiply(policy, csc_a, db) == expected );
+    }
+
+    SECTION( "sparse matrix-vector product" )
+    {
+        auto da = make_dense(301, 257, 4);
+        std::vector<int> x(da.width());
+        for (std::size_t i = 0 ; i < x.size() ; ++i)
+        {
+            x[i] = int(i % 9) - 4;
+        }
+
+        std::vector<int> expected(da.height());
+        for (std::size_t i = 0 ; i < da.height() ; ++i)
+        {
+            for (std::size_t j = 0 ; j < da.width() ; ++j)
+            {
+                expected[i] += da(i, j) * x[j];
+            }
+        }
+
+        CsrMatrix<int> csr_a(da);
+        CscMatrix<int> csc_a(da);
+        std::vector<int> y(da.height(), 42);
+
+        spmv(csr_a, x.data(), y.data());
+        CHECK( y == expected );
+        std::fill(y.begin(), y.end(), 42);
+        spmv(csc_a, x.data(), y.data());
+        CHECK( y == expected );
+
+        thread_pool pool(3);
+        auto policy = execution::par.on(pool).with_threshold(1);
+        std::fill(y.begin(), y.end(), 42);
+        spmv(policy, csr_a, x.data(), y.data());
+        CHECK( y == expected );
+        std::fill(y.begin(), y.end(), 42);
+        spmv(policy, csc_a, x.data(), y.data());
+        CHECK( y == expected );
+    }
+}